@@ -73,21 +73,120 @@ typedef struct _XUSB_REPORT {
 
 VIGEM_ERROR vigem_target_x360_update(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, XUSB_REPORT report);
 
+typedef VOID(CALLBACK* PFN_VIGEM_X360_NOTIFICATION)(
+    PVIGEM_CLIENT Client,
+    PVIGEM_TARGET Target,
+    UCHAR LargeMotor,
+    UCHAR SmallMotor,
+    UCHAR LedNumber,
+    LPVOID UserData);
+
+VIGEM_ERROR vigem_target_x360_register_notification(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PFN_VIGEM_X360_NOTIFICATION notification, LPVOID userData);
+void vigem_target_x360_unregister_notification(PVIGEM_TARGET target);
+
+typedef enum _DS4_BUTTONS {
+    DS4_BUTTON_THUMB_RIGHT = 1 << 15,
+    DS4_BUTTON_THUMB_LEFT = 1 << 14,
+    DS4_BUTTON_OPTIONS = 1 << 13,
+    DS4_BUTTON_SHARE = 1 << 12,
+    DS4_BUTTON_TRIGGER_RIGHT = 1 << 11,
+    DS4_BUTTON_TRIGGER_LEFT = 1 << 10,
+    DS4_BUTTON_SHOULDER_RIGHT = 1 << 9,
+    DS4_BUTTON_SHOULDER_LEFT = 1 << 8,
+    DS4_BUTTON_TRIANGLE = 1 << 7,
+    DS4_BUTTON_CIRCLE = 1 << 6,
+    DS4_BUTTON_CROSS = 1 << 5,
+    DS4_BUTTON_SQUARE = 1 << 4
+} DS4_BUTTONS;
+
+typedef enum _DS4_SPECIAL_BUTTONS {
+    DS4_SPECIAL_BUTTON_PS = 1 << 0,
+    DS4_SPECIAL_BUTTON_TOUCHPAD = 1 << 1
+} DS4_SPECIAL_BUTTONS;
+
+typedef enum _DS4_DPAD_DIRECTIONS {
+    DS4_BUTTON_DPAD_NONE = 0x8,
+    DS4_BUTTON_DPAD_NORTHWEST = 0x7,
+    DS4_BUTTON_DPAD_WEST = 0x6,
+    DS4_BUTTON_DPAD_SOUTHWEST = 0x5,
+    DS4_BUTTON_DPAD_SOUTH = 0x4,
+    DS4_BUTTON_DPAD_SOUTHEAST = 0x3,
+    DS4_BUTTON_DPAD_EAST = 0x2,
+    DS4_BUTTON_DPAD_NORTHEAST = 0x1,
+    DS4_BUTTON_DPAD_NORTH = 0x0
+} DS4_DPAD_DIRECTIONS;
+
 typedef struct _DS4_REPORT {
     BYTE bThumbLX;
     BYTE bThumbLY;
     BYTE bThumbRX;
     BYTE bThumbRY;
-    BYTE bButtons1;
-    BYTE bButtons2;
-    BYTE bButtons3;
-    BYTE bButtons4;
+    USHORT wButtons;
     BYTE bSpecial;
     BYTE bTriggerL;
     BYTE bTriggerR;
 } DS4_REPORT, *PDS4_REPORT;
 
+#include <pshpack1.h>
+typedef struct _DS4_TOUCH {
+    BYTE bPacketCounter;
+    BYTE bIsUpTrackingNum1;
+    BYTE bTouchData1[3];
+    BYTE bIsUpTrackingNum2;
+    BYTE bTouchData2[3];
+} DS4_TOUCH, *PDS4_TOUCH;
+
+typedef struct _DS4_REPORT_EX {
+    union {
+        struct {
+            BYTE bThumbLX;
+            BYTE bThumbLY;
+            BYTE bThumbRX;
+            BYTE bThumbRY;
+            USHORT wButtons;
+            BYTE bSpecial;
+            BYTE bTriggerL;
+            BYTE bTriggerR;
+            USHORT wTimestamp;
+            BYTE bBatteryLvl;
+            SHORT wGyroX;
+            SHORT wGyroY;
+            SHORT wGyroZ;
+            SHORT wAccelX;
+            SHORT wAccelY;
+            SHORT wAccelZ;
+            BYTE _bUnknown1[5];
+            BYTE bBatteryLvlSpecial;
+            BYTE _bUnknown2[2];
+            BYTE bTouchPacketsN;
+            DS4_TOUCH sCurrentTouch;
+            DS4_TOUCH sPreviousTouch[2];
+        } Report;
+
+        UCHAR ReportBuffer[63];
+    };
+} DS4_REPORT_EX, *PDS4_REPORT_EX;
+#include <poppack.h>
+
 VIGEM_ERROR vigem_target_ds4_update(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, DS4_REPORT report);
+VIGEM_ERROR vigem_target_ds4_update_ex(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, DS4_REPORT_EX report);
+
+typedef struct _DS4_LIGHTBAR_COLOR {
+    UCHAR Red;
+    UCHAR Green;
+    UCHAR Blue;
+} DS4_LIGHTBAR_COLOR, *PDS4_LIGHTBAR_COLOR;
+
+typedef VOID(CALLBACK* PFN_VIGEM_DS4_NOTIFICATION)(
+    PVIGEM_CLIENT Client,
+    PVIGEM_TARGET Target,
+    UCHAR LargeMotor,
+    UCHAR SmallMotor,
+    DS4_LIGHTBAR_COLOR LightbarColor,
+    LPVOID UserData);
+
+VIGEM_ERROR vigem_target_ds4_register_notification(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PFN_VIGEM_DS4_NOTIFICATION notification, LPVOID userData);
+void vigem_target_ds4_unregister_notification(PVIGEM_TARGET target);
 
 #ifdef __cplusplus
 }
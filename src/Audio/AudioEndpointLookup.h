@@ -0,0 +1,140 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief One playback endpoint as an enumeration backend reports it. Id is opaque (raw backend bytes).
+	 */
+	struct FAudioEndpoint
+	{
+		std::string Id;
+		std::string Name;
+	};
+
+	/**
+	 * @brief Lists the playback endpoints (miniaudio on Windows, a fake in the benchmark).
+	 */
+	class IAudioEndpointBackend
+	{
+	public:
+		virtual ~IAudioEndpointBackend() = default;
+
+		/**
+		 * @return false when the enumeration failed; OutEndpoints is then unspecified.
+		 */
+		virtual bool EnumeratePlayback(std::vector<FAudioEndpoint>& OutEndpoints) = 0;
+	};
+
+	/**
+	 * @brief Cached lookup of the DualSense playback endpoint over an enumeration backend.
+	 *
+	 * Enumerates only after Invalidate() (a device-change notification) or when the caller has no
+	 * notifications to rely on. A re-enumeration keeps the endpoint it had, matched by ID and then by
+	 * name, before falling back to the first endpoint named like a DualSense; an unrelated device
+	 * change therefore never moves the haptics to another controller. Not thread-safe, except for
+	 * Invalidate(), which notification threads call.
+	 */
+	class FAudioEndpointLookup
+	{
+	public:
+		/**
+		 * @param bNotificationsActive false when nothing can ever call Invalidate(): every call enumerates.
+		 * @return True when a DualSense endpoint is known; it is copied to OutEndpoint.
+		 */
+		bool Find(IAudioEndpointBackend& Backend, FAudioEndpoint& OutEndpoint, bool bNotificationsActive)
+		{
+			const bool bStale = bDirty.exchange(!bNotificationsActive, std::memory_order_acq_rel);
+			if (!bStale)
+			{
+				if (bHasEndpoint)
+				{
+					OutEndpoint = Endpoint;
+				}
+				return bHasEndpoint;
+			}
+
+			++Enumerations;
+			if (!Backend.EnumeratePlayback(Scratch))
+			{
+				bDirty.store(true, std::memory_order_release);
+				return false;
+			}
+
+			const int Index = MatchDualSenseEndpoint(Scratch, bHasEndpoint ? &Endpoint : nullptr);
+			bHasEndpoint = Index >= 0;
+			if (!bHasEndpoint)
+			{
+				Endpoint = {};
+				return false;
+			}
+
+			Endpoint = Scratch[static_cast<std::size_t>(Index)];
+			OutEndpoint = Endpoint;
+			return true;
+		}
+
+		void Invalidate() { bDirty.store(true, std::memory_order_release); }
+
+		/**
+		 * @brief Forgets the cached endpoint entirely (it failed to open), not just its freshness.
+		 */
+		void Forget()
+		{
+			bHasEndpoint = false;
+			Endpoint = {};
+			Invalidate();
+		}
+
+		std::uint64_t GetEnumerationCount() const { return Enumerations; }
+
+		/**
+		 * @brief Index of the endpoint to use, or -1. Previous (the cached endpoint) wins by ID, then by
+		 * name; otherwise the first endpoint named "DualSense" or "Wireless Controller".
+		 */
+		static int MatchDualSenseEndpoint(const std::vector<FAudioEndpoint>& Endpoints, const FAudioEndpoint* Previous)
+		{
+			if (Previous)
+			{
+				int SameName = -1;
+				for (std::size_t i = 0; i < Endpoints.size(); ++i)
+				{
+					if (Endpoints[i].Name != Previous->Name)
+					{
+						continue;
+					}
+					if (Endpoints[i].Id == Previous->Id)
+					{
+						return static_cast<int>(i);
+					}
+					SameName = SameName < 0 ? static_cast<int>(i) : SameName;
+				}
+				if (SameName >= 0)
+				{
+					return SameName;
+				}
+			}
+
+			for (std::size_t i = 0; i < Endpoints.size(); ++i)
+			{
+				const char* Name = Endpoints[i].Name.c_str();
+				if (std::strstr(Name, "DualSense") != nullptr || std::strstr(Name, "Wireless Controller") != nullptr)
+				{
+					return static_cast<int>(i);
+				}
+			}
+			return -1;
+		}
+
+	private:
+		std::atomic<bool> bDirty{true};
+		bool bHasEndpoint = false;
+		FAudioEndpoint Endpoint;
+		std::vector<FAudioEndpoint> Scratch;
+		std::uint64_t Enumerations = 0;
+	};
+} // namespace GamepadCore
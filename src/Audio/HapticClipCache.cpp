@@ -0,0 +1,356 @@
+#include "HapticClipCache.h"
+#include "Audio/HapticEqualizer.h"
+#include "Audio/HapticMixer.h"
+#include "Audio/HapticSource.h"
+#include "Util/CacheFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+namespace GamepadCore
+{
+	namespace
+	{
+		// On-disk entry: header, encoded payload, checksum of everything before it
+		struct FHapticClipFileHeader
+		{
+			static constexpr char ExpectedMagic[8] = {'G', 'P', 'H', 'C', 'L', 'I', 'P', '1'};
+
+			char Magic[8];
+			std::uint64_t ContentHash;
+			std::uint64_t ParameterHash;
+			std::uint32_t Transport;
+			std::uint32_t Reserved;
+			std::uint64_t PayloadBytes;
+			std::uint8_t Padding[24]; // keeps the payload 64-byte aligned in the mapping
+		};
+		static_assert(sizeof(FHapticClipFileHeader) == 64, "FHapticClipFileHeader is part of the cache file format");
+
+		// Everything the encoded bytes depend on besides the content. Bump FormatVersion when the
+		// encoder math changes in a way these values do not capture.
+		struct FHapticClipParameters
+		{
+			std::uint32_t FormatVersion;
+			std::uint32_t Transport;
+			float Gain;
+			float SampleRate;
+			float RailHz, RailQ, RailGainDb;
+			float ConcreteHz, ConcreteQ, ConcreteGainDb;
+			float LimiterKnee;
+			std::uint32_t MixBlockFrames;
+			std::uint32_t BtBlockFrames;
+			std::uint32_t BtResampledFrames;
+			std::uint32_t BtPacketSize;
+		};
+
+		std::uint64_t GetEntryKey(std::uint64_t ContentHash, std::uint64_t ParameterHash)
+		{
+			return Fnv1a64(&ParameterHash, sizeof(ParameterHash), Fnv1a64(&ContentHash, sizeof(ContentHash)));
+		}
+	} // namespace
+
+	bool FHapticClipCache::SetDirectory(std::string InDirectory, std::uint64_t MaxDirectoryBytes)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (!Entries.empty() && InDirectory != Directory)
+		{
+			return false;
+		}
+		Directory = std::move(InDirectory);
+		MaxBytes = MaxDirectoryBytes;
+		PruneDirectory();
+		return true;
+	}
+
+	void FHapticClipCache::PruneDirectory()
+	{
+		struct FCacheFile
+		{
+			std::filesystem::path Path;
+			std::filesystem::file_time_type Time;
+			std::uintmax_t Bytes;
+		};
+
+		std::error_code Error;
+		if (Directory.empty() || !std::filesystem::is_directory(Directory, Error))
+		{
+			return;
+		}
+
+		std::vector<FCacheFile> Files;
+		std::uintmax_t TotalBytes = 0;
+		for (const auto& Item : std::filesystem::directory_iterator(Directory, Error))
+		{
+			const std::filesystem::path& Path = Item.path();
+			if (Path.extension() == ".tmp")
+			{
+				// Left by a crash between write and rename; stores run under Mutex, so none is in flight
+				std::filesystem::remove(Path, Error);
+			}
+			else if (Path.extension() == ".hclip")
+			{
+				FCacheFile File{Path, Item.last_write_time(Error), Item.file_size(Error)};
+				TotalBytes += Error ? 0 : File.Bytes;
+				Files.push_back(std::move(File));
+			}
+		}
+		if (TotalBytes <= MaxBytes)
+		{
+			return;
+		}
+
+		std::sort(Files.begin(), Files.end(), [](const FCacheFile& A, const FCacheFile& B) { return A.Time < B.Time; });
+		for (const FCacheFile& File : Files)
+		{
+			if (TotalBytes <= MaxBytes)
+			{
+				break;
+			}
+			// Loaded entries are mapped and may be playing: they stay until the cache goes away
+			const std::uint64_t EntryKey = std::strtoull(File.Path.stem().string().c_str(), nullptr, 16);
+			if (Entries.count(EntryKey) == 0 && std::filesystem::remove(File.Path, Error))
+			{
+				TotalBytes -= File.Bytes;
+				++Evictions;
+			}
+		}
+	}
+
+	std::uint64_t FHapticClipCache::HashContent(const void* Data, std::size_t Bytes)
+	{
+		return Fnv1a64(Data, Bytes);
+	}
+
+	std::uint64_t FHapticClipCache::HashParameters(EHapticTransport Transport, float Gain)
+	{
+		FHapticClipParameters Parameters{};
+		Parameters.FormatVersion = FormatVersion;
+		Parameters.Transport = static_cast<std::uint32_t>(Transport);
+		Parameters.Gain = Gain;
+		Parameters.SampleRate = FHapticSourcePipeline::SampleRate;
+		Parameters.RailHz = FHapticEqualizer::RailHz;
+		Parameters.RailQ = FHapticEqualizer::RailQ;
+		Parameters.RailGainDb = FHapticEqualizer::RailGainDb;
+		Parameters.ConcreteHz = FHapticEqualizer::ConcreteHz;
+		Parameters.ConcreteQ = FHapticEqualizer::ConcreteQ;
+		Parameters.ConcreteGainDb = FHapticEqualizer::ConcreteGainDb;
+		Parameters.LimiterKnee = HapticMixKernels::LimiterKnee;
+		Parameters.MixBlockFrames = static_cast<std::uint32_t>(FHapticMixer::BlockFrames);
+		Parameters.BtBlockFrames = static_cast<std::uint32_t>(FHapticEncoder::BtBlockFrames);
+		Parameters.BtResampledFrames = static_cast<std::uint32_t>(FHapticEncoder::BtResampledFrames);
+		Parameters.BtPacketSize = static_cast<std::uint32_t>(FHapticEncoder::BtPacketSize);
+		return Fnv1a64(&Parameters, sizeof(Parameters));
+	}
+
+	void FHapticClipCache::Encode(const float* Interleaved, std::size_t Frames, EHapticTransport Transport, float Gain, std::vector<std::uint8_t>& OutPayload)
+	{
+		OutPayload.clear();
+		if (!Interleaved || Frames == 0)
+		{
+			return;
+		}
+
+		FHapticEqualizer Equalizer;
+		Equalizer.Configure(FHapticSourcePipeline::SampleRate);
+		FHapticFrameRing Unused(1);
+		FHapticEncoder Encoder;
+		Encoder.SetTransport(Transport, Unused);
+
+		const auto Append = [&OutPayload](const void* Data, std::size_t Bytes)
+		{
+			const auto* First = static_cast<const std::uint8_t*>(Data);
+			OutPayload.insert(OutPayload.end(), First, First + Bytes);
+		};
+		const auto OnUsb = [&Append](std::vector<std::int16_t>& Samples) { Append(Samples.data(), Samples.size() * sizeof(std::int16_t)); };
+		const auto OnBt = [&Append](std::vector<std::uint8_t>& Packet) { Append(Packet.data(), Packet.size()); };
+
+		// Same steps and block size as a lone clip on the mixer bus, so the bytes match the live path
+		const std::size_t BtBlockFrames = FHapticEncoder::BtBlockFrames;
+		const std::size_t EncodedFrames = Transport == EHapticTransport::Usb ? Frames : (Frames + BtBlockFrames - 1) / BtBlockFrames * BtBlockFrames;
+		OutPayload.reserve(Transport == EHapticTransport::Usb ? Frames * 2 * sizeof(std::int16_t) : EncodedFrames / BtBlockFrames * 2 * FHapticEncoder::BtPacketSize);
+		for (std::size_t Offset = 0; Offset < EncodedFrames; Offset += FHapticMixer::BlockFrames)
+		{
+			std::size_t Count = std::min(FHapticMixer::BlockFrames, EncodedFrames - Offset);
+			float* Block = Encoder.AppendFrames(Count);
+			const std::size_t Available = Offset < Frames ? std::min(Count, Frames - Offset) : 0;
+			const float* Source = Interleaved + Offset * 2;
+			for (std::size_t i = 0; i < Available * 2; ++i)
+			{
+				Block[i] = Source[i] * Gain;
+			}
+			std::fill_n(Block + Available * 2, (Count - Available) * 2, 0.0f);
+			Equalizer.Process(Block, Block, Count);
+			HapticMixKernels::SoftLimit(Block, Count * 2);
+			Encoder.Flush(OnUsb, OnBt);
+		}
+	}
+
+	void FHapticClipCache::BindPayload(FEntry& Entry, EHapticTransport Transport, const std::uint8_t* Payload, std::size_t Bytes)
+	{
+		Entry.Clip = FEncodedHapticClip{};
+		Entry.Clip.Transport = Transport;
+		if (Transport == EHapticTransport::Usb)
+		{
+			Entry.Clip.UsbSamples = reinterpret_cast<const std::int16_t*>(Payload);
+			Entry.Clip.UsbFrames = Bytes / (2 * sizeof(std::int16_t));
+		}
+		else
+		{
+			Entry.Clip.BtPackets = Payload;
+			Entry.Clip.BtPacketCount = Bytes / FHapticEncoder::BtPacketSize;
+		}
+	}
+
+	const FEncodedHapticClip* FHapticClipCache::Find(std::uint64_t ContentHash, EHapticTransport Transport, float Gain)
+	{
+		const std::uint64_t ParameterHash = HashParameters(Transport, Gain);
+		const std::uint64_t EntryKey = GetEntryKey(ContentHash, ParameterHash);
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		const auto Found = Entries.find(EntryKey);
+		if (Found != Entries.end())
+		{
+			++MemoryHits;
+			return &Found->second->Clip;
+		}
+
+		std::unique_ptr<FEntry> Entry = LoadFile(ContentHash, ParameterHash, Transport);
+		if (!Entry)
+		{
+			return nullptr;
+		}
+		// Recently used entries are the last to be pruned
+		std::error_code Error;
+		std::filesystem::last_write_time(GetFilePath(EntryKey), std::filesystem::file_time_type::clock::now(), Error);
+		++FileHits;
+		const FEncodedHapticClip* Clip = &Entry->Clip;
+		Entries.emplace(EntryKey, std::move(Entry));
+		return Clip;
+	}
+
+	const FEncodedHapticClip* FHapticClipCache::Render(std::uint64_t ContentHash, const float* Interleaved, std::size_t Frames, EHapticTransport Transport, float Gain)
+	{
+		std::vector<std::uint8_t> Payload;
+		Encode(Interleaved, Frames, Transport, Gain, Payload);
+		if (Payload.empty())
+		{
+			return nullptr;
+		}
+
+		const std::uint64_t ParameterHash = HashParameters(Transport, Gain);
+		const std::uint64_t EntryKey = GetEntryKey(ContentHash, ParameterHash);
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		++Renders;
+		const auto Found = Entries.find(EntryKey);
+		if (Found != Entries.end())
+		{
+			// Rendered concurrently by another caller; clips handed out earlier must stay valid
+			return &Found->second->Clip;
+		}
+
+		std::unique_ptr<FEntry> Entry;
+		const bool bStored = !Directory.empty() && SaveFile(ContentHash, ParameterHash, Transport, Payload);
+		if (bStored)
+		{
+			Entry = LoadFile(ContentHash, ParameterHash, Transport);
+		}
+		if (!Entry)
+		{
+			Entry = std::make_unique<FEntry>();
+			Entry->Payload = std::move(Payload);
+			BindPayload(*Entry, Transport, Entry->Payload.data(), Entry->Payload.size());
+		}
+		const FEncodedHapticClip* Clip = &Entry->Clip;
+		Entries.emplace(EntryKey, std::move(Entry));
+		if (bStored)
+		{
+			PruneDirectory();
+		}
+		return Clip;
+	}
+
+	const FEncodedHapticClip* FHapticClipCache::Acquire(const float* Interleaved, std::size_t Frames, EHapticTransport Transport, float Gain)
+	{
+		if (!Interleaved || Frames == 0)
+		{
+			return nullptr;
+		}
+		const std::uint64_t ContentHash = HashContent(Interleaved, Frames * 2 * sizeof(float));
+		if (const FEncodedHapticClip* Clip = Find(ContentHash, Transport, Gain))
+		{
+			return Clip;
+		}
+		return Render(ContentHash, Interleaved, Frames, Transport, Gain);
+	}
+
+	std::string FHapticClipCache::GetFilePath(std::uint64_t EntryKey) const
+	{
+		char Name[32];
+		std::snprintf(Name, sizeof(Name), "%016llx.hclip", static_cast<unsigned long long>(EntryKey));
+		return (std::filesystem::path(Directory) / Name).string();
+	}
+
+	std::unique_ptr<FHapticClipCache::FEntry> FHapticClipCache::LoadFile(std::uint64_t ContentHash, std::uint64_t ParameterHash, EHapticTransport Transport) const
+	{
+		if (Directory.empty())
+		{
+			return nullptr;
+		}
+
+		auto Entry = std::make_unique<FEntry>();
+		const std::string Path = GetFilePath(GetEntryKey(ContentHash, ParameterHash));
+		if (!Entry->File.Open(Path))
+		{
+			return nullptr;
+		}
+
+		const std::uint8_t* Data = Entry->File.GetData();
+		const std::size_t Size = Entry->File.GetSize();
+		FHapticClipFileHeader Header{};
+		if (Size < sizeof(Header) + sizeof(std::uint64_t))
+		{
+			std::cerr << "[HapticClips] Discarding truncated cache entry " << Path << "." << std::endl;
+			return nullptr;
+		}
+		std::memcpy(&Header, Data, sizeof(Header));
+
+		const std::size_t PayloadBytes = Size - sizeof(Header) - sizeof(std::uint64_t);
+		const std::size_t Unit = Transport == EHapticTransport::Usb ? 2 * sizeof(std::int16_t) : 2 * FHapticEncoder::BtPacketSize;
+		std::uint64_t StoredChecksum = 0;
+		std::memcpy(&StoredChecksum, Data + Size - sizeof(StoredChecksum), sizeof(StoredChecksum));
+		if (std::memcmp(Header.Magic, FHapticClipFileHeader::ExpectedMagic, sizeof(Header.Magic)) != 0 || Header.ContentHash != ContentHash ||
+		    Header.ParameterHash != ParameterHash || Header.Transport != static_cast<std::uint32_t>(Transport) || Header.PayloadBytes != PayloadBytes ||
+		    PayloadBytes == 0 || PayloadBytes % Unit != 0 || Fnv1a64(Data, Size - sizeof(StoredChecksum)) != StoredChecksum)
+		{
+			std::cerr << "[HapticClips] Discarding corrupt cache entry " << Path << "." << std::endl;
+			return nullptr;
+		}
+
+		BindPayload(*Entry, Transport, Data + sizeof(Header), PayloadBytes);
+		return Entry;
+	}
+
+	bool FHapticClipCache::SaveFile(std::uint64_t ContentHash, std::uint64_t ParameterHash, EHapticTransport Transport, const std::vector<std::uint8_t>& Payload) const
+	{
+		std::error_code Error;
+		std::filesystem::create_directories(Directory, Error);
+
+		FHapticClipFileHeader Header{};
+		std::memcpy(Header.Magic, FHapticClipFileHeader::ExpectedMagic, sizeof(Header.Magic));
+		Header.ContentHash = ContentHash;
+		Header.ParameterHash = ParameterHash;
+		Header.Transport = static_cast<std::uint32_t>(Transport);
+		Header.PayloadBytes = Payload.size();
+
+		const std::string Path = GetFilePath(GetEntryKey(ContentHash, ParameterHash));
+		if (!WriteCacheFile(Path, {{&Header, sizeof(Header)}, {Payload.data(), Payload.size()}}))
+		{
+			std::cerr << "[HapticClips] Failed to write " << Path << "." << std::endl;
+			return false;
+		}
+		return true;
+	}
+} // namespace GamepadCore
@@ -0,0 +1,293 @@
+#pragma once
+#include "Audio/HapticFileSources.h"
+#include "Audio/HapticStream.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief One clip in its final transport form: what the encoder would have sent, ready to go out as is.
+	 *
+	 * Points into an FHapticClipCache entry (a mapped cache file or memory) and stays valid as long as
+	 * the cache keeps the entry.
+	 */
+	struct FEncodedHapticClip
+	{
+		EHapticTransport Transport = EHapticTransport::Usb;
+		const std::int16_t* UsbSamples = nullptr; // interleaved stereo, 48 kHz
+		std::size_t UsbFrames = 0;
+		const std::uint8_t* BtPackets = nullptr; // FHapticEncoder::BtPacketSize bytes each, two per block
+		std::size_t BtPacketCount = 0;
+
+		std::size_t GetDurationFrames() const
+		{
+			return Transport == EHapticTransport::Usb ? UsbFrames : BtPacketCount / 2 * FHapticEncoder::BtBlockFrames;
+		}
+	};
+
+	/**
+	 * @brief Clips rendered once per transport through the clip path of the mixer (gain, EQ, soft
+	 * limiter, encoder) and kept in their encoded form, one cache file per clip and transport.
+	 *
+	 * Short recurring effects (landings, grinds) otherwise repeat the same filtering and quantizing on
+	 * every hit. An entry is keyed by the hash of the clip content and of every parameter the encoded
+	 * bytes depend on (transport, gain, EQ bands, limiter knee, encoder layout, format version), so a
+	 * pipeline change misses instead of replaying stale bytes. Files are written to a temporary name
+	 * and renamed, mapped on load, and checksummed: a corrupt entry counts as a miss and is rendered
+	 * again. Without a directory the cache lives in memory only.
+	 *
+	 * The directory is bounded: when its files exceed the byte budget, the least recently used ones
+	 * (by file time, refreshed on every load) are deleted, except those loaded by this cache.
+	 */
+	class FHapticClipCache
+	{
+	public:
+		static constexpr std::uint32_t FormatVersion = 1;
+		static constexpr std::uint64_t DefaultMaxDirectoryBytes = 64ull << 20;
+
+		FHapticClipCache() = default;
+		FHapticClipCache(const FHapticClipCache&) = delete;
+		FHapticClipCache& operator=(const FHapticClipCache&) = delete;
+
+		/**
+		 * @brief Directory for the cache files, created on first store.
+		 *
+		 * Clips handed out point into the loaded entries, so the directory can only change while none
+		 * is loaded. Prunes the directory down to MaxDirectoryBytes.
+		 * @return False, keeping the current directory, once entries exist under another one.
+		 */
+		bool SetDirectory(std::string InDirectory, std::uint64_t MaxDirectoryBytes = DefaultMaxDirectoryBytes);
+
+		/**
+		 * @brief Content key of 48 kHz interleaved stereo float frames.
+		 */
+		static std::uint64_t HashContent(const void* Data, std::size_t Bytes);
+
+		/**
+		 * @brief The cached clip, from memory or from its cache file; nullptr on a miss.
+		 */
+		const FEncodedHapticClip* Find(std::uint64_t ContentHash, EHapticTransport Transport, float Gain);
+
+		/**
+		 * @brief Renders the clip, stores it under ContentHash and returns the cached copy.
+		 *
+		 * ContentHash is normally HashContent() of the frames, but may be the hash of the file they
+		 * were decoded from, so that a hit skips decoding as well.
+		 */
+		const FEncodedHapticClip* Render(std::uint64_t ContentHash, const float* Interleaved, std::size_t Frames, EHapticTransport Transport, float Gain);
+
+		/**
+		 * @brief Find() by the content of the frames, Render() on a miss. nullptr only for an empty clip.
+		 */
+		const FEncodedHapticClip* Acquire(const float* Interleaved, std::size_t Frames, EHapticTransport Transport, float Gain);
+
+		/**
+		 * @brief The offline pipeline: Interleaved through gain, EQ and limiter, encoded for Transport
+		 * into OutPayload (int16 stereo for USB; 64-byte packets for Bluetooth, the last block padded
+		 * with the filtered silence that follows the clip).
+		 */
+		static void Encode(const float* Interleaved, std::size_t Frames, EHapticTransport Transport, float Gain, std::vector<std::uint8_t>& OutPayload);
+
+		std::uint64_t GetMemoryHitCount() const
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return MemoryHits;
+		}
+		std::uint64_t GetFileHitCount() const
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return FileHits;
+		}
+		std::uint64_t GetRenderCount() const
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Renders;
+		}
+		std::uint64_t GetEvictionCount() const
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Evictions;
+		}
+
+	private:
+		struct FEntry
+		{
+			FMappedFile File;
+			std::vector<std::uint8_t> Payload; // when the entry could not be stored on disk
+			FEncodedHapticClip Clip;
+		};
+
+		static std::uint64_t HashParameters(EHapticTransport Transport, float Gain);
+		static void BindPayload(FEntry& Entry, EHapticTransport Transport, const std::uint8_t* Payload, std::size_t Bytes);
+
+		std::unique_ptr<FEntry> LoadFile(std::uint64_t ContentHash, std::uint64_t ParameterHash, EHapticTransport Transport) const;
+		bool SaveFile(std::uint64_t ContentHash, std::uint64_t ParameterHash, EHapticTransport Transport, const std::vector<std::uint8_t>& Payload) const;
+		std::string GetFilePath(std::uint64_t EntryKey) const;
+		void PruneDirectory();
+
+		mutable std::mutex Mutex;
+		std::string Directory;
+		std::uint64_t MaxBytes = DefaultMaxDirectoryBytes;
+		std::unordered_map<std::uint64_t, std::unique_ptr<FEntry>> Entries;
+		std::uint64_t MemoryHits = 0;
+		std::uint64_t FileHits = 0;
+		std::uint64_t Renders = 0;
+		std::uint64_t Evictions = 0;
+	};
+
+	/**
+	 * @brief Sends an FEncodedHapticClip at the real-time rate, straight from the cache. Haptics thread.
+	 *
+	 * USB batches run UsbLeadFrames ahead of the clock, like the 16 ms cadence of the live path; one
+	 * Bluetooth packet pair goes out per 1024-frame block. The transport sinks take vectors, so each
+	 * payload is a copy of a slice of the clip into a buffer reserved up front: no filtering,
+	 * quantizing or allocation happens while playing.
+	 */
+	class FEncodedHapticClipPlayer
+	{
+	public:
+		static constexpr std::size_t UsbLeadFrames = 768; // 16 ms
+
+		FEncodedHapticClipPlayer()
+		{
+			UsbSamples.reserve(FHapticEncoder::MaxUsbBatchFrames * 2);
+			Packet.resize(FHapticEncoder::BtPacketSize);
+		}
+
+		void Play(const FEncodedHapticClip* InClip, std::int64_t NowNs)
+		{
+			Clip = InClip;
+			StartNs = NowNs;
+			Sent = 0;
+		}
+
+		void Stop() { Clip = nullptr; }
+
+		bool IsPlaying() const { return Clip != nullptr; }
+		const FEncodedHapticClip* GetClip() const { return Clip; }
+
+		/** Frames of the clip already handed to the transport, where a handover to the mixer resumes. */
+		std::size_t GetSentFrames() const
+		{
+			if (!Clip)
+			{
+				return 0;
+			}
+			return Clip->Transport == EHapticTransport::Usb ? Sent : Sent / 2 * FHapticEncoder::BtBlockFrames;
+		}
+
+		/**
+		 * @brief Sends what is due at NowNs; the clip stops by itself after its last payload.
+		 *
+		 * @param OnUsb Called with a std::vector<std::int16_t>& of interleaved stereo samples.
+		 * @param OnBt Called with a std::vector<std::uint8_t>& holding one 64-byte packet.
+		 * @return Number of payloads handed to the callbacks.
+		 */
+		template<typename FUsbSink, typename FBtSink>
+		std::size_t Send(std::int64_t NowNs, FUsbSink&& OnUsb, FBtSink&& OnBt)
+		{
+			if (!Clip)
+			{
+				return 0;
+			}
+
+			const std::size_t ElapsedFrames = static_cast<std::size_t>(std::max<std::int64_t>(NowNs - StartNs, 0) * 48 / 1000000);
+			std::size_t Payloads = 0;
+			std::size_t Total = 0;
+			if (Clip->Transport == EHapticTransport::Usb)
+			{
+				Total = Clip->UsbFrames;
+				const std::size_t Due = std::min(Total, ElapsedFrames + UsbLeadFrames);
+				while (Sent < Due)
+				{
+					const std::size_t Frames = std::min(FHapticEncoder::MaxUsbBatchFrames, Due - Sent);
+					UsbSamples.assign(Clip->UsbSamples + Sent * 2, Clip->UsbSamples + (Sent + Frames) * 2);
+					OnUsb(UsbSamples);
+					Sent += Frames;
+					++Payloads;
+				}
+			}
+			else
+			{
+				Total = Clip->BtPacketCount;
+				const std::size_t Due = std::min(Total, (ElapsedFrames / FHapticEncoder::BtBlockFrames + 1) * 2);
+				while (Sent < Due)
+				{
+					std::memcpy(Packet.data(), Clip->BtPackets + Sent * FHapticEncoder::BtPacketSize, FHapticEncoder::BtPacketSize);
+					OnBt(Packet);
+					++Sent;
+					++Payloads;
+				}
+			}
+
+			if (Sent >= Total)
+			{
+				Clip = nullptr;
+			}
+			return Payloads;
+		}
+
+	private:
+		const FEncodedHapticClip* Clip = nullptr;
+		std::int64_t StartNs = 0;
+		std::size_t Sent = 0; // USB frames or Bluetooth packets
+		std::vector<std::int16_t> UsbSamples;
+		std::vector<std::uint8_t> Packet;
+	};
+
+	/**
+	 * @brief The USB form of a cached clip as a mixer input, for when it has to share the bus.
+	 *
+	 * The USB payload is the clip after gain, EQ and limiter at 48 kHz, so it only needs converting
+	 * back to float and goes in without EQ. Whatever transport is active, the encoder then encodes
+	 * the mix. Play() and Read() both run on the haptics thread.
+	 */
+	class FEncodedClipHapticSource final : public IHapticAudioSource
+	{
+	public:
+		/**
+		 * @param InClip USB form of the clip; any other is ignored (silence).
+		 * @param StartFrame First frame to play, e.g. what a FEncodedHapticClipPlayer already sent.
+		 */
+		void Play(const FEncodedHapticClip* InClip, std::size_t StartFrame = 0)
+		{
+			Clip = InClip && InClip->Transport == EHapticTransport::Usb ? InClip : nullptr;
+			Position = StartFrame;
+		}
+
+		void Stop() { Clip = nullptr; }
+
+		const char* GetName() const override { return "cached clip"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Clock; }
+		bool IsFinished() const override { return !Clip || Position >= Clip->UsbFrames; }
+
+		std::size_t Read(float* Interleaved, std::size_t Frames) override
+		{
+			if (IsFinished())
+			{
+				return 0;
+			}
+			constexpr float Scale = 1.0f / 32767.0f;
+			const std::size_t Count = std::min(Frames, Clip->UsbFrames - Position);
+			const std::int16_t* Samples = Clip->UsbSamples + Position * 2;
+			for (std::size_t i = 0; i < Count * 2; ++i)
+			{
+				Interleaved[i] = static_cast<float>(Samples[i]) * Scale;
+			}
+			Position += Count;
+			return Count;
+		}
+
+	private:
+		const FEncodedHapticClip* Clip = nullptr;
+		std::size_t Position = 0;
+	};
+} // namespace GamepadCore
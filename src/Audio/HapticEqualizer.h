@@ -0,0 +1,103 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Biquad section (RBJ cookbook), direct form I.
+	 */
+	struct FBiquadFilter
+	{
+		float B0 = 1.0f, B1 = 0.0f, B2 = 0.0f, A1 = 0.0f, A2 = 0.0f;
+		float X1 = 0.0f, X2 = 0.0f, Y1 = 0.0f, Y2 = 0.0f;
+
+		void ConfigurePeaking(float SampleRate, float Frequency, float Q, float GainDb)
+		{
+			const float A = std::pow(10.0f, GainDb / 40.0f);
+			const float Omega = 2.0f * 3.14159265f * Frequency / SampleRate;
+			const float Sn = std::sin(Omega);
+			const float Cs = std::cos(Omega);
+			const float Alpha = Sn / (2.0f * Q);
+
+			const float A0 = 1.0f + Alpha / A;
+			B0 = (1.0f + Alpha * A) / A0;
+			B1 = (-2.0f * Cs) / A0;
+			B2 = (1.0f - Alpha * A) / A0;
+			A1 = (-2.0f * Cs) / A0;
+			A2 = (1.0f - Alpha / A) / A0;
+		}
+
+		void ResetState() { X1 = X2 = Y1 = Y2 = 0.0f; }
+
+		float Process(float In)
+		{
+			const float Out = B0 * In + B1 * X1 + B2 * X2 - A1 * Y1 - A2 * Y2;
+			X2 = X1;
+			X1 = In;
+			Y2 = Y1;
+			Y1 = Out;
+			return Out;
+		}
+	};
+
+	/**
+	 * @brief The haptic EQ every audio source goes through before the encoder.
+	 *
+	 * Two peaking bands per channel bring out the textures the actuators render well: rail grinds
+	 * around 4.5 kHz and concrete rolling around 200 Hz.
+	 */
+	class FHapticEqualizer
+	{
+	public:
+		static constexpr float RailHz = 4500.0f;
+		static constexpr float RailQ = 1.0f;
+		static constexpr float RailGainDb = 5.0f;
+		static constexpr float ConcreteHz = 200.0f;
+		static constexpr float ConcreteQ = 0.7f;
+		static constexpr float ConcreteGainDb = 5.0f;
+
+		void Configure(float SampleRate)
+		{
+			for (FBiquadFilter* Rail : {&RailLeft, &RailRight})
+			{
+				Rail->ConfigurePeaking(SampleRate, RailHz, RailQ, RailGainDb);
+			}
+			for (FBiquadFilter* Concrete : {&ConcreteLeft, &ConcreteRight})
+			{
+				Concrete->ConfigurePeaking(SampleRate, ConcreteHz, ConcreteQ, ConcreteGainDb);
+			}
+			bConfigured = true;
+		}
+
+		bool IsConfigured() const { return bConfigured; }
+
+		void ResetState()
+		{
+			RailLeft.ResetState();
+			RailRight.ResetState();
+			ConcreteLeft.ResetState();
+			ConcreteRight.ResetState();
+		}
+
+		/**
+		 * @brief Filters Frames interleaved stereo frames from In to Out; In and Out may be the same buffer.
+		 */
+		void Process(const float* In, float* Out, std::size_t Frames)
+		{
+			for (std::size_t i = 0; i < Frames; ++i)
+			{
+				const float Left = In[i * 2];
+				const float Right = In[i * 2 + 1];
+				Out[i * 2] = ConcreteLeft.Process(RailLeft.Process(Left));
+				Out[i * 2 + 1] = ConcreteRight.Process(RailRight.Process(Right));
+			}
+		}
+
+	private:
+		FBiquadFilter RailLeft, RailRight;
+		FBiquadFilter ConcreteLeft, ConcreteRight;
+		bool bConfigured = false;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,365 @@
+#pragma once
+#include "Audio/HapticSynth.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Things that happened on the controller or in the game, and what their Values mean.
+	 */
+	enum class EHapticEventType : std::uint8_t
+	{
+		StickFlick,    // strength (0..1), horizontal direction (-1..1)
+		TriggerPull,   // strength (0..1, from the pull speed)
+		TriggerBottom, // trigger reached the end of its travel
+		Impact,        // strength (0..1), duration (s)
+		Grind,         // intensity (0..1, 0 ends it), surface id
+		BoardState     // speed (m/s)
+	};
+
+	struct FHapticEvent
+	{
+		EHapticEventType Type = EHapticEventType::Impact;
+		std::uint8_t Side = 0; // 0 = left, 1 = right (stick and trigger events)
+		float Values[2] = {0.0f, 0.0f};
+		std::int64_t PostedNs = 0;
+	};
+
+	/**
+	 * @brief Single-producer, single-consumer queue of haptic events, from the input thread to the haptics thread.
+	 *
+	 * Fixed capacity; a push into a full queue is refused and counted, never waits.
+	 */
+	class FHapticEventQueue
+	{
+	public:
+		static constexpr std::size_t Capacity = 256;
+
+		bool Push(const FHapticEvent& Event)
+		{
+			const std::size_t Write = WriteIndex.load(std::memory_order_relaxed);
+			if (Write - ReadIndex.load(std::memory_order_acquire) == Capacity)
+			{
+				Dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			Events[Write % Capacity] = Event;
+			WriteIndex.store(Write + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool Pop(FHapticEvent& Out)
+		{
+			const std::size_t Read = ReadIndex.load(std::memory_order_relaxed);
+			if (Read == WriteIndex.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			Out = Events[Read % Capacity];
+			ReadIndex.store(Read + 1, std::memory_order_release);
+			return true;
+		}
+
+		std::uint64_t GetDroppedCount() const { return Dropped.load(std::memory_order_relaxed); }
+
+	private:
+		std::array<FHapticEvent, Capacity> Events{};
+		alignas(64) std::atomic<std::size_t> WriteIndex{0};
+		alignas(64) std::atomic<std::size_t> ReadIndex{0};
+		alignas(64) std::atomic<std::uint64_t> Dropped{0};
+	};
+
+	/**
+	 * @brief Controller state of one input report, as the detector reads it.
+	 */
+	struct FHapticInputSample
+	{
+		float LeftX = 0.0f, LeftY = 0.0f;   // -1..1
+		float RightX = 0.0f, RightY = 0.0f; // -1..1
+		float LeftTrigger = 0.0f;           // 0..1
+		float RightTrigger = 0.0f;          // 0..1
+	};
+
+	/**
+	 * @brief Finds flicks and trigger pulls in the input reports. Input thread.
+	 *
+	 * A flick is a stick going from the center to the rim within FlickWindowNs; the faster, the
+	 * stronger. A pull is a trigger crossing PullThreshold, strength again from how fast it got there
+	 * from rest, and a bottom-out is the trigger reaching the end of its travel. Each re-arms only
+	 * after the stick or trigger returned towards rest, so holding still never repeats an event.
+	 */
+	class FHapticInputEventDetector
+	{
+	public:
+		static constexpr float CenterRadius = 0.3f;
+		static constexpr float RimRadius = 0.9f;
+		static constexpr std::int64_t FlickWindowNs = 80000000;
+		static constexpr float RestTrigger = 0.1f;
+		static constexpr float PullThreshold = 0.5f;
+		static constexpr float BottomThreshold = 0.98f;
+		static constexpr float RearmTrigger = 0.3f;
+		static constexpr std::int64_t FastPullNs = 30000000; // from rest to the threshold in this time is full strength
+
+		/**
+		 * @return Number of events pushed.
+		 */
+		std::size_t Process(const FHapticInputSample& Sample, std::int64_t NowNs, FHapticEventQueue& Queue)
+		{
+			std::size_t Pushed = 0;
+			Pushed += ProcessStick(Sticks[0], Sample.LeftX, Sample.LeftY, 0, NowNs, Queue);
+			Pushed += ProcessStick(Sticks[1], Sample.RightX, Sample.RightY, 1, NowNs, Queue);
+			Pushed += ProcessTrigger(Triggers[0], Sample.LeftTrigger, 0, NowNs, Queue);
+			Pushed += ProcessTrigger(Triggers[1], Sample.RightTrigger, 1, NowNs, Queue);
+			return Pushed;
+		}
+
+		void Reset()
+		{
+			Sticks[0] = Sticks[1] = FStickState{};
+			Triggers[0] = Triggers[1] = FTriggerState{};
+		}
+
+	private:
+		struct FStickState
+		{
+			std::int64_t CenteredNs = 0;
+			bool bCentered = false;
+			bool bArmed = true;
+		};
+
+		struct FTriggerState
+		{
+			std::int64_t RestNs = 0;
+			bool bAtRest = false;
+			bool bPullArmed = true;
+			bool bBottomArmed = true;
+		};
+
+		static std::size_t ProcessStick(FStickState& State, float X, float Y, std::uint8_t Side, std::int64_t NowNs, FHapticEventQueue& Queue)
+		{
+			const float Radius = std::sqrt(X * X + Y * Y);
+			if (Radius < CenterRadius)
+			{
+				State.CenteredNs = NowNs;
+				State.bCentered = true;
+				State.bArmed = true;
+				return 0;
+			}
+			if (Radius < RimRadius || !State.bArmed || !State.bCentered)
+			{
+				return 0;
+			}
+
+			State.bArmed = false;
+			const std::int64_t Elapsed = NowNs - State.CenteredNs;
+			if (Elapsed > FlickWindowNs)
+			{
+				return 0;
+			}
+			FHapticEvent Event;
+			Event.Type = EHapticEventType::StickFlick;
+			Event.Side = Side;
+			Event.Values[0] = 1.0f - 0.5f * static_cast<float>(Elapsed) / static_cast<float>(FlickWindowNs);
+			Event.Values[1] = X / Radius;
+			Event.PostedNs = NowNs;
+			return Queue.Push(Event) ? 1 : 0;
+		}
+
+		static std::size_t ProcessTrigger(FTriggerState& State, float Value, std::uint8_t Side, std::int64_t NowNs, FHapticEventQueue& Queue)
+		{
+			if (Value < RestTrigger)
+			{
+				State.RestNs = NowNs;
+				State.bAtRest = true;
+			}
+			if (Value < RearmTrigger)
+			{
+				State.bPullArmed = true;
+				State.bBottomArmed = true;
+				return 0;
+			}
+
+			std::size_t Pushed = 0;
+			FHapticEvent Event;
+			Event.Side = Side;
+			Event.PostedNs = NowNs;
+			if (State.bPullArmed && Value >= PullThreshold)
+			{
+				State.bPullArmed = false;
+				const std::int64_t Elapsed = State.bAtRest ? std::max<std::int64_t>(NowNs - State.RestNs, 1) : FastPullNs * 10;
+				Event.Type = EHapticEventType::TriggerPull;
+				Event.Values[0] = std::clamp(static_cast<float>(FastPullNs) / static_cast<float>(Elapsed), 0.1f, 1.0f);
+				Pushed += Queue.Push(Event) ? 1 : 0;
+			}
+			if (State.bBottomArmed && Value >= BottomThreshold)
+			{
+				State.bBottomArmed = false;
+				Event.Type = EHapticEventType::TriggerBottom;
+				Event.Values[0] = 1.0f;
+				Pushed += Queue.Push(Event) ? 1 : 0;
+			}
+			return Pushed;
+		}
+
+		FStickState Sticks[2];
+		FTriggerState Triggers[2];
+	};
+
+	/**
+	 * @brief Turns haptic events and rumble into synth voices. Haptics thread, once per tick.
+	 *
+	 * One-shot events (flicks, pulls, impacts) start a voice each. Continuous ones keep a held voice
+	 * and modulate it: a grind and the rolling board follow their latest record and are released when
+	 * it says so or when records stop for ContinuousTimeoutNs; the two rumble motors follow the
+	 * game's motor strengths like the motors of an Xbox pad (large = left, low; small = right, high).
+	 *
+	 * Motors play in a bank of their own, so a burst of events can never steal them and the mixer
+	 * can give rumble its own input (gain, ducking) apart from the effect voices.
+	 */
+	class FHapticEventSynth
+	{
+	public:
+		static constexpr std::int64_t ContinuousTimeoutNs = 150000000;
+		static constexpr float LargeMotorHz = 60.0f;
+		static constexpr float SmallMotorHz = 180.0f;
+		static constexpr float MaxMotorAmplitude = 0.9f;
+
+		explicit FHapticEventSynth(FHapticEventQueue& InQueue)
+		    : Queue(InQueue)
+		{
+		}
+
+		FHapticSynthBank& GetEffectBank() { return EffectBank; }
+		FHapticSynthBank& GetRumbleBank() { return RumbleBank; }
+
+		/**
+		 * @brief Current rumble request; only changes reach the bank.
+		 */
+		void SetRumble(std::uint8_t LargeMotor, std::uint8_t SmallMotor)
+		{
+			SetMotor(Motors[0], LargeMotor, LargeMotorHz, 0.0f);
+			SetMotor(Motors[1], SmallMotor, SmallMotorHz, 1.0f);
+		}
+
+		/**
+		 * @brief Drains the queued events into voices and ends the continuous voices that timed out.
+		 * @return Number of events handled.
+		 */
+		std::size_t Update(std::int64_t NowNs)
+		{
+			std::size_t Handled = 0;
+			FHapticEvent Event;
+			while (Queue.Pop(Event))
+			{
+				OnEvent(Event, NowNs);
+				++Handled;
+			}
+
+			for (FContinuousVoice* Voice : {&Grind, &Board})
+			{
+				if (Voice->Handle.IsValid() && NowNs - Voice->LastEventNs > ContinuousTimeoutNs)
+				{
+					EffectBank.Release(Voice->Handle);
+					Voice->Handle = {};
+				}
+			}
+			return Handled;
+		}
+
+	private:
+		struct FContinuousVoice
+		{
+			FHapticVoiceHandle Handle;
+			std::int64_t LastEventNs = 0;
+		};
+
+		struct FMotorVoice
+		{
+			FHapticVoiceHandle Handle;
+			std::uint8_t Strength = 0;
+		};
+
+		void OnEvent(const FHapticEvent& Event, std::int64_t NowNs)
+		{
+			const float SidePan = Event.Side == 0 ? 0.0f : 1.0f;
+			switch (Event.Type)
+			{
+			case EHapticEventType::StickFlick:
+				EffectBank.Play(HapticVoices::Click(Event.Values[0], std::clamp(0.5f + 0.5f * Event.Values[1], 0.0f, 1.0f)));
+				break;
+			case EHapticEventType::TriggerPull:
+				EffectBank.Play(HapticVoices::Thunk(Event.Values[0], SidePan));
+				break;
+			case EHapticEventType::TriggerBottom:
+				EffectBank.Play(HapticVoices::Click(0.6f, SidePan));
+				break;
+			case EHapticEventType::Impact:
+				EffectBank.Play(HapticVoices::Impact(Event.Values[0], Event.Values[1]));
+				break;
+			case EHapticEventType::Grind:
+			{
+				// Each surface gets its own grain
+				const float Intensity = std::clamp(Event.Values[0], 0.0f, 1.0f);
+				const int Surface = static_cast<int>(Event.Values[1]);
+				const float Frequency = 90.0f + 25.0f * static_cast<float>(((Surface % 6) + 6) % 6);
+				UpdateContinuous(Grind, Intensity > 0.0f, 0.45f * Intensity, Frequency, HapticVoices::Texture(Frequency, 0.7f, 300.0f + 20.0f * Frequency, 0.45f * Intensity), NowNs);
+				break;
+			}
+			case EHapticEventType::BoardState:
+			{
+				const float Speed = std::max(Event.Values[0], 0.0f);
+				const float Amplitude = 0.2f * std::min(Speed / 15.0f, 1.0f);
+				const float Frequency = 35.0f + 2.0f * std::min(Speed, 30.0f);
+				UpdateContinuous(Board, Speed > 0.3f, Amplitude, Frequency, HapticVoices::Texture(Frequency, 0.8f, 150.0f, Amplitude), NowNs);
+				break;
+			}
+			}
+		}
+
+		void UpdateContinuous(FContinuousVoice& Voice, bool bSounding, float Amplitude, float Frequency, const FHapticVoiceParams& Start, std::int64_t NowNs)
+		{
+			Voice.LastEventNs = NowNs;
+			if (!bSounding)
+			{
+				EffectBank.Release(Voice.Handle);
+				Voice.Handle = {};
+			}
+			else if (!EffectBank.Modulate(Voice.Handle, Amplitude, Frequency))
+			{
+				// Not playing yet, or stolen meanwhile
+				Voice.Handle = EffectBank.Play(Start);
+			}
+		}
+
+		void SetMotor(FMotorVoice& Motor, std::uint8_t Strength, float Frequency, float Pan)
+		{
+			if (Strength == Motor.Strength && (Strength == 0 || RumbleBank.IsPlaying(Motor.Handle)))
+			{
+				return;
+			}
+			Motor.Strength = Strength;
+			const float Amplitude = MaxMotorAmplitude * static_cast<float>(Strength) / 255.0f;
+			if (Strength == 0)
+			{
+				RumbleBank.Release(Motor.Handle);
+				Motor.Handle = {};
+			}
+			else if (!RumbleBank.Modulate(Motor.Handle, Amplitude, Frequency))
+			{
+				Motor.Handle = RumbleBank.Play(HapticVoices::Motor(Frequency, Pan, Amplitude));
+			}
+		}
+
+		FHapticEventQueue& Queue;
+		FHapticSynthBank EffectBank;
+		FHapticSynthBank RumbleBank;
+		FContinuousVoice Grind;
+		FContinuousVoice Board;
+		FMotorVoice Motors[2];
+	};
+} // namespace GamepadCore
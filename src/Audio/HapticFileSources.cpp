@@ -0,0 +1,404 @@
+#include "HapticFileSources.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GamepadCore
+{
+	namespace
+	{
+		std::uint32_t ReadLe32(const std::uint8_t* Bytes)
+		{
+			return static_cast<std::uint32_t>(Bytes[0]) | static_cast<std::uint32_t>(Bytes[1]) << 8 | static_cast<std::uint32_t>(Bytes[2]) << 16 |
+			       static_cast<std::uint32_t>(Bytes[3]) << 24;
+		}
+
+		std::uint16_t ReadLe16(const std::uint8_t* Bytes)
+		{
+			return static_cast<std::uint16_t>(Bytes[0] | Bytes[1] << 8);
+		}
+	} // namespace
+
+	bool FMappedPcmFileSource::Open(const std::string& Path, bool bInLoop)
+	{
+		Close();
+		bLoop = bInLoop;
+		if (!Mapping.Open(Path) || !ParseLayout())
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void FMappedPcmFileSource::Close()
+	{
+		Mapping.Close();
+		Samples = nullptr;
+		FrameCount = 0;
+		Position = 0;
+	}
+
+	bool FMappedPcmFileSource::ParseLayout()
+	{
+		const std::uint8_t* Data = Mapping.GetData();
+		const std::size_t Size = Mapping.GetSize();
+		if (Size < 12 || std::memcmp(Data, "RIFF", 4) != 0 || std::memcmp(Data + 8, "WAVE", 4) != 0)
+		{
+			// Headerless 32-bit float stereo
+			Samples = Data;
+			Format = ESampleFormat::Float32;
+			Channels = 2;
+			FrameCount = Size / (2 * sizeof(float));
+			return FrameCount > 0;
+		}
+
+		bool bHasFormat = false;
+		std::size_t Offset = 12;
+		while (Offset + 8 <= Size)
+		{
+			const std::uint8_t* Chunk = Data + Offset;
+			const std::size_t ChunkSize = ReadLe32(Chunk + 4);
+			const std::size_t Available = std::min(ChunkSize, Size - Offset - 8);
+			if (std::memcmp(Chunk, "fmt ", 4) == 0 && Available >= 16)
+			{
+				const std::uint16_t Tag = ReadLe16(Chunk + 8);
+				const std::uint16_t ChunkChannels = ReadLe16(Chunk + 10);
+				const std::uint32_t Rate = ReadLe32(Chunk + 12);
+				const std::uint16_t Bits = ReadLe16(Chunk + 22);
+				if (Rate != 48000 || (ChunkChannels != 1 && ChunkChannels != 2))
+				{
+					return false;
+				}
+				if (Tag == 1 && Bits == 16)
+				{
+					Format = ESampleFormat::Int16;
+				}
+				else if (Tag == 3 && Bits == 32)
+				{
+					Format = ESampleFormat::Float32;
+				}
+				else
+				{
+					return false;
+				}
+				Channels = ChunkChannels;
+				bHasFormat = true;
+			}
+			else if (std::memcmp(Chunk, "data", 4) == 0 && bHasFormat)
+			{
+				Samples = Chunk + 8;
+				FrameCount = Available / (Channels * (Format == ESampleFormat::Int16 ? 2 : 4));
+				return FrameCount > 0;
+			}
+			Offset += 8 + ChunkSize + (ChunkSize & 1);
+		}
+		return false;
+	}
+
+	std::size_t FMappedPcmFileSource::Read(float* Interleaved, std::size_t Frames)
+	{
+		std::size_t Written = 0;
+		while (Written < Frames && FrameCount > 0)
+		{
+			if (Position >= FrameCount)
+			{
+				if (!bLoop)
+				{
+					break;
+				}
+				Position = 0;
+			}
+
+			const std::size_t Count = std::min(Frames - Written, FrameCount - Position);
+			float* Out = Interleaved + Written * 2;
+			if (Format == ESampleFormat::Float32)
+			{
+				const float* In = reinterpret_cast<const float*>(Samples) + Position * Channels;
+				if (Channels == 2)
+				{
+					std::memcpy(Out, In, Count * 2 * sizeof(float));
+				}
+				else
+				{
+					for (std::size_t i = 0; i < Count; ++i)
+					{
+						Out[i * 2] = Out[i * 2 + 1] = In[i];
+					}
+				}
+			}
+			else
+			{
+				constexpr float Scale = 1.0f / 32768.0f;
+				const std::uint8_t* In = Samples + Position * Channels * 2;
+				for (std::size_t i = 0; i < Count; ++i)
+				{
+					const float Left = static_cast<float>(static_cast<std::int16_t>(ReadLe16(In + i * Channels * 2))) * Scale;
+					Out[i * 2] = Left;
+					Out[i * 2 + 1] = Channels == 2 ? static_cast<float>(static_cast<std::int16_t>(ReadLe16(In + i * 4 + 2))) * Scale : Left;
+				}
+			}
+			Position += Count;
+			Written += Count;
+		}
+		return Written;
+	}
+
+#ifdef _WIN32
+	bool FMappedFile::Open(const std::string& Path)
+	{
+		Close();
+		HANDLE Handle = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (Handle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER FileSize{};
+		if (!GetFileSizeEx(Handle, &FileSize) || FileSize.QuadPart <= 0)
+		{
+			CloseHandle(Handle);
+			return false;
+		}
+		HANDLE MappingHandle = CreateFileMappingA(Handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void* View = MappingHandle ? MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		File = Handle;
+		Mapping = MappingHandle;
+		Data = static_cast<const std::uint8_t*>(View);
+		Size = static_cast<std::size_t>(FileSize.QuadPart);
+		if (!Data)
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void FMappedFile::Close()
+	{
+		if (Data)
+		{
+			UnmapViewOfFile(Data);
+		}
+		if (Mapping)
+		{
+			CloseHandle(static_cast<HANDLE>(Mapping));
+		}
+		if (File)
+		{
+			CloseHandle(static_cast<HANDLE>(File));
+		}
+		File = nullptr;
+		Mapping = nullptr;
+		Data = nullptr;
+		Size = 0;
+	}
+
+	bool FPipeHapticSource::Open(const std::string& Path)
+	{
+		Close();
+		HANDLE Handle = CreateNamedPipeA(Path.c_str(), PIPE_ACCESS_INBOUND, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_NOWAIT, 1, 0, 64 * 1024, 0, nullptr);
+		if (Handle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		Pipe = Handle;
+		return true;
+	}
+
+	void FPipeHapticSource::Close()
+	{
+		if (Pipe)
+		{
+			CloseHandle(static_cast<HANDLE>(Pipe));
+		}
+		Pipe = nullptr;
+		PartialBytes = 0;
+	}
+
+	long long FPipeHapticSource::ReadBytes(std::uint8_t* Buffer, std::size_t Bytes)
+	{
+		if (!Pipe)
+		{
+			return -1;
+		}
+		HANDLE Handle = static_cast<HANDLE>(Pipe);
+		// PIPE_NOWAIT: returns at once, connected or not
+		if (!ConnectNamedPipe(Handle, nullptr))
+		{
+			const DWORD Error = GetLastError();
+			if (Error == ERROR_NO_DATA)
+			{
+				// The previous writer closed its end: reset the instance for the next one
+				DisconnectNamedPipe(Handle);
+				PartialBytes = 0;
+			}
+			if (Error != ERROR_PIPE_CONNECTED)
+			{
+				return -1;
+			}
+		}
+		DWORD Read = 0;
+		if (!ReadFile(Handle, Buffer, static_cast<DWORD>(Bytes), &Read, nullptr))
+		{
+			if (GetLastError() == ERROR_BROKEN_PIPE)
+			{
+				// Writer gone: listen for the next one, a half-written frame is dropped
+				DisconnectNamedPipe(Handle);
+				PartialBytes = 0;
+			}
+			return -1;
+		}
+		return static_cast<long long>(Read);
+	}
+#else
+	bool FMappedFile::Open(const std::string& Path)
+	{
+		Close();
+		const int FileDescriptor = open(Path.c_str(), O_RDONLY);
+		if (FileDescriptor < 0)
+		{
+			return false;
+		}
+		struct stat Info{};
+		if (fstat(FileDescriptor, &Info) != 0 || Info.st_size <= 0)
+		{
+			close(FileDescriptor);
+			return false;
+		}
+		const std::size_t FileSize = static_cast<std::size_t>(Info.st_size);
+		void* View = mmap(nullptr, FileSize, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+		close(FileDescriptor); // the mapping keeps the file open
+		if (View == MAP_FAILED)
+		{
+			return false;
+		}
+		madvise(View, FileSize, MADV_SEQUENTIAL);
+		Data = static_cast<const std::uint8_t*>(View);
+		Size = FileSize;
+		return true;
+	}
+
+	void FMappedFile::Close()
+	{
+		if (Data)
+		{
+			munmap(const_cast<std::uint8_t*>(Data), Size);
+		}
+		Data = nullptr;
+		Size = 0;
+	}
+
+	bool FPipeHapticSource::Open(const std::string& Path)
+	{
+		Close();
+		if (mkfifo(Path.c_str(), 0600) == 0)
+		{
+			CreatedPath = Path;
+		}
+		else if (errno != EEXIST)
+		{
+			return false;
+		}
+		// Read end non-blocking: open() does not wait for a writer, read() does not wait for data
+		Descriptor = open(Path.c_str(), O_RDONLY | O_NONBLOCK);
+		if (Descriptor < 0)
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void FPipeHapticSource::Close()
+	{
+		if (Descriptor >= 0)
+		{
+			close(Descriptor);
+		}
+		if (!CreatedPath.empty())
+		{
+			unlink(CreatedPath.c_str());
+			CreatedPath.clear();
+		}
+		Descriptor = -1;
+		PartialBytes = 0;
+	}
+
+	long long FPipeHapticSource::ReadBytes(std::uint8_t* Buffer, std::size_t Bytes)
+	{
+		if (Descriptor < 0)
+		{
+			return -1;
+		}
+		// 0 means no writer at the moment; the next writer to open the FIFO is picked up as is
+		const ssize_t Read = read(Descriptor, Buffer, Bytes);
+		return Read > 0 ? static_cast<long long>(Read) : -1;
+	}
+#endif
+
+	std::size_t FPipeHapticSource::Read(float* Interleaved, std::size_t Frames)
+	{
+		if (Frames == 0)
+		{
+			return 0;
+		}
+		// Bytes land directly in the output; a frame split across writes is completed on the next call
+		std::uint8_t* Bytes = reinterpret_cast<std::uint8_t*>(Interleaved);
+		std::memcpy(Bytes, Partial, PartialBytes);
+		const long long Read = ReadBytes(Bytes + PartialBytes, Frames * FrameBytes - PartialBytes);
+		const std::size_t Total = PartialBytes + static_cast<std::size_t>(std::max(Read, 0LL));
+		const std::size_t Complete = Total / FrameBytes;
+		PartialBytes = Total - Complete * FrameBytes;
+		std::memcpy(Partial, Bytes + Complete * FrameBytes, PartialBytes);
+		return Complete;
+	}
+
+	std::unique_ptr<IHapticAudioSource> CreateHapticSource(const std::string& Spec)
+	{
+		const std::size_t Colon = Spec.find(':');
+		const std::string Kind = Spec.substr(0, Colon);
+		const std::string Argument = Colon == std::string::npos ? std::string() : Spec.substr(Colon + 1);
+
+		if (Kind == "loopback")
+		{
+			return std::make_unique<FLoopbackHapticSource>();
+		}
+		if (Kind == "tone")
+		{
+			char* End = nullptr;
+			const float Left = Argument.empty() ? 80.0f : std::strtof(Argument.c_str(), &End);
+			const float Right = End && *End == ',' ? std::strtof(End + 1, nullptr) : Left;
+			return std::make_unique<FToneHapticSource>(Left, Right);
+		}
+		if ((Kind == "file" || Kind == "file-once") && !Argument.empty())
+		{
+			auto Source = std::make_unique<FMappedPcmFileSource>();
+			if (Source->Open(Argument, Kind == "file"))
+			{
+				return Source;
+			}
+			return nullptr;
+		}
+		if (Kind == "pipe" && !Argument.empty())
+		{
+			auto Source = std::make_unique<FPipeHapticSource>();
+			if (Source->Open(Argument))
+			{
+				return Source;
+			}
+			return nullptr;
+		}
+		return nullptr;
+	}
+} // namespace GamepadCore
@@ -0,0 +1,129 @@
+#pragma once
+#include "Audio/HapticSource.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief A whole file mapped read-only into memory, for sequential reads.
+	 */
+	class FMappedFile
+	{
+	public:
+		FMappedFile() = default;
+		~FMappedFile() { Close(); }
+
+		FMappedFile(const FMappedFile&) = delete;
+		FMappedFile& operator=(const FMappedFile&) = delete;
+
+		/**
+		 * @return false when the file is missing, empty or cannot be mapped.
+		 */
+		bool Open(const std::string& Path);
+		void Close();
+
+		bool IsOpen() const { return Data != nullptr; }
+		const std::uint8_t* GetData() const { return Data; }
+		std::size_t GetSize() const { return Size; }
+
+	private:
+#ifdef _WIN32
+		void* File = nullptr;    // HANDLE
+		void* Mapping = nullptr; // HANDLE
+#endif
+		const std::uint8_t* Data = nullptr;
+		std::size_t Size = 0;
+	};
+
+	/**
+	 * @brief A PCM file mapped into memory and played at the real-time rate.
+	 *
+	 * Accepts 48 kHz WAV (16-bit integer or 32-bit float, mono or stereo) and headerless 32-bit
+	 * float interleaved stereo. The file is never copied: Read() converts straight from the mapping.
+	 */
+	class FMappedPcmFileSource final : public IHapticAudioSource
+	{
+	public:
+		FMappedPcmFileSource() = default;
+		~FMappedPcmFileSource() override { Close(); }
+
+		FMappedPcmFileSource(const FMappedPcmFileSource&) = delete;
+		FMappedPcmFileSource& operator=(const FMappedPcmFileSource&) = delete;
+
+		bool Open(const std::string& Path, bool bLoop = true);
+		void Close();
+
+		const char* GetName() const override { return "file"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Clock; }
+		bool IsFinished() const override { return !bLoop && Position >= FrameCount; }
+		std::size_t Read(float* Interleaved, std::size_t Frames) override;
+
+		std::size_t GetFrameCount() const { return FrameCount; }
+
+	private:
+		enum class ESampleFormat : std::uint8_t
+		{
+			Int16,
+			Float32
+		};
+
+		bool ParseLayout();
+
+		FMappedFile Mapping;
+		const std::uint8_t* Samples = nullptr;
+		ESampleFormat Format = ESampleFormat::Float32;
+		std::size_t Channels = 2;
+		std::size_t FrameCount = 0;
+		std::size_t Position = 0;
+		bool bLoop = true;
+	};
+
+	/**
+	 * @brief 32-bit float interleaved stereo written by another process into a pipe.
+	 *
+	 * A POSIX FIFO (created if missing) or a Windows named pipe server (\\.\pipe\...). Reads never
+	 * block; writers may come and go, the source waits for the next one.
+	 */
+	class FPipeHapticSource final : public IHapticAudioSource
+	{
+	public:
+		FPipeHapticSource() = default;
+		~FPipeHapticSource() override { Close(); }
+
+		FPipeHapticSource(const FPipeHapticSource&) = delete;
+		FPipeHapticSource& operator=(const FPipeHapticSource&) = delete;
+
+		bool Open(const std::string& Path);
+		void Close();
+
+		const char* GetName() const override { return "pipe"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Stream; }
+		std::size_t Read(float* Interleaved, std::size_t Frames) override;
+
+	private:
+		static constexpr std::size_t FrameBytes = 2 * sizeof(float);
+
+		// Bytes read into Buffer, -1 when nothing is available right now
+		long long ReadBytes(std::uint8_t* Buffer, std::size_t Bytes);
+
+#ifdef _WIN32
+		void* Pipe = nullptr; // HANDLE
+#else
+		int Descriptor = -1;
+		std::string CreatedPath; // FIFO created by Open(), removed by Close()
+#endif
+		std::uint8_t Partial[FrameBytes] = {};
+		std::size_t PartialBytes = 0;
+	};
+
+	/**
+	 * @brief Builds a source from its description.
+	 *
+	 * "loopback", "tone[:LeftHz[,RightHz]]", "file:<path>" (looped), "file-once:<path>",
+	 * "pipe:<path>". nullptr when the description is unknown or the file/pipe cannot be opened.
+	 */
+	std::unique_ptr<IHapticAudioSource> CreateHapticSource(const std::string& Spec);
+} // namespace GamepadCore
@@ -0,0 +1,480 @@
+#pragma once
+#include "Audio/HapticEqualizer.h"
+#include "Audio/HapticSource.h"
+#include "Audio/HapticStream.h"
+#include "Input/InputStateBuffer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAMEPAD_MIXER_SSE 1
+#endif
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Block kernels of the haptic mixer. The SSE2 paths work on two stereo frames per vector.
+	 */
+	namespace HapticMixKernels
+	{
+		// Below the knee the limiter is the identity; above, it bends smoothly towards +-1
+		constexpr float LimiterKnee = 0.8f;
+
+		/**
+		 * @brief Out += In * Gain(i) over interleaved stereo, Gain(i) = Gain + Step * i for frame i.
+		 */
+		inline void MixRamp(float* Out, const float* In, std::size_t Frames, float Gain, float Step)
+		{
+			std::size_t i = 0;
+#ifdef GAMEPAD_MIXER_SSE
+			__m128 Gains = _mm_setr_ps(Gain, Gain, Gain + Step, Gain + Step);
+			const __m128 GainStep = _mm_set1_ps(2.0f * Step);
+			for (; i + 2 <= Frames; i += 2)
+			{
+				const __m128 Mixed = _mm_add_ps(_mm_loadu_ps(Out + i * 2), _mm_mul_ps(_mm_loadu_ps(In + i * 2), Gains));
+				_mm_storeu_ps(Out + i * 2, Mixed);
+				Gains = _mm_add_ps(Gains, GainStep);
+			}
+#endif
+			for (; i < Frames; ++i)
+			{
+				const float FrameGain = Gain + Step * static_cast<float>(i);
+				Out[i * 2] += In[i * 2] * FrameGain;
+				Out[i * 2 + 1] += In[i * 2 + 1] * FrameGain;
+			}
+		}
+
+		/**
+		 * @brief Largest absolute sample of Samples floats.
+		 */
+		inline float Peak(const float* In, std::size_t Samples)
+		{
+			std::size_t i = 0;
+			float Result = 0.0f;
+#ifdef GAMEPAD_MIXER_SSE
+			const __m128 AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			__m128 Max = _mm_setzero_ps();
+			for (; i + 4 <= Samples; i += 4)
+			{
+				Max = _mm_max_ps(Max, _mm_and_ps(_mm_loadu_ps(In + i), AbsMask));
+			}
+			alignas(16) float Lanes[4];
+			_mm_store_ps(Lanes, Max);
+			Result = std::max(std::max(Lanes[0], Lanes[1]), std::max(Lanes[2], Lanes[3]));
+#endif
+			for (; i < Samples; ++i)
+			{
+				Result = std::max(Result, std::fabs(In[i]));
+			}
+			return Result;
+		}
+
+		inline float SoftLimitSample(float Sample)
+		{
+			const float Magnitude = std::fabs(Sample);
+			if (Magnitude <= LimiterKnee)
+			{
+				return Sample;
+			}
+			const float Over = (Magnitude - LimiterKnee) / (1.0f - LimiterKnee);
+			return std::copysign(LimiterKnee + (1.0f - LimiterKnee) * Over / (1.0f + Over), Sample);
+		}
+
+		/**
+		 * @brief Soft-knee limiter in place: continuous slope at the knee, never reaches +-1.
+		 *
+		 * Replaces the hard clamp for mixed signals, so summed peaks are rounded off instead of
+		 * flattened into square edges the actuators render as clicks.
+		 */
+		inline void SoftLimit(float* Buffer, std::size_t Samples)
+		{
+			std::size_t i = 0;
+#ifdef GAMEPAD_MIXER_SSE
+			const __m128 SignMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+			const __m128 Knee = _mm_set1_ps(LimiterKnee);
+			const __m128 Range = _mm_set1_ps(1.0f - LimiterKnee);
+			const __m128 InvRange = _mm_set1_ps(1.0f / (1.0f - LimiterKnee));
+			const __m128 One = _mm_set1_ps(1.0f);
+			for (; i + 4 <= Samples; i += 4)
+			{
+				const __m128 Sample = _mm_loadu_ps(Buffer + i);
+				const __m128 Sign = _mm_and_ps(Sample, SignMask);
+				const __m128 Magnitude = _mm_andnot_ps(SignMask, Sample);
+				const __m128 Over = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(Magnitude, Knee), _mm_setzero_ps()), InvRange);
+				const __m128 Bent = _mm_add_ps(Knee, _mm_mul_ps(Range, _mm_div_ps(Over, _mm_add_ps(One, Over))));
+				const __m128 Below = _mm_cmple_ps(Magnitude, Knee);
+				const __m128 Limited = _mm_or_ps(_mm_and_ps(Below, Magnitude), _mm_andnot_ps(Below, Bent));
+				_mm_storeu_ps(Buffer + i, _mm_or_ps(Limited, Sign));
+			}
+#endif
+			for (; i < Samples; ++i)
+			{
+				Buffer[i] = SoftLimitSample(Buffer[i]);
+			}
+		}
+	} // namespace HapticMixKernels
+
+	/**
+	 * @brief How one source is mixed into the haptic bus.
+	 */
+	struct FHapticMixerInputConfig
+	{
+		float Gain = 1.0f;
+		// Higher priority is mixed first and paces the bus; it can duck lower priorities
+		int Priority = 0;
+		// Gain imposed on the lower-priority inputs it ducks while this one is active (1 = no ducking)
+		float DuckGain = 1.0f;
+		// False for sources that are already equalized (the source pipeline, pushed PCM) or must stay dry (rumble)
+		bool bEqualize = true;
+		// Ducking group bits this input belongs to, and the groups of lower-priority inputs it ducks
+		std::uint32_t Groups = 1;
+		std::uint32_t DuckGroups = ~0u;
+	};
+
+	/**
+	 * @brief Sums up to MaxInputs haptic sources into the encoder staging buffer.
+	 *
+	 * Per block: every input is read into one scratch buffer and accumulated with its gain, ramped
+	 * towards the ducking target of the block; inputs that need the haptic EQ are summed apart and
+	 * filtered once (the EQ is linear, so that equals filtering each of them), then the sum goes
+	 * through the soft limiter. Cost is linear in the number of inputs and nothing is allocated
+	 * after AddInput().
+	 *
+	 * Stage() runs on the haptics thread instead of pulling one ring into the encoder: the
+	 * highest-priority buffered input that has frames decides how many are mixed (everything it
+	 * has, like the single-source path), otherwise playing clock sources are mixed at the real-time
+	 * rate, and nothing is staged while everything is silent.
+	 */
+	class FHapticMixer
+	{
+	public:
+		static constexpr std::size_t MaxInputs = 16;
+		static constexpr std::size_t BlockFrames = 512;
+		static constexpr float ActivityThreshold = 1.0f / 1024.0f;
+		static constexpr std::size_t ActivityHoldFrames = 4800; // 100 ms
+		static constexpr std::size_t DuckRampFrames = 480;      // 10 ms
+		static constexpr std::int64_t MaxOwedFrames = static_cast<std::int64_t>(FHapticEncoder::BtBlockFrames * 2);
+
+		FHapticMixer()
+		    : Scratch(BlockFrames * 2)
+		    , EqualizedSum(BlockFrames * 2)
+		{
+			Equalizer.Configure(FHapticSourcePipeline::SampleRate);
+		}
+
+		/**
+		 * @brief Adds Source (not owned, must outlive the mixer). Setup only, before mixing starts.
+		 * @return Input index, -1 when full.
+		 */
+		int AddInput(IHapticAudioSource* Source, const FHapticMixerInputConfig& Config)
+		{
+			if (!Source || InputCount == MaxInputs)
+			{
+				return -1;
+			}
+			// Kept sorted by priority, so a block knows who is active above an input before mixing it
+			std::size_t Slot = InputCount;
+			while (Slot > 0 && Inputs[Slot - 1].Config.Priority < Config.Priority)
+			{
+				Inputs[Slot] = Inputs[Slot - 1];
+				--Slot;
+			}
+			Inputs[Slot] = FInput{Source, Config, Config.Gain, 0, static_cast<int>(InputCount)};
+			return static_cast<int>(InputCount++);
+		}
+
+		std::size_t GetInputCount() const { return InputCount; }
+
+		/** Haptics thread. The change is ramped like ducking. */
+		void SetGain(int Index, float Gain)
+		{
+			if (const FInput* Input = Find(Index))
+			{
+				const_cast<FInput*>(Input)->Config.Gain = Gain;
+			}
+		}
+
+		bool IsInputActive(int Index) const
+		{
+			const FInput* Input = Find(Index);
+			return Input && Input->HeldFrames > 0;
+		}
+
+		/** True while any input but ExceptIndex is active, i.e. the bus carries something audible. */
+		bool IsAnyInputActive(int ExceptIndex = -1) const
+		{
+			for (std::size_t i = 0; i < InputCount; ++i)
+			{
+				if (Inputs[i].Index != ExceptIndex && Inputs[i].HeldFrames > 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * @brief Current gain of an input, ducking included.
+		 */
+		float GetInputGain(int Index) const
+		{
+			const FInput* Input = Find(Index);
+			return Input ? Input->CurrentGain : 0.0f;
+		}
+
+		/**
+		 * @brief Mixes Frames frames of all inputs into Out (interleaved stereo, overwritten).
+		 */
+		void Mix(float* Out, std::size_t Frames)
+		{
+			for (std::size_t Offset = 0; Offset < Frames; Offset += BlockFrames)
+			{
+				MixBlock(Out + Offset * 2, std::min(BlockFrames, Frames - Offset));
+			}
+		}
+
+		/**
+		 * @brief Haptics thread, once per tick: mixes what is due straight into the encoder staging.
+		 * @return Number of frames staged.
+		 */
+		std::size_t Stage(FHapticEncoder& Encoder, std::int64_t NowNs)
+		{
+			const std::int64_t ElapsedFrames = LastStageNs != 0 ? (NowNs - LastStageNs) * 48 / 1000000 : 0;
+			LastStageNs = NowNs;
+
+			std::size_t Buffered = 0;
+			bool bClockPlaying = false;
+			for (std::size_t i = 0; i < InputCount; ++i)
+			{
+				IHapticAudioSource& Source = *Inputs[i].Source;
+				if (Source.GetDrive() == EHapticSourceDrive::Clock)
+				{
+					bClockPlaying = bClockPlaying || !Source.IsFinished();
+				}
+				else if (Buffered == 0)
+				{
+					Buffered = Source.GetBufferedFrames();
+				}
+			}
+
+			std::size_t Frames = Buffered;
+			if (bClockPlaying)
+			{
+				// Buffered frames count towards real time too, so bursty streams never make us over-stage
+				OwedFrames = std::clamp(OwedFrames + ElapsedFrames, -static_cast<std::int64_t>(FHapticEncoder::MaxPendingFrames), MaxOwedFrames);
+				Frames = std::max(Frames, static_cast<std::size_t>(std::max<std::int64_t>(OwedFrames, 0)));
+			}
+			else
+			{
+				OwedFrames = 0;
+			}
+
+			float* Out = Encoder.AppendFrames(Frames);
+			Mix(Out, Frames);
+			if (bClockPlaying)
+			{
+				OwedFrames -= static_cast<std::int64_t>(Frames);
+			}
+			return Frames;
+		}
+
+	private:
+		struct FInput
+		{
+			IHapticAudioSource* Source = nullptr;
+			FHapticMixerInputConfig Config;
+			float CurrentGain = 1.0f;
+			std::size_t HeldFrames = 0; // > 0 while active: frames left of the activity hold
+			int Index = -1;
+		};
+
+		const FInput* Find(int Index) const
+		{
+			for (std::size_t i = 0; i < InputCount; ++i)
+			{
+				if (Inputs[i].Index == Index)
+				{
+					return &Inputs[i];
+				}
+			}
+			return nullptr;
+		}
+
+		/**
+		 * @brief Ducking imposed on Inputs[Slot] by the active inputs already mixed in this block.
+		 *
+		 * Inputs of equal priority never duck each other; within a higher priority level the deepest
+		 * duck wins, and the levels multiply.
+		 */
+		float GetDucking(std::size_t Slot) const
+		{
+			const FHapticMixerInputConfig& Config = Inputs[Slot].Config;
+			float Ducking = 1.0f;
+			for (std::size_t i = 0; i < Slot && Inputs[i].Config.Priority > Config.Priority;)
+			{
+				const int Priority = Inputs[i].Config.Priority;
+				float LevelDucking = 1.0f;
+				for (; i < Slot && Inputs[i].Config.Priority == Priority; ++i)
+				{
+					if (Inputs[i].HeldFrames > 0 && (Inputs[i].Config.DuckGroups & Config.Groups) != 0)
+					{
+						LevelDucking = std::min(LevelDucking, Inputs[i].Config.DuckGain);
+					}
+				}
+				Ducking *= LevelDucking;
+			}
+			return Ducking;
+		}
+
+		void MixBlock(float* Out, std::size_t Frames)
+		{
+			const std::size_t Samples = Frames * 2;
+			std::fill_n(Out, Samples, 0.0f);
+			bool bAnyEqualized = false;
+
+			for (std::size_t i = 0; i < InputCount; ++i)
+			{
+				FInput& Input = Inputs[i];
+				const std::size_t Read = Input.Source->Read(Scratch.data(), Frames);
+				const float Peak = HapticMixKernels::Peak(Scratch.data(), Read * 2);
+				Input.HeldFrames = Peak > ActivityThreshold ? ActivityHoldFrames : Input.HeldFrames - std::min(Input.HeldFrames, Frames);
+
+				const float Target = Input.Config.Gain * GetDucking(i);
+				const float MaxStep = static_cast<float>(Frames) / static_cast<float>(DuckRampFrames);
+				const float EndGain = Input.CurrentGain + std::clamp(Target - Input.CurrentGain, -MaxStep, MaxStep);
+				if (Read > 0 && (Input.CurrentGain != 0.0f || EndGain != 0.0f))
+				{
+					float* Destination = Out;
+					if (Input.Config.bEqualize)
+					{
+						if (!bAnyEqualized)
+						{
+							std::fill_n(EqualizedSum.data(), Samples, 0.0f);
+							bAnyEqualized = true;
+						}
+						Destination = EqualizedSum.data();
+					}
+					const float Step = (EndGain - Input.CurrentGain) / static_cast<float>(Frames);
+					HapticMixKernels::MixRamp(Destination, Scratch.data(), Read, Input.CurrentGain, Step);
+				}
+				Input.CurrentGain = EndGain;
+			}
+
+			if (bAnyEqualized)
+			{
+				Equalizer.Process(EqualizedSum.data(), EqualizedSum.data(), Frames);
+				HapticMixKernels::MixRamp(Out, EqualizedSum.data(), Frames, 1.0f, 0.0f);
+			}
+			HapticMixKernels::SoftLimit(Out, Samples);
+		}
+
+		std::array<FInput, MaxInputs> Inputs{};
+		std::size_t InputCount = 0;
+		std::vector<float> Scratch;
+		std::vector<float> EqualizedSum;
+		FHapticEqualizer Equalizer;
+		std::int64_t LastStageNs = 0;
+		std::int64_t OwedFrames = 0;
+	};
+
+	/**
+	 * @brief A frame ring as a mixer input, e.g. the source pipeline or the pushed game PCM.
+	 *
+	 * Keeps at most MaxBacklogFrames beyond what is read, so a lower-priority stream that the bus is
+	 * not paced on cannot build up latency.
+	 */
+	class FRingHapticSource final : public IHapticAudioSource
+	{
+	public:
+		explicit FRingHapticSource(FHapticFrameRing& InRing, std::size_t InMaxBacklogFrames = FHapticEncoder::BtBlockFrames)
+		    : Ring(InRing)
+		    , MaxBacklogFrames(InMaxBacklogFrames)
+		{
+		}
+
+		const char* GetName() const override { return "ring"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Stream; }
+		std::size_t GetBufferedFrames() const override { return Ring.Size(); }
+
+		std::size_t Read(float* Interleaved, std::size_t Frames) override
+		{
+			const std::size_t Popped = Ring.Pop(Interleaved, Frames);
+			Ring.TrimTo(MaxBacklogFrames);
+			return Popped;
+		}
+
+	private:
+		FHapticFrameRing& Ring;
+		std::size_t MaxBacklogFrames;
+	};
+
+	/**
+	 * @brief A clip played from caller-owned memory (48 kHz interleaved stereo float), retriggerable.
+	 *
+	 * Play() may be called from one other thread; the clip memory must stay valid until the clip
+	 * ended or another one was started and picked up.
+	 */
+	class FClipHapticSource final : public IHapticAudioSource
+	{
+	public:
+		void Play(const float* Interleaved, std::size_t Frames, float Gain = 1.0f)
+		{
+			Requests.Publish(FClipRequest{Interleaved, Frames, Gain});
+		}
+
+		void Stop() { Play(nullptr, 0); }
+
+		const char* GetName() const override { return "clip"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Clock; }
+
+		bool IsFinished() const override
+		{
+			return Requests.GetPublishCount() == SeenRequests && Position >= Current.Frames;
+		}
+
+		std::size_t Read(float* Interleaved, std::size_t Frames) override
+		{
+			FClipRequest Request;
+			const std::uint64_t Published = Requests.Snapshot(Request);
+			if (Published != SeenRequests)
+			{
+				SeenRequests = Published;
+				Current = Request;
+				Position = 0;
+			}
+			if (!Current.Data || Position >= Current.Frames)
+			{
+				return 0;
+			}
+
+			// The rest of the block stays silent once the clip ends
+			const std::size_t Count = std::min(Frames, Current.Frames - Position);
+			const float* Source = Current.Data + Position * 2;
+			for (std::size_t i = 0; i < Count * 2; ++i)
+			{
+				Interleaved[i] = Source[i] * Current.Gain;
+			}
+			std::fill_n(Interleaved + Count * 2, (Frames - Count) * 2, 0.0f);
+			Position += Count;
+			return Frames;
+		}
+
+	private:
+		struct FClipRequest
+		{
+			const float* Data;
+			std::size_t Frames;
+			float Gain;
+		};
+
+		TSeqLock<FClipRequest> Requests;
+		FClipRequest Current{nullptr, 0, 1.0f};
+		std::uint64_t SeenRequests = 0;
+		std::size_t Position = 0;
+	};
+} // namespace GamepadCore
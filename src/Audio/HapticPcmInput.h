@@ -0,0 +1,105 @@
+#pragma once
+#include "Audio/HapticEqualizer.h"
+#include "Audio/HapticStream.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Haptic PCM submitted by the game itself, as 48 kHz interleaved stereo float.
+	 *
+	 * Bypasses the system loopback capture (its extra buffering, and the music and voice chat it picks
+	 * up). The producer, one game thread, either renders in place, Acquire() -> write -> Commit(),
+	 * and the EQ then runs in place over the committed slots, or hands its own buffer to Submit(),
+	 * which runs the EQ from that buffer straight into the ring. Either way the frames are written
+	 * once, into the ring the haptics thread stages from, exactly like captured frames.
+	 *
+	 * The haptics thread drives the encoder from GetRing() instead of the capture ring while
+	 * IsActive(), i.e. until ActiveHoldNs after the last submission.
+	 */
+	class FHapticPcmInput
+	{
+	public:
+		static constexpr float SampleRate = 48000.0f;
+		static constexpr std::int64_t ActiveHoldNs = 250000000;
+
+		explicit FHapticPcmInput(std::size_t CapacityFrames = 8192)
+		    : Ring(CapacityFrames)
+		{
+			Equalizer.Configure(SampleRate);
+		}
+
+		/**
+		 * @brief Producer: up to Frames ring slots to render into. Valid until Commit().
+		 */
+		FHapticRingSpan Acquire(std::size_t Frames)
+		{
+			Acquired = Ring.Reserve(Frames);
+			return Acquired;
+		}
+
+		/**
+		 * @brief Producer: filters and publishes the first Frames frames written since Acquire().
+		 * @return Number of frames published.
+		 */
+		std::size_t Commit(std::size_t Frames, std::int64_t NowNs)
+		{
+			const std::size_t Count = std::min(Frames, Acquired.Total());
+			const std::size_t First = std::min(Count, Acquired.Frames[0]);
+			Equalizer.Process(Acquired.Data[0], Acquired.Data[0], First);
+			Equalizer.Process(Acquired.Data[1], Acquired.Data[1], Count - First);
+			Ring.Commit(Count);
+			Acquired = FHapticRingSpan();
+			Account(Count, Frames - Count, NowNs);
+			return Count;
+		}
+
+		/**
+		 * @brief Producer: filters Frames frames from Interleaved into the ring. Frames that do not
+		 * fit are dropped.
+		 * @return Number of frames accepted.
+		 */
+		std::size_t Submit(const float* Interleaved, std::size_t Frames, std::int64_t NowNs)
+		{
+			const FHapticRingSpan Span = Ring.Reserve(Frames);
+			Equalizer.Process(Interleaved, Span.Data[0], Span.Frames[0]);
+			Equalizer.Process(Interleaved + Span.Frames[0] * 2, Span.Data[1], Span.Frames[1]);
+			Ring.Commit(Span.Total());
+			Account(Span.Total(), Frames - Span.Total(), NowNs);
+			return Span.Total();
+		}
+
+		bool IsActive(std::int64_t NowNs) const
+		{
+			const std::int64_t Last = LastSubmitNs.load(std::memory_order_acquire);
+			return Last != 0 && NowNs - Last < ActiveHoldNs;
+		}
+
+		/** Consumer side (haptics thread). */
+		FHapticFrameRing& GetRing() { return Ring; }
+
+		std::uint64_t GetSubmittedFrames() const { return SubmittedFrames.load(std::memory_order_relaxed); }
+		std::uint64_t GetDroppedFrames() const { return DroppedFrames.load(std::memory_order_relaxed); }
+
+	private:
+		void Account(std::size_t Accepted, std::size_t Dropped, std::int64_t NowNs)
+		{
+			SubmittedFrames.fetch_add(Accepted, std::memory_order_relaxed);
+			DroppedFrames.fetch_add(Dropped, std::memory_order_relaxed);
+			if (Accepted > 0)
+			{
+				LastSubmitNs.store(NowNs, std::memory_order_release);
+			}
+		}
+
+		FHapticFrameRing Ring;
+		FHapticEqualizer Equalizer; // producer thread only
+		FHapticRingSpan Acquired;
+		std::atomic<std::int64_t> LastSubmitNs{0};
+		std::atomic<std::uint64_t> SubmittedFrames{0};
+		std::atomic<std::uint64_t> DroppedFrames{0};
+	};
+} // namespace GamepadCore
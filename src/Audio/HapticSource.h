@@ -0,0 +1,317 @@
+#pragma once
+#include "Audio/HapticEqualizer.h"
+#include "Audio/HapticStream.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief What paces a haptic audio source.
+	 */
+	enum class EHapticSourceDrive : std::uint8_t
+	{
+		Capture, // frames arrive with the capture device callback (system loopback)
+		Clock,   // rendered at the real-time rate by the haptics thread (files, generators)
+		Stream   // whatever has arrived is taken by the haptics thread (pipes)
+	};
+
+	/**
+	 * @brief A producer of 48 kHz interleaved stereo float frames for the haptic pipeline.
+	 *
+	 * Sources only produce raw frames: EQ, buffering and encoding are shared by all of them in
+	 * FHapticSourcePipeline. Read() is called from one rendering thread at a time and must not block.
+	 */
+	class IHapticAudioSource
+	{
+	public:
+		virtual ~IHapticAudioSource() = default;
+
+		virtual const char* GetName() const = 0;
+		virtual EHapticSourceDrive GetDrive() const = 0;
+
+		/**
+		 * @brief Writes up to Frames frames into Interleaved.
+		 * @return Number of frames written; fewer than Frames when nothing more is available right now.
+		 */
+		virtual std::size_t Read(float* Interleaved, std::size_t Frames) = 0;
+
+		/** True while the source has nothing to play: end of a non-looping file, idle rumble. */
+		virtual bool IsFinished() const { return false; }
+
+		/** Stream sources backed by a buffer: frames Read() can return right now (0 if unknown). */
+		virtual std::size_t GetBufferedFrames() const { return 0; }
+
+		/** Capture-driven sources: the block the device just delivered, read by the next Read() calls. */
+		virtual void OnCapture(const float* /*Interleaved*/, std::size_t /*Frames*/) {}
+	};
+
+	/**
+	 * @brief System audio from the loopback capture device.
+	 */
+	class FLoopbackHapticSource final : public IHapticAudioSource
+	{
+	public:
+		const char* GetName() const override { return "loopback"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Capture; }
+
+		void OnCapture(const float* Interleaved, std::size_t Frames) override
+		{
+			Block = Interleaved;
+			BlockFrames = Interleaved ? Frames : 0;
+		}
+
+		std::size_t Read(float* Interleaved, std::size_t Frames) override
+		{
+			const std::size_t Count = std::min(Frames, BlockFrames);
+			std::copy_n(Block, Count * 2, Interleaved);
+			Block += Count * 2;
+			BlockFrames -= Count;
+			return Count;
+		}
+
+	private:
+		const float* Block = nullptr;
+		std::size_t BlockFrames = 0;
+	};
+
+	/**
+	 * @brief Test and calibration signal: a sine per channel, optionally gated into bursts.
+	 */
+	class FToneHapticSource final : public IHapticAudioSource
+	{
+	public:
+		static constexpr float SampleRate = 48000.0f;
+
+		/**
+		 * @param BurstFrames Length of each on/off period; 0 plays continuously.
+		 */
+		FToneHapticSource(float LeftHz, float RightHz, float Amplitude = 0.5f, std::size_t BurstFrames = 0)
+		    : LeftIncrement(LeftHz / SampleRate)
+		    , RightIncrement(RightHz / SampleRate)
+		    , Amplitude(Amplitude)
+		    , BurstFrames(BurstFrames)
+		{
+		}
+
+		const char* GetName() const override { return "tone"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Clock; }
+
+		std::size_t Read(float* Interleaved, std::size_t Frames) override
+		{
+			constexpr float TwoPi = 6.28318530718f;
+			for (std::size_t i = 0; i < Frames; ++i)
+			{
+				const bool bOn = BurstFrames == 0 || (Position / BurstFrames) % 2 == 0;
+				const float Gain = bOn ? Amplitude : 0.0f;
+				Interleaved[i * 2] = Gain * std::sin(TwoPi * LeftPhase);
+				Interleaved[i * 2 + 1] = Gain * std::sin(TwoPi * RightPhase);
+				LeftPhase += LeftIncrement;
+				RightPhase += RightIncrement;
+				LeftPhase -= std::floor(LeftPhase);
+				RightPhase -= std::floor(RightPhase);
+				++Position;
+			}
+			return Frames;
+		}
+
+	private:
+		float LeftIncrement;
+		float RightIncrement;
+		float Amplitude;
+		std::size_t BurstFrames;
+		float LeftPhase = 0.0f;
+		float RightPhase = 0.0f;
+		std::uint64_t Position = 0;
+	};
+
+	/**
+	 * @brief The one block path every haptic audio source goes through: source -> EQ -> frame ring.
+	 *
+	 * The capture device callback hands its blocks to OnCapture() and the haptics thread calls Pump()
+	 * every tick; each renders only when the current source is paced by it, so the capture device
+	 * keeps running whatever the source is. Frames are rendered straight into reserved ring slots
+	 * and filtered in place. SetSource() swaps the source at runtime from any other thread: it
+	 * waits for a render in flight to finish, then destroys the previous source.
+	 */
+	class FHapticSourcePipeline
+	{
+	public:
+		static constexpr float SampleRate = 48000.0f;
+		// Frames rendered per Pump() at most: clock-driven catch-up after a stall, and stream reads
+		static constexpr std::int64_t MaxOwedFrames = static_cast<std::int64_t>(FHapticEncoder::BtBlockFrames * 2);
+
+		explicit FHapticSourcePipeline(std::size_t CapacityFrames = 16384)
+		    : Ring(CapacityFrames)
+		{
+			Equalizer.Configure(SampleRate);
+		}
+
+		~FHapticSourcePipeline() { delete Source.load(std::memory_order_acquire); }
+
+		FHapticSourcePipeline(const FHapticSourcePipeline&) = delete;
+		FHapticSourcePipeline& operator=(const FHapticSourcePipeline&) = delete;
+
+		/**
+		 * @brief Makes NewSource current (nullptr: silence). Not callable from the rendering threads.
+		 */
+		void SetSource(std::unique_ptr<IHapticAudioSource> NewSource)
+		{
+			// Raised before a capture source becomes current and dropped only after it stopped being current,
+			// so Pump() never contends with a capture block for the render scope
+			const bool bCapture = NewSource && NewSource->GetDrive() == EHapticSourceDrive::Capture;
+			if (bCapture)
+			{
+				bCaptureDriven.store(true);
+			}
+			IHapticAudioSource* Previous = Source.exchange(NewSource.release());
+			if (!bCapture)
+			{
+				bCaptureDriven.store(false);
+			}
+			bSwitched.store(true);
+			while (bRendering.load())
+			{
+				std::this_thread::yield();
+			}
+			delete Previous;
+			SwitchCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Capture device callback: renders the block if the current source is capture-driven.
+		 * @return Number of frames rendered into the ring.
+		 */
+		std::size_t OnCapture(const float* Interleaved, std::size_t Frames)
+		{
+			FRenderScope Scope(*this);
+			IHapticAudioSource* Current = Scope.GetSource();
+			if (!Current || Current->GetDrive() != EHapticSourceDrive::Capture)
+			{
+				return 0;
+			}
+			Current->OnCapture(Interleaved, Frames);
+			return Render(*Current, Frames);
+		}
+
+		/**
+		 * @brief Haptics thread, once per tick: renders what clock- and stream-driven sources owe.
+		 * @return Number of frames rendered into the ring.
+		 */
+		std::size_t Pump(std::int64_t NowNs)
+		{
+			if (bCaptureDriven.load())
+			{
+				// Capture blocks render themselves; holding the scope here would make one arrive unowned and be lost
+				LastPumpNs = NowNs;
+				OwedFrames = 0;
+				return 0;
+			}
+			FRenderScope Scope(*this);
+			if (!Scope.IsOwned())
+			{
+				return 0; // a capture block is being rendered, what is owed carries over to the next tick
+			}
+			IHapticAudioSource* Current = Scope.GetSource();
+			const std::int64_t ElapsedFrames = LastPumpNs != 0 ? (NowNs - LastPumpNs) * 48 / 1000000 : MaxOwedFrames;
+			LastPumpNs = NowNs;
+			if (!Current || Current->GetDrive() == EHapticSourceDrive::Capture || Current->IsFinished())
+			{
+				OwedFrames = 0;
+				return 0;
+			}
+			if (Current->GetDrive() == EHapticSourceDrive::Stream)
+			{
+				return Render(*Current, static_cast<std::size_t>(MaxOwedFrames));
+			}
+
+			OwedFrames = std::min(OwedFrames + ElapsedFrames, MaxOwedFrames);
+			const std::size_t Rendered = Render(*Current, static_cast<std::size_t>(std::max<std::int64_t>(OwedFrames, 0)));
+			OwedFrames -= static_cast<std::int64_t>(Rendered);
+			return Rendered;
+		}
+
+		/** Consumer side (haptics thread). */
+		FHapticFrameRing& GetRing() { return Ring; }
+
+		std::uint64_t GetRenderedFrames() const { return RenderedFrames.load(std::memory_order_relaxed); }
+		std::uint64_t GetSwitchCount() const { return SwitchCount.load(std::memory_order_relaxed); }
+
+	private:
+		/**
+		 * @brief Excludes the other rendering thread and holds the current source alive until destroyed.
+		 */
+		class FRenderScope
+		{
+		public:
+			explicit FRenderScope(FHapticSourcePipeline& InOwner)
+			    : Owner(InOwner)
+			{
+				bOwned = !Owner.bRendering.exchange(true);
+			}
+
+			~FRenderScope()
+			{
+				if (bOwned)
+				{
+					Owner.bRendering.store(false, std::memory_order_release);
+				}
+			}
+
+			bool IsOwned() const { return bOwned; }
+
+			IHapticAudioSource* GetSource() const
+			{
+				if (!bOwned)
+				{
+					return nullptr;
+				}
+				if (Owner.bSwitched.exchange(false))
+				{
+					// New source: its first frames must not be filtered with the previous one's history
+					Owner.Equalizer.ResetState();
+				}
+				return Owner.Source.load();
+			}
+
+		private:
+			FHapticSourcePipeline& Owner;
+			bool bOwned = false;
+		};
+
+		std::size_t Render(IHapticAudioSource& Current, std::size_t Frames)
+		{
+			const FHapticRingSpan Span = Ring.Reserve(Frames);
+			std::size_t Count = 0;
+			for (int Part = 0; Part < 2 && Span.Frames[Part] > 0; ++Part)
+			{
+				const std::size_t PartRead = Current.Read(Span.Data[Part], Span.Frames[Part]);
+				Equalizer.Process(Span.Data[Part], Span.Data[Part], PartRead);
+				Count += PartRead;
+				if (PartRead < Span.Frames[Part])
+				{
+					break;
+				}
+			}
+			Ring.Commit(Count);
+			RenderedFrames.fetch_add(Count, std::memory_order_relaxed);
+			return Count;
+		}
+
+		FHapticFrameRing Ring;
+		FHapticEqualizer Equalizer; // rendering threads only, under bRendering
+		std::atomic<IHapticAudioSource*> Source{nullptr};
+		std::atomic<bool> bRendering{false};
+		std::atomic<bool> bSwitched{false};
+		std::atomic<bool> bCaptureDriven{false};
+		std::int64_t LastPumpNs = 0; // haptics thread
+		std::int64_t OwedFrames = 0;
+		std::atomic<std::uint64_t> RenderedFrames{0};
+		std::atomic<std::uint64_t> SwitchCount{0};
+	};
+} // namespace GamepadCore
@@ -0,0 +1,369 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Transport the haptic stream is currently encoded for.
+	 */
+	enum class EHapticTransport : std::uint8_t
+	{
+		Usb,
+		Bluetooth
+	};
+
+	/**
+	 * @brief Writable part of an FHapticFrameRing, in two pieces where the ring wraps.
+	 */
+	struct FHapticRingSpan
+	{
+		float* Data[2] = {nullptr, nullptr}; // interleaved stereo
+		std::size_t Frames[2] = {0, 0};
+
+		std::size_t Total() const { return Frames[0] + Frames[1]; }
+	};
+
+	/**
+	 * @brief Single-producer, single-consumer ring of interleaved stereo float frames.
+	 *
+	 * The capture callback pushes filtered frames, the haptics thread pops them. Frames are kept in
+	 * transport-neutral float form so the encoder downstream can be swapped without losing audio.
+	 * A producer can also write in place: Reserve() hands out the free slots, Commit() publishes them.
+	 */
+	class FHapticFrameRing
+	{
+	public:
+		explicit FHapticFrameRing(std::size_t CapacityFrames = 16384)
+		{
+			std::size_t Capacity = 1;
+			while (Capacity < CapacityFrames)
+			{
+				Capacity <<= 1;
+			}
+			Mask = Capacity - 1;
+			Samples.resize(Capacity * 2);
+		}
+
+		/**
+		 * @brief Producer side. Frames that do not fit are dropped.
+		 * @return Number of frames written.
+		 */
+		std::size_t Push(const float* Interleaved, std::size_t Frames)
+		{
+			const FHapticRingSpan Span = Reserve(Frames);
+			std::copy_n(Interleaved, Span.Frames[0] * 2, Span.Data[0]);
+			std::copy_n(Interleaved + Span.Frames[0] * 2, Span.Frames[1] * 2, Span.Data[1]);
+			Commit(Span.Total());
+			return Span.Total();
+		}
+
+		/**
+		 * @brief Producer side, zero-copy: up to Frames free slots to be written in place.
+		 *
+		 * Nothing is visible to the consumer until Commit(); reserving again before that returns the
+		 * same slots.
+		 */
+		FHapticRingSpan Reserve(std::size_t Frames)
+		{
+			const std::size_t Write = WriteIndex.load(std::memory_order_relaxed);
+			const std::size_t Read = ReadIndex.load(std::memory_order_acquire);
+			const std::size_t Count = std::min(Frames, (Mask + 1) - (Write - Read));
+			const std::size_t Start = Write & Mask;
+
+			FHapticRingSpan Span;
+			Span.Frames[0] = std::min(Count, (Mask + 1) - Start);
+			Span.Frames[1] = Count - Span.Frames[0];
+			Span.Data[0] = Samples.data() + Start * 2;
+			Span.Data[1] = Samples.data();
+			return Span;
+		}
+
+		/**
+		 * @brief Producer side. Publishes the first Frames frames of the last Reserve().
+		 */
+		void Commit(std::size_t Frames)
+		{
+			WriteIndex.store(WriteIndex.load(std::memory_order_relaxed) + Frames, std::memory_order_release);
+		}
+
+		/**
+		 * @brief Consumer side.
+		 * @return Number of frames copied into Out.
+		 */
+		std::size_t Pop(float* Out, std::size_t MaxFrames)
+		{
+			const std::size_t Read = ReadIndex.load(std::memory_order_relaxed);
+			const std::size_t Count = std::min(MaxFrames, WriteIndex.load(std::memory_order_acquire) - Read);
+
+			for (std::size_t i = 0; i < Count; ++i)
+			{
+				const std::size_t Slot = ((Read + i) & Mask) * 2;
+				Out[i * 2] = Samples[Slot];
+				Out[i * 2 + 1] = Samples[Slot + 1];
+			}
+
+			ReadIndex.store(Read + Count, std::memory_order_release);
+			return Count;
+		}
+
+		/**
+		 * @brief Consumer side. Drops the oldest frames so at most MaxFrames remain buffered.
+		 */
+		void TrimTo(std::size_t MaxFrames)
+		{
+			const std::size_t Read = ReadIndex.load(std::memory_order_relaxed);
+			const std::size_t Available = WriteIndex.load(std::memory_order_acquire) - Read;
+			if (Available > MaxFrames)
+			{
+				ReadIndex.store(Read + (Available - MaxFrames), std::memory_order_release);
+			}
+		}
+
+		std::size_t Size() const
+		{
+			return WriteIndex.load(std::memory_order_acquire) - ReadIndex.load(std::memory_order_acquire);
+		}
+
+	private:
+		std::vector<float> Samples;
+		std::size_t Mask = 0;
+		alignas(64) std::atomic<std::size_t> WriteIndex{0};
+		alignas(64) std::atomic<std::size_t> ReadIndex{0};
+	};
+
+	/**
+	 * @brief Turns buffered float frames into DualSense haptic payloads for the active transport.
+	 *
+	 * USB receives 48 kHz int16 stereo batches; Bluetooth receives 64-byte int8 packets resampled
+	 * to 3 kHz, two per 1024-frame block. Frames are first pulled from the capture ring into a
+	 * staging buffer owned by the consumer thread, where other sources (e.g. synthesized rumble) can
+	 * be mixed in place before encoding. The transport can be changed between Drain() calls: the
+	 * frames already buffered are carried over to the new encoder, trimmed to MaxSwitchBacklogFrames
+	 * so a switch never adds more than that much latency.
+	 */
+	class FHapticEncoder
+	{
+	public:
+		static constexpr std::size_t MaxUsbBatchFrames = 2048;
+		static constexpr std::size_t BtBlockFrames = 1024;
+		static constexpr std::size_t BtResampledFrames = 64;
+		static constexpr std::size_t BtPacketSize = 64;
+		static constexpr std::size_t MaxSwitchBacklogFrames = 2048;
+		static constexpr std::size_t MaxPendingFrames = 8192;
+
+		FHapticEncoder()
+		{
+			UsbSamples.reserve(MaxUsbBatchFrames * 2);
+			Pending.resize(MaxPendingFrames * 2);
+			Packet.resize(BtPacketSize);
+		}
+
+		/**
+		 * @brief Selects the encoder used by the next Flush(). Call from the consumer thread.
+		 * @return True if the transport actually changed.
+		 */
+		bool SetTransport(EHapticTransport NewTransport, FHapticFrameRing& Ring)
+		{
+			if (NewTransport == Transport)
+			{
+				return false;
+			}
+
+			Transport = NewTransport;
+			if (PendingFrames > MaxSwitchBacklogFrames)
+			{
+				Consume(PendingFrames - MaxSwitchBacklogFrames);
+			}
+			Ring.TrimTo(MaxSwitchBacklogFrames - PendingFrames);
+			LowPassStateLeft = 0.0f;
+			LowPassStateRight = 0.0f;
+			++SwitchCount;
+			return true;
+		}
+
+		EHapticTransport GetTransport() const { return Transport; }
+		std::uint64_t GetSwitchCount() const { return SwitchCount; }
+		std::size_t GetPendingFrames() const { return PendingFrames; }
+
+		/**
+		 * @brief Moves the frames available in Ring into the staging buffer.
+		 *
+		 * If fewer than MinFrames arrived, the difference is staged as silence so that mixed-in
+		 * sources keep running while the capture is idle.
+		 * @return Number of frames appended to the staging buffer.
+		 */
+		std::size_t Pull(FHapticFrameRing& Ring, std::size_t MinFrames = 0)
+		{
+			const std::size_t Free = MaxPendingFrames - PendingFrames;
+			const std::size_t Popped = Ring.Pop(Pending.data() + PendingFrames * 2, Free);
+			const std::size_t Silence = std::min(MinFrames > Popped ? MinFrames - Popped : 0, Free - Popped);
+			std::fill_n(Pending.data() + (PendingFrames + Popped) * 2, Silence * 2, 0.0f);
+			PendingFrames += Popped + Silence;
+			return Popped + Silence;
+		}
+
+		/**
+		 * @brief Appends up to Frames frames to the staging buffer, to be written in place (e.g. by a mixer).
+		 * @param Frames In: frames wanted. Out: frames appended, limited by the free staging space.
+		 * @return Interleaved stereo view of the appended frames.
+		 */
+		float* AppendFrames(std::size_t& Frames)
+		{
+			Frames = std::min(Frames, MaxPendingFrames - PendingFrames);
+			float* Appended = Pending.data() + PendingFrames * 2;
+			PendingFrames += Frames;
+			return Appended;
+		}
+
+		/**
+		 * @brief Interleaved stereo view of the newest Frames staged frames, for in-place mixing.
+		 */
+		float* GetNewestFrames(std::size_t Frames)
+		{
+			return Pending.data() + (PendingFrames - std::min(Frames, PendingFrames)) * 2;
+		}
+
+		/**
+		 * @brief Drops the staged frames unsent, e.g. while a pre-encoded clip holds the transport.
+		 */
+		void DiscardPending() { PendingFrames = 0; }
+
+		/**
+		 * @brief Encodes everything the active transport can consume from the staging buffer.
+		 *
+		 * @param OnUsb Called with a std::vector<std::int16_t>& of interleaved stereo samples.
+		 * @param OnBt Called with a std::vector<std::uint8_t>& holding one 64-byte packet.
+		 * @return Number of payloads handed to the callbacks.
+		 */
+		template<typename FUsbSink, typename FBtSink>
+		std::size_t Flush(FUsbSink&& OnUsb, FBtSink&& OnBt)
+		{
+			return Transport == EHapticTransport::Usb ? FlushUsb(OnUsb) : FlushBt(OnBt);
+		}
+
+		/**
+		 * @brief Pull() followed by Flush().
+		 */
+		template<typename FUsbSink, typename FBtSink>
+		std::size_t Drain(FHapticFrameRing& Ring, FUsbSink&& OnUsb, FBtSink&& OnBt)
+		{
+			Pull(Ring);
+			return Flush(OnUsb, OnBt);
+		}
+
+	private:
+		static constexpr float kLowPassAlpha = 1.0f;
+		static constexpr float kOneMinusAlpha = 1.0f - kLowPassAlpha;
+
+		void Consume(std::size_t Frames)
+		{
+			std::copy(Pending.begin() + Frames * 2, Pending.begin() + PendingFrames * 2, Pending.begin());
+			PendingFrames -= Frames;
+		}
+
+		template<typename FUsbSink>
+		std::size_t FlushUsb(FUsbSink& OnUsb)
+		{
+			std::size_t Sent = 0;
+			for (std::size_t Offset = 0; Offset < PendingFrames; Offset += MaxUsbBatchFrames)
+			{
+				const std::size_t Frames = std::min(MaxUsbBatchFrames, PendingFrames - Offset);
+				const float* Source = Pending.data() + Offset * 2;
+
+				UsbSamples.resize(Frames * 2);
+				for (std::size_t i = 0; i < Frames; ++i)
+				{
+					const float InLeft = Source[i * 2];
+					const float InRight = Source[i * 2 + 1];
+
+					LowPassStateLeft = kOneMinusAlpha * InLeft + kLowPassAlpha * LowPassStateLeft;
+					LowPassStateRight = kOneMinusAlpha * InRight + kLowPassAlpha * LowPassStateRight;
+
+					const float OutLeft = std::clamp(InLeft - LowPassStateLeft, -1.0f, 1.0f);
+					const float OutRight = std::clamp(InRight - LowPassStateRight, -1.0f, 1.0f);
+
+					UsbSamples[i * 2] = static_cast<std::int16_t>(OutLeft * 32767.0f);
+					UsbSamples[i * 2 + 1] = static_cast<std::int16_t>(OutRight * 32767.0f);
+				}
+
+				OnUsb(UsbSamples);
+				++Sent;
+			}
+			PendingFrames = 0;
+			return Sent;
+		}
+
+		template<typename FBtSink>
+		std::size_t FlushBt(FBtSink& OnBt)
+		{
+			std::size_t Sent = 0;
+			std::size_t Offset = 0;
+			while (PendingFrames - Offset >= BtBlockFrames)
+			{
+				const float* Block = Pending.data() + Offset * 2;
+				Offset += BtBlockFrames;
+
+				constexpr float Ratio = 3000.0f / 48000.0f;
+				float Resampled[BtResampledFrames * 2];
+				for (std::size_t OutFrame = 0; OutFrame < BtResampledFrames; ++OutFrame)
+				{
+					const float SrcPos = static_cast<float>(OutFrame) / Ratio;
+					std::size_t SrcIndex = static_cast<std::size_t>(SrcPos);
+					float Frac = SrcPos - static_cast<float>(SrcIndex);
+					if (SrcIndex >= BtBlockFrames - 1)
+					{
+						SrcIndex = BtBlockFrames - 2;
+						Frac = 1.0f;
+					}
+
+					const float Left0 = Block[SrcIndex * 2];
+					const float Left1 = Block[(SrcIndex + 1) * 2];
+					const float Right0 = Block[SrcIndex * 2 + 1];
+					const float Right1 = Block[(SrcIndex + 1) * 2 + 1];
+
+					const float InLeft = Left0 + Frac * (Left1 - Left0);
+					const float InRight = Right0 + Frac * (Right1 - Right0);
+
+					LowPassStateLeft = kOneMinusAlpha * InLeft + kLowPassAlpha * LowPassStateLeft;
+					LowPassStateRight = kOneMinusAlpha * InRight + kLowPassAlpha * LowPassStateRight;
+
+					Resampled[OutFrame * 2] = InLeft - LowPassStateLeft;
+					Resampled[OutFrame * 2 + 1] = InRight - LowPassStateRight;
+				}
+
+				// Two packets of 32 stereo frames each
+				for (std::size_t Half = 0; Half < 2; ++Half)
+				{
+					for (std::size_t i = 0; i < BtPacketSize; ++i)
+					{
+						const float Sample = Resampled[Half * BtPacketSize + i];
+						const int Quantized = std::clamp(static_cast<int>(std::round(Sample * 127.0f)), -128, 127);
+						Packet[i] = static_cast<std::uint8_t>(static_cast<std::int8_t>(Quantized));
+					}
+					OnBt(Packet);
+					++Sent;
+				}
+			}
+
+			if (Offset > 0)
+			{
+				Consume(Offset);
+			}
+			return Sent;
+		}
+
+		EHapticTransport Transport = EHapticTransport::Usb;
+		std::uint64_t SwitchCount = 0;
+		float LowPassStateLeft = 0.0f;
+		float LowPassStateRight = 0.0f;
+		std::vector<float> Pending;
+		std::size_t PendingFrames = 0;
+		std::vector<std::int16_t> UsbSamples;
+		std::vector<std::uint8_t> Packet;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,592 @@
+#pragma once
+#include "Audio/HapticSource.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAMEPAD_SYNTH_SSE 1
+#endif
+
+namespace GamepadCore
+{
+	/**
+	 * @brief One synthesizer voice: a sine oscillator blended with low-passed noise, under an envelope.
+	 *
+	 * The envelope rises over Attack, falls to Sustain over Decay, stays there for Hold and fades out
+	 * over Release. A negative Hold keeps the voice at Sustain until it is released.
+	 */
+	struct FHapticVoiceParams
+	{
+		float Frequency = 80.0f;      // Hz
+		float Sweep = 0.0f;           // Hz per second, e.g. a falling thump
+		float Amplitude = 0.5f;       // peak, 0..1
+		float Pan = 0.5f;             // 0 = left actuator only, 0.5 = both at full, 1 = right only
+		float Noise = 0.0f;           // 0 = pure tone .. 1 = pure noise
+		float NoiseCutoff = 1000.0f;  // Hz
+		float Attack = 0.002f;        // seconds
+		float Decay = 0.05f;
+		float Sustain = 0.0f;         // relative to Amplitude
+		float Hold = 0.0f;
+		float Release = 0.005f;
+	};
+
+	struct FHapticVoiceHandle
+	{
+		std::uint32_t Slot = ~0u;
+		std::uint32_t Generation = 0;
+
+		bool IsValid() const { return Slot != ~0u; }
+	};
+
+	/**
+	 * @brief Ready-made voices for input and game events.
+	 */
+	namespace HapticVoices
+	{
+		// Short bright tick, e.g. a stick flick
+		inline FHapticVoiceParams Click(float Strength, float Pan)
+		{
+			FHapticVoiceParams Voice;
+			Voice.Frequency = 180.0f;
+			Voice.Sweep = -1500.0f;
+			Voice.Amplitude = 0.35f * std::clamp(Strength, 0.0f, 1.0f);
+			Voice.Pan = Pan;
+			Voice.Noise = 0.25f;
+			Voice.NoiseCutoff = 2000.0f;
+			Voice.Attack = 0.001f;
+			Voice.Decay = 0.025f;
+			return Voice;
+		}
+
+		// Dull knock, e.g. a trigger pulled hard
+		inline FHapticVoiceParams Thunk(float Strength, float Pan)
+		{
+			FHapticVoiceParams Voice;
+			Voice.Frequency = 90.0f;
+			Voice.Sweep = -400.0f;
+			Voice.Amplitude = 0.25f + 0.45f * std::clamp(Strength, 0.0f, 1.0f);
+			Voice.Pan = Pan;
+			Voice.Noise = 0.2f;
+			Voice.NoiseCutoff = 600.0f;
+			Voice.Attack = 0.002f;
+			Voice.Decay = 0.04f;
+			return Voice;
+		}
+
+		// Low thump with a noisy crack on both actuators, e.g. a landing
+		inline FHapticVoiceParams Impact(float Strength, float DurationSeconds)
+		{
+			FHapticVoiceParams Voice;
+			Voice.Frequency = 55.0f;
+			Voice.Sweep = -60.0f;
+			Voice.Amplitude = std::clamp(Strength, 0.0f, 1.0f);
+			Voice.Noise = 0.35f;
+			Voice.NoiseCutoff = 400.0f;
+			Voice.Attack = 0.002f;
+			Voice.Decay = DurationSeconds > 0.0f ? DurationSeconds : 0.12f;
+			return Voice;
+		}
+
+		// Held noisy texture, modulated while it lasts, e.g. a grind or rolling wheels
+		inline FHapticVoiceParams Texture(float Frequency, float Noise, float NoiseCutoff, float Amplitude)
+		{
+			FHapticVoiceParams Voice;
+			Voice.Frequency = Frequency;
+			Voice.Amplitude = Amplitude;
+			Voice.Noise = Noise;
+			Voice.NoiseCutoff = NoiseCutoff;
+			Voice.Attack = 0.01f;
+			Voice.Decay = 0.0f;
+			Voice.Sustain = 1.0f;
+			Voice.Hold = -1.0f;
+			Voice.Release = 0.05f;
+			return Voice;
+		}
+
+		// Held pure tone with click-free ramps, e.g. one rumble motor
+		inline FHapticVoiceParams Motor(float Frequency, float Pan, float Amplitude)
+		{
+			FHapticVoiceParams Voice;
+			Voice.Frequency = Frequency;
+			Voice.Amplitude = Amplitude;
+			Voice.Pan = Pan;
+			Voice.Attack = 0.005f;
+			Voice.Decay = 0.0f;
+			Voice.Sustain = 1.0f;
+			Voice.Hold = -1.0f;
+			Voice.Release = 0.005f;
+			return Voice;
+		}
+	} // namespace HapticVoices
+
+	/**
+	 * @brief Bank of up to MaxVoices procedural haptic voices, rendered Lanes voices per vector.
+	 *
+	 * Audio-rate state is kept as structure of arrays, so one SSE2 vector steps the same field of
+	 * four voices: a rotation oscillator (no sin() per sample), xorshift noise through a one-pole
+	 * low-pass, and a linear envelope segment. Envelopes, sweeps and gains are updated per voice
+	 * once every ControlFrames frames. Groups of four with no active voice are skipped and an idle
+	 * bank renders nothing, so the cost follows the number of sounding voices. When all voices are
+	 * busy, the quietest one is stolen. Never allocates. Single-threaded: the haptics thread owns it.
+	 */
+	class FHapticSynthBank
+	{
+	public:
+		static constexpr std::size_t Lanes = 4;
+		static constexpr std::size_t MaxVoices = 32;
+		static constexpr std::size_t ControlFrames = 32;
+		static constexpr float SampleRate = 48000.0f;
+		static constexpr float MinFrequency = 5.0f;
+		static constexpr float MaxFrequency = 4000.0f;
+
+		FHapticSynthBank()
+		{
+			for (std::size_t Voice = 0; Voice < MaxVoices; ++Voice)
+			{
+				Seed[Voice] = 0x9E3779B9u * static_cast<std::uint32_t>(Voice + 1);
+				Silence(Voice);
+			}
+		}
+
+		/**
+		 * @brief Starts a voice. Takes the quietest voice when all are busy.
+		 */
+		FHapticVoiceHandle Play(const FHapticVoiceParams& Params)
+		{
+			std::size_t Voice = MaxVoices;
+			for (std::size_t i = 0; i < MaxVoices; ++i)
+			{
+				if (!(ActiveMask & (1u << i)))
+				{
+					Voice = i;
+					break;
+				}
+			}
+			if (Voice == MaxVoices)
+			{
+				Voice = 0;
+				for (std::size_t i = 1; i < MaxVoices; ++i)
+				{
+					Voice = Env[i] < Env[Voice] ? i : Voice;
+				}
+				Deactivate(Voice);
+				++StolenCount;
+			}
+
+			FVoiceControl& Control = Controls[Voice];
+			Control.Params = Params;
+			Control.Stage = EStage::Attack;
+			Control.StageTime = 0.0f;
+			Control.Level = 0.0f;
+			Control.Frequency = std::clamp(Params.Frequency, MinFrequency, MaxFrequency);
+			Control.bFrequencyDirty = true;
+
+			const float Pan = std::clamp(Params.Pan, 0.0f, 1.0f);
+			const float Noise = std::clamp(Params.Noise, 0.0f, 1.0f);
+			X[Voice] = 1.0f;
+			Y[Voice] = 0.0f;
+			Env[Voice] = 0.0f;
+			EnvStep[Voice] = 0.0f;
+			LowPass[Voice] = 0.0f;
+			LowPassCoefficient[Voice] = 1.0f - std::exp(-6.28318530718f * std::clamp(Params.NoiseCutoff, MinFrequency, SampleRate * 0.5f) / SampleRate);
+			ToneGain[Voice] = 1.0f - Noise;
+			NoiseGain[Voice] = Noise;
+			PanLeft[Voice] = std::min(1.0f, 2.0f * (1.0f - Pan));
+			PanRight[Voice] = std::min(1.0f, 2.0f * Pan);
+			ActiveMask |= 1u << Voice;
+			return {static_cast<std::uint32_t>(Voice), Control.Generation};
+		}
+
+		/**
+		 * @brief Moves the voice to its release segment (held voices end only this way).
+		 */
+		bool Release(FHapticVoiceHandle Handle)
+		{
+			if (!IsPlaying(Handle))
+			{
+				return false;
+			}
+			FVoiceControl& Control = Controls[Handle.Slot];
+			if (Control.Stage != EStage::Release)
+			{
+				Control.ReleaseLevel = Control.Level;
+				Control.Stage = EStage::Release;
+				Control.StageTime = 0.0f;
+			}
+			return true;
+		}
+
+		/** Silences the voice at once. */
+		bool Stop(FHapticVoiceHandle Handle)
+		{
+			if (!IsPlaying(Handle))
+			{
+				return false;
+			}
+			Deactivate(Handle.Slot);
+			return true;
+		}
+
+		/**
+		 * @brief New peak amplitude and frequency of a playing voice; the amplitude is ramped over one control block.
+		 */
+		bool Modulate(FHapticVoiceHandle Handle, float Amplitude, float Frequency)
+		{
+			if (!IsPlaying(Handle))
+			{
+				return false;
+			}
+			FVoiceControl& Control = Controls[Handle.Slot];
+			Control.Params.Amplitude = Amplitude;
+			const float Clamped = std::clamp(Frequency, MinFrequency, MaxFrequency);
+			Control.bFrequencyDirty = Control.bFrequencyDirty || Clamped != Control.Frequency;
+			Control.Frequency = Clamped;
+			return true;
+		}
+
+		bool IsPlaying(FHapticVoiceHandle Handle) const
+		{
+			return Handle.Slot < MaxVoices && (ActiveMask & (1u << Handle.Slot)) && Controls[Handle.Slot].Generation == Handle.Generation;
+		}
+
+		bool IsActive() const { return ActiveMask != 0; }
+
+		std::size_t GetActiveVoiceCount() const
+		{
+			std::size_t Count = 0;
+			for (std::uint32_t Mask = ActiveMask; Mask; Mask &= Mask - 1)
+			{
+				++Count;
+			}
+			return Count;
+		}
+
+		std::uint64_t GetStolenCount() const { return StolenCount; }
+
+		/**
+		 * @brief Adds Frames of the active voices onto interleaved stereo. Does nothing while idle.
+		 */
+		void Render(float* Interleaved, std::size_t Frames)
+		{
+			for (std::size_t Offset = 0; Offset < Frames && ActiveMask != 0; Offset += ControlFrames)
+			{
+				const std::size_t Count = std::min(ControlFrames, Frames - Offset);
+				UpdateControl(Count);
+
+				std::fill_n(&AccumulatedLeft[0][0], Count * Lanes, 0.0f);
+				std::fill_n(&AccumulatedRight[0][0], Count * Lanes, 0.0f);
+				for (std::size_t Group = 0; Group < MaxVoices / Lanes; ++Group)
+				{
+					if ((ActiveMask >> (Group * Lanes)) & ((1u << Lanes) - 1))
+					{
+						RenderGroup(Group * Lanes, Count);
+					}
+				}
+				Reduce(Interleaved + Offset * 2, Count);
+
+				FinishControl();
+			}
+		}
+
+	private:
+		enum class EStage : std::uint8_t
+		{
+			Attack,
+			Decay,
+			Sustain,
+			Release,
+			Off
+		};
+
+		struct FVoiceControl
+		{
+			FHapticVoiceParams Params;
+			EStage Stage = EStage::Off;
+			float StageTime = 0.0f;
+			float Level = 0.0f;        // envelope, relative to the amplitude
+			float ReleaseLevel = 0.0f; // level the release started from
+			float Frequency = 0.0f;
+			bool bFrequencyDirty = false;
+			std::uint32_t Generation = 0;
+		};
+
+		void Silence(std::size_t Voice)
+		{
+			Env[Voice] = EnvStep[Voice] = 0.0f;
+			ToneGain[Voice] = NoiseGain[Voice] = 0.0f;
+			PanLeft[Voice] = PanRight[Voice] = 0.0f;
+			X[Voice] = 1.0f;
+			Y[Voice] = 0.0f;
+			Cos[Voice] = 1.0f;
+			Sin[Voice] = 0.0f;
+			LowPass[Voice] = LowPassCoefficient[Voice] = 0.0f;
+		}
+
+		void Deactivate(std::size_t Voice)
+		{
+			ActiveMask &= ~(1u << Voice);
+			Controls[Voice].Stage = EStage::Off;
+			++Controls[Voice].Generation;
+			Silence(Voice);
+		}
+
+		// Envelope level after Seconds more of the voice; moves through the segments it crosses
+		static float Advance(FVoiceControl& Control, float Seconds)
+		{
+			const FHapticVoiceParams& Params = Control.Params;
+			Control.StageTime += Seconds;
+			for (;;)
+			{
+				switch (Control.Stage)
+				{
+				case EStage::Attack:
+					if (Control.StageTime < Params.Attack)
+					{
+						return Control.StageTime / Params.Attack;
+					}
+					Control.StageTime -= std::max(Params.Attack, 0.0f);
+					Control.Stage = EStage::Decay;
+					break;
+				case EStage::Decay:
+					if (Control.StageTime < Params.Decay)
+					{
+						return 1.0f - (1.0f - Params.Sustain) * Control.StageTime / Params.Decay;
+					}
+					Control.StageTime -= std::max(Params.Decay, 0.0f);
+					Control.Stage = EStage::Sustain;
+					break;
+				case EStage::Sustain:
+					if (Params.Hold < 0.0f || Control.StageTime < Params.Hold)
+					{
+						return Params.Sustain;
+					}
+					Control.StageTime -= Params.Hold;
+					Control.ReleaseLevel = Params.Sustain;
+					Control.Stage = EStage::Release;
+					break;
+				case EStage::Release:
+					if (Control.StageTime < Params.Release)
+					{
+						return Control.ReleaseLevel * (1.0f - Control.StageTime / Params.Release);
+					}
+					Control.Stage = EStage::Off;
+					break;
+				case EStage::Off:
+					return 0.0f;
+				}
+			}
+		}
+
+		// Per active voice: envelope target at the end of the block, sweep, oscillator upkeep
+		void UpdateControl(std::size_t Frames)
+		{
+			const float Seconds = static_cast<float>(Frames) / SampleRate;
+			for (std::uint32_t Mask = ActiveMask; Mask; Mask &= Mask - 1)
+			{
+				const std::size_t Voice = CountTrailingZeros(Mask);
+				FVoiceControl& Control = Controls[Voice];
+				Control.Level = Advance(Control, Seconds);
+				TargetEnv[Voice] = Control.Level * Control.Params.Amplitude;
+				EnvStep[Voice] = (TargetEnv[Voice] - Env[Voice]) / static_cast<float>(Frames);
+
+				if (Control.Params.Sweep != 0.0f)
+				{
+					const float Swept = std::clamp(Control.Frequency + Control.Params.Sweep * Seconds, MinFrequency, MaxFrequency);
+					Control.bFrequencyDirty = Control.bFrequencyDirty || Swept != Control.Frequency;
+					Control.Frequency = Swept;
+				}
+				if (Control.bFrequencyDirty)
+				{
+					const float Increment = 6.28318530718f * Control.Frequency / SampleRate;
+					Cos[Voice] = std::cos(Increment);
+					Sin[Voice] = std::sin(Increment);
+					Control.bFrequencyDirty = false;
+				}
+
+				// The rotation slowly drifts off the unit circle in float; pull it back once per block
+				const float Radius = std::sqrt(X[Voice] * X[Voice] + Y[Voice] * Y[Voice]);
+				X[Voice] /= Radius;
+				Y[Voice] /= Radius;
+			}
+		}
+
+		void FinishControl()
+		{
+			for (std::uint32_t Mask = ActiveMask; Mask; Mask &= Mask - 1)
+			{
+				const std::size_t Voice = CountTrailingZeros(Mask);
+				Env[Voice] = TargetEnv[Voice]; // no ramp drift between blocks
+				if (Controls[Voice].Stage == EStage::Off)
+				{
+					Deactivate(Voice);
+				}
+			}
+		}
+
+		static std::size_t CountTrailingZeros(std::uint32_t Mask)
+		{
+			std::size_t Index = 0;
+			while (!(Mask & 1u))
+			{
+				Mask >>= 1;
+				++Index;
+			}
+			return Index;
+		}
+
+		void RenderGroup(std::size_t Base, std::size_t Frames)
+		{
+#ifdef GAMEPAD_SYNTH_SSE
+			__m128 VX = _mm_load_ps(&X[Base]);
+			__m128 VY = _mm_load_ps(&Y[Base]);
+			__m128 VEnv = _mm_load_ps(&Env[Base]);
+			__m128 VLowPass = _mm_load_ps(&LowPass[Base]);
+			__m128i VSeed = _mm_load_si128(reinterpret_cast<const __m128i*>(&Seed[Base]));
+			const __m128 VCos = _mm_load_ps(&Cos[Base]);
+			const __m128 VSin = _mm_load_ps(&Sin[Base]);
+			const __m128 VStep = _mm_load_ps(&EnvStep[Base]);
+			const __m128 VCoefficient = _mm_load_ps(&LowPassCoefficient[Base]);
+			const __m128 VTone = _mm_load_ps(&ToneGain[Base]);
+			const __m128 VNoise = _mm_load_ps(&NoiseGain[Base]);
+			const __m128 VLeft = _mm_load_ps(&PanLeft[Base]);
+			const __m128 VRight = _mm_load_ps(&PanRight[Base]);
+			const __m128 NoiseScale = _mm_set1_ps(1.0f / 2147483648.0f);
+
+			for (std::size_t Frame = 0; Frame < Frames; ++Frame)
+			{
+				const __m128 NextX = _mm_sub_ps(_mm_mul_ps(VX, VCos), _mm_mul_ps(VY, VSin));
+				VY = _mm_add_ps(_mm_mul_ps(VX, VSin), _mm_mul_ps(VY, VCos));
+				VX = NextX;
+
+				VSeed = _mm_xor_si128(VSeed, _mm_slli_epi32(VSeed, 13));
+				VSeed = _mm_xor_si128(VSeed, _mm_srli_epi32(VSeed, 17));
+				VSeed = _mm_xor_si128(VSeed, _mm_slli_epi32(VSeed, 5));
+				const __m128 White = _mm_mul_ps(_mm_cvtepi32_ps(VSeed), NoiseScale);
+				VLowPass = _mm_add_ps(VLowPass, _mm_mul_ps(VCoefficient, _mm_sub_ps(White, VLowPass)));
+
+				VEnv = _mm_add_ps(VEnv, VStep);
+				const __m128 Sample = _mm_mul_ps(VEnv, _mm_add_ps(_mm_mul_ps(VY, VTone), _mm_mul_ps(VLowPass, VNoise)));
+				_mm_store_ps(AccumulatedLeft[Frame], _mm_add_ps(_mm_load_ps(AccumulatedLeft[Frame]), _mm_mul_ps(Sample, VLeft)));
+				_mm_store_ps(AccumulatedRight[Frame], _mm_add_ps(_mm_load_ps(AccumulatedRight[Frame]), _mm_mul_ps(Sample, VRight)));
+			}
+
+			_mm_store_ps(&X[Base], VX);
+			_mm_store_ps(&Y[Base], VY);
+			_mm_store_ps(&Env[Base], VEnv);
+			_mm_store_ps(&LowPass[Base], VLowPass);
+			_mm_store_si128(reinterpret_cast<__m128i*>(&Seed[Base]), VSeed);
+#else
+			for (std::size_t Frame = 0; Frame < Frames; ++Frame)
+			{
+				for (std::size_t Lane = 0; Lane < Lanes; ++Lane)
+				{
+					const std::size_t Voice = Base + Lane;
+					const float NextX = X[Voice] * Cos[Voice] - Y[Voice] * Sin[Voice];
+					Y[Voice] = X[Voice] * Sin[Voice] + Y[Voice] * Cos[Voice];
+					X[Voice] = NextX;
+
+					std::uint32_t State = Seed[Voice];
+					State ^= State << 13;
+					State ^= State >> 17;
+					State ^= State << 5;
+					Seed[Voice] = State;
+					const float White = static_cast<float>(static_cast<std::int32_t>(State)) * (1.0f / 2147483648.0f);
+					LowPass[Voice] += LowPassCoefficient[Voice] * (White - LowPass[Voice]);
+
+					Env[Voice] += EnvStep[Voice];
+					const float Sample = Env[Voice] * (Y[Voice] * ToneGain[Voice] + LowPass[Voice] * NoiseGain[Voice]);
+					AccumulatedLeft[Frame][Lane] += Sample * PanLeft[Voice];
+					AccumulatedRight[Frame][Lane] += Sample * PanRight[Voice];
+				}
+			}
+#endif
+		}
+
+		// Sums the lanes of every frame into the output, four frames per transpose
+		void Reduce(float* Interleaved, std::size_t Frames)
+		{
+			std::size_t Frame = 0;
+#ifdef GAMEPAD_SYNTH_SSE
+			for (; Frame + 4 <= Frames; Frame += 4)
+			{
+				__m128 L0 = _mm_load_ps(AccumulatedLeft[Frame]), L1 = _mm_load_ps(AccumulatedLeft[Frame + 1]);
+				__m128 L2 = _mm_load_ps(AccumulatedLeft[Frame + 2]), L3 = _mm_load_ps(AccumulatedLeft[Frame + 3]);
+				__m128 R0 = _mm_load_ps(AccumulatedRight[Frame]), R1 = _mm_load_ps(AccumulatedRight[Frame + 1]);
+				__m128 R2 = _mm_load_ps(AccumulatedRight[Frame + 2]), R3 = _mm_load_ps(AccumulatedRight[Frame + 3]);
+				_MM_TRANSPOSE4_PS(L0, L1, L2, L3);
+				_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+				const __m128 Left = _mm_add_ps(_mm_add_ps(L0, L1), _mm_add_ps(L2, L3));
+				const __m128 Right = _mm_add_ps(_mm_add_ps(R0, R1), _mm_add_ps(R2, R3));
+
+				float* Out = Interleaved + Frame * 2;
+				_mm_storeu_ps(Out, _mm_add_ps(_mm_loadu_ps(Out), _mm_unpacklo_ps(Left, Right)));
+				_mm_storeu_ps(Out + 4, _mm_add_ps(_mm_loadu_ps(Out + 4), _mm_unpackhi_ps(Left, Right)));
+			}
+#endif
+			for (; Frame < Frames; ++Frame)
+			{
+				const float* Left = AccumulatedLeft[Frame];
+				const float* Right = AccumulatedRight[Frame];
+				Interleaved[Frame * 2] += (Left[0] + Left[1]) + (Left[2] + Left[3]);
+				Interleaved[Frame * 2 + 1] += (Right[0] + Right[1]) + (Right[2] + Right[3]);
+			}
+		}
+
+		std::array<FVoiceControl, MaxVoices> Controls{};
+		std::uint32_t ActiveMask = 0;
+		std::uint64_t StolenCount = 0;
+
+		// Audio-rate state, one lane per voice
+		alignas(16) float X[MaxVoices];
+		alignas(16) float Y[MaxVoices];
+		alignas(16) float Cos[MaxVoices];
+		alignas(16) float Sin[MaxVoices];
+		alignas(16) float Env[MaxVoices];
+		alignas(16) float EnvStep[MaxVoices];
+		alignas(16) float TargetEnv[MaxVoices] = {};
+		alignas(16) float LowPass[MaxVoices];
+		alignas(16) float LowPassCoefficient[MaxVoices];
+		alignas(16) float ToneGain[MaxVoices];
+		alignas(16) float NoiseGain[MaxVoices];
+		alignas(16) float PanLeft[MaxVoices];
+		alignas(16) float PanRight[MaxVoices];
+		alignas(16) std::uint32_t Seed[MaxVoices];
+
+		alignas(16) float AccumulatedLeft[ControlFrames][Lanes];
+		alignas(16) float AccumulatedRight[ControlFrames][Lanes];
+	};
+
+	/**
+	 * @brief The synth bank as a haptic mixer input. Silent (and skipped) while no voice plays.
+	 */
+	class FSynthHapticSource final : public IHapticAudioSource
+	{
+	public:
+		explicit FSynthHapticSource(FHapticSynthBank& InBank)
+		    : Bank(InBank)
+		{
+		}
+
+		const char* GetName() const override { return "synth"; }
+		EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Clock; }
+		bool IsFinished() const override { return !Bank.IsActive(); }
+
+		std::size_t Read(float* Interleaved, std::size_t Frames) override
+		{
+			if (!Bank.IsActive())
+			{
+				return 0;
+			}
+			std::fill_n(Interleaved, Frames * 2, 0.0f);
+			Bank.Render(Interleaved, Frames);
+			return Frames;
+		}
+
+	private:
+		FHapticSynthBank& Bank;
+	};
+} // namespace GamepadCore
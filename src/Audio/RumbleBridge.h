@@ -0,0 +1,108 @@
+#pragma once
+#include "Diagnostics/LatencyHistogram.h"
+#include "Input/InputStateBuffer.h"
+#include "Timing/ServiceClock.h"
+#include <atomic>
+#include <cstdint>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Last rumble request received from the game, as Xbox-style motor strengths.
+	 */
+	struct FRumbleState
+	{
+		std::uint8_t LargeMotor;
+		std::uint8_t SmallMotor;
+		std::int64_t PostedNs;
+	};
+
+	/**
+	 * @brief Lock-free handoff of rumble requests from a virtual pad backend to the haptics thread.
+	 *
+	 * Rumble is a state, not a stream: only the latest request matters, so the mailbox is a seqlock
+	 * slot and the poster never waits on the haptics thread. Exactly one thread may post to a mailbox
+	 * (the ViGEm notification thread, the input thread polling uinput, or a test driving it by hand).
+	 * Other threads that need the motors off (a backend shutting down after its notification thread
+	 * is gone) call RequestStop(), which never touches the slot.
+	 */
+	class FRumbleMailbox
+	{
+	public:
+		static std::int64_t NowNs() { return IServiceClock::Get().NowNs(); }
+
+		void Post(std::uint8_t LargeMotor, std::uint8_t SmallMotor) { Post(LargeMotor, SmallMotor, NowNs()); }
+
+		void Post(std::uint8_t LargeMotor, std::uint8_t SmallMotor, std::int64_t PostedNs)
+		{
+			State.Publish(FRumbleState{LargeMotor, SmallMotor, PostedNs});
+		}
+
+		/** @return Number of requests posted so far, 0 if none. */
+		std::uint64_t Snapshot(FRumbleState& Out) const { return State.Snapshot(Out); }
+		std::uint64_t GetPostCount() const { return State.GetPublishCount(); }
+
+		/**
+		 * @brief Any thread: stops the motors until the next Post(). Requests posted before the call are superseded.
+		 */
+		void RequestStop() { StoppedThrough.store(GetPostCount() + 1, std::memory_order_release); }
+
+		/** @return 1 + the post count at the last RequestStop(), 0 if never stopped. */
+		std::uint64_t GetStoppedThrough() const { return StoppedThrough.load(std::memory_order_acquire); }
+
+	private:
+		TSeqLock<FRumbleState> State;
+		std::atomic<std::uint64_t> StoppedThrough{0};
+	};
+
+	/**
+	 * @brief Routes game rumble into the DualSense haptic stream.
+	 *
+	 * Backends post into GetMailbox(); the haptics thread calls Update() once per tick and hands
+	 * GetLastRequest() to FHapticEventSynth::SetRumble(), whose rumble bank the haptic mixer plays.
+	 * A request is therefore picked up at most one haptics tick after it was posted. The
+	 * post-to-pickup latency of every request is recorded in GetLatency().
+	 */
+	class FRumbleBridge
+	{
+	public:
+		FRumbleMailbox& GetMailbox() { return Mailbox; }
+		const FLatencyHistogram& GetLatency() const { return Latency; }
+
+		/**
+		 * @brief Consumer side: picks up the latest request and records its latency.
+		 */
+		void Update(std::int64_t NowNs)
+		{
+			FRumbleState Request;
+			const std::uint64_t PostCount = Mailbox.Snapshot(Request);
+			if (PostCount != LastPostCount)
+			{
+				LastPostCount = PostCount;
+				LastRequest = Request;
+				Latency.Record((NowNs - Request.PostedNs) / 1000);
+			}
+
+			// A stop only wins over the requests posted before it; a later post is picked up next tick
+			const std::uint64_t StoppedThrough = Mailbox.GetStoppedThrough();
+			if (StoppedThrough != LastStoppedThrough)
+			{
+				LastStoppedThrough = StoppedThrough;
+				if (StoppedThrough > PostCount)
+				{
+					LastRequest = FRumbleState{0, 0, NowNs};
+				}
+			}
+		}
+
+		/** Latest request picked up by Update(); both motors off before the first. */
+		const FRumbleState& GetLastRequest() const { return LastRequest; }
+
+	private:
+		FRumbleMailbox Mailbox;
+		FLatencyHistogram Latency;
+		FRumbleState LastRequest{0, 0, 0};
+		std::uint64_t LastPostCount = 0;
+		std::uint64_t LastStoppedThrough = 0;
+	};
+} // namespace GamepadCore
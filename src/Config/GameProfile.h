@@ -0,0 +1,142 @@
+#pragma once
+#include "Input/StickResponseCurve.h"
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Which virtual controller the DualSense is exposed as.
+	 */
+	enum class EVirtualPadMode : std::uint8_t
+	{
+		Xbox360,
+		DualShock4
+	};
+
+	/**
+	 * @brief Per-game settings, matched against the executable that loaded the mod.
+	 */
+	struct FGameProfile
+	{
+		const char* ExecutableName;
+		EVirtualPadMode VirtualPadMode;
+		FStickCurveConfig LeftStick{};
+		FStickCurveConfig RightStick{};
+	};
+
+	inline constexpr FGameProfile kDefaultGameProfile{"", EVirtualPadMode::Xbox360};
+
+	// Profiles ship the identity curves: the game keeps its own deadzones unless the user sets
+	// DUALSENSE_MOD_LEFT_STICK / DUALSENSE_MOD_RIGHT_STICK.
+	inline constexpr FGameProfile kGameProfiles[] = {
+	    {"SessionGame-Win64-Shipping.exe", EVirtualPadMode::Xbox360},
+	};
+
+	inline bool EqualsIgnoreCase(const std::string& A, const char* B)
+	{
+		std::size_t i = 0;
+		for (; i < A.size() && B[i] != '\0'; ++i)
+		{
+			if (std::tolower(static_cast<unsigned char>(A[i])) != std::tolower(static_cast<unsigned char>(B[i])))
+			{
+				return false;
+			}
+		}
+		return i == A.size() && B[i] == '\0';
+	}
+
+	/**
+	 * @brief Parses "inner,outer,anti,exponent" (e.g. "0.05,0.97,0,1.4") into a stick curve.
+	 *
+	 * Trailing fields may be left out and keep their identity values. Rejects anything that is not a
+	 * list of one to four finite numbers, and exponents that are not positive; Out is left untouched then.
+	 */
+	inline bool ParseStickCurve(const char* Text, FStickCurveConfig& Out)
+	{
+		FStickCurveConfig Config;
+		float* const Fields[] = {&Config.InnerDeadzone, &Config.OuterDeadzone, &Config.AntiDeadzone, &Config.Exponent};
+		std::size_t Count = 0;
+		const char* Cursor = Text;
+		for (;;)
+		{
+			if (Count == std::size(Fields))
+			{
+				return false;
+			}
+			char* End = nullptr;
+			const float Value = std::strtof(Cursor, &End);
+			if (End == Cursor || !std::isfinite(Value))
+			{
+				return false;
+			}
+			*Fields[Count++] = Value;
+
+			while (std::isspace(static_cast<unsigned char>(*End)))
+			{
+				++End;
+			}
+			if (*End == '\0')
+			{
+				break;
+			}
+			if (*End != ',')
+			{
+				return false;
+			}
+			Cursor = End + 1;
+		}
+		if (Config.Exponent <= 0.0f)
+		{
+			return false;
+		}
+		Out = Config;
+		return true;
+	}
+
+	/**
+	 * @brief Picks the profile for the given executable name (file name only, case-insensitive).
+	 *
+	 * DUALSENSE_MOD_VIRTUAL_PAD=ds4|x360 overrides the virtual pad mode of whatever profile matched, and
+	 * DUALSENSE_MOD_LEFT_STICK / DUALSENSE_MOD_RIGHT_STICK its stick curves (see ParseStickCurve).
+	 */
+	inline FGameProfile ResolveGameProfile(const std::string& ExecutableName)
+	{
+		FGameProfile Profile = kDefaultGameProfile;
+		for (const FGameProfile& Candidate : kGameProfiles)
+		{
+			if (EqualsIgnoreCase(ExecutableName, Candidate.ExecutableName))
+			{
+				Profile = Candidate;
+				break;
+			}
+		}
+
+		if (const char* Curve = std::getenv("DUALSENSE_MOD_LEFT_STICK"))
+		{
+			ParseStickCurve(Curve, Profile.LeftStick);
+		}
+		if (const char* Curve = std::getenv("DUALSENSE_MOD_RIGHT_STICK"))
+		{
+			ParseStickCurve(Curve, Profile.RightStick);
+		}
+
+		if (const char* Override = std::getenv("DUALSENSE_MOD_VIRTUAL_PAD"))
+		{
+			const std::string Mode(Override);
+			if (EqualsIgnoreCase(Mode, "ds4"))
+			{
+				Profile.VirtualPadMode = EVirtualPadMode::DualShock4;
+			}
+			else if (EqualsIgnoreCase(Mode, "x360"))
+			{
+				Profile.VirtualPadMode = EVirtualPadMode::Xbox360;
+			}
+		}
+		return Profile;
+	}
+} // namespace GamepadCore
@@ -0,0 +1,119 @@
+#include "FrameTrace.h"
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace GamepadCore
+{
+	bool FFrameTrace::Open(const std::string& Path, std::size_t CapacityRecords)
+	{
+		Close();
+
+		std::size_t Capacity = 1;
+		while (Capacity < CapacityRecords)
+		{
+			Capacity <<= 1;
+		}
+		const std::size_t NamesBytes = ThreadNameCapacity * sizeof(FTraceThreadName);
+		const std::size_t Bytes = sizeof(FTraceFileHeader) + NamesBytes + Capacity * sizeof(FTraceRecord);
+
+		void* View = nullptr;
+#if defined(_WIN32)
+		HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			std::cerr << "[Trace] Failed to create " << Path << " (Error: " << GetLastError() << ")." << std::endl;
+			return false;
+		}
+
+		ULARGE_INTEGER Size;
+		Size.QuadPart = Bytes;
+		HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READWRITE, Size.HighPart, Size.LowPart, nullptr);
+		View = Mapping ? MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, Bytes) : nullptr;
+		if (!View)
+		{
+			std::cerr << "[Trace] Failed to map " << Path << " (Error: " << GetLastError() << ")." << std::endl;
+			if (Mapping)
+			{
+				CloseHandle(Mapping);
+			}
+			CloseHandle(File);
+			return false;
+		}
+		FileHandle = File;
+		MappingHandle = Mapping;
+#else
+		const int Fd = ::open(Path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (Fd < 0 || ftruncate(Fd, static_cast<off_t>(Bytes)) != 0)
+		{
+			std::cerr << "[Trace] Failed to create " << Path << "." << std::endl;
+			if (Fd >= 0)
+			{
+				::close(Fd);
+			}
+			return false;
+		}
+
+		View = mmap(nullptr, Bytes, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+		if (View == MAP_FAILED)
+		{
+			std::cerr << "[Trace] Failed to map " << Path << "." << std::endl;
+			::close(Fd);
+			return false;
+		}
+		FileDescriptor = Fd;
+#endif
+
+		Header = static_cast<FTraceFileHeader*>(View);
+		std::memset(Header, 0, sizeof(FTraceFileHeader));
+		std::memcpy(Header->Magic, FTraceFileHeader::ExpectedMagic, sizeof(Header->Magic));
+		Header->Version = FTraceFileHeader::CurrentVersion;
+		Header->RecordSize = sizeof(FTraceRecord);
+		Header->Capacity = Capacity;
+		Header->ThreadNameCapacity = ThreadNameCapacity;
+
+		ThreadNames = reinterpret_cast<FTraceThreadName*>(static_cast<std::uint8_t*>(View) + sizeof(FTraceFileHeader));
+		Records = reinterpret_cast<FTraceRecord*>(static_cast<std::uint8_t*>(View) + sizeof(FTraceFileHeader) + NamesBytes);
+		Mask = Capacity - 1;
+		MappedBytes = Bytes;
+
+		std::cout << "[Trace] Recording up to " << Capacity << " events to " << Path << std::endl;
+		return true;
+	}
+
+	void FFrameTrace::Close()
+	{
+		bEnabled.store(false, std::memory_order_relaxed);
+		if (!Header)
+		{
+			return;
+		}
+
+#if defined(_WIN32)
+		FlushViewOfFile(Header, 0);
+		UnmapViewOfFile(Header);
+		CloseHandle(static_cast<HANDLE>(MappingHandle));
+		CloseHandle(static_cast<HANDLE>(FileHandle));
+		MappingHandle = nullptr;
+		FileHandle = nullptr;
+#else
+		msync(Header, MappedBytes, MS_ASYNC);
+		munmap(Header, MappedBytes);
+		::close(FileDescriptor);
+		FileDescriptor = -1;
+#endif
+
+		Header = nullptr;
+		ThreadNames = nullptr;
+		Records = nullptr;
+		Mask = 0;
+		MappedBytes = 0;
+	}
+} // namespace GamepadCore
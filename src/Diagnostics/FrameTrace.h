@@ -0,0 +1,227 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Frame tracing is compiled out unless the build defines GAMEPAD_TRACE_ENABLED=1. Even when compiled
+// in, nothing is recorded until FFrameTrace::Open() succeeds and tracing is enabled at run time.
+#ifndef GAMEPAD_TRACE_ENABLED
+#define GAMEPAD_TRACE_ENABLED 0
+#endif
+
+namespace GamepadCore
+{
+	enum class ETraceEvent : std::uint8_t
+	{
+		ThreadName,
+		InputReportReceived,
+		InputDecoded,
+		VirtualPadSubmit,
+		OutputWrite,
+		AudioBlockCaptured,
+		HapticPacketSent,
+		Count
+	};
+
+	enum class ETracePhase : std::uint8_t
+	{
+		Instant,
+		Begin,
+		End
+	};
+
+	enum class ETraceThread : std::uint32_t
+	{
+		Service,
+		Input,
+		Audio,
+		Capture,
+		Count
+	};
+
+	inline const char* GetTraceEventName(ETraceEvent Event)
+	{
+		static constexpr const char* Names[] = {"ThreadName", "InputReportReceived", "InputDecoded", "VirtualPadSubmit",
+		                                        "OutputWrite", "AudioBlockCaptured", "HapticPacketSent"};
+		return Event < ETraceEvent::Count ? Names[static_cast<std::size_t>(Event)] : "Unknown";
+	}
+
+	inline const char* GetTraceThreadName(std::uint32_t Thread)
+	{
+		static constexpr const char* Names[] = {"Service", "Input", "Audio", "Capture"};
+		return Thread < static_cast<std::uint32_t>(ETraceThread::Count) ? Names[Thread] : "Thread";
+	}
+
+	/**
+	 * @brief One trace event, 16 bytes. Arg is event specific (frame number, frame count, bytes...).
+	 */
+	struct FTraceRecord
+	{
+		std::uint64_t TimestampNs;
+		std::uint32_t Arg;
+		std::uint16_t ThreadId;
+		ETraceEvent Event;
+		ETracePhase Phase;
+	};
+	static_assert(sizeof(FTraceRecord) == 16, "FTraceRecord is part of the trace file format");
+
+	/**
+	 * @brief Side table entry naming a trace thread. ThreadId 0 is a slot claimed but never written.
+	 */
+	struct FTraceThreadName
+	{
+		std::uint16_t ThreadId;
+		std::uint16_t Thread;
+	};
+	static_assert(sizeof(FTraceThreadName) == 4, "FTraceThreadName is part of the trace file format");
+
+	/**
+	 * @brief Start of the trace file, followed by ThreadNameCapacity thread names, then Capacity records.
+	 *
+	 * WriteIndex counts every record ever written; the newest min(WriteIndex, Capacity) records are
+	 * valid, the oldest at slot WriteIndex % Capacity once the ring has wrapped. Thread names live
+	 * outside the ring so they survive the wrap; ThreadNameCount counts every name claimed, and names
+	 * past the table's capacity fall back to ThreadName records in the ring.
+	 */
+	struct FTraceFileHeader
+	{
+		static constexpr char ExpectedMagic[8] = {'G', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+		static constexpr std::uint32_t CurrentVersion = 2;
+
+		char Magic[8];
+		std::uint32_t Version;
+		std::uint32_t RecordSize;
+		std::uint64_t Capacity;
+		std::uint64_t WriteIndex;
+		std::uint32_t ThreadNameCapacity;
+		std::uint32_t ThreadNameCount;
+		std::uint8_t Reserved[24];
+	};
+	static_assert(sizeof(FTraceFileHeader) == 64, "FTraceFileHeader is part of the trace file format");
+
+	/**
+	 * @brief Process-wide trace ring backed by a memory-mapped file.
+	 *
+	 * Record() claims a slot with one atomic increment and writes 16 bytes into the mapping; the OS
+	 * writes the pages back, so a trace survives a crash or a killed game. Convert the file with
+	 * trace-to-chrome for chrome://tracing or ui.perfetto.dev.
+	 */
+	class FFrameTrace
+	{
+	public:
+		static constexpr std::uint32_t ThreadNameCapacity = 256;
+
+		static FFrameTrace& Get()
+		{
+			static FFrameTrace Instance;
+			return Instance;
+		}
+
+		/**
+		 * @brief Creates (or truncates) the trace file with room for CapacityRecords events (rounded up to a power of two).
+		 */
+		bool Open(const std::string& Path, std::size_t CapacityRecords = 1 << 18);
+		void Close();
+
+		void SetEnabled(bool bEnable) { bEnabled.store(bEnable && Records != nullptr, std::memory_order_relaxed); }
+		bool IsEnabled() const { return bEnabled.load(std::memory_order_relaxed); }
+
+		void Record(ETraceEvent Event, ETracePhase Phase, std::uint32_t Arg)
+		{
+			if (!bEnabled.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			const std::uint64_t Index = std::atomic_ref<std::uint64_t>(Header->WriteIndex).fetch_add(1, std::memory_order_relaxed);
+			FTraceRecord& Slot = Records[Index & Mask];
+			Slot.TimestampNs = NowNs();
+			Slot.Arg = Arg;
+			Slot.ThreadId = GetThreadId();
+			Slot.Event = Event;
+			Slot.Phase = Phase;
+		}
+
+		/**
+		 * @brief Tags the calling thread once in the thread name table, so the converter can label its track.
+		 */
+		void NameThread(ETraceThread Thread)
+		{
+			thread_local bool bNamed = false;
+			if (bNamed || !IsEnabled())
+			{
+				return;
+			}
+
+			bNamed = true;
+			const std::uint32_t Slot = std::atomic_ref<std::uint32_t>(Header->ThreadNameCount).fetch_add(1, std::memory_order_relaxed);
+			if (Slot >= ThreadNameCapacity)
+			{
+				Record(ETraceEvent::ThreadName, ETracePhase::Instant, static_cast<std::uint32_t>(Thread));
+				return;
+			}
+			ThreadNames[Slot].Thread = static_cast<std::uint16_t>(Thread);
+			std::atomic_ref<std::uint16_t>(ThreadNames[Slot].ThreadId).store(GetThreadId(), std::memory_order_release);
+		}
+
+	private:
+		FFrameTrace() = default;
+		~FFrameTrace() { Close(); }
+		FFrameTrace(const FFrameTrace&) = delete;
+		FFrameTrace& operator=(const FFrameTrace&) = delete;
+
+		static std::uint64_t NowNs()
+		{
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		static std::uint16_t GetThreadId()
+		{
+			static std::atomic<std::uint16_t> NextId{1};
+			thread_local const std::uint16_t Id = NextId.fetch_add(1, std::memory_order_relaxed);
+			return Id;
+		}
+
+		std::atomic<bool> bEnabled{false};
+		FTraceFileHeader* Header = nullptr;
+		FTraceThreadName* ThreadNames = nullptr;
+		FTraceRecord* Records = nullptr;
+		std::uint64_t Mask = 0;
+		std::size_t MappedBytes = 0;
+		void* FileHandle = nullptr;
+		void* MappingHandle = nullptr;
+		int FileDescriptor = -1;
+	};
+
+	/**
+	 * @brief Emits a Begin/End pair around a scope.
+	 */
+	class FTraceScope
+	{
+	public:
+		FTraceScope(ETraceEvent InEvent, std::uint32_t Arg)
+		    : Event(InEvent)
+		{
+			FFrameTrace::Get().Record(Event, ETracePhase::Begin, Arg);
+		}
+
+		~FTraceScope() { FFrameTrace::Get().Record(Event, ETracePhase::End, 0); }
+
+	private:
+		ETraceEvent Event;
+	};
+} // namespace GamepadCore
+
+#if GAMEPAD_TRACE_ENABLED
+#define GAMEPAD_TRACE_CONCAT_INNER(A, B) A##B
+#define GAMEPAD_TRACE_CONCAT(A, B) GAMEPAD_TRACE_CONCAT_INNER(A, B)
+#define GAMEPAD_TRACE_INSTANT(Event, Arg) ::GamepadCore::FFrameTrace::Get().Record(::GamepadCore::ETraceEvent::Event, ::GamepadCore::ETracePhase::Instant, static_cast<std::uint32_t>(Arg))
+#define GAMEPAD_TRACE_SCOPE(Event, Arg) const ::GamepadCore::FTraceScope GAMEPAD_TRACE_CONCAT(TraceScope_, __LINE__)(::GamepadCore::ETraceEvent::Event, static_cast<std::uint32_t>(Arg))
+#define GAMEPAD_TRACE_THREAD(Thread) ::GamepadCore::FFrameTrace::Get().NameThread(::GamepadCore::ETraceThread::Thread)
+#else
+#define GAMEPAD_TRACE_INSTANT(Event, Arg) ((void)0)
+#define GAMEPAD_TRACE_SCOPE(Event, Arg) ((void)0)
+#define GAMEPAD_TRACE_THREAD(Thread) ((void)0)
+#endif
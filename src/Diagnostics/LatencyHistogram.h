@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Lock-free log2 histogram of latencies in microseconds.
+	 *
+	 * Bucket i holds samples in [2^(i-1), 2^i) us (bucket 0 is < 1 us). Record() is a couple of
+	 * relaxed atomic adds, so it can be called from real-time threads; percentiles are resolved
+	 * to the upper edge of a bucket, which is enough to check a latency budget.
+	 */
+	class FLatencyHistogram
+	{
+	public:
+		static constexpr std::size_t BucketCount = 32;
+
+		void Record(std::int64_t Microseconds)
+		{
+			const std::uint64_t Value = Microseconds > 0 ? static_cast<std::uint64_t>(Microseconds) : 0;
+			std::size_t Bucket = 0;
+			while (Bucket < BucketCount - 1 && (Value >> Bucket) != 0)
+			{
+				++Bucket;
+			}
+
+			Buckets[Bucket].fetch_add(1, std::memory_order_relaxed);
+			Count.fetch_add(1, std::memory_order_relaxed);
+
+			std::uint64_t Previous = Max.load(std::memory_order_relaxed);
+			while (Value > Previous && !Max.compare_exchange_weak(Previous, Value, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		void Reset()
+		{
+			for (std::atomic<std::uint64_t>& Bucket : Buckets)
+			{
+				Bucket.store(0, std::memory_order_relaxed);
+			}
+			Count.store(0, std::memory_order_relaxed);
+			Max.store(0, std::memory_order_relaxed);
+		}
+
+		std::uint64_t GetCount() const { return Count.load(std::memory_order_relaxed); }
+		std::uint64_t GetMaxUs() const { return Max.load(std::memory_order_relaxed); }
+		std::uint64_t GetBucket(std::size_t Index) const { return Buckets[Index].load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Upper bound (us) of the bucket holding the given percentile (0..100), 0 when empty.
+		 */
+		std::uint64_t GetPercentileUs(double Percentile) const
+		{
+			const std::uint64_t Total = GetCount();
+			if (Total == 0)
+			{
+				return 0;
+			}
+
+			const std::uint64_t Rank = static_cast<std::uint64_t>(static_cast<double>(Total) * Percentile / 100.0);
+			std::uint64_t Seen = 0;
+			for (std::size_t i = 0; i < BucketCount; ++i)
+			{
+				Seen += GetBucket(i);
+				if (Seen > Rank || Seen == Total)
+				{
+					return std::uint64_t{1} << i;
+				}
+			}
+			return GetMaxUs();
+		}
+
+		void Print(const char* Label) const
+		{
+			std::cout << "[" << Label << "] Latency samples: " << GetCount() << ", p50 < " << GetPercentileUs(50.0) / 1000.0
+			          << " ms, p99 < " << GetPercentileUs(99.0) / 1000.0 << " ms, max " << GetMaxUs() / 1000.0 << " ms" << std::endl;
+		}
+
+	private:
+		std::atomic<std::uint64_t> Buckets[BucketCount] = {};
+		std::atomic<std::uint64_t> Count{0};
+		std::atomic<std::uint64_t> Max{0};
+	};
+} // namespace GamepadCore
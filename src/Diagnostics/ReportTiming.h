@@ -0,0 +1,331 @@
+#pragma once
+#include "Diagnostics/LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Input report timing of one controller, as published by the input thread.
+	 *
+	 * Latencies are relative to the transport floor: the fastest delivery seen, after mapping the
+	 * device clock onto the host clock. The absolute one-way latency is not observable from the host,
+	 * but the part above the floor (queueing, radio retries, poll phase) is, and that is what varies.
+	 */
+	struct FReportTimingMetrics
+	{
+		std::uint64_t Reports = 0;
+		std::uint64_t DroppedReports = 0;
+		std::uint64_t DuplicateReads = 0;
+		std::int64_t ReportPeriodNs = 0;   // device-side report interval
+		double ClockSkewPpm = 0.0;         // device clock rate vs host clock, parts per million (> 0: device fast)
+		std::int64_t LatencyMeanNs = 0;    // above the floor, smoothed
+		std::int64_t LatencyP99Us = 0;     // above the floor, log2 bucket upper edge
+		std::int64_t JitterNs = 0;         // RFC 3550 interarrival jitter
+	};
+
+	/**
+	 * @brief Reconstructs the device clock from report timestamps and measures transport timing.
+	 *
+	 * Every report carries the controller's sensor timestamp (1/3 us ticks) and an 8-bit sequence
+	 * number. Against the host receive time this gives:
+	 *  - the device -> host clock mapping: a line fitted through per-window minima of
+	 *    (host - device), i.e. the lower envelope, which tracks offset and crystal skew;
+	 *  - latency above the floor for every report (host time minus the mapped device time);
+	 *  - interarrival jitter (RFC 3550 estimator) and dropped reports (sequence gaps).
+	 * OnReport() is O(1) apart from a small refit once per window; single-threaded, input thread only.
+	 *
+	 * A blocking read (Bluetooth) returns when the report arrives, so every read time is an arrival
+	 * time. A polled transport (USB) only gives an upper bound: in polled mode the floor is fed only
+	 * by reports bracketed by a preceding empty poll, at the middle of the bracket.
+	 */
+	class FReportClockEstimator
+	{
+	public:
+		static constexpr double NsPerTick = 1000.0 / 3.0;
+		static constexpr std::int64_t WindowNs = 500000000; // one floor sample per half second
+		static constexpr std::size_t WindowCount = 16;     // ~8 s of history for the skew fit
+		static constexpr std::size_t SkewWindows = 4;      // shorter baselines fit noise, not skew
+
+		void Reset()
+		{
+			Metrics = FReportTimingMetrics();
+			LatencyHistogram.Reset();
+			LastEmptyPollNs = -1;
+			LastTicks = 0;
+			LastSequence = 0;
+			LastHostNs = 0;
+			FirstHostNs = 0;
+			DeviceTicks = 0;
+			DeviceNs = 0;
+			PeriodNs = 0.0;
+			Jitter = 0.0;
+			SmoothedLatency = 0.0;
+			LastLatency = 0.0;
+			WindowHead = 0;
+			FitWindows = 0;
+			CurrentWindow = {-1.0, 0.0, 0.0};
+			PollMargin = 0.0;
+			Intercept = std::numeric_limits<double>::max();
+			Slope = 0.0;
+		}
+
+		void SetPolled(bool bInPolled) { bPolled = bInPolled; }
+
+		/**
+		 * @brief Feeds one report read at HostNs (service clock).
+		 *
+		 * @return false when the report was already seen (same device timestamp re-read).
+		 */
+		bool OnReport(std::uint32_t Ticks, std::uint8_t Sequence, std::int64_t HostNs)
+		{
+			if (Metrics.Reports > 0 && Ticks == LastTicks)
+			{
+				++Metrics.DuplicateReads;
+				LastEmptyPollNs = HostNs;
+				PollMargin += 3.0 * PeriodNs / MarginSteps; // polled too early
+				return false;
+			}
+
+			if (Metrics.Reports == 0)
+			{
+				FirstHostNs = HostNs;
+			}
+			else
+			{
+				// Unwrapped in ticks so the 1/3 us rounding never accumulates
+				const std::uint32_t DeltaTicks = Ticks - LastTicks;
+				const double DeltaNs = static_cast<double>(DeltaTicks) * NsPerTick;
+				DeviceTicks += DeltaTicks;
+				DeviceNs = static_cast<std::int64_t>(static_cast<double>(DeviceTicks) * NsPerTick);
+				CountDrops(DeltaNs, static_cast<std::uint8_t>(Sequence - LastSequence));
+				UpdateJitter(HostNs - LastHostNs, DeltaNs);
+			}
+
+			LastTicks = Ticks;
+			LastSequence = Sequence;
+			LastHostNs = HostNs;
+			++Metrics.Reports;
+
+			// (host - device) relative to the first report keeps the doubles small
+			const double Offset = static_cast<double>(HostNs - FirstHostNs - DeviceNs);
+			// Polled: the report arrived between the last empty poll and now
+			const std::int64_t BracketNs = LastEmptyPollNs >= 0 ? HostNs - LastEmptyPollNs : -1;
+			LastEmptyPollNs = -1;
+			if (!bPolled)
+			{
+				TrackFloor(Offset);
+			}
+			else if (BracketNs >= 0 && PeriodNs > 0.0 && static_cast<double>(BracketNs) <= PeriodNs / 4.0)
+			{
+				TrackFloor(Offset - static_cast<double>(BracketNs) / 2.0);
+			}
+			else
+			{
+				if (FitWindows == 0)
+				{
+					Intercept = std::min(Intercept, Offset); // provisional floor from upper bounds
+				}
+				PollMargin -= PeriodNs / MarginSteps; // first poll already had it: try earlier
+			}
+			PollMargin = std::clamp(PollMargin, -PeriodNs / 2.0, PeriodNs);
+
+			const double Latency = std::max(0.0, Offset - FloorAt(static_cast<double>(DeviceNs)));
+			LastLatency = Latency;
+			SmoothedLatency += (Latency - SmoothedLatency) / (Metrics.Reports < 16 ? static_cast<double>(Metrics.Reports) : 16.0);
+			LatencyHistogram.Record(static_cast<std::int64_t>(Latency / 1000.0));
+
+			Metrics.LatencyMeanNs = static_cast<std::int64_t>(SmoothedLatency);
+			Metrics.LatencyP99Us = static_cast<std::int64_t>(LatencyHistogram.GetPercentileUs(99.0));
+			Metrics.JitterNs = static_cast<std::int64_t>(Jitter);
+			Metrics.ReportPeriodNs = static_cast<std::int64_t>(PeriodNs);
+			Metrics.ClockSkewPpm = -Slope * 1e6; // offset shrinks when the device clock runs fast
+			return true;
+		}
+
+		/**
+		 * @brief Host time at which the next report should be readable: the mapped device time of the
+		 * next report plus the typical latency above the floor. 0 until the period is known.
+		 */
+		std::int64_t PredictNextArrivalNs() const
+		{
+			const std::int64_t Earliest = PredictEarliestArrivalNs();
+			return Earliest > 0 ? Earliest + static_cast<std::int64_t>(SmoothedLatency) : 0;
+		}
+
+		/**
+		 * @brief Poll deadline phase-aligned to report arrival (polled transports).
+		 *
+		 * Returns the earliest possible arrival of the next report plus a margin, kept between
+		 * PollIntervalNs / 8 and 2 x PollIntervalNs from now; a poll that comes up empty is retried
+		 * PollIntervalNs / 8 later, which also brackets the arrival for the floor. Until the clock is
+		 * locked it polls at PollIntervalNs / 8 to acquire the phase.
+		 *
+		 * The margin is a quantile tracker: an empty poll moves it 3 steps later, a report found on
+		 * the first poll 1 step earlier, so about a quarter of the reports need a retry. That keeps
+		 * the floor fed with bracketed arrivals; the latency above the floor cannot be used instead,
+		 * as with polling it is mostly the poll phase itself and would push every poll later.
+		 */
+		std::int64_t GetNextPollNs(std::int64_t NowNs, std::int64_t PollIntervalNs) const
+		{
+			const std::int64_t RetryNs = PollIntervalNs / 8;
+			if (!IsLocked())
+			{
+				return NowNs + RetryNs;
+			}
+			const std::int64_t Aligned = PredictEarliestArrivalNs() + static_cast<std::int64_t>(PollMargin);
+			return std::clamp(Aligned, NowNs + RetryNs, NowNs + 2 * PollIntervalNs);
+		}
+
+		/**
+		 * @brief True once the floor rests on two full windows (skew follows from SkewWindows on).
+		 */
+		bool IsLocked() const { return FitWindows >= 2; }
+
+		/** Latency above the floor of the last report, in ns. */
+		double GetLastLatencyNs() const { return LastLatency; }
+
+		const FReportTimingMetrics& GetMetrics() const { return Metrics; }
+		const FLatencyHistogram& GetLatency() const { return LatencyHistogram; }
+
+	private:
+		static constexpr double MarginSteps = 256.0; // poll margin step = period / 256
+
+		struct FWindowMinimum
+		{
+			double StartNs;  // device time the window opened
+			double DeviceNs; // device time of the minimum
+			double Offset;
+		};
+
+		// Next report's device time mapped onto the floor; 0 until the period is known
+		std::int64_t PredictEarliestArrivalNs() const
+		{
+			if (Metrics.Reports < 2 || PeriodNs <= 0.0)
+			{
+				return 0;
+			}
+			const double NextDeviceNs = static_cast<double>(DeviceNs) + PeriodNs;
+			return FirstHostNs + static_cast<std::int64_t>(NextDeviceNs + FloorAt(NextDeviceNs));
+		}
+
+		void CountDrops(double DeltaNs, std::uint8_t SequenceStep)
+		{
+			// The 8-bit sequence is exact for short gaps; long outages wrap it, use the timestamps there
+			std::uint64_t Missing = SequenceStep > 0 ? SequenceStep - 1u : 0u;
+			if (PeriodNs > 0.0 && DeltaNs > 200.0 * PeriodNs)
+			{
+				Missing = static_cast<std::uint64_t>(std::llround(DeltaNs / PeriodNs)) - 1;
+			}
+			Metrics.DroppedReports += Missing;
+
+			if (Missing == 0)
+			{
+				PeriodNs = PeriodNs <= 0.0 ? DeltaNs : PeriodNs + (DeltaNs - PeriodNs) / 64.0;
+			}
+		}
+
+		void UpdateJitter(std::int64_t HostDeltaNs, double DeviceDeltaNs)
+		{
+			const double Transit = std::fabs(static_cast<double>(HostDeltaNs) - DeviceDeltaNs);
+			Jitter += (Transit - Jitter) / 16.0;
+		}
+
+		void TrackFloor(double Offset)
+		{
+			const double Device = static_cast<double>(DeviceNs);
+			if (CurrentWindow.StartNs < 0.0 || Device - CurrentWindow.StartNs >= static_cast<double>(WindowNs))
+			{
+				if (CurrentWindow.StartNs >= 0.0)
+				{
+					Windows[WindowHead] = CurrentWindow;
+					WindowHead = (WindowHead + 1) % WindowCount;
+					FitWindows = std::min(FitWindows + 1, WindowCount);
+					Refit();
+				}
+				CurrentWindow = {Device, Device, Offset};
+			}
+			else if (Offset < CurrentWindow.Offset)
+			{
+				CurrentWindow.DeviceNs = Device;
+				CurrentWindow.Offset = Offset;
+			}
+
+			// Until the first fit the floor is simply the lowest sample seen
+			if (FitWindows == 0)
+			{
+				Intercept = std::min(Intercept, Offset);
+			}
+		}
+
+		// Least squares through the window minima, then shifted down onto the lowest of them
+		void Refit()
+		{
+			if (FitWindows < SkewWindows)
+			{
+				Slope = 0.0;
+				Intercept = Windows[0].Offset;
+				for (std::size_t i = 1; i < FitWindows; ++i)
+				{
+					Intercept = std::min(Intercept, Windows[i].Offset);
+				}
+				return;
+			}
+
+			double MeanX = 0.0, MeanY = 0.0;
+			for (std::size_t i = 0; i < FitWindows; ++i)
+			{
+				MeanX += Windows[i].DeviceNs;
+				MeanY += Windows[i].Offset;
+			}
+			MeanX /= static_cast<double>(FitWindows);
+			MeanY /= static_cast<double>(FitWindows);
+
+			double Sxx = 0.0, Sxy = 0.0;
+			for (std::size_t i = 0; i < FitWindows; ++i)
+			{
+				Sxx += (Windows[i].DeviceNs - MeanX) * (Windows[i].DeviceNs - MeanX);
+				Sxy += (Windows[i].DeviceNs - MeanX) * (Windows[i].Offset - MeanY);
+			}
+			Slope = Sxx > 0.0 ? Sxy / Sxx : 0.0;
+			Intercept = MeanY - Slope * MeanX;
+
+			double Lowest = 0.0;
+			for (std::size_t i = 0; i < FitWindows; ++i)
+			{
+				Lowest = std::min(Lowest, Windows[i].Offset - FloorAt(Windows[i].DeviceNs));
+			}
+			Intercept += Lowest;
+		}
+
+		double FloorAt(double Device) const { return Intercept + Slope * Device; }
+
+		FReportTimingMetrics Metrics;
+		FLatencyHistogram LatencyHistogram;
+
+		std::uint32_t LastTicks = 0;
+		std::uint8_t LastSequence = 0;
+		std::int64_t LastHostNs = 0;
+		std::int64_t LastEmptyPollNs = -1;
+		bool bPolled = false;
+		std::int64_t FirstHostNs = 0;
+		std::int64_t DeviceTicks = 0; // unwrapped device time since the first report
+		std::int64_t DeviceNs = 0;
+
+		double PeriodNs = 0.0;
+		double Jitter = 0.0;
+		double SmoothedLatency = 0.0;
+		double LastLatency = 0.0;
+		double PollMargin = 0.0;
+
+		FWindowMinimum Windows[WindowCount] = {};
+		std::size_t WindowHead = 0;
+		std::size_t FitWindows = 0;
+		FWindowMinimum CurrentWindow{-1.0, 0.0, 0.0};
+		double Intercept = std::numeric_limits<double>::max();
+		double Slope = 0.0;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,66 @@
+#pragma once
+#include "Timing/ServiceClock.h"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Records the service startup timeline (controller attach, first input report, first haptic packet).
+	 *
+	 * Every milestone is logged once per service run, measured from Begin(). The Mark* calls are
+	 * lock-free and cheap after the first hit, so they can stay on the input and audio hot paths.
+	 */
+	class FStartupMetrics
+	{
+	public:
+		void Begin()
+		{
+			StartNs.store(IServiceClock::Get().NowNs(), std::memory_order_relaxed);
+			bDeviceAttached.store(false, std::memory_order_relaxed);
+			bFirstInputReport.store(false, std::memory_order_relaxed);
+			bFirstHapticPacket.store(false, std::memory_order_relaxed);
+		}
+
+		void MarkDeviceAttached() { Mark(bDeviceAttached, DeviceAttachedUs, "controller attached"); }
+		void MarkFirstInputReport() { Mark(bFirstInputReport, FirstInputReportUs, "first input report"); }
+		void MarkFirstHapticPacket() { Mark(bFirstHapticPacket, FirstHapticPacketUs, "first haptic packet"); }
+
+		/** Microseconds from Begin() to each milestone, or -1 when it has not happened yet. */
+		std::int64_t GetDeviceAttachedUs() const { return Read(bDeviceAttached, DeviceAttachedUs); }
+		std::int64_t GetFirstInputReportUs() const { return Read(bFirstInputReport, FirstInputReportUs); }
+		std::int64_t GetFirstHapticPacketUs() const { return Read(bFirstHapticPacket, FirstHapticPacketUs); }
+
+	private:
+		void Mark(std::atomic<bool>& bDone, std::atomic<std::int64_t>& OutUs, const char* Label)
+		{
+			if (bDone.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			const std::int64_t Elapsed = (IServiceClock::Get().NowNs() - StartNs.load(std::memory_order_relaxed)) / 1000;
+			OutUs.store(Elapsed, std::memory_order_relaxed);
+			if (bDone.exchange(true, std::memory_order_release))
+			{
+				return;
+			}
+
+			std::cout << "[Startup] Time to " << Label << ": " << (Elapsed / 1000.0) << " ms" << std::endl;
+		}
+
+		static std::int64_t Read(const std::atomic<bool>& bDone, const std::atomic<std::int64_t>& Us)
+		{
+			return bDone.load(std::memory_order_acquire) ? Us.load(std::memory_order_relaxed) : -1;
+		}
+
+		std::atomic<std::int64_t> StartNs{0};
+		std::atomic<bool> bDeviceAttached{false};
+		std::atomic<bool> bFirstInputReport{false};
+		std::atomic<bool> bFirstHapticPacket{false};
+		std::atomic<std::int64_t> DeviceAttachedUs{0};
+		std::atomic<std::int64_t> FirstInputReportUs{0};
+		std::atomic<std::int64_t> FirstHapticPacketUs{0};
+	};
+} // namespace GamepadCore
@@ -0,0 +1,416 @@
+#include "CalibrationCache.h"
+#include "Timing/ServiceClock.h"
+#include "Util/CacheFile.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace GamepadCore
+{
+	namespace
+	{
+		// On-disk entry: header, device id, report bytes. Checksum covers everything before it.
+		struct FCalibrationFileHeader
+		{
+			static constexpr char ExpectedMagic[8] = {'G', 'P', 'C', 'A', 'L', 'I', 'B', '2'};
+
+			char Magic[8];
+			std::uint32_t KeyLength;
+			std::uint32_t Firmware;
+			std::int64_t StoredAtSeconds;
+		};
+		static_assert(sizeof(FCalibrationFileHeader) == 24, "FCalibrationFileHeader is part of the cache file format");
+
+		std::int16_t ReadInt16(const std::uint8_t* Report, std::size_t Offset)
+		{
+			return static_cast<std::int16_t>(Report[Offset] | (Report[Offset + 1] << 8));
+		}
+	} // namespace
+
+	namespace DualSenseFeatureReport
+	{
+		std::string MacFromPairingInfo(const std::uint8_t* Report)
+		{
+			char Mac[18];
+			const std::uint8_t* Bytes = Report + PairingInfoMac;
+			std::snprintf(Mac, sizeof(Mac), "%02x:%02x:%02x:%02x:%02x:%02x", Bytes[5], Bytes[4], Bytes[3], Bytes[2], Bytes[1], Bytes[0]);
+			return Mac;
+		}
+
+		std::string NormalizeMac(const std::string& Text)
+		{
+			std::string Mac;
+			for (const char Character : Text)
+			{
+				if (std::isxdigit(static_cast<unsigned char>(Character)))
+				{
+					if (Mac.size() % 3 == 2)
+					{
+						Mac += ':';
+					}
+					Mac += static_cast<char>(std::tolower(static_cast<unsigned char>(Character)));
+				}
+				else if (Character != ':' && Character != '-')
+				{
+					return std::string();
+				}
+			}
+			return Mac.size() == 17 ? Mac : std::string();
+		}
+
+		std::uint32_t FirmwareFromFirmwareInfo(const std::uint8_t* Report)
+		{
+			const std::uint8_t* Bytes = Report + FirmwareInfoVersion;
+			return static_cast<std::uint32_t>(Bytes[0]) | (static_cast<std::uint32_t>(Bytes[1]) << 8) | (static_cast<std::uint32_t>(Bytes[2]) << 16) |
+			       (static_cast<std::uint32_t>(Bytes[3]) << 24);
+		}
+	} // namespace DualSenseFeatureReport
+
+	FCalibrationCache& FCalibrationCache::Get()
+	{
+		static FCalibrationCache Cache;
+		return Cache;
+	}
+
+	std::int64_t FCalibrationCache::WallClockSeconds()
+	{
+		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	void FCalibrationCache::SetDirectory(std::string InDirectory)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Directory = std::move(InDirectory);
+		Entries.clear();
+	}
+
+	bool FCalibrationCache::IsValidReport(const FReport& Report)
+	{
+		using namespace DualSenseCalibrationReport;
+		if (Report[0] != ReportId)
+		{
+			return false;
+		}
+
+		// Every scale factor the sensor code derives must have a non-zero, correctly signed range
+		const int Ranges[] = {
+		    ReadInt16(Report, GyroPitchPlus) - ReadInt16(Report, GyroPitchMinus),
+		    ReadInt16(Report, GyroYawPlus) - ReadInt16(Report, GyroYawMinus),
+		    ReadInt16(Report, GyroRollPlus) - ReadInt16(Report, GyroRollMinus),
+		    ReadInt16(Report, AccelXPlus) - ReadInt16(Report, AccelXMinus),
+		    ReadInt16(Report, AccelYPlus) - ReadInt16(Report, AccelYMinus),
+		    ReadInt16(Report, AccelZPlus) - ReadInt16(Report, AccelZMinus)};
+		for (const int Range : Ranges)
+		{
+			if (Range <= 0)
+			{
+				return false;
+			}
+		}
+		return ReadInt16(Report, GyroSpeedPlus) + ReadInt16(Report, GyroSpeedMinus) > 0;
+	}
+
+	bool FCalibrationCache::Publish(const FReport& Report)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		std::memcpy(ResolvedReport, Report, sizeof(FReport));
+		ResolvedGeneration.fetch_add(1, std::memory_order_release);
+		return true;
+	}
+
+	bool FCalibrationCache::Resolve(const FCalibrationKey* Key, FReport& OutReport, const FReadFeature& ReadFeature, const std::function<FReadFeature()>& MakeRefreshReader)
+	{
+		const ECalibrationLookup Lookup = Key ? Load(*Key, OutReport) : ECalibrationLookup::Miss;
+		// Claim the refresh before asking for a reader: a reader may own a duplicated handle, so one is
+		// only made when it is going to run
+		if (Lookup == ECalibrationLookup::Stale && MakeRefreshReader && BeginRefresh(*Key))
+		{
+			if (FReadFeature RefreshReader = MakeRefreshReader())
+			{
+				StartRefresh(*Key, std::move(RefreshReader));
+			}
+		}
+		if (Lookup != ECalibrationLookup::Miss)
+		{
+			return Publish(OutReport);
+		}
+
+		std::memset(OutReport, 0, sizeof(FReport));
+		OutReport[0] = DualSenseCalibrationReport::ReportId;
+		if (!ReadFeature(OutReport))
+		{
+			return false;
+		}
+		if (Key)
+		{
+			Store(*Key, OutReport);
+		}
+		return IsValidReport(OutReport) && Publish(OutReport);
+	}
+
+	bool FCalibrationCache::ResolveFromDevice(const FCalibrationKey* Key, FReport& OutReport, const FReadDevice& ReadDevice, const std::function<FReadDevice()>& MakeAsyncReader)
+	{
+		FReport Cached = {};
+		const bool bCached = Key && Load(*Key, Cached) != ECalibrationLookup::Miss;
+		if (bCached && MakeAsyncReader)
+		{
+			if (FReadDevice AsyncReader = MakeAsyncReader())
+			{
+				StartDeviceRead(Key->DeviceId, std::move(AsyncReader));
+				std::memcpy(OutReport, Cached, sizeof(FReport));
+				return Publish(OutReport);
+			}
+		}
+
+		// First connect, or no reader for the worker: read here, falling back to the cached report
+		std::memset(OutReport, 0, sizeof(FReport));
+		OutReport[0] = DualSenseCalibrationReport::ReportId;
+		std::uint32_t Firmware = FCalibrationKey::AnyFirmware;
+		if (!ReadDevice(Firmware, OutReport))
+		{
+			if (!bCached)
+			{
+				return false;
+			}
+			std::memcpy(OutReport, Cached, sizeof(FReport));
+			return Publish(OutReport);
+		}
+
+		const FCalibrationKey ReadKey{Key ? Key->DeviceId : std::string(), Firmware};
+		if (Key && !IsCached(ReadKey, OutReport))
+		{
+			Store(ReadKey, OutReport);
+		}
+		return IsValidReport(OutReport) && Publish(OutReport);
+	}
+
+	std::uint64_t FCalibrationCache::GetResolvedReport(FReport& OutReport) const
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		std::memcpy(OutReport, ResolvedReport, sizeof(FReport));
+		return ResolvedGeneration.load(std::memory_order_relaxed);
+	}
+
+	ECalibrationLookup FCalibrationCache::Load(const FCalibrationKey& Key, FReport& OutReport)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		auto Found = Entries.find(Key.DeviceId);
+		if (Found == Entries.end())
+		{
+			FEntry Entry;
+			if (!LoadFile(Key.DeviceId, Entry))
+			{
+				++Misses;
+				return ECalibrationLookup::Miss;
+			}
+			Found = Entries.emplace(Key.DeviceId, Entry).first;
+		}
+		if (Key.Firmware != FCalibrationKey::AnyFirmware && Found->second.Firmware != Key.Firmware)
+		{
+			++Misses;
+			return ECalibrationLookup::Miss;
+		}
+
+		std::memcpy(OutReport, Found->second.Report, sizeof(FReport));
+		++Hits;
+		return NowSeconds() - Found->second.StoredAtSeconds > MaxAgeSeconds ? ECalibrationLookup::Stale : ECalibrationLookup::Fresh;
+	}
+
+	bool FCalibrationCache::Store(const FCalibrationKey& Key, const FReport& Report)
+	{
+		if (!IsValidReport(Report))
+		{
+			return false;
+		}
+
+		FEntry Entry;
+		std::memcpy(Entry.Report, Report, sizeof(FReport));
+		Entry.Firmware = Key.Firmware;
+		Entry.StoredAtSeconds = NowSeconds();
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Entries[Key.DeviceId] = Entry;
+		return SaveFile(Key.DeviceId, Entry);
+	}
+
+	bool FCalibrationCache::IsCached(const FCalibrationKey& Key, const FReport& Report) const
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		const auto Found = Entries.find(Key.DeviceId);
+		return Found != Entries.end() && Found->second.Firmware == Key.Firmware && std::memcmp(Found->second.Report, Report, sizeof(FReport)) == 0;
+	}
+
+	void FCalibrationCache::RefreshAsync(const FCalibrationKey& Key, FReadFeature ReadFeature)
+	{
+		if (BeginRefresh(Key))
+		{
+			StartRefresh(Key, std::move(ReadFeature));
+		}
+	}
+
+	bool FCalibrationCache::BeginRefresh(const FCalibrationKey& Key)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		// One attempt per key and session: a failed read is retried on the next service start
+		return Refreshing.insert(Key.ToString()).second;
+	}
+
+	void FCalibrationCache::StartRefresh(const FCalibrationKey& Key, FReadFeature ReadFeature)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		StartWorker([this, Key, ReadFeature = std::move(ReadFeature)]
+		{
+			FReport Report = {DualSenseCalibrationReport::ReportId};
+			if (ReadFeature(Report) && !Store(Key, Report))
+			{
+				std::cerr << "[Calibration] Refreshed report for " << Key.DeviceId << " failed validation, keeping the cached one." << std::endl;
+			}
+		});
+	}
+
+	void FCalibrationCache::StartDeviceRead(const std::string& DeviceId, FReadDevice ReadDevice)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		StartWorker([this, DeviceId, ReadDevice = std::move(ReadDevice)]
+		{
+			FReport Report = {DualSenseCalibrationReport::ReportId};
+			std::uint32_t Firmware = FCalibrationKey::AnyFirmware;
+			if (!ReadDevice(Firmware, Report))
+			{
+				return;
+			}
+
+			// Usually the same firmware and bytes: nothing to write. Otherwise the connection already
+			// runs on the old report, so the new one is published for the motion stage too
+			const FCalibrationKey Key{DeviceId, Firmware};
+			if (IsCached(Key, Report))
+			{
+				return;
+			}
+			if (!Store(Key, Report))
+			{
+				std::cerr << "[Calibration] Report read for " << DeviceId << " failed validation, keeping the cached one." << std::endl;
+				return;
+			}
+			Publish(Report);
+		});
+	}
+
+	void FCalibrationCache::StartWorker(std::function<void()> Work)
+	{
+		for (auto Worker = Workers.begin(); Worker != Workers.end();)
+		{
+			if (Worker->bDone->load(std::memory_order_acquire))
+			{
+				Worker->Thread.join();
+				Worker = Workers.erase(Worker);
+			}
+			else
+			{
+				++Worker;
+			}
+		}
+
+		// Joins the service clock for the worker before it exists, so a simulated clock never runs ahead of it
+		auto bDone = std::make_shared<std::atomic<bool>>(false);
+		IServiceClock& Clock = IServiceClock::Get();
+		Clock.EnterThread();
+		std::thread Thread([Work = std::move(Work), bDone, &Clock]
+		{
+			Work();
+			Clock.LeaveThread();
+			bDone->store(true, std::memory_order_release);
+		});
+		Workers.push_back(FWorker{std::move(Thread), std::move(bDone)});
+	}
+
+	void FCalibrationCache::Shutdown()
+	{
+		std::vector<FWorker> Pending;
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Pending.swap(Workers);
+		}
+		for (FWorker& Worker : Pending)
+		{
+			Worker.Thread.join();
+		}
+	}
+
+	std::string FCalibrationCache::GetFilePath(const std::string& DeviceId) const
+	{
+		char Name[32];
+		std::snprintf(Name, sizeof(Name), "%016llx.cal", static_cast<unsigned long long>(Fnv1a64(DeviceId.data(), DeviceId.size())));
+		return (std::filesystem::path(Directory) / Name).string();
+	}
+
+	bool FCalibrationCache::LoadFile(const std::string& DeviceId, FEntry& OutEntry) const
+	{
+		if (Directory.empty())
+		{
+			return false;
+		}
+
+		std::ifstream File(GetFilePath(DeviceId), std::ios::binary);
+		const std::string& Id = DeviceId;
+		FCalibrationFileHeader Header{};
+		if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header)) ||
+		    std::memcmp(Header.Magic, FCalibrationFileHeader::ExpectedMagic, sizeof(Header.Magic)) != 0 ||
+		    Header.KeyLength != Id.size())
+		{
+			return false;
+		}
+
+		std::string StoredId(Header.KeyLength, '\0');
+		std::uint64_t StoredChecksum = 0;
+		if (!File.read(StoredId.data(), StoredId.size()) ||
+		    !File.read(reinterpret_cast<char*>(OutEntry.Report), sizeof(OutEntry.Report)) ||
+		    !File.read(reinterpret_cast<char*>(&StoredChecksum), sizeof(StoredChecksum)) || StoredId != Id)
+		{
+			return false;
+		}
+
+		std::uint64_t Checksum = Fnv1a64(&Header, sizeof(Header));
+		Checksum = Fnv1a64(StoredId.data(), StoredId.size(), Checksum);
+		Checksum = Fnv1a64(OutEntry.Report, sizeof(OutEntry.Report), Checksum);
+		if (Checksum != StoredChecksum || !IsValidReport(OutEntry.Report))
+		{
+			std::cerr << "[Calibration] Discarding corrupt cache entry for " << DeviceId << "." << std::endl;
+			return false;
+		}
+
+		OutEntry.Firmware = Header.Firmware;
+		OutEntry.StoredAtSeconds = Header.StoredAtSeconds;
+		return true;
+	}
+
+	bool FCalibrationCache::SaveFile(const std::string& DeviceId, const FEntry& Entry) const
+	{
+		if (Directory.empty())
+		{
+			return true;
+		}
+
+		std::error_code Error;
+		std::filesystem::create_directories(Directory, Error);
+
+		const std::string& Id = DeviceId;
+		FCalibrationFileHeader Header{};
+		std::memcpy(Header.Magic, FCalibrationFileHeader::ExpectedMagic, sizeof(Header.Magic));
+		Header.KeyLength = static_cast<std::uint32_t>(Id.size());
+		Header.Firmware = Entry.Firmware;
+		Header.StoredAtSeconds = Entry.StoredAtSeconds;
+
+		const std::string Path = GetFilePath(DeviceId);
+		if (!WriteCacheFile(Path, {{&Header, sizeof(Header)}, {Id.data(), Id.size()}, {Entry.Report, sizeof(Entry.Report)}}))
+		{
+			std::cerr << "[Calibration] Failed to write " << Path << "." << std::endl;
+			return false;
+		}
+		return true;
+	}
+} // namespace GamepadCore
@@ -0,0 +1,238 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Byte layout of the DualSense IMU calibration feature report (0x05), int16 LE fields.
+	 */
+	namespace DualSenseCalibrationReport
+	{
+		constexpr std::uint8_t ReportId = 0x05;
+		constexpr std::size_t Size = 41;
+
+		constexpr std::size_t GyroPitchBias = 1;
+		constexpr std::size_t GyroYawBias = 3;
+		constexpr std::size_t GyroRollBias = 5;
+		constexpr std::size_t GyroPitchPlus = 7;
+		constexpr std::size_t GyroPitchMinus = 9;
+		constexpr std::size_t GyroYawPlus = 11;
+		constexpr std::size_t GyroYawMinus = 13;
+		constexpr std::size_t GyroRollPlus = 15;
+		constexpr std::size_t GyroRollMinus = 17;
+		constexpr std::size_t GyroSpeedPlus = 19;
+		constexpr std::size_t GyroSpeedMinus = 21;
+		constexpr std::size_t AccelXPlus = 23;
+		constexpr std::size_t AccelXMinus = 25;
+		constexpr std::size_t AccelYPlus = 27;
+		constexpr std::size_t AccelYMinus = 29;
+		constexpr std::size_t AccelZPlus = 31;
+		constexpr std::size_t AccelZMinus = 33;
+	} // namespace DualSenseCalibrationReport
+
+	/**
+	 * @brief Feature reports that identify a DualSense: pairing info (MAC) and firmware info.
+	 */
+	namespace DualSenseFeatureReport
+	{
+		constexpr std::uint8_t PairingInfoId = 0x09;
+		constexpr std::size_t PairingInfoSize = 20;
+		constexpr std::size_t PairingInfoMac = 1; // 6 bytes, little endian
+
+		constexpr std::uint8_t FirmwareInfoId = 0x20;
+		constexpr std::size_t FirmwareInfoSize = 64;
+		constexpr std::size_t FirmwareInfoVersion = 28; // uint32 LE
+
+		/**
+		 * @brief "aa:bb:cc:dd:ee:ff" from the little-endian MAC of a pairing info report.
+		 */
+		std::string MacFromPairingInfo(const std::uint8_t* Report);
+
+		/**
+		 * @brief Canonical "aa:bb:cc:dd:ee:ff" form of a MAC written with or without separators, in any
+		 * case (Bluetooth serial strings, device instance IDs). Empty unless it holds exactly 12 hex digits.
+		 */
+		std::string NormalizeMac(const std::string& Text);
+
+		std::uint32_t FirmwareFromFirmwareInfo(const std::uint8_t* Report);
+	} // namespace DualSenseFeatureReport
+
+	/**
+	 * @brief Identifies one controller's calibration: device identity (VID/PID + MAC) and firmware.
+	 *
+	 * Entries are stored per device; the firmware they were read on is checked on lookup. A key with
+	 * AnyFirmware matches the device's entry whatever its firmware, for connections that cannot read the
+	 * firmware version without a round trip to the controller.
+	 */
+	struct FCalibrationKey
+	{
+		static constexpr std::uint32_t AnyFirmware = 0;
+
+		std::string DeviceId;
+		std::uint32_t Firmware = AnyFirmware;
+
+		std::string ToString() const { return DeviceId + "@" + std::to_string(Firmware); }
+	};
+
+	enum class ECalibrationLookup : std::uint8_t
+	{
+		Miss,  // nothing usable cached: read the feature report now
+		Fresh, // cached copy is valid and recent
+		Stale  // cached copy is valid but old: use it, refresh in the background
+	};
+
+	/**
+	 * @brief Persistent cache of the raw calibration feature report, one file per controller, tagged
+	 * with the firmware it was read on.
+	 *
+	 * Reading report 0x05 is a blocking round trip to the controller (tens of ms over Bluetooth) on
+	 * every connect. The cache lets CreateHandle reuse the report of the previous connection instead:
+	 * Load() answers from memory or disk without touching the device, and a stale entry is refreshed
+	 * on a worker thread with RefreshAsync() for the next connection. On Bluetooth, where the read
+	 * cannot be skipped, it moves to a worker thread instead (ResolveFromDevice). The raw report is
+	 * stored rather than the parsed calibration, so parsing changes never invalidate the cache. Every
+	 * entry carries a checksum and is re-validated on load; a corrupt or implausible entry counts as a miss.
+	 */
+	class FCalibrationCache
+	{
+	public:
+		using FReport = std::uint8_t[DualSenseCalibrationReport::Size];
+		using FReadFeature = std::function<bool(std::uint8_t* OutReport)>;
+		// Reads the firmware version and the calibration report, for keys with AnyFirmware
+		using FReadDevice = std::function<bool(std::uint32_t& OutFirmware, std::uint8_t* OutReport)>;
+		using FTimeSource = std::int64_t (*)();
+
+		static constexpr std::int64_t DefaultMaxAgeSeconds = 7 * 24 * 60 * 60;
+
+		static FCalibrationCache& Get();
+
+		/**
+		 * @brief Directory for the cache files, created on first store. Empty keeps the cache in memory only.
+		 */
+		void SetDirectory(std::string InDirectory);
+		void SetMaxAgeSeconds(std::int64_t Seconds) { MaxAgeSeconds = Seconds; }
+
+		/**
+		 * @brief Clock for entry ages, in seconds. Defaults to the wall clock (ages span service runs).
+		 */
+		void SetTimeSource(FTimeSource InNowSeconds) { NowSeconds = InNowSeconds ? InNowSeconds : &WallClockSeconds; }
+
+		/**
+		 * @brief Calibration report for a connecting controller, with the device read only when needed.
+		 *
+		 * Returns the cached report when there is a valid one, otherwise reads it with ReadFeature and
+		 * caches it. A stale hit is returned immediately and refreshed in the background with the reader
+		 * MakeRefreshReader returns (it may duplicate the handle; nullptr skips the refresh). It is only
+		 * called when the refresh will run, so the reader never needs cleaning up unused. Key may be
+		 * null when the controller has no stable identity, which always reads the device.
+		 *
+		 * @return false when neither the cache nor the device produced a valid report.
+		 */
+		bool Resolve(const FCalibrationKey* Key, FReport& OutReport, const FReadFeature& ReadFeature, const std::function<FReadFeature()>& MakeRefreshReader);
+
+		/**
+		 * @brief Resolve() for connections where the 0x05 read itself matters: reading it switches a
+		 * Bluetooth DualSense from the basic 0x01 input report to the full one, so it cannot be skipped.
+		 *
+		 * Key usually has AnyFirmware (the firmware report is a round trip too). With a cached entry the
+		 * cached report is returned at once and the device is read on a worker thread, with the reader
+		 * MakeAsyncReader returns (it may duplicate the handle); a changed firmware or report is stored
+		 * and published when it arrives. Without one, ReadDevice runs on the calling thread.
+		 *
+		 * @return false when neither the cache nor the device produced a valid report.
+		 */
+		bool ResolveFromDevice(const FCalibrationKey* Key, FReport& OutReport, const FReadDevice& ReadDevice, const std::function<FReadDevice()>& MakeAsyncReader);
+
+		ECalibrationLookup Load(const FCalibrationKey& Key, FReport& OutReport);
+
+		/**
+		 * @brief Stores a freshly read report. Reports that fail validation are not cached.
+		 */
+		bool Store(const FCalibrationKey& Key, const FReport& Report);
+
+		/**
+		 * @brief Reads the report on a worker thread with ReadFeature and stores it. A key is refreshed at
+		 * most once per session; ReadFeature owns whatever handle it captured.
+		 */
+		void RefreshAsync(const FCalibrationKey& Key, FReadFeature ReadFeature);
+
+		/**
+		 * @brief Waits for the pending refreshes. Call before the service unloads.
+		 */
+		void Shutdown();
+
+		static bool IsValidReport(const FReport& Report);
+
+		/**
+		 * @brief Last report Resolve() handed out, for consumers outside the handle-creation path (motion stage).
+		 *
+		 * @return Resolve generation of the copied report; 0 when nothing was resolved yet.
+		 */
+		std::uint64_t GetResolvedReport(FReport& OutReport) const;
+
+		/**
+		 * @brief Lock-free check for a new resolved report, cheap enough for the input thread.
+		 */
+		std::uint64_t GetResolvedGeneration() const { return ResolvedGeneration.load(std::memory_order_acquire); }
+
+		std::uint64_t GetHitCount() const
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Hits;
+		}
+		std::uint64_t GetMissCount() const
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Misses;
+		}
+
+		static std::int64_t WallClockSeconds();
+
+	private:
+		struct FEntry
+		{
+			std::uint8_t Report[DualSenseCalibrationReport::Size];
+			std::uint32_t Firmware;
+			std::int64_t StoredAtSeconds;
+		};
+
+		struct FWorker
+		{
+			std::thread Thread;
+			std::shared_ptr<std::atomic<bool>> bDone;
+		};
+
+		bool Publish(const FReport& Report);
+		bool BeginRefresh(const FCalibrationKey& Key);
+		void StartRefresh(const FCalibrationKey& Key, FReadFeature ReadFeature);
+		void StartDeviceRead(const std::string& DeviceId, FReadDevice ReadDevice);
+		// Caller holds Mutex. A worker per Bluetooth connect: joins the finished ones before adding one
+		void StartWorker(std::function<void()> Work);
+		bool IsCached(const FCalibrationKey& Key, const FReport& Report) const;
+		bool LoadFile(const std::string& DeviceId, FEntry& OutEntry) const;
+		bool SaveFile(const std::string& DeviceId, const FEntry& Entry) const;
+		std::string GetFilePath(const std::string& DeviceId) const;
+
+		mutable std::mutex Mutex;
+		std::string Directory;
+		std::int64_t MaxAgeSeconds = DefaultMaxAgeSeconds;
+		FTimeSource NowSeconds = &WallClockSeconds;
+		std::unordered_map<std::string, FEntry> Entries;
+		std::unordered_set<std::string> Refreshing;
+		std::vector<FWorker> Workers;
+		FReport ResolvedReport = {};
+		std::atomic<std::uint64_t> ResolvedGeneration{0};
+		std::uint64_t Hits = 0;
+		std::uint64_t Misses = 0;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Byte layout of the DualSense input report payload (USB report 0x01 / BT report 0x31).
+	 *
+	 * Offsets are relative to the payload, i.e. after the report ID on USB and after the report ID and
+	 * sequence tag on Bluetooth.
+	 */
+	namespace DualSenseReport
+	{
+		constexpr std::size_t PayloadSize = 63;
+		constexpr std::size_t UsbHeaderSize = 1;
+		constexpr std::size_t BtHeaderSize = 2;
+		constexpr std::uint8_t UsbReportId = 0x01;
+		constexpr std::uint8_t BtReportId = 0x31;
+		// Until feature report 0x05 is read, a Bluetooth pad sends this reduced report (ID 0x01, no motion)
+		constexpr std::size_t BtBasicReportSize = 10;
+		constexpr std::size_t BtReportSize = 78; // header, payload, padding, CRC-32
+
+		constexpr std::size_t LeftStickX = 0;
+		constexpr std::size_t LeftStickY = 1;
+		constexpr std::size_t RightStickX = 2;
+		constexpr std::size_t RightStickY = 3;
+		constexpr std::size_t LeftTrigger = 4;
+		constexpr std::size_t RightTrigger = 5;
+		constexpr std::size_t Sequence = 6;
+		constexpr std::size_t Buttons0 = 7; // D-pad hat (low nibble), square/cross/circle/triangle (high nibble)
+		constexpr std::size_t Buttons1 = 8; // L1, R1, L2, R2, Create, Options, L3, R3
+		constexpr std::size_t Buttons2 = 9; // PS, touchpad, mute
+		constexpr std::size_t Gyro = 15;    // 3 x int16 LE (pitch, yaw, roll)
+		constexpr std::size_t Accel = 21;   // 3 x int16 LE (x, y, z)
+		constexpr std::size_t SensorTimestamp = 27; // uint32 LE, 1/3 us ticks
+		constexpr std::size_t TouchPoint0 = 32;     // 4 bytes: [active-low bit7 | id], 12-bit X, 12-bit Y
+		constexpr std::size_t TouchPoint1 = 36;
+		constexpr std::size_t Status = 52; // battery level (low nibble), charging state (high nibble)
+
+		constexpr std::uint16_t TouchpadWidth = 1920;
+		constexpr std::uint16_t TouchpadHeight = 1080;
+	} // namespace DualSenseReport
+
+	/**
+	 * @brief CRC-32 (IEEE, reflected) as used by DualSense Bluetooth reports, seeded with one prefix byte
+	 * (0xA1 for input reports, 0xA2 for output reports).
+	 */
+	inline std::uint32_t DualSenseBtCrc32(std::uint8_t Seed, const std::uint8_t* Data, std::size_t Length)
+	{
+		std::uint32_t Crc = 0xFFFFFFFFu;
+		auto Feed = [&Crc](std::uint8_t Byte)
+		{
+			Crc ^= Byte;
+			for (int Bit = 0; Bit < 8; ++Bit)
+			{
+				Crc = (Crc >> 1) ^ (0xEDB88320u & (0u - (Crc & 1u)));
+			}
+		};
+		Feed(Seed);
+		for (std::size_t i = 0; i < Length; ++i)
+		{
+			Feed(Data[i]);
+		}
+		return ~Crc;
+	}
+
+	/**
+	 * @brief Rewrites a basic Bluetooth report (ID 0x01: sticks, buttons, triggers) in place as a full
+	 * 0x31 report without motion or touch, so input works while the read that switches the pad to full
+	 * reports is still in flight.
+	 * @return false when Buffer does not hold a basic report.
+	 */
+	inline bool ExpandBasicBtReport(std::uint8_t* Buffer, std::size_t Length)
+	{
+		if (!Buffer || Length < DualSenseReport::BtReportSize || Buffer[0] != DualSenseReport::UsbReportId)
+		{
+			return false;
+		}
+
+		std::uint8_t Basic[DualSenseReport::BtBasicReportSize];
+		std::memcpy(Basic, Buffer, sizeof(Basic));
+		std::memset(Buffer, 0, DualSenseReport::BtReportSize);
+		Buffer[0] = DualSenseReport::BtReportId;
+		std::uint8_t* Payload = Buffer + DualSenseReport::BtHeaderSize;
+		Payload[DualSenseReport::LeftStickX] = Basic[1];
+		Payload[DualSenseReport::LeftStickY] = Basic[2];
+		Payload[DualSenseReport::RightStickX] = Basic[3];
+		Payload[DualSenseReport::RightStickY] = Basic[4];
+		Payload[DualSenseReport::Buttons0] = Basic[5];
+		Payload[DualSenseReport::Buttons1] = Basic[6];
+		Payload[DualSenseReport::Buttons2] = Basic[7] & 0x03; // the upper six bits are a report counter
+		Payload[DualSenseReport::Sequence] = Basic[7] >> 2;
+		Payload[DualSenseReport::LeftTrigger] = Basic[8];
+		Payload[DualSenseReport::RightTrigger] = Basic[9];
+		Payload[DualSenseReport::TouchPoint0] = 0x80;
+		Payload[DualSenseReport::TouchPoint1] = 0x80;
+
+		const std::uint32_t Crc = DualSenseBtCrc32(0xA1, Buffer, DualSenseReport::BtReportSize - 4);
+		std::memcpy(Buffer + DualSenseReport::BtReportSize - 4, &Crc, sizeof(Crc));
+		return true;
+	}
+
+	/**
+	 * @brief Read-only view over a raw DualSense input report as delivered by the HID read.
+	 */
+	struct FDualSenseReportView
+	{
+		const std::uint8_t* Payload = nullptr;
+
+		/**
+		 * @brief Locates the payload inside a raw buffer; returns an invalid view for other report types.
+		 */
+		static FDualSenseReportView FromBuffer(const std::uint8_t* Buffer, std::size_t Length, bool bBluetooth)
+		{
+			FDualSenseReportView View;
+			const std::size_t Header = bBluetooth ? DualSenseReport::BtHeaderSize : DualSenseReport::UsbHeaderSize;
+			const std::uint8_t ReportId = bBluetooth ? DualSenseReport::BtReportId : DualSenseReport::UsbReportId;
+			if (Buffer && Length >= Header + DualSenseReport::PayloadSize && Buffer[0] == ReportId)
+			{
+				View.Payload = Buffer + Header;
+			}
+			return View;
+		}
+
+		bool IsValid() const { return Payload != nullptr; }
+
+		std::uint8_t Byte(std::size_t Offset) const { return Payload[Offset]; }
+
+		std::int16_t Int16(std::size_t Offset) const
+		{
+			return static_cast<std::int16_t>(static_cast<std::uint16_t>(Payload[Offset] | (Payload[Offset + 1] << 8)));
+		}
+
+		std::uint32_t UInt32(std::size_t Offset) const
+		{
+			return static_cast<std::uint32_t>(Payload[Offset]) |
+			       (static_cast<std::uint32_t>(Payload[Offset + 1]) << 8) |
+			       (static_cast<std::uint32_t>(Payload[Offset + 2]) << 16) |
+			       (static_cast<std::uint32_t>(Payload[Offset + 3]) << 24);
+		}
+
+		std::int16_t GetGyro(std::size_t Axis) const { return Int16(DualSenseReport::Gyro + Axis * 2); }
+		std::int16_t GetAccel(std::size_t Axis) const { return Int16(DualSenseReport::Accel + Axis * 2); }
+		std::uint32_t GetSensorTimestamp() const { return UInt32(DualSenseReport::SensorTimestamp); }
+		std::uint8_t GetSequence() const { return Byte(DualSenseReport::Sequence); }
+		const std::uint8_t* GetTouchPoint(std::size_t Index) const { return Payload + (Index == 0 ? DualSenseReport::TouchPoint0 : DualSenseReport::TouchPoint1); }
+	};
+} // namespace GamepadCore
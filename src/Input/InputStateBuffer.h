@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Single-writer, multi-reader sequence lock for small trivially copyable state.
+	 *
+	 * The input thread publishes each decoded state with Publish(), which never blocks.
+	 * Readers (ViGEm feeder, trigger engine, exported API) take a consistent copy with
+	 * Snapshot(); a reader that races a write simply retries, so no reader ever observes
+	 * a torn state and no lock is taken on either side.
+	 */
+	template<typename T>
+	class TSeqLock
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "TSeqLock requires a trivially copyable payload");
+
+	public:
+		TSeqLock() { std::memset(static_cast<void*>(&Storage), 0, sizeof(Storage)); }
+
+		/**
+		 * @brief Publishes a new value. Must only be called from one thread.
+		 */
+		void Publish(const T& Value)
+		{
+			const std::uint64_t Seq = Sequence.load(std::memory_order_relaxed);
+			Sequence.store(Seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			std::memcpy(&Storage, &Value, sizeof(T));
+
+			Sequence.store(Seq + 2, std::memory_order_release);
+		}
+
+		/**
+		 * @brief Copies the latest published value into Out.
+		 *
+		 * @return The publication counter of the copied value (0 when nothing was published yet).
+		 */
+		std::uint64_t Snapshot(T& Out) const
+		{
+			for (;;)
+			{
+				const std::uint64_t Before = Sequence.load(std::memory_order_acquire);
+				if (Before & 1)
+				{
+					continue;
+				}
+
+				std::memcpy(&Out, &Storage, sizeof(T));
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (Sequence.load(std::memory_order_relaxed) == Before)
+				{
+					return Before / 2;
+				}
+			}
+		}
+
+		/**
+		 * @brief Number of values published so far; cheap way for readers to detect a new frame.
+		 */
+		std::uint64_t GetPublishCount() const
+		{
+			return Sequence.load(std::memory_order_acquire) / 2;
+		}
+
+	private:
+		alignas(64) std::atomic<std::uint64_t> Sequence{0};
+		alignas(64) T Storage;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,403 @@
+#pragma once
+#include "Input/CalibrationCache.h"
+#include "Input/DualSenseReport.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAMEPAD_MOTION_SSE 1
+#endif
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Per-axis IMU calibration in report order: gyro pitch/yaw/roll, then accel X/Y/Z.
+	 *
+	 * A calibrated value is Raw * Scale + Offset, in rad/s for the gyro and g for the accelerometer.
+	 */
+	struct FMotionCalibration
+	{
+		static constexpr std::size_t AxisCount = 6;
+
+		float Scale[AxisCount];
+		float Offset[AxisCount];
+
+		/**
+		 * @brief Nominal DualSense ranges (+-2048 deg/s, +-4 g), used until the feature report is known.
+		 */
+		static FMotionCalibration Nominal()
+		{
+			FMotionCalibration Out;
+			for (std::size_t Axis = 0; Axis < 3; ++Axis)
+			{
+				Out.Scale[Axis] = DegreesToRadians(2048.0f / 32768.0f);
+				Out.Offset[Axis] = 0.0f;
+				Out.Scale[Axis + 3] = 1.0f / 8192.0f;
+				Out.Offset[Axis + 3] = 0.0f;
+			}
+			return Out;
+		}
+
+		/**
+		 * @brief Derives the scales from calibration feature report 0x05 (same math as hid-playstation).
+		 *
+		 * Falls back to Nominal() for a report that fails FCalibrationCache::IsValidReport.
+		 */
+		static FMotionCalibration FromReport(const FCalibrationCache::FReport& Report)
+		{
+			if (!FCalibrationCache::IsValidReport(Report))
+			{
+				return Nominal();
+			}
+
+			using namespace DualSenseCalibrationReport;
+			auto Field = [&Report](std::size_t Offset)
+			{
+				return static_cast<float>(static_cast<std::int16_t>(Report[Offset] | (Report[Offset + 1] << 8)));
+			};
+
+			FMotionCalibration Out;
+			const float SpeedRange = Field(GyroSpeedPlus) + Field(GyroSpeedMinus);
+			const std::size_t Gyro[3][3] = {{GyroPitchBias, GyroPitchPlus, GyroPitchMinus}, {GyroYawBias, GyroYawPlus, GyroYawMinus}, {GyroRollBias, GyroRollPlus, GyroRollMinus}};
+			for (std::size_t Axis = 0; Axis < 3; ++Axis)
+			{
+				const float Bias = Field(Gyro[Axis][0]);
+				const float Span = std::fabs(Field(Gyro[Axis][1]) - Bias) + std::fabs(Field(Gyro[Axis][2]) - Bias);
+				Out.Scale[Axis] = DegreesToRadians(SpeedRange / Span);
+				Out.Offset[Axis] = -Bias * Out.Scale[Axis];
+			}
+
+			const std::size_t Accel[3][2] = {{AccelXPlus, AccelXMinus}, {AccelYPlus, AccelYMinus}, {AccelZPlus, AccelZMinus}};
+			for (std::size_t Axis = 0; Axis < 3; ++Axis)
+			{
+				const float Range = Field(Accel[Axis][0]) - Field(Accel[Axis][1]); // 2 g
+				const float Bias = Field(Accel[Axis][0]) - Range / 2.0f;
+				Out.Scale[Axis + 3] = 2.0f / Range;
+				Out.Offset[Axis + 3] = -Bias * Out.Scale[Axis + 3];
+			}
+			return Out;
+		}
+
+		static constexpr float DegreesToRadians(float Degrees) { return Degrees * 0.017453292519943295f; }
+	};
+
+	/**
+	 * @brief Applies an FMotionCalibration to batches of raw IMU samples (6 x int16 each, report order).
+	 *
+	 * The raw block is copied straight out of the report (payload bytes 15..26), so a batch is a plain
+	 * int16 array. The SSE2 path converts four samples per iteration: 24 values are three 8-lane loads,
+	 * and since 24 is a multiple of the 6-axis period the scale/offset patterns are fixed per lane.
+	 */
+	class FMotionCalibrator
+	{
+	public:
+		static constexpr std::size_t AxisCount = FMotionCalibration::AxisCount;
+		static constexpr std::size_t LanePeriod = 4 * AxisCount;
+
+		FMotionCalibrator() { Compile(FMotionCalibration::Nominal()); }
+
+		void Compile(const FMotionCalibration& Calibration)
+		{
+			for (std::size_t Lane = 0; Lane < LanePeriod; ++Lane)
+			{
+				Scale[Lane] = Calibration.Scale[Lane % AxisCount];
+				Offset[Lane] = Calibration.Offset[Lane % AxisCount];
+			}
+		}
+
+		/**
+		 * @brief Out[i * 6 + Axis] = Raw[i * 6 + Axis] * Scale + Offset for Count samples.
+		 */
+		void CalibrateBatch(const std::int16_t* Raw, std::size_t Count, float* Out) const
+		{
+			std::size_t Sample = 0;
+#ifdef GAMEPAD_MOTION_SSE
+			for (; Sample + 4 <= Count; Sample += 4)
+			{
+				const std::int16_t* Source = Raw + Sample * AxisCount;
+				float* Target = Out + Sample * AxisCount;
+				for (std::size_t Lane = 0; Lane < LanePeriod; Lane += 8)
+				{
+					// Sign-extend 8 x int16 into two 4 x int32 halves, then convert
+					const __m128i Packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Source + Lane));
+					const __m128 Low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(Packed, Packed), 16));
+					const __m128 High = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(Packed, Packed), 16));
+					_mm_storeu_ps(Target + Lane, _mm_add_ps(_mm_mul_ps(Low, _mm_load_ps(Scale + Lane)), _mm_load_ps(Offset + Lane)));
+					_mm_storeu_ps(Target + Lane + 4, _mm_add_ps(_mm_mul_ps(High, _mm_load_ps(Scale + Lane + 4)), _mm_load_ps(Offset + Lane + 4)));
+				}
+			}
+#endif
+			CalibrateScalar(Raw + Sample * AxisCount, Count - Sample, Out + Sample * AxisCount);
+		}
+
+		void CalibrateScalar(const std::int16_t* Raw, std::size_t Count, float* Out) const
+		{
+			for (std::size_t i = 0; i < Count * AxisCount; ++i)
+			{
+				Out[i] = static_cast<float>(Raw[i]) * Scale[i % AxisCount] + Offset[i % AxisCount];
+			}
+		}
+
+	private:
+		alignas(16) float Scale[LanePeriod];
+		alignas(16) float Offset[LanePeriod];
+	};
+
+	/**
+	 * @brief Madgwick gradient-descent orientation filter, IMU variant (gyro + accelerometer).
+	 *
+	 * Works in a Z-up world frame. The quaternion (W, X, Y, Z) rotates body vectors into the world;
+	 * yaw is unobservable without a magnetometer and drifts with the gyro, pitch and roll do not.
+	 */
+	class FMadgwickFilter
+	{
+	public:
+		static constexpr float DefaultBeta = 0.1f;
+
+		explicit FMadgwickFilter(float InBeta = DefaultBeta)
+			: Beta(InBeta)
+		{
+		}
+
+		void Reset()
+		{
+			Q[0] = 1.0f;
+			Q[1] = Q[2] = Q[3] = 0.0f;
+			bInitialized = false;
+		}
+
+		/**
+		 * @brief Starts from the tilt the accelerometer measures instead of converging from identity.
+		 */
+		void InitializeFromAccel(float Ax, float Ay, float Az)
+		{
+			const float Norm = std::sqrt(Ax * Ax + Ay * Ay + Az * Az);
+			if (Norm <= 0.0f)
+			{
+				return;
+			}
+			Ax /= Norm;
+			Ay /= Norm;
+			Az /= Norm;
+
+			// Shortest rotation taking the measured "up" onto world +Z
+			if (Az < -0.9999f)
+			{
+				Q[0] = 0.0f;
+				Q[1] = 1.0f;
+				Q[2] = Q[3] = 0.0f;
+			}
+			else
+			{
+				const float W = 1.0f + Az;
+				const float InvNorm = 1.0f / std::sqrt(W * W + Ay * Ay + Ax * Ax);
+				Q[0] = W * InvNorm;
+				Q[1] = Ay * InvNorm;
+				Q[2] = -Ax * InvNorm;
+				Q[3] = 0.0f;
+			}
+			bInitialized = true;
+		}
+
+		/**
+		 * @brief One filter step. Gyro in rad/s, accel in any unit (only its direction is used).
+		 *
+		 * The accelerometer correction is skipped when the measured magnitude is far from 1 g, i.e.
+		 * while the controller is being shaken and the vector no longer points up.
+		 */
+		void Update(float Gx, float Gy, float Gz, float Ax, float Ay, float Az, float DeltaSeconds)
+		{
+			if (!bInitialized)
+			{
+				InitializeFromAccel(Ax, Ay, Az);
+			}
+
+			float Q0 = Q[0], Q1 = Q[1], Q2 = Q[2], Q3 = Q[3];
+			float Dot0 = 0.5f * (-Q1 * Gx - Q2 * Gy - Q3 * Gz);
+			float Dot1 = 0.5f * (Q0 * Gx + Q2 * Gz - Q3 * Gy);
+			float Dot2 = 0.5f * (Q0 * Gy - Q1 * Gz + Q3 * Gx);
+			float Dot3 = 0.5f * (Q0 * Gz + Q1 * Gy - Q2 * Gx);
+
+			const float AccelNormSquared = Ax * Ax + Ay * Ay + Az * Az;
+			if (AccelNormSquared > MinAccelSquared && AccelNormSquared < MaxAccelSquared)
+			{
+				const float InvAccel = 1.0f / std::sqrt(AccelNormSquared);
+				Ax *= InvAccel;
+				Ay *= InvAccel;
+				Az *= InvAccel;
+
+				// Gradient J^T * f of the gravity objective function (Madgwick 2010, eq. 25-26)
+				const float Q0Q0 = Q0 * Q0, Q1Q1 = Q1 * Q1, Q2Q2 = Q2 * Q2, Q3Q3 = Q3 * Q3;
+				float S0 = 4.0f * Q0 * Q2Q2 + 2.0f * Q2 * Ax + 4.0f * Q0 * Q1Q1 - 2.0f * Q1 * Ay;
+				float S1 = 4.0f * Q1 * Q3Q3 - 2.0f * Q3 * Ax + 4.0f * Q0Q0 * Q1 - 2.0f * Q0 * Ay - 4.0f * Q1 + 8.0f * Q1 * Q1Q1 + 8.0f * Q1 * Q2Q2 + 4.0f * Q1 * Az;
+				float S2 = 4.0f * Q0Q0 * Q2 + 2.0f * Q0 * Ax + 4.0f * Q2 * Q3Q3 - 2.0f * Q3 * Ay - 4.0f * Q2 + 8.0f * Q2 * Q1Q1 + 8.0f * Q2 * Q2Q2 + 4.0f * Q2 * Az;
+				float S3 = 4.0f * Q1Q1 * Q3 - 2.0f * Q1 * Ax + 4.0f * Q2Q2 * Q3 - 2.0f * Q2 * Ay;
+				const float GradientNorm = std::sqrt(S0 * S0 + S1 * S1 + S2 * S2 + S3 * S3);
+				if (GradientNorm > 0.0f)
+				{
+					const float Step = Beta / GradientNorm;
+					Dot0 -= Step * S0;
+					Dot1 -= Step * S1;
+					Dot2 -= Step * S2;
+					Dot3 -= Step * S3;
+				}
+			}
+
+			Q0 += Dot0 * DeltaSeconds;
+			Q1 += Dot1 * DeltaSeconds;
+			Q2 += Dot2 * DeltaSeconds;
+			Q3 += Dot3 * DeltaSeconds;
+			const float InvNorm = 1.0f / std::sqrt(Q0 * Q0 + Q1 * Q1 + Q2 * Q2 + Q3 * Q3);
+			Q[0] = Q0 * InvNorm;
+			Q[1] = Q1 * InvNorm;
+			Q[2] = Q2 * InvNorm;
+			Q[3] = Q3 * InvNorm;
+		}
+
+		const float* GetQuaternion() const { return Q; }
+		void SetBeta(float InBeta) { Beta = InBeta; }
+
+	private:
+		static constexpr float MinAccelSquared = 0.5f * 0.5f;
+		static constexpr float MaxAccelSquared = 1.5f * 1.5f;
+
+		float Beta;
+		float Q[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+		bool bInitialized = false;
+	};
+
+	/**
+	 * @brief Latest motion output, published by the input thread next to the input state.
+	 *
+	 * Orientation is in a Z-up world frame with Y pointing away from the player. AngularVelocity and
+	 * Acceleration are the calibrated device-frame samples (rad/s, g). Pitch is the nose-up angle and
+	 * Roll is positive with the right side down, both in radians and derived from the orientation.
+	 */
+	struct FMotionState
+	{
+		float Orientation[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+		float AngularVelocity[3] = {};
+		float Acceleration[3] = {};
+		float Pitch = 0.0f;
+		float Roll = 0.0f;
+		std::uint32_t SensorTimestamp = 0;
+		std::uint64_t SampleCount = 0;
+	};
+
+	/**
+	 * @brief Calibration + fusion for the DualSense IMU, fed with raw reports at the full report rate.
+	 *
+	 * Device axes are X right, Y up, Z toward the player; they are mapped into the filter's Z-up
+	 * frame here. The step length comes from the sensor timestamp (1/3 us ticks), so a report the
+	 * service read late still integrates over the right interval, and a report read twice (the USB
+	 * poll can see the same buffer again) is dropped.
+	 */
+	class FMotionStage
+	{
+	public:
+		static constexpr std::size_t MaxBatch = 64;
+		static constexpr float TicksPerSecond = 3000000.0f;
+		static constexpr float MaxStepSeconds = 0.02f; // gaps longer than this are not integrated
+
+		explicit FMotionStage(float Beta = FMadgwickFilter::DefaultBeta)
+			: Filter(Beta)
+		{
+		}
+
+		void SetCalibration(const FMotionCalibration& Calibration) { Calibrator.Compile(Calibration); }
+
+		void Reset()
+		{
+			Filter.Reset();
+			State = FMotionState();
+			bHasTimestamp = false;
+		}
+
+		/**
+		 * @brief Calibrates and fuses Count samples (6 raw int16 each, report order).
+		 *
+		 * @return Number of samples integrated (duplicates are skipped).
+		 */
+		std::size_t ProcessBatch(const std::int16_t* RawImu, const std::uint32_t* Timestamps, std::size_t Count)
+		{
+			alignas(16) float Calibrated[MaxBatch * FMotionCalibration::AxisCount];
+			std::size_t Integrated = 0;
+			for (std::size_t First = 0; First < Count; First += MaxBatch)
+			{
+				const std::size_t BatchSize = std::min(MaxBatch, Count - First);
+				Calibrator.CalibrateBatch(RawImu + First * FMotionCalibration::AxisCount, BatchSize, Calibrated);
+				for (std::size_t i = 0; i < BatchSize; ++i)
+				{
+					Integrated += Integrate(Calibrated + i * FMotionCalibration::AxisCount, Timestamps[First + i]) ? 1 : 0;
+				}
+			}
+			if (Integrated > 0)
+			{
+				UpdateAngles();
+			}
+			return Integrated;
+		}
+
+		/**
+		 * @brief Single-report convenience for the input thread; true when the sample was new.
+		 */
+		bool Process(const FDualSenseReportView& Report)
+		{
+			std::int16_t Raw[FMotionCalibration::AxisCount];
+			std::memcpy(Raw, Report.Payload + DualSenseReport::Gyro, sizeof(Raw)); // gyro and accel are contiguous, LE
+			const std::uint32_t Timestamp = Report.GetSensorTimestamp();
+			return ProcessBatch(Raw, &Timestamp, 1) == 1;
+		}
+
+		const FMotionState& GetState() const { return State; }
+
+	private:
+		bool Integrate(const float* Sample, std::uint32_t Timestamp)
+		{
+			float DeltaSeconds = 0.0f;
+			if (bHasTimestamp)
+			{
+				const std::uint32_t Ticks = Timestamp - LastTimestamp; // wraps every ~23 min
+				if (Ticks == 0)
+				{
+					return false;
+				}
+				DeltaSeconds = std::min(static_cast<float>(Ticks) / TicksPerSecond, MaxStepSeconds);
+			}
+			bHasTimestamp = true;
+			LastTimestamp = Timestamp;
+
+			// Device (X right, Y up, Z toward player) -> filter (X right, Y forward, Z up)
+			Filter.Update(Sample[0], -Sample[2], Sample[1], Sample[3], -Sample[5], Sample[4], DeltaSeconds);
+
+			std::memcpy(State.AngularVelocity, Sample, sizeof(State.AngularVelocity));
+			std::memcpy(State.Acceleration, Sample + 3, sizeof(State.Acceleration));
+			State.SensorTimestamp = Timestamp;
+			++State.SampleCount;
+			return true;
+		}
+
+		void UpdateAngles()
+		{
+			const float* Q = Filter.GetQuaternion();
+			std::memcpy(State.Orientation, Q, sizeof(State.Orientation));
+
+			// World up seen from the body frame
+			const float UpX = 2.0f * (Q[1] * Q[3] - Q[0] * Q[2]);
+			const float UpY = 2.0f * (Q[0] * Q[1] + Q[2] * Q[3]);
+			const float UpZ = Q[0] * Q[0] - Q[1] * Q[1] - Q[2] * Q[2] + Q[3] * Q[3];
+			State.Pitch = std::asin(std::clamp(UpY, -1.0f, 1.0f));
+			State.Roll = std::atan2(-UpX, UpZ);
+		}
+
+		FMotionCalibrator Calibrator;
+		FMadgwickFilter Filter;
+		FMotionState State;
+		std::uint32_t LastTimestamp = 0;
+		bool bHasTimestamp = false;
+	};
+} // namespace GamepadCore
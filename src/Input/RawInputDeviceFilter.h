@@ -0,0 +1,164 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Fixed-size handle -> vendor ID cache used by the raw input device list detour.
+	 *
+	 * Lookups go through an injected function (GetRawInputDeviceInfo on Windows, a synthetic table in
+	 * tests), so the filter can run anywhere. The cache never allocates: it is a flat open-addressing
+	 * table that is cleared whenever the device set changes (a device arrived or was removed). Once it
+	 * is full, devices beyond Capacity - 1 are looked up on every call instead of evicting the others.
+	 */
+	class FRawInputVendorCache
+	{
+	public:
+		using FVendorLookup = bool (*)(void* Handle, std::uint32_t& OutVendorId);
+
+		static constexpr std::size_t Capacity = 4096;
+
+		explicit FRawInputVendorCache(FVendorLookup InLookup)
+		    : Lookup(InLookup)
+		{
+			Clear();
+		}
+
+		/**
+		 * @brief Drops every cached entry if the device set differs from the one seen last time.
+		 *
+		 * Raw input hands out a new handle for every arrival, so a changed handle set is exactly an
+		 * arrival or removal.
+		 */
+		void SyncDeviceSet(std::uint64_t Signature)
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			if (Signature != DeviceSetSignature)
+			{
+				DeviceSetSignature = Signature;
+				Clear();
+			}
+		}
+
+		void Invalidate()
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Clear();
+		}
+
+		/**
+		 * @brief Returns the vendor ID of Handle, querying the lookup function only on a cache miss.
+		 *
+		 * Failed lookups are not cached, so a device that is still initializing gets queried again.
+		 */
+		bool GetVendorId(void* Handle, std::uint32_t& OutVendorId)
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+
+			std::size_t Slot = Hash(Handle);
+			for (std::size_t Probe = 0; Probe < Capacity; ++Probe, Slot = (Slot + 1) & (Capacity - 1))
+			{
+				if (Entries[Slot].Handle == Handle)
+				{
+					OutVendorId = Entries[Slot].VendorId;
+					return true;
+				}
+
+				if (Entries[Slot].Handle == nullptr)
+				{
+					if (!Lookup || !Lookup(Handle, OutVendorId))
+					{
+						return false;
+					}
+
+					if (Used == Capacity - 1)
+					{
+						return true;
+					}
+					Entries[Slot] = {Handle, OutVendorId};
+					++Used;
+					return true;
+				}
+			}
+			return Lookup && Lookup(Handle, OutVendorId);
+		}
+
+		static std::uint64_t MixHandle(const void* Handle)
+		{
+			std::uint64_t Value = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(Handle));
+			Value ^= Value >> 33;
+			Value *= 0xff51afd7ed558ccdULL;
+			Value ^= Value >> 33;
+			return Value;
+		}
+
+	private:
+		struct FEntry
+		{
+			void* Handle;
+			std::uint32_t VendorId;
+		};
+
+		static std::size_t Hash(const void* Handle)
+		{
+			return static_cast<std::size_t>(MixHandle(Handle)) & (Capacity - 1);
+		}
+
+		void Clear()
+		{
+			for (FEntry& Entry : Entries)
+			{
+				Entry = {nullptr, 0};
+			}
+			Used = 0;
+		}
+
+		FVendorLookup Lookup = nullptr;
+		std::mutex Mutex;
+		FEntry Entries[Capacity];
+		std::size_t Used = 0;
+		std::uint64_t DeviceSetSignature = 0;
+	};
+
+	/**
+	 * @brief Removes HID devices of BlockedVendorId from a raw input device list, in place.
+	 *
+	 * The relative order of the remaining devices is preserved and no memory is allocated.
+	 * TDevice must expose hDevice and dwType like RAWINPUTDEVICELIST.
+	 *
+	 * @return Number of devices left at the front of the buffer.
+	 */
+	template<typename TDevice>
+	std::uint32_t FilterRawInputDevices(TDevice* Devices, std::uint32_t Count, std::uint32_t HidType, std::uint32_t BlockedVendorId, FRawInputVendorCache& Cache)
+	{
+		std::uint64_t Signature = Count;
+		for (std::uint32_t i = 0; i < Count; ++i)
+		{
+			Signature ^= FRawInputVendorCache::MixHandle(Devices[i].hDevice);
+		}
+		Cache.SyncDeviceSet(Signature);
+
+		std::uint32_t Kept = 0;
+		for (std::uint32_t i = 0; i < Count; ++i)
+		{
+			bool bIsBlocked = false;
+			if (Devices[i].dwType == HidType)
+			{
+				std::uint32_t VendorId = 0;
+				bIsBlocked = Cache.GetVendorId(Devices[i].hDevice, VendorId) && VendorId == BlockedVendorId;
+			}
+
+			if (!bIsBlocked)
+			{
+				if (Kept != i)
+				{
+					Devices[Kept] = Devices[i];
+				}
+				++Kept;
+			}
+		}
+		return Kept;
+	}
+} // namespace GamepadCore
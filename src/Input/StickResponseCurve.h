@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAMEPAD_STICK_CURVE_SSE 1
+#endif
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Radial stick shaping parameters. The defaults are the identity (raw linear stick).
+	 *
+	 * InnerDeadzone and OuterDeadzone are radii in stick units (0..1). AntiDeadzone is the output
+	 * radius produced right outside the inner deadzone, to cancel a game's own deadzone. Exponent
+	 * shapes the response between the two deadzones (1 = linear, >1 = finer control near center).
+	 */
+	struct FStickCurveConfig
+	{
+		float InnerDeadzone = 0.0f;
+		float OuterDeadzone = 1.0f;
+		float AntiDeadzone = 0.0f;
+		float Exponent = 1.0f;
+
+		constexpr bool IsIdentity() const
+		{
+			return InnerDeadzone == 0.0f && OuterDeadzone == 1.0f && AntiDeadzone == 0.0f && Exponent == 1.0f;
+		}
+	};
+
+	/**
+	 * @brief A stick response curve compiled into a radius -> output radius lookup table.
+	 *
+	 * The pow() work happens once in Compile(). At run time a stick vector is scaled by the
+	 * interpolated output radius over its radius, which keeps the direction intact (radial
+	 * processing). The table holds the output radius rather than the gain because the gain of an
+	 * anti-deadzone (Anti / radius) is far from linear between entries, while the output radius is
+	 * smooth everywhere except at the inner deadzone edge. The table covers radii up to sqrt(2) so
+	 * square-gate corners are handled too.
+	 */
+	class FStickResponseCurve
+	{
+	public:
+		static constexpr std::size_t TableSize = 1024;
+		static constexpr float MaxRadius = 1.41421356f;
+
+		FStickResponseCurve() { Compile(FStickCurveConfig{}); }
+		explicit FStickResponseCurve(const FStickCurveConfig& Config) { Compile(Config); }
+
+		void Compile(const FStickCurveConfig& InConfig)
+		{
+			Config = InConfig;
+			bIdentity = Config.IsIdentity();
+
+			const float Inner = std::clamp(Config.InnerDeadzone, 0.0f, 0.99f);
+			const float Outer = std::clamp(Config.OuterDeadzone, Inner + 0.01f, MaxRadius);
+			const float Anti = std::clamp(Config.AntiDeadzone, 0.0f, 1.0f);
+
+			// Entry 0 is always 0. With an anti-deadzone the curve jumps to Anti at the inner edge (at the
+			// origin when there is no inner deadzone); the jump is spread over the one cell that contains it.
+			for (std::size_t i = 0; i < TableSize; ++i)
+			{
+				const float Radius = MaxRadius * static_cast<float>(i) / static_cast<float>(TableSize - 1);
+				Response[i] = EvaluateRadius(Radius, Inner, Outer, Anti, Config.Exponent);
+			}
+			TableScale = static_cast<float>(TableSize - 1) / MaxRadius;
+		}
+
+		/**
+		 * @brief Reference evaluation of the output radius (slow path, used to build the table).
+		 */
+		static float EvaluateRadius(float Radius, float Inner, float Outer, float Anti, float Exponent)
+		{
+			if (Radius <= Inner)
+			{
+				return 0.0f;
+			}
+			const float T = std::min((Radius - Inner) / (Outer - Inner), 1.0f);
+			return Anti + (1.0f - Anti) * std::pow(T, Exponent);
+		}
+
+		const FStickCurveConfig& GetConfig() const { return Config; }
+		bool IsIdentity() const { return bIdentity; }
+
+		/**
+		 * @brief Output radius for a given radius, linearly interpolated from the table.
+		 */
+		float LookupRadius(float Radius) const
+		{
+			const float Position = std::min(Radius * TableScale, static_cast<float>(TableSize - 1));
+			const std::size_t Index = std::min(static_cast<std::size_t>(Position), TableSize - 2);
+			const float Frac = Position - static_cast<float>(Index);
+			return Response[Index] + Frac * (Response[Index + 1] - Response[Index]);
+		}
+
+		/**
+		 * @brief Factor a stick vector of the given radius is scaled by (0 at the origin).
+		 */
+		float LookupGain(float Radius) const { return Radius > 0.0f ? LookupRadius(Radius) / Radius : 0.0f; }
+
+		void Apply(float& X, float& Y) const
+		{
+			if (bIdentity)
+			{
+				return;
+			}
+			const float Scale = LookupGain(std::sqrt(X * X + Y * Y));
+			X *= Scale;
+			Y *= Scale;
+		}
+
+	private:
+		FStickCurveConfig Config;
+		bool bIdentity = true;
+		float TableScale = 1.0f;
+		std::array<float, TableSize> Response{};
+	};
+
+	/**
+	 * @brief Shapes both sticks of one report. Magnitudes are computed for the two sticks at once.
+	 */
+	inline void ApplyStickCurves(const FStickResponseCurve& LeftCurve, const FStickResponseCurve& RightCurve, float& LeftX, float& LeftY, float& RightX, float& RightY)
+	{
+		if (LeftCurve.IsIdentity() && RightCurve.IsIdentity())
+		{
+			return;
+		}
+
+#ifdef GAMEPAD_STICK_CURVE_SSE
+		// [LX, LY, RX, RY] -> squared -> [LX²+LY², -, RX²+RY², -] -> sqrt
+		const __m128 Sticks = _mm_setr_ps(LeftX, LeftY, RightX, RightY);
+		const __m128 Squared = _mm_mul_ps(Sticks, Sticks);
+		const __m128 Sums = _mm_add_ps(Squared, _mm_shuffle_ps(Squared, Squared, _MM_SHUFFLE(2, 3, 0, 1)));
+		const __m128 Radii = _mm_sqrt_ps(Sums);
+		alignas(16) float RadiusLanes[4];
+		_mm_store_ps(RadiusLanes, Radii);
+
+		// Identity sides map a radius to itself; one division gives both gains (0 / FLT_MIN = 0 at the origin)
+		const float LeftOut = LeftCurve.IsIdentity() ? RadiusLanes[0] : LeftCurve.LookupRadius(RadiusLanes[0]);
+		const float RightOut = RightCurve.IsIdentity() ? RadiusLanes[2] : RightCurve.LookupRadius(RadiusLanes[2]);
+		const __m128 Gains = _mm_div_ps(_mm_setr_ps(LeftOut, LeftOut, RightOut, RightOut), _mm_max_ps(_mm_shuffle_ps(Radii, Radii, _MM_SHUFFLE(2, 2, 0, 0)), _mm_set1_ps(1.17549435e-38f)));
+
+		alignas(16) float Shaped[4];
+		_mm_store_ps(Shaped, _mm_mul_ps(Sticks, Gains));
+		LeftX = Shaped[0];
+		LeftY = Shaped[1];
+		RightX = Shaped[2];
+		RightY = Shaped[3];
+#else
+		LeftCurve.Apply(LeftX, LeftY);
+		RightCurve.Apply(RightX, RightY);
+#endif
+	}
+} // namespace GamepadCore
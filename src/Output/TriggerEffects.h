@@ -0,0 +1,548 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GamepadCore
+{
+	enum class ETriggerSide : std::uint8_t
+	{
+		Left,
+		Right
+	};
+
+	/**
+	 * @brief Values a trigger program can read. Angles in radians, trigger travel 0..1.
+	 *
+	 * Pitch/Roll are the controller's; the Board* inputs come from game telemetry (ETelemetryType::BoardState).
+	 */
+	enum class ETriggerInput : std::uint8_t
+	{
+		Time,     // seconds since the effect started
+		Envelope, // the effect's keyframe curve at Time
+		Pitch,
+		Roll,
+		LeftTrigger,
+		RightTrigger,
+		BoardPitch,
+		BoardRoll,
+		BoardSpeed,     // m/s
+		TruckTightness, // 0..1
+		Count
+	};
+
+	struct FTriggerKeyframe
+	{
+		float Time;  // seconds
+		float Value; // 0..1
+	};
+
+	/**
+	 * @brief Piecewise-linear keyframe curve, optionally looping.
+	 *
+	 * Evaluation keeps a cursor on the current segment: effect time only moves forward (or wraps when
+	 * looping), so a tick advances the cursor by at most a key or two instead of searching.
+	 */
+	struct FTriggerCurve
+	{
+		static constexpr std::size_t MaxKeys = 8;
+
+		FTriggerKeyframe Keys[MaxKeys] = {};
+		std::uint8_t KeyCount = 0;
+		bool bLoop = false;
+
+		/** Appends a key; times must be increasing, keys past MaxKeys are ignored. */
+		FTriggerCurve& Add(float Time, float Value)
+		{
+			if (KeyCount < MaxKeys)
+			{
+				Keys[KeyCount++] = {Time, Value};
+			}
+			return *this;
+		}
+
+		FTriggerCurve& Loop()
+		{
+			bLoop = true;
+			return *this;
+		}
+
+		float GetLength() const { return KeyCount > 0 ? Keys[KeyCount - 1].Time : 0.0f; }
+
+		float Evaluate(float Time, std::uint8_t& Cursor) const
+		{
+			if (KeyCount == 0)
+			{
+				return 0.0f;
+			}
+			const float Length = GetLength();
+			if (bLoop && Length > 0.0f)
+			{
+				Time = std::fmod(Time, Length);
+			}
+			if (Cursor >= KeyCount || Time < Keys[Cursor].Time)
+			{
+				Cursor = 0; // wrapped, or a fresh cursor
+			}
+			while (Cursor + 1 < KeyCount && Time >= Keys[Cursor + 1].Time)
+			{
+				++Cursor;
+			}
+
+			const FTriggerKeyframe& A = Keys[Cursor];
+			if (Cursor + 1 == KeyCount || Time <= A.Time)
+			{
+				return A.Value;
+			}
+			const FTriggerKeyframe& B = Keys[Cursor + 1];
+			return A.Value + (B.Value - A.Value) * (Time - A.Time) / (B.Time - A.Time);
+		}
+	};
+
+	enum class ETriggerOp : std::uint8_t
+	{
+		Const,   // push Operand
+		Input,   // push input Index (ETriggerInput)
+		Add,
+		Sub,
+		Mul,
+		Min,
+		Max,
+		Abs,
+		Clamp01,
+		Decay,   // x -> exp(-x * Operand)
+		Pulse,   // x -> 1 while frac(x / Operand) < Index / 255, else 0
+		Step     // x -> x >= Operand ? 1 : 0
+	};
+
+	struct FTriggerInstruction
+	{
+		ETriggerOp Op;
+		std::uint8_t Index;
+		float Operand;
+	};
+
+	/**
+	 * @brief Compact stack bytecode computing one effect's strength from its inputs.
+	 *
+	 * Programs are checked while they are built (stack depth never under- or overflows, one value
+	 * left at the end), so Evaluate() runs without checks. An empty program yields the envelope.
+	 */
+	class FTriggerProgram
+	{
+	public:
+		static constexpr std::size_t MaxInstructions = 16;
+		static constexpr std::size_t MaxStack = 8;
+
+		FTriggerProgram& Emit(ETriggerOp Op, float Operand = 0.0f, std::uint8_t Index = 0)
+		{
+			int Pops = 0, Pushes = 1;
+			switch (Op)
+			{
+				case ETriggerOp::Const:
+				case ETriggerOp::Input:
+					break;
+				case ETriggerOp::Add:
+				case ETriggerOp::Sub:
+				case ETriggerOp::Mul:
+				case ETriggerOp::Min:
+				case ETriggerOp::Max:
+					Pops = 2;
+					break;
+				default:
+					Pops = 1;
+					break;
+			}
+			if (Count == MaxInstructions || Depth < Pops || Depth - Pops + Pushes > static_cast<int>(MaxStack) ||
+			    (Op == ETriggerOp::Input && Index >= static_cast<std::uint8_t>(ETriggerInput::Count)) ||
+			    (Op == ETriggerOp::Pulse && Operand <= 0.0f))
+			{
+				bValid = false;
+				return *this;
+			}
+			Instructions[Count++] = {Op, Index, Operand};
+			Depth += Pushes - Pops;
+			return *this;
+		}
+
+		FTriggerProgram& Push(float Value) { return Emit(ETriggerOp::Const, Value); }
+		FTriggerProgram& Load(ETriggerInput Input) { return Emit(ETriggerOp::Input, 0.0f, static_cast<std::uint8_t>(Input)); }
+
+		bool IsEmpty() const { return Count == 0; }
+		bool IsValid() const { return Count == 0 || (bValid && Depth == 1); }
+
+		float Evaluate(const float* Inputs) const
+		{
+			if (Count == 0)
+			{
+				return Inputs[static_cast<std::size_t>(ETriggerInput::Envelope)];
+			}
+
+			float Stack[MaxStack];
+			std::size_t Top = 0;
+			for (std::size_t i = 0; i < Count; ++i)
+			{
+				const FTriggerInstruction& I = Instructions[i];
+				switch (I.Op)
+				{
+					case ETriggerOp::Const: Stack[Top++] = I.Operand; break;
+					case ETriggerOp::Input: Stack[Top++] = Inputs[I.Index]; break;
+					case ETriggerOp::Add: --Top; Stack[Top - 1] += Stack[Top]; break;
+					case ETriggerOp::Sub: --Top; Stack[Top - 1] -= Stack[Top]; break;
+					case ETriggerOp::Mul: --Top; Stack[Top - 1] *= Stack[Top]; break;
+					case ETriggerOp::Min: --Top; Stack[Top - 1] = std::min(Stack[Top - 1], Stack[Top]); break;
+					case ETriggerOp::Max: --Top; Stack[Top - 1] = std::max(Stack[Top - 1], Stack[Top]); break;
+					case ETriggerOp::Abs: Stack[Top - 1] = std::fabs(Stack[Top - 1]); break;
+					case ETriggerOp::Clamp01: Stack[Top - 1] = std::clamp(Stack[Top - 1], 0.0f, 1.0f); break;
+					case ETriggerOp::Decay: Stack[Top - 1] = std::exp(-Stack[Top - 1] * I.Operand); break;
+					case ETriggerOp::Pulse:
+					{
+						const float Cycles = Stack[Top - 1] / I.Operand;
+						Stack[Top - 1] = Cycles - std::floor(Cycles) < static_cast<float>(I.Index) / 255.0f ? 1.0f : 0.0f;
+						break;
+					}
+					case ETriggerOp::Step: Stack[Top - 1] = Stack[Top - 1] >= I.Operand ? 1.0f : 0.0f; break;
+				}
+			}
+			return Stack[0];
+		}
+
+	private:
+		FTriggerInstruction Instructions[MaxInstructions] = {};
+		std::uint8_t Count = 0;
+		int Depth = 0;
+		bool bValid = true;
+	};
+
+	/**
+	 * @brief One trigger effect: a keyframe envelope, optionally reshaped by a program.
+	 */
+	struct FTriggerEffect
+	{
+		ETriggerSide Side = ETriggerSide::Right;
+		float StartPosition = 0.0f; // where along the travel the resistance begins, 0..1
+		FTriggerCurve Envelope;
+		FTriggerProgram Program;
+		float Duration = 0.0f; // seconds; <= 0 plays until stopped
+	};
+
+	/**
+	 * @brief Ready-made effects built from curves and programs.
+	 */
+	namespace TriggerEffects
+	{
+		inline FTriggerEffect Constant(ETriggerSide Side, float StartPosition, float Strength)
+		{
+			FTriggerEffect Effect;
+			Effect.Side = Side;
+			Effect.StartPosition = StartPosition;
+			Effect.Envelope.Add(0.0f, Strength);
+			return Effect;
+		}
+
+		/** Strength goes From -> To over Seconds, then holds. */
+		inline FTriggerEffect Ramp(ETriggerSide Side, float From, float To, float Seconds)
+		{
+			FTriggerEffect Effect;
+			Effect.Side = Side;
+			Effect.Envelope.Add(0.0f, From).Add(Seconds, To);
+			return Effect;
+		}
+
+		/** Square pulses of Strength, Period seconds apart, on for Duty (0..1) of each period. */
+		inline FTriggerEffect Pulse(ETriggerSide Side, float Strength, float Period, float Duty, float Duration = 0.0f)
+		{
+			FTriggerEffect Effect;
+			Effect.Side = Side;
+			Effect.Duration = Duration;
+			Effect.Envelope.Add(0.0f, Strength);
+			Effect.Program.Load(ETriggerInput::Time)
+			    .Emit(ETriggerOp::Pulse, Period, static_cast<std::uint8_t>(std::clamp(Duty, 0.0f, 1.0f) * 255.0f))
+			    .Load(ETriggerInput::Envelope)
+			    .Emit(ETriggerOp::Mul);
+			return Effect;
+		}
+
+		/** A hit: Peak at once, decaying exponentially with time constant Seconds; ends after 4 of them. */
+		inline FTriggerEffect ImpactKick(ETriggerSide Side, float Peak, float Seconds)
+		{
+			FTriggerEffect Effect;
+			Effect.Side = Side;
+			Effect.Duration = 4.0f * Seconds;
+			Effect.Program.Load(ETriggerInput::Time).Emit(ETriggerOp::Decay, 1.0f / Seconds).Push(Peak).Emit(ETriggerOp::Mul);
+			return Effect;
+		}
+
+		/** Base strength plus Gain per radian of controller pitch (either direction). */
+		inline FTriggerEffect Inclination(ETriggerSide Side, float Base, float Gain)
+		{
+			FTriggerEffect Effect;
+			Effect.Side = Side;
+			Effect.Program.Load(ETriggerInput::Pitch)
+			    .Emit(ETriggerOp::Abs)
+			    .Push(Gain)
+			    .Emit(ETriggerOp::Mul)
+			    .Push(Base)
+			    .Emit(ETriggerOp::Add)
+			    .Emit(ETriggerOp::Clamp01);
+			return Effect;
+		}
+
+		/** Turning resistance: Base plus Gain per radian of board lean, scaled by 0.5..1.5 with truck tightness. */
+		inline FTriggerEffect BoardLean(ETriggerSide Side, float Base, float Gain)
+		{
+			FTriggerEffect Effect;
+			Effect.Side = Side;
+			Effect.Program.Load(ETriggerInput::BoardRoll)
+			    .Emit(ETriggerOp::Abs)
+			    .Load(ETriggerInput::TruckTightness)
+			    .Push(0.5f)
+			    .Emit(ETriggerOp::Add)
+			    .Emit(ETriggerOp::Mul)
+			    .Push(Gain)
+			    .Emit(ETriggerOp::Mul)
+			    .Push(Base)
+			    .Emit(ETriggerOp::Add)
+			    .Emit(ETriggerOp::Clamp01);
+			return Effect;
+		}
+	} // namespace TriggerEffects
+
+	/**
+	 * @brief Per-tick inputs of the effect engine (input thread state).
+	 */
+	struct FTriggerEffectInputs
+	{
+		float Pitch = 0.0f;
+		float Roll = 0.0f;
+		float LeftTrigger = 0.0f;
+		float RightTrigger = 0.0f;
+		float BoardPitch = 0.0f;
+		float BoardRoll = 0.0f;
+		float BoardSpeed = 0.0f;
+		float TruckTightness = 0.0f;
+	};
+
+	/**
+	 * @brief Quantized state of one trigger, i.e. what actually reaches the controller.
+	 *
+	 * The DualSense resolves resistance in 10 start zones and 8 strength levels; Level 0 is off.
+	 */
+	struct FTriggerEffectBytes
+	{
+		static constexpr std::uint8_t MaxZone = 9;
+		static constexpr std::uint8_t MaxLevel = 8;
+
+		std::uint8_t Zone = 0;
+		std::uint8_t Level = 0;
+
+		bool IsOff() const { return Level == 0; }
+		bool operator==(const FTriggerEffectBytes& Other) const { return Zone == Other.Zone && Level == Other.Level; }
+		bool operator!=(const FTriggerEffectBytes& Other) const { return !(*this == Other); }
+	};
+
+	/**
+	 * @brief Where the engine writes changed trigger states (the gamepad, or a test recorder).
+	 */
+	class ITriggerEffectSink
+	{
+	public:
+		virtual ~ITriggerEffectSink() = default;
+		virtual void WriteTrigger(ETriggerSide Side, const FTriggerEffectBytes& Bytes) = 0;
+	};
+
+	struct FTriggerEffectHandle
+	{
+		std::uint32_t Slot = ~0u;
+		std::uint32_t Generation = 0;
+
+		bool IsValid() const { return Slot != ~0u; }
+	};
+
+	/**
+	 * @brief Evaluates the playing trigger effects and writes a trigger only when its quantized state changes.
+	 *
+	 * Per side the strongest effect wins (its strength and start position). Each effect costs O(1) per
+	 * tick: a cursor step on its curve and at most FTriggerProgram::MaxInstructions instructions. Slots
+	 * are preallocated, so Play/Stop/Tick never allocate. Quantization has a little hysteresis, so a
+	 * value hovering on a level boundary (tilt noise) does not toggle the trigger every report.
+	 * Single-threaded: the input thread owns the engine.
+	 */
+	class FTriggerEffectEngine
+	{
+	public:
+		static constexpr std::size_t DefaultCapacity = 512;
+		static constexpr float Hysteresis = 0.15f; // in levels / zones, beyond the half-step rounding
+
+		explicit FTriggerEffectEngine(std::size_t Capacity = DefaultCapacity)
+			: Slots(Capacity)
+		{
+			Active.reserve(Capacity);
+			FreeSlots.reserve(Capacity);
+			for (std::size_t i = Capacity; i > 0; --i)
+			{
+				FreeSlots.push_back(static_cast<std::uint32_t>(i - 1));
+			}
+		}
+
+		/**
+		 * @brief Starts Effect at NowNs (service clock). Returns an invalid handle when the program is
+		 * malformed or every slot is in use.
+		 */
+		FTriggerEffectHandle Play(const FTriggerEffect& Effect, std::int64_t NowNs)
+		{
+			if (!Effect.Program.IsValid() || FreeSlots.empty())
+			{
+				return {};
+			}
+			const std::uint32_t Index = FreeSlots.back();
+			FreeSlots.pop_back();
+
+			FSlot& Slot = Slots[Index];
+			Slot.Effect = Effect;
+			Slot.StartNs = NowNs;
+			Slot.Cursor = 0;
+			Slot.ActiveIndex = static_cast<std::uint32_t>(Active.size());
+			Slot.bActive = true;
+			Active.push_back(Index);
+			return {Index, Slot.Generation};
+		}
+
+		bool Stop(FTriggerEffectHandle Handle)
+		{
+			if (!IsPlaying(Handle))
+			{
+				return false;
+			}
+			Release(Handle.Slot);
+			return true;
+		}
+
+		void StopAll()
+		{
+			while (!Active.empty())
+			{
+				Release(Active.back());
+			}
+		}
+
+		bool IsPlaying(FTriggerEffectHandle Handle) const
+		{
+			return Handle.Slot < Slots.size() && Slots[Handle.Slot].bActive && Slots[Handle.Slot].Generation == Handle.Generation;
+		}
+
+		/**
+		 * @brief Forces both triggers to be written on the next tick (reconnect, periodic resend).
+		 */
+		void Invalidate() { bWritten[0] = bWritten[1] = false; }
+
+		/**
+		 * @brief Evaluates every effect at NowNs and writes the sides whose state changed.
+		 *
+		 * @return Number of trigger writes (0..2).
+		 */
+		int Tick(std::int64_t NowNs, const FTriggerEffectInputs& Inputs, ITriggerEffectSink& Sink)
+		{
+			float Values[static_cast<std::size_t>(ETriggerInput::Count)];
+			Values[static_cast<std::size_t>(ETriggerInput::Pitch)] = Inputs.Pitch;
+			Values[static_cast<std::size_t>(ETriggerInput::Roll)] = Inputs.Roll;
+			Values[static_cast<std::size_t>(ETriggerInput::LeftTrigger)] = Inputs.LeftTrigger;
+			Values[static_cast<std::size_t>(ETriggerInput::RightTrigger)] = Inputs.RightTrigger;
+			Values[static_cast<std::size_t>(ETriggerInput::BoardPitch)] = Inputs.BoardPitch;
+			Values[static_cast<std::size_t>(ETriggerInput::BoardRoll)] = Inputs.BoardRoll;
+			Values[static_cast<std::size_t>(ETriggerInput::BoardSpeed)] = Inputs.BoardSpeed;
+			Values[static_cast<std::size_t>(ETriggerInput::TruckTightness)] = Inputs.TruckTightness;
+
+			float Strength[2] = {0.0f, 0.0f};
+			float Start[2] = {0.0f, 0.0f};
+			for (std::size_t i = 0; i < Active.size();)
+			{
+				FSlot& Slot = Slots[Active[i]];
+				const float Time = static_cast<float>(static_cast<double>(NowNs - Slot.StartNs) * 1e-9);
+				if (Slot.Effect.Duration > 0.0f && Time >= Slot.Effect.Duration)
+				{
+					Release(Active[i]); // swaps the last effect into i
+					continue;
+				}
+
+				Values[static_cast<std::size_t>(ETriggerInput::Time)] = Time;
+				Values[static_cast<std::size_t>(ETriggerInput::Envelope)] = Slot.Effect.Envelope.Evaluate(Time, Slot.Cursor);
+				const float Value = std::clamp(Slot.Effect.Program.Evaluate(Values), 0.0f, 1.0f);
+				const std::size_t Side = static_cast<std::size_t>(Slot.Effect.Side);
+				if (Value > Strength[Side])
+				{
+					Strength[Side] = Value;
+					Start[Side] = Slot.Effect.StartPosition;
+				}
+				++i;
+			}
+
+			int Writes = 0;
+			for (std::size_t Side = 0; Side < 2; ++Side)
+			{
+				FTriggerEffectBytes Bytes;
+				Bytes.Level = Quantize(Strength[Side], FTriggerEffectBytes::MaxLevel, Last[Side].Level);
+				Bytes.Zone = Bytes.IsOff() ? 0 : Quantize(Start[Side], FTriggerEffectBytes::MaxZone, Last[Side].Zone);
+				if (!bWritten[Side] || Bytes != Last[Side])
+				{
+					Sink.WriteTrigger(static_cast<ETriggerSide>(Side), Bytes);
+					Last[Side] = Bytes;
+					bWritten[Side] = true;
+					++Writes;
+				}
+			}
+			++TickCount;
+			WriteCount += static_cast<std::uint64_t>(Writes);
+			return Writes;
+		}
+
+		std::size_t GetActiveCount() const { return Active.size(); }
+		const FTriggerEffectBytes& GetLastBytes(ETriggerSide Side) const { return Last[static_cast<std::size_t>(Side)]; }
+		std::uint64_t GetTickCount() const { return TickCount; }
+		std::uint64_t GetWriteCount() const { return WriteCount; }
+
+	private:
+		struct FSlot
+		{
+			FTriggerEffect Effect;
+			std::int64_t StartNs = 0;
+			std::uint32_t Generation = 0;
+			std::uint32_t ActiveIndex = 0;
+			std::uint8_t Cursor = 0;
+			bool bActive = false;
+		};
+
+		// Rounds Value * Steps to the nearest step, but keeps Previous unless Value is clearly past it
+		static std::uint8_t Quantize(float Value, std::uint8_t Steps, std::uint8_t Previous)
+		{
+			const float Scaled = std::clamp(Value, 0.0f, 1.0f) * static_cast<float>(Steps);
+			if (std::fabs(Scaled - static_cast<float>(Previous)) <= 0.5f + Hysteresis)
+			{
+				return Previous;
+			}
+			return static_cast<std::uint8_t>(std::lround(Scaled));
+		}
+
+		void Release(std::uint32_t Index)
+		{
+			FSlot& Slot = Slots[Index];
+			const std::uint32_t Moved = Active.back();
+			Active[Slot.ActiveIndex] = Moved;
+			Slots[Moved].ActiveIndex = Slot.ActiveIndex;
+			Active.pop_back();
+			Slot.bActive = false;
+			++Slot.Generation;
+			FreeSlots.push_back(Index);
+		}
+
+		std::vector<FSlot> Slots;
+		std::vector<std::uint32_t> Active;
+		std::vector<std::uint32_t> FreeSlots;
+		FTriggerEffectBytes Last[2];
+		bool bWritten[2] = {false, false};
+		std::uint64_t TickCount = 0;
+		std::uint64_t WriteCount = 0;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,241 @@
+#if defined(__linux__)
+#include "UInputAdapter.h"
+#include "Audio/RumbleBridge.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace GamepadCore {
+
+namespace {
+
+constexpr int kButtonCodes[] = {
+    BTN_SOUTH, BTN_EAST, BTN_WEST, BTN_NORTH,
+    BTN_TL, BTN_TR, BTN_SELECT, BTN_START,
+    BTN_THUMBL, BTN_THUMBR, BTN_MODE
+};
+
+bool SetupAbs(int fd, unsigned int code, int minimum, int maximum) {
+    uinput_abs_setup abs{};
+    abs.code = static_cast<__u16>(code);
+    abs.absinfo.minimum = minimum;
+    abs.absinfo.maximum = maximum;
+    return ioctl(fd, UI_SET_ABSBIT, code) == 0 && ioctl(fd, UI_ABS_SETUP, &abs) == 0;
+}
+
+int ToStick(float value) {
+    return static_cast<int>(std::clamp(value * 32767.0f, -32768.0f, 32767.0f));
+}
+
+} // namespace
+
+UInputAdapter::UInputAdapter() {}
+
+UInputAdapter::~UInputAdapter() {
+    Shutdown();
+}
+
+bool UInputAdapter::Initialize() {
+    if (m_Initialized) return true;
+
+    // Read access is needed to receive the force feedback requests of the game
+    m_Fd = open("/dev/uinput", O_RDWR | O_NONBLOCK);
+    if (m_Fd < 0) {
+        std::cerr << "[uinput] Failed to open /dev/uinput (" << std::strerror(errno) << "). Is the module loaded and accessible?" << std::endl;
+        return false;
+    }
+
+    bool ok = ioctl(m_Fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(m_Fd, UI_SET_EVBIT, EV_ABS) == 0;
+    for (int code : kButtonCodes) {
+        ok = ok && ioctl(m_Fd, UI_SET_KEYBIT, code) == 0;
+    }
+    ok = ok && SetupAbs(m_Fd, ABS_X, -32768, 32767) && SetupAbs(m_Fd, ABS_Y, -32768, 32767);
+    ok = ok && SetupAbs(m_Fd, ABS_RX, -32768, 32767) && SetupAbs(m_Fd, ABS_RY, -32768, 32767);
+    ok = ok && SetupAbs(m_Fd, ABS_Z, 0, 255) && SetupAbs(m_Fd, ABS_RZ, 0, 255);
+    ok = ok && SetupAbs(m_Fd, ABS_HAT0X, -1, 1) && SetupAbs(m_Fd, ABS_HAT0Y, -1, 1);
+    if (m_RumbleMailbox) {
+        ok = ok && ioctl(m_Fd, UI_SET_EVBIT, EV_FF) == 0 && ioctl(m_Fd, UI_SET_FFBIT, FF_RUMBLE) == 0 && ioctl(m_Fd, UI_SET_FFBIT, FF_GAIN) == 0;
+    }
+
+    uinput_setup setup{};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x045E;  // Microsoft
+    setup.id.product = 0x028E; // Xbox 360 Controller
+    std::strncpy(setup.name, "DualSense Mod Virtual Gamepad", UINPUT_MAX_NAME_SIZE - 1);
+    setup.ff_effects_max = m_RumbleMailbox ? MaxFfEffects : 0;
+
+    ok = ok && ioctl(m_Fd, UI_DEV_SETUP, &setup) == 0 && ioctl(m_Fd, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        std::cerr << "[uinput] Failed to create virtual gamepad (" << std::strerror(errno) << ")." << std::endl;
+        close(m_Fd);
+        m_Fd = -1;
+        return false;
+    }
+
+    std::cout << "[uinput] Virtual gamepad created!" << std::endl;
+    m_Initialized = true;
+    return true;
+}
+
+void UInputAdapter::Shutdown() {
+    if (!m_Initialized) return;
+
+    ioctl(m_Fd, UI_DEV_DESTROY);
+    close(m_Fd);
+    m_Fd = -1;
+
+    for (FRumbleEffect& effect : m_Effects) {
+        effect = FRumbleEffect{};
+    }
+    m_PostedLarge = 0;
+    m_PostedSmall = 0;
+    // The device is gone, so no effect will stop the motors. This thread is not the mailbox's
+    // poster (the one calling PollFeedback), so it only raises the stop flag.
+    if (m_RumbleMailbox) m_RumbleMailbox->RequestStop();
+
+    m_Initialized = false;
+    std::cout << "[uinput] Virtual gamepad destroyed." << std::endl;
+}
+
+void UInputAdapter::Update(const FInputContext& context) {
+    if (!m_Initialized) return;
+
+    const bool buttons[] = {
+        context.bCross, context.bCircle, context.bSquare, context.bTriangle,
+        context.bLeftShoulder, context.bRightShoulder, context.bShare, context.bStart,
+        context.bLeftStick, context.bRightStick, context.bPSButton
+    };
+
+    // One write per report: evdev only publishes the batch on SYN_REPORT anyway
+    input_event events[std::size(kButtonCodes) + 9] = {};
+    size_t count = 0;
+    auto push = [&](unsigned short type, unsigned short code, int value) {
+        events[count].type = type;
+        events[count].code = code;
+        events[count].value = value;
+        ++count;
+    };
+
+    for (size_t i = 0; i < std::size(kButtonCodes); ++i) {
+        push(EV_KEY, static_cast<unsigned short>(kButtonCodes[i]), buttons[i] ? 1 : 0);
+    }
+
+    // evdev: Y grows downwards, GamepadCore: Y is up (+1.0)
+    push(EV_ABS, ABS_X, ToStick(context.LeftAnalog.X));
+    push(EV_ABS, ABS_Y, -ToStick(context.LeftAnalog.Y));
+    push(EV_ABS, ABS_RX, ToStick(context.RightAnalog.X));
+    push(EV_ABS, ABS_RY, -ToStick(context.RightAnalog.Y));
+    push(EV_ABS, ABS_Z, static_cast<int>(context.LeftTriggerAnalog * 255.0f));
+    push(EV_ABS, ABS_RZ, static_cast<int>(context.RightTriggerAnalog * 255.0f));
+    push(EV_ABS, ABS_HAT0X, (context.bDpadRight ? 1 : 0) - (context.bDpadLeft ? 1 : 0));
+    push(EV_ABS, ABS_HAT0Y, (context.bDpadDown ? 1 : 0) - (context.bDpadUp ? 1 : 0));
+    push(EV_SYN, SYN_REPORT, 0);
+
+    const ssize_t bytes = static_cast<ssize_t>(count * sizeof(input_event));
+    if (write(m_Fd, events, bytes) != bytes) {
+        // Device busy or reader gone; the next report carries the full state again
+    }
+}
+
+void UInputAdapter::PollFeedback() {
+    if (!m_Initialized || !m_RumbleMailbox) return;
+
+    bool changed = false;
+    input_event events[16];
+    ssize_t bytes;
+    while ((bytes = read(m_Fd, events, sizeof(events))) > 0) {
+        const size_t count = static_cast<size_t>(bytes) / sizeof(input_event);
+        for (size_t i = 0; i < count; ++i) {
+            const input_event& ev = events[i];
+            if (ev.type == EV_UINPUT && ev.code == UI_FF_UPLOAD) {
+                HandleUpload(ev.value);
+                changed = true;
+            } else if (ev.type == EV_UINPUT && ev.code == UI_FF_ERASE) {
+                HandleErase(ev.value);
+                changed = true;
+            } else if (ev.type == EV_FF && ev.code == FF_GAIN) {
+                m_Gain = static_cast<uint32_t>(std::clamp(ev.value, 0, 0xFFFF));
+                changed = true;
+            } else if (ev.type == EV_FF && ev.code < MaxFfEffects) {
+                FRumbleEffect& effect = m_Effects[ev.code];
+                effect.Playing = effect.Uploaded && ev.value > 0;
+                effect.StopAtNs = effect.LengthMs ? FRumbleMailbox::NowNs() + int64_t{effect.LengthMs} * 1000000 : 0;
+                changed = true;
+            }
+        }
+    }
+
+    // uinput does not time effects out by itself, the replay length is ours to enforce
+    const int64_t now = FRumbleMailbox::NowNs();
+    for (FRumbleEffect& effect : m_Effects) {
+        if (effect.Playing && effect.StopAtNs != 0 && now >= effect.StopAtNs) {
+            effect.Playing = false;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        PostRumble();
+    }
+}
+
+void UInputAdapter::HandleUpload(int requestId) {
+    uinput_ff_upload upload{};
+    upload.request_id = static_cast<__u32>(requestId);
+    if (ioctl(m_Fd, UI_BEGIN_FF_UPLOAD, &upload) != 0) return;
+
+    const int id = upload.effect.id;
+    if (upload.effect.type == FF_RUMBLE && id >= 0 && id < MaxFfEffects) {
+        FRumbleEffect& effect = m_Effects[id];
+        effect.Strong = upload.effect.u.rumble.strong_magnitude;
+        effect.Weak = upload.effect.u.rumble.weak_magnitude;
+        effect.LengthMs = upload.effect.replay.length;
+        effect.Uploaded = true;
+        upload.retval = 0;
+    } else {
+        upload.retval = -EINVAL;
+    }
+    ioctl(m_Fd, UI_END_FF_UPLOAD, &upload);
+}
+
+void UInputAdapter::HandleErase(int requestId) {
+    uinput_ff_erase erase{};
+    erase.request_id = static_cast<__u32>(requestId);
+    if (ioctl(m_Fd, UI_BEGIN_FF_ERASE, &erase) != 0) return;
+
+    if (erase.effect_id < MaxFfEffects) {
+        m_Effects[erase.effect_id] = FRumbleEffect{};
+    }
+    erase.retval = 0;
+    ioctl(m_Fd, UI_END_FF_ERASE, &erase);
+}
+
+void UInputAdapter::PostRumble() {
+    if (!m_RumbleMailbox) return;
+
+    // Overlapping effects: the strongest one wins on each motor, like ff-memless does
+    uint32_t strong = 0;
+    uint32_t weak = 0;
+    for (const FRumbleEffect& effect : m_Effects) {
+        if (effect.Playing) {
+            strong = std::max<uint32_t>(strong, effect.Strong);
+            weak = std::max<uint32_t>(weak, effect.Weak);
+        }
+    }
+
+    const uint8_t large = static_cast<uint8_t>((strong * m_Gain / 0xFFFF) >> 8);
+    const uint8_t small = static_cast<uint8_t>((weak * m_Gain / 0xFFFF) >> 8);
+    if (large != m_PostedLarge || small != m_PostedSmall) {
+        m_PostedLarge = large;
+        m_PostedSmall = small;
+        m_RumbleMailbox->Post(large, small);
+    }
+}
+
+} // namespace GamepadCore
+#endif // __linux__
@@ -0,0 +1,52 @@
+#pragma once
+#if defined(__linux__)
+
+#include "VirtualPad/IVirtualGamepadSink.h"
+#include <cstdint>
+
+namespace GamepadCore {
+
+// Virtual gamepad exposed through /dev/uinput (Xbox-style layout, evdev button/axis codes).
+class UInputAdapter final : public IVirtualGamepadSink {
+public:
+    UInputAdapter();
+    ~UInputAdapter() override;
+
+    bool Initialize() override;
+    void Shutdown() override;
+
+    void Update(const FInputContext& context) override;
+    const char* GetName() const override { return "uinput"; }
+
+    // FF_RUMBLE effects uploaded and played by the game are forwarded to the mailbox
+    void SetRumbleMailbox(FRumbleMailbox* mailbox) override { m_RumbleMailbox = mailbox; }
+    void PollFeedback() override;
+
+    static constexpr int MaxFfEffects = 16;
+
+private:
+    struct FRumbleEffect {
+        uint16_t Strong = 0;
+        uint16_t Weak = 0;
+        uint16_t LengthMs = 0;
+        bool Uploaded = false;
+        bool Playing = false;
+        int64_t StopAtNs = 0;
+    };
+
+    void HandleUpload(int requestId);
+    void HandleErase(int requestId);
+    void PostRumble();
+
+    FRumbleMailbox* m_RumbleMailbox = nullptr;
+    FRumbleEffect m_Effects[MaxFfEffects];
+    uint32_t m_Gain = 0xFFFF;
+    uint8_t m_PostedLarge = 0;
+    uint8_t m_PostedSmall = 0;
+    int m_Fd = -1;
+    bool m_Initialized = false;
+};
+
+} // namespace GamepadCore
+
+#endif // __linux__
@@ -0,0 +1,296 @@
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "GCore/Templates/TGenericHardwareInfo.h"
+#include "GCore/Types/Structs/Config/GamepadCalibration.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GImplementations/Utils/GamepadSensors.h"
+#include "Simulation/SimulatedDualSense.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace Ftest_simulated_platform
+{
+	struct Ftest_simulated_hardware_policy;
+	using Ftest_simulated_hardware = GamepadCore::TGenericHardwareInfo<Ftest_simulated_hardware_policy>;
+
+	/**
+	 * @brief Hardware policy backed by GamepadCore::FSimulatedBus instead of HID.
+	 *
+	 * Controllers on the bus are enumerated, read and written like real ones, with the same report
+	 * sizes as the Windows policy, so the registry, gamepad library and service code run unchanged
+	 * without a controller attached. Reads block on the service clock until the next report is due.
+	 * Every bus access takes FSimulatedBus::Mutex, so the service loops can run on their own threads.
+	 */
+	struct Ftest_simulated_hardware_policy
+	{
+	public:
+		void Read(FDeviceContext* Context)
+		{
+			GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+			std::int64_t DueNs = 0;
+			{
+				std::lock_guard<std::mutex> Lock(Bus.Mutex);
+				GamepadCore::FSimulatedDualSense* Device = Find(Context);
+				if (!Device)
+				{
+					return;
+				}
+				if (!Device->IsPlugged())
+				{
+					Context->IsConnected = false;
+					return;
+				}
+				DueNs = Device->GetNextInputReportNs();
+			}
+
+			GamepadCore::IServiceClock::Get().SleepUntilNs(DueNs);
+
+			std::lock_guard<std::mutex> Lock(Bus.Mutex);
+			GamepadCore::FSimulatedDualSense* Device = Find(Context);
+			if (!Device || !Device->IsPlugged())
+			{
+				Context->IsConnected = false;
+				return;
+			}
+			const size_t Length = Device->ReadInputReport(Context->Buffer, sizeof(Context->Buffer), Bus.NowNs());
+			// Until the calibration read on the cache worker lands, a Bluetooth pad sends basic reports
+			if (Length == GamepadCore::DualSenseReport::BtBasicReportSize && GamepadCore::ExpandBasicBtReport(Context->Buffer, sizeof(Context->Buffer)))
+			{
+				++Bus.BasicReports;
+			}
+		}
+
+		void Write(FDeviceContext* Context)
+		{
+			GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+			std::lock_guard<std::mutex> Lock(Bus.Mutex);
+			GamepadCore::FSimulatedDualSense* Device = Find(Context);
+			if (!Device)
+			{
+				return;
+			}
+
+			const size_t InReportLength = Context->DeviceType == EDSDeviceType::DualShock4 ? 32 : 74;
+			const size_t OutputReportLength = Context->ConnectionType == EDSDeviceConnection::Bluetooth ? 78 : InReportLength;
+			if (!Device->WriteOutputReport(Context->GetRawOutputBuffer(), OutputReportLength, Bus.NowNs()))
+			{
+				// A write to a removed controller fails: on USB, where nothing reads, this is how the unplug is seen
+				Context->IsConnected = false;
+				return;
+			}
+
+			const GamepadCore::FRecordedOutput& Output = Device->GetOutputs().back();
+			Bus.InvalidOutputs += Output.bValidReportId && Output.bValidCrc ? 0 : 1;
+			if (!Bus.bKeepOutputs)
+			{
+				Device->ClearOutputs();
+			}
+		}
+
+		void Detect(std::vector<FDeviceContext>& Devices)
+		{
+			GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+			std::lock_guard<std::mutex> Lock(Bus.Mutex);
+			for (const GamepadCore::FSimulatedDualSense& Device : Bus.Devices)
+			{
+				if (!Device.IsPlugged())
+				{
+					continue;
+				}
+
+				FDeviceContext Context = {};
+				Context.Path = Device.GetPath();
+				Context.DeviceType = EDSDeviceType::DualSense;
+				Context.IsConnected = true;
+				Context.ConnectionType = Device.GetTransport() == GamepadCore::ESimulatedTransport::Bluetooth ? EDSDeviceConnection::Bluetooth : EDSDeviceConnection::Usb;
+				Devices.push_back(Context);
+			}
+		}
+
+		bool CreateHandle(FDeviceContext* Context)
+		{
+			GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+			size_t Index = 0;
+			{
+				std::lock_guard<std::mutex> Lock(Bus.Mutex);
+				while (Index < Bus.Devices.size() && !(Bus.Devices[Index].GetPath() == Context->Path && Bus.Devices[Index].IsPlugged()))
+				{
+					++Index;
+				}
+				if (Index == Bus.Devices.size())
+				{
+					Context->Handle = INVALID_PLATFORM_HANDLE;
+					return false;
+				}
+
+				Context->Handle = MakeHandle<decltype(Context->Handle)>(Index + 1);
+				++Bus.Connects;
+				++Bus.OpenHandles;
+			}
+
+			// Feature reads wait on the clock: the bus lock is not held here
+			ConfigureFeatures(Context, Index);
+			return true;
+		}
+
+		void InvalidateHandle(FDeviceContext* Context)
+		{
+			if (!Context || Context->Handle == INVALID_PLATFORM_HANDLE)
+			{
+				return;
+			}
+
+			{
+				GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+				std::lock_guard<std::mutex> Lock(Bus.Mutex);
+				--Bus.OpenHandles;
+			}
+			Context->Handle = INVALID_PLATFORM_HANDLE;
+			Context->IsConnected = false;
+			Context->Path.clear();
+
+			std::memset(Context->Buffer, 0, sizeof(Context->Buffer));
+			std::memset(Context->BufferDS4, 0, sizeof(Context->BufferDS4));
+			std::memset(Context->BufferAudio, 0, sizeof(Context->BufferAudio));
+			std::memset(Context->GetRawOutputBuffer(), 0, 78);
+		}
+
+		void ProcessAudioHaptic(FDeviceContext* Context)
+		{
+			(void)Context;
+			GamepadCore::FSimulatedBus::Get().AudioHapticPackets.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// There is no audio endpoint behind a simulated controller: haptics stay on the report path
+		void InitializeAudioDevice(FDeviceContext* Context)
+		{
+			(void)Context;
+		}
+
+	private:
+		// Same flow as the Windows ConfigureFeatures: calibration from the cache keyed by MAC and firmware,
+		// device read on a miss; on Bluetooth the read that switches to full reports runs on the cache worker
+		void ConfigureFeatures(FDeviceContext* Context, size_t Index)
+		{
+			auto ReadFeature = [Index](std::uint8_t* Report, std::size_t Length)
+			{
+				GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+				std::int64_t LatencyNs = 0;
+				{
+					std::lock_guard<std::mutex> Lock(Bus.Mutex);
+					LatencyNs = Bus.Devices[Index].GetFeatureLatencyNs();
+				}
+				GamepadCore::IServiceClock::Get().SleepFor(std::chrono::nanoseconds(LatencyNs));
+
+				std::lock_guard<std::mutex> Lock(Bus.Mutex);
+				return Bus.Devices[Index].ReadFeatureReport(Report, Length);
+			};
+			auto ReadCalibration = [ReadFeature](std::uint8_t* Report)
+			{
+				return ReadFeature(Report, GamepadCore::DualSenseCalibrationReport::Size);
+			};
+			auto ReadDevice = [ReadFeature, ReadCalibration](std::uint32_t& OutFirmware, std::uint8_t* Report)
+			{
+				std::uint8_t FirmwareInfo[GamepadCore::DualSenseFeatureReport::FirmwareInfoSize] = {GamepadCore::DualSenseFeatureReport::FirmwareInfoId};
+				if (ReadFeature(FirmwareInfo, sizeof(FirmwareInfo)))
+				{
+					OutFirmware = GamepadCore::DualSenseFeatureReport::FirmwareFromFirmwareInfo(FirmwareInfo);
+				}
+				return ReadCalibration(Report);
+			};
+			// Stand in for the duplicated handle the Windows policy opens: every reader made must also run
+			auto MakeRefreshReader = [ReadCalibration]() -> GamepadCore::FCalibrationCache::FReadFeature
+			{
+				GamepadCore::FSimulatedBus::Get().RefreshReadersMade.fetch_add(1, std::memory_order_relaxed);
+				return [ReadCalibration](std::uint8_t* Report)
+				{
+					GamepadCore::FSimulatedBus::Get().RefreshReadersRun.fetch_add(1, std::memory_order_relaxed);
+					return ReadCalibration(Report);
+				};
+			};
+			auto MakeAsyncReader = [ReadDevice]() -> GamepadCore::FCalibrationCache::FReadDevice
+			{
+				GamepadCore::FSimulatedBus::Get().RefreshReadersMade.fetch_add(1, std::memory_order_relaxed);
+				return [ReadDevice](std::uint32_t& OutFirmware, std::uint8_t* Report)
+				{
+					GamepadCore::FSimulatedBus::Get().RefreshReadersRun.fetch_add(1, std::memory_order_relaxed);
+					return ReadDevice(OutFirmware, Report);
+				};
+			};
+
+			unsigned char FeatureBuffer[41] = {0};
+			GamepadCore::FCalibrationCache& Cache = GamepadCore::FCalibrationCache::Get();
+			bool bResolved = false;
+			if (!GamepadCore::FSimulatedBus::Get().bCalibrationCache)
+			{
+				FeatureBuffer[0] = GamepadCore::DualSenseCalibrationReport::ReportId;
+				bResolved = ReadCalibration(FeatureBuffer) && GamepadCore::FCalibrationCache::IsValidReport(FeatureBuffer);
+			}
+			else if (Context->ConnectionType == EDSDeviceConnection::Bluetooth)
+			{
+				// The MAC is the serial string; the firmware would take a round trip, so any matches
+				GamepadCore::FCalibrationKey Key;
+				{
+					GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+					std::lock_guard<std::mutex> Lock(Bus.Mutex);
+					Key.DeviceId = "054C:0CE6:" + GamepadCore::DualSenseFeatureReport::NormalizeMac(Bus.Devices[Index].GetSerialString());
+				}
+				bResolved = Cache.ResolveFromDevice(&Key, FeatureBuffer, ReadDevice, MakeAsyncReader);
+			}
+			else
+			{
+				// USB feature reads are cheap: MAC and firmware come from the pairing and firmware reports
+				std::uint8_t PairingInfo[GamepadCore::DualSenseFeatureReport::PairingInfoSize] = {GamepadCore::DualSenseFeatureReport::PairingInfoId};
+				std::uint8_t FirmwareInfo[GamepadCore::DualSenseFeatureReport::FirmwareInfoSize] = {GamepadCore::DualSenseFeatureReport::FirmwareInfoId};
+				GamepadCore::FCalibrationKey Key;
+				const bool bHasKey = ReadFeature(PairingInfo, sizeof(PairingInfo)) && ReadFeature(FirmwareInfo, sizeof(FirmwareInfo));
+				if (bHasKey)
+				{
+					Key.DeviceId = "054C:0CE6:" + GamepadCore::DualSenseFeatureReport::MacFromPairingInfo(PairingInfo);
+					Key.Firmware = GamepadCore::DualSenseFeatureReport::FirmwareFromFirmwareInfo(FirmwareInfo);
+				}
+				bResolved = Cache.Resolve(bHasKey ? &Key : nullptr, FeatureBuffer, ReadCalibration, MakeRefreshReader);
+			}
+			if (!bResolved)
+			{
+				GamepadCore::FSimulatedBus& Bus = GamepadCore::FSimulatedBus::Get();
+				std::lock_guard<std::mutex> Lock(Bus.Mutex);
+				++Bus.CalibrationFailures;
+				return;
+			}
+
+			FGamepadCalibration Calibration;
+			using namespace FGamepadSensors;
+			DualSenseCalibrationSensors(FeatureBuffer, Calibration);
+			Context->Calibration = Calibration;
+		}
+
+		template<typename THandle>
+		static THandle MakeHandle(std::uintptr_t Token)
+		{
+			if constexpr (std::is_pointer_v<THandle>)
+			{
+				return reinterpret_cast<THandle>(Token);
+			}
+			else
+			{
+				return static_cast<THandle>(Token);
+			}
+		}
+
+		// Caller holds the bus mutex
+		static GamepadCore::FSimulatedDualSense* Find(FDeviceContext* Context)
+		{
+			if (!Context || Context->Handle == INVALID_PLATFORM_HANDLE)
+			{
+				return nullptr;
+			}
+			return GamepadCore::FSimulatedBus::Get().Find(Context->Path);
+		}
+	};
+} // namespace Ftest_simulated_platform
+#endif
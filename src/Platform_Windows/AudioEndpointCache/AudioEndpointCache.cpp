@@ -0,0 +1,215 @@
+#include "AudioEndpointCache.h"
+#ifdef _WIN32
+#include <cstring>
+#include <iostream>
+
+namespace Ftest_windows_platform
+{
+	namespace
+	{
+		// Endpoint IDs travel through the portable lookup as the raw bytes of ma_device_id
+		class FMiniaudioEndpointBackend final : public GamepadCore::IAudioEndpointBackend
+		{
+		public:
+			explicit FMiniaudioEndpointBackend(ma_context& InContext)
+			    : Context(InContext)
+			{
+			}
+
+			bool EnumeratePlayback(std::vector<GamepadCore::FAudioEndpoint>& OutEndpoints) override
+			{
+				ma_device_info* PlaybackInfos;
+				ma_uint32 PlaybackCount;
+				ma_device_info* CaptureInfos;
+				ma_uint32 CaptureCount;
+				if (ma_context_get_devices(&Context, &PlaybackInfos, &PlaybackCount, &CaptureInfos, &CaptureCount) != MA_SUCCESS)
+				{
+					return false;
+				}
+
+				OutEndpoints.resize(PlaybackCount);
+				for (ma_uint32 i = 0; i < PlaybackCount; ++i)
+				{
+					OutEndpoints[i].Id.assign(reinterpret_cast<const char*>(&PlaybackInfos[i].id), sizeof(ma_device_id));
+					OutEndpoints[i].Name = PlaybackInfos[i].name;
+				}
+				return true;
+			}
+
+		private:
+			ma_context& Context;
+		};
+	} // namespace
+
+	FAudioEndpointWatcher::~FAudioEndpointWatcher()
+	{
+		// Static destruction at process exit: the thread is already gone and joining would need the loader lock
+		if (Thread.joinable())
+		{
+			Thread.detach();
+		}
+	}
+
+	bool FAudioEndpointWatcher::Register()
+	{
+		if (Thread.joinable())
+		{
+			return IsRegistered();
+		}
+
+		StopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		HANDLE Registered = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		if (!StopEvent || !Registered)
+		{
+			if (StopEvent)
+			{
+				CloseHandle(StopEvent);
+				StopEvent = nullptr;
+			}
+			if (Registered)
+			{
+				CloseHandle(Registered);
+			}
+			return false;
+		}
+
+		Thread = std::thread(&FAudioEndpointWatcher::Run, this, Registered);
+		WaitForSingleObject(Registered, INFINITE);
+		CloseHandle(Registered);
+		return IsRegistered();
+	}
+
+	void FAudioEndpointWatcher::Unregister()
+	{
+		if (Thread.joinable())
+		{
+			SetEvent(StopEvent);
+			Thread.join();
+		}
+		if (StopEvent)
+		{
+			CloseHandle(StopEvent);
+			StopEvent = nullptr;
+		}
+	}
+
+	void FAudioEndpointWatcher::Run(HANDLE Registered)
+	{
+		const bool bComInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+
+		IMMDeviceEnumerator* Enumerator = nullptr;
+		if (SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), reinterpret_cast<void**>(&Enumerator))))
+		{
+			if (SUCCEEDED(Enumerator->RegisterEndpointNotificationCallback(this)))
+			{
+				bRegistered.store(true, std::memory_order_release);
+			}
+		}
+		SetEvent(Registered);
+
+		if (IsRegistered())
+		{
+			WaitForSingleObject(StopEvent, INFINITE);
+			Enumerator->UnregisterEndpointNotificationCallback(this);
+			bRegistered.store(false, std::memory_order_release);
+		}
+		if (Enumerator)
+		{
+			Enumerator->Release();
+		}
+		if (bComInitialized)
+		{
+			CoUninitialize();
+		}
+	}
+
+	HRESULT FAudioEndpointWatcher::QueryInterface(REFIID Riid, void** OutObject)
+	{
+		if (!OutObject)
+		{
+			return E_POINTER;
+		}
+
+		if (Riid == __uuidof(IUnknown) || Riid == __uuidof(IMMNotificationClient))
+		{
+			*OutObject = static_cast<IMMNotificationClient*>(this);
+			AddRef();
+			return S_OK;
+		}
+
+		*OutObject = nullptr;
+		return E_NOINTERFACE;
+	}
+
+	FAudioEndpointCache::~FAudioEndpointCache()
+	{
+		// Shutdown() is the service's job; at static destruction only the miniaudio context is left to free
+		if (bContextReady)
+		{
+			ma_context_uninit(&Context);
+		}
+	}
+
+	FAudioEndpointCache& FAudioEndpointCache::Get()
+	{
+		static FAudioEndpointCache Cache;
+		return Cache;
+	}
+
+	void FAudioEndpointCache::Shutdown()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Watcher.Unregister();
+		if (bContextReady)
+		{
+			ma_context_uninit(&Context);
+			bContextReady = false;
+		}
+		Lookup.Forget();
+	}
+
+	bool FAudioEndpointCache::EnsureContext()
+	{
+		if (bContextReady)
+		{
+			return true;
+		}
+
+		if (ma_context_init(nullptr, 0, nullptr, &Context) != MA_SUCCESS)
+		{
+			return false;
+		}
+		bContextReady = true;
+
+		if (!Watcher.Register())
+		{
+			std::cerr << "[Audio] Endpoint notifications unavailable, DualSense endpoint lookup will not be cached." << std::endl;
+		}
+		return true;
+	}
+
+	bool FAudioEndpointCache::FindDualSenseDevice(ma_device_id& OutId)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (!EnsureContext())
+		{
+			return false;
+		}
+
+		const std::uint64_t Enumerations = Lookup.GetEnumerationCount();
+		FMiniaudioEndpointBackend Backend(Context);
+		GamepadCore::FAudioEndpoint Endpoint;
+		if (!Lookup.Find(Backend, Endpoint, Watcher.IsRegistered()) || Endpoint.Id.size() != sizeof(ma_device_id))
+		{
+			return false;
+		}
+
+		std::memcpy(&OutId, Endpoint.Id.data(), sizeof(ma_device_id));
+		if (Lookup.GetEnumerationCount() != Enumerations)
+		{
+			std::cout << "[Audio] DualSense endpoint cached: " << Endpoint.Name << std::endl;
+		}
+		return true;
+	}
+} // namespace Ftest_windows_platform
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+#ifdef _WIN32
+#include "Audio/AudioEndpointLookup.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include <Windows.h>
+#include <atomic>
+#include <mmdeviceapi.h>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Ftest_windows_platform
+{
+	/**
+	 * @brief Receives WASAPI endpoint notifications and marks the endpoint lookup as stale.
+	 *
+	 * Only arrival, removal and state changes invalidate the lookup; default-device and property
+	 * changes do not affect which endpoint belongs to the DualSense. Registration lives on a thread
+	 * of its own, which initializes COM, registers, waits for Unregister() and unregisters, so
+	 * CoInitializeEx and CoUninitialize always pair on one thread whatever thread starts or stops it.
+	 */
+	class FAudioEndpointWatcher final : public IMMNotificationClient
+	{
+	public:
+		explicit FAudioEndpointWatcher(GamepadCore::FAudioEndpointLookup& InLookup)
+		    : Lookup(InLookup)
+		{
+		}
+		~FAudioEndpointWatcher();
+
+		/**
+		 * @brief Starts the notification thread; returns once registration succeeded or failed.
+		 */
+		bool Register();
+
+		/**
+		 * @brief Stops the notification thread and waits for it. Never call under the loader lock.
+		 */
+		void Unregister();
+		bool IsRegistered() const { return bRegistered.load(std::memory_order_acquire); }
+
+		ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&RefCount); }
+		ULONG STDMETHODCALLTYPE Release() override { return InterlockedDecrement(&RefCount); }
+		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID Riid, void** OutObject) override;
+
+		HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override { return MarkDirty(); }
+		HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override { return MarkDirty(); }
+		HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override { return MarkDirty(); }
+		HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow, ERole, LPCWSTR) override { return S_OK; }
+		HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override { return S_OK; }
+
+	private:
+		HRESULT MarkDirty()
+		{
+			Lookup.Invalidate();
+			return S_OK;
+		}
+
+		void Run(HANDLE Registered);
+
+		GamepadCore::FAudioEndpointLookup& Lookup;
+		std::thread Thread;
+		HANDLE StopEvent = nullptr;
+		std::atomic<bool> bRegistered{false};
+		LONG RefCount = 1;
+	};
+
+	/**
+	 * @brief Long-lived miniaudio context with a cached lookup of the DualSense playback endpoint.
+	 *
+	 * The context is created once and reused for every reconnect. The endpoint match (device ID and
+	 * name) is kept until the endpoint watcher reports a device change, or until the cached ID fails
+	 * to open. When notifications cannot be registered the cache degrades to a fresh enumeration per call.
+	 * One instance serves the process, so the audio thread can warm it up while HID detection runs.
+	 */
+	class FAudioEndpointCache
+	{
+	public:
+		FAudioEndpointCache()
+		    : Watcher(Lookup)
+		{
+		}
+		~FAudioEndpointCache();
+
+		FAudioEndpointCache(const FAudioEndpointCache&) = delete;
+		FAudioEndpointCache& operator=(const FAudioEndpointCache&) = delete;
+
+		static FAudioEndpointCache& Get();
+
+		/**
+		 * @brief Releases the context and the notifications. Call before the service unloads.
+		 */
+		void Shutdown();
+
+		/**
+		 * @brief Resolves the DualSense playback endpoint, enumerating only when the cache is stale.
+		 *
+		 * @param OutId Receives the endpoint ID when found.
+		 * @return True if a DualSense endpoint is currently known.
+		 */
+		bool FindDualSenseDevice(ma_device_id& OutId);
+
+		/**
+		 * @brief Drops the cached match (it failed to open) so the next lookup enumerates again.
+		 */
+		void Invalidate()
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Lookup.Forget();
+		}
+
+	private:
+		bool EnsureContext();
+
+		std::mutex Mutex;
+		GamepadCore::FAudioEndpointLookup Lookup;
+		FAudioEndpointWatcher Watcher;
+		ma_context Context;
+		bool bContextReady = false;
+	};
+} // namespace Ftest_windows_platform
+#endif
@@ -0,0 +1,65 @@
+#include "HidArrivalWatcher.h"
+#ifdef _WIN32
+#include <initguid.h>
+#include <hidclass.h>
+#include <cwchar>
+#include <cwctype>
+#include <iostream>
+
+namespace Ftest_windows_platform
+{
+	namespace
+	{
+		// USB links carry "VID_054C", Bluetooth links "_VID&0002054C": both contain the Sony vendor ID
+		bool IsSonyInterface(const wchar_t* SymbolicLink)
+		{
+			for (const wchar_t* Cursor = SymbolicLink; *Cursor; ++Cursor)
+			{
+				if (Cursor[0] == L'0' && Cursor[1] == L'5' && Cursor[2] == L'4' && std::towupper(Cursor[3]) == L'C')
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+	} // namespace
+
+	bool FHidArrivalWatcher::Register()
+	{
+		if (Notification)
+		{
+			return true;
+		}
+
+		CM_NOTIFY_FILTER Filter = {};
+		Filter.cbSize = sizeof(Filter);
+		Filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+		Filter.u.DeviceInterface.ClassGuid = GUID_DEVINTERFACE_HID;
+		if (CM_Register_Notification(&Filter, this, &FHidArrivalWatcher::OnNotification, &Notification) != CR_SUCCESS)
+		{
+			Notification = nullptr;
+			std::cerr << "[System] HID arrival notifications unavailable, falling back to periodic detection." << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	void FHidArrivalWatcher::Unregister()
+	{
+		if (Notification)
+		{
+			CM_Unregister_Notification(Notification);
+			Notification = nullptr;
+		}
+	}
+
+	DWORD CALLBACK FHidArrivalWatcher::OnNotification(HCMNOTIFICATION, PVOID Context, CM_NOTIFY_ACTION Action, PCM_NOTIFY_EVENT_DATA EventData, DWORD)
+	{
+		if (Action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL && EventData && IsSonyInterface(EventData->u.DeviceInterface.SymbolicLink))
+		{
+			static_cast<FHidArrivalWatcher*>(Context)->Arrival.Notify();
+		}
+		return ERROR_SUCCESS;
+	}
+} // namespace Ftest_windows_platform
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+#ifdef _WIN32
+#include "Timing/ServiceClock.h"
+#include <Windows.h>
+#include <cfgmgr32.h>
+
+namespace Ftest_windows_platform
+{
+	/**
+	 * @brief Notifies a wake signal when a Sony HID interface arrives, so detection runs on plug-in
+	 * instead of on a polling timer.
+	 *
+	 * Uses CM_Register_Notification, whose callbacks come from a system thread pool without any window
+	 * or message loop. Only arrivals are reported; removals show up as failed reads on the open handle.
+	 */
+	class FHidArrivalWatcher
+	{
+	public:
+		explicit FHidArrivalWatcher(GamepadCore::FServiceWakeSignal& InArrival)
+		    : Arrival(InArrival)
+		{
+		}
+		~FHidArrivalWatcher() { Unregister(); }
+
+		FHidArrivalWatcher(const FHidArrivalWatcher&) = delete;
+		FHidArrivalWatcher& operator=(const FHidArrivalWatcher&) = delete;
+
+		bool Register();
+
+		/**
+		 * @brief Stops the notifications; returns once no callback is running anymore.
+		 */
+		void Unregister();
+		bool IsRegistered() const { return Notification != nullptr; }
+
+	private:
+		static DWORD CALLBACK OnNotification(HCMNOTIFICATION Notification, PVOID Context, CM_NOTIFY_ACTION Action, PCM_NOTIFY_EVENT_DATA EventData, DWORD EventDataSize);
+
+		GamepadCore::FServiceWakeSignal& Arrival;
+		HCMNOTIFICATION Notification = nullptr;
+	};
+} // namespace Ftest_windows_platform
+#endif
@@ -1,11 +1,11 @@
 ﻿#if defined(_WIN32) && defined(USE_VIGEM)
 #include "ViGEmAdapter.h"
 #include <iostream>
-#include <algorithm>
+#include <cstring>
 
 namespace GamepadCore {
 
-ViGEmAdapter::ViGEmAdapter() {}
+ViGEmAdapter::ViGEmAdapter(EVirtualPadMode mode) : m_Mode(mode) {}
 
 ViGEmAdapter::~ViGEmAdapter() {
     Shutdown();
@@ -28,9 +28,12 @@ bool ViGEmAdapter::Initialize() {
         return false;
     }
 
-    m_Target = vigem_target_x360_alloc();
+    const bool isDs4 = m_Mode == EVirtualPadMode::DualShock4;
+    const char* targetName = isDs4 ? "DS4" : "X360";
+
+    m_Target = isDs4 ? vigem_target_ds4_alloc() : vigem_target_x360_alloc();
     if (m_Target == nullptr) {
-        std::cerr << "[ViGEm] Failed to allocate X360 Target." << std::endl;
+        std::cerr << "[ViGEm] Failed to allocate " << targetName << " Target." << std::endl;
         vigem_disconnect(m_Client);
         vigem_free(m_Client);
         m_Client = nullptr;
@@ -39,7 +42,7 @@ bool ViGEmAdapter::Initialize() {
 
     const VIGEM_ERROR addErr = vigem_target_add(m_Client, m_Target);
     if (!VIGEM_SUCCESS(addErr)) {
-        std::cerr << "[ViGEm] Failed to add X360 Target (Error: 0x" << std::hex << addErr << ")." << std::endl;
+        std::cerr << "[ViGEm] Failed to add " << targetName << " Target (Error: 0x" << std::hex << addErr << ")." << std::endl;
         vigem_target_free(m_Target);
         vigem_disconnect(m_Client);
         vigem_free(m_Client);
@@ -48,7 +51,8 @@ bool ViGEmAdapter::Initialize() {
         return false;
     }
 
-    std::cout << "[ViGEm] Virtual Xbox 360 Controller connected!" << std::endl;
+    std::cout << "[ViGEm] Virtual " << (isDs4 ? "DualShock 4" : "Xbox 360") << " Controller connected!" << std::endl;
+    RegisterRumbleNotification();
     m_Initialized = true;
     return true;
 }
@@ -56,6 +60,18 @@ bool ViGEmAdapter::Initialize() {
 void ViGEmAdapter::Shutdown() {
     if (!m_Initialized) return;
 
+    if (m_NotificationRegistered) {
+        if (m_Mode == EVirtualPadMode::DualShock4) {
+            vigem_target_ds4_unregister_notification(m_Target);
+        } else {
+            vigem_target_x360_unregister_notification(m_Target);
+        }
+        m_NotificationRegistered = false;
+        // The notification thread is gone now: make sure a rumble in progress does not keep playing.
+        // This thread is not the mailbox's poster, so it only raises the stop flag.
+        m_RumbleMailbox->RequestStop();
+    }
+
     if (m_Target) {
         vigem_target_remove(m_Client, m_Target);
         vigem_target_free(m_Target);
@@ -69,51 +85,75 @@ void ViGEmAdapter::Shutdown() {
     }
 
     m_Initialized = false;
-    std::cout << "[ViGEm] Virtual Xbox 360 Controller disconnected." << std::endl;
+    std::cout << "[ViGEm] Virtual " << (m_Mode == EVirtualPadMode::DualShock4 ? "DualShock 4" : "Xbox 360")
+              << " Controller disconnected (reports submitted: " << GetSubmittedReports()
+              << ", skipped unchanged: " << GetSkippedReports() << ")." << std::endl;
+}
+
+void ViGEmAdapter::RegisterRumbleNotification() {
+    if (!m_RumbleMailbox) return;
+
+    const VIGEM_ERROR err = m_Mode == EVirtualPadMode::DualShock4
+        ? vigem_target_ds4_register_notification(m_Client, m_Target, &ViGEmAdapter::OnDs4Notification, this)
+        : vigem_target_x360_register_notification(m_Client, m_Target, &ViGEmAdapter::OnX360Notification, this);
+
+    m_NotificationRegistered = VIGEM_SUCCESS(err);
+    if (!m_NotificationRegistered) {
+        std::cerr << "[ViGEm] Failed to register rumble notification (Error: 0x" << std::hex << err << std::dec << "). Game rumble will be ignored." << std::endl;
+    }
+}
+
+VOID CALLBACK ViGEmAdapter::OnX360Notification(PVIGEM_CLIENT, PVIGEM_TARGET, UCHAR largeMotor, UCHAR smallMotor, UCHAR, LPVOID userData) {
+    static_cast<ViGEmAdapter*>(userData)->m_RumbleMailbox->Post(largeMotor, smallMotor);
+}
+
+VOID CALLBACK ViGEmAdapter::OnDs4Notification(PVIGEM_CLIENT, PVIGEM_TARGET, UCHAR largeMotor, UCHAR smallMotor, DS4_LIGHTBAR_COLOR, LPVOID userData) {
+    static_cast<ViGEmAdapter*>(userData)->m_RumbleMailbox->Post(largeMotor, smallMotor);
 }
 
 void ViGEmAdapter::Update(const FInputContext& context) {
     if (!m_Initialized) return;
 
-    XUSB_REPORT report;
-    XUSB_REPORT_INIT(&report);
+    if (m_Mode == EVirtualPadMode::DualShock4) {
+        SubmitDs4(BuildDs4Report(context));
+        return;
+    }
 
-    // Buttons mapping
-    if (context.bCross) report.wButtons |= XUSB_GAMEPAD_A;
-    if (context.bCircle) report.wButtons |= XUSB_GAMEPAD_B;
-    if (context.bSquare) report.wButtons |= XUSB_GAMEPAD_X;
-    if (context.bTriangle) report.wButtons |= XUSB_GAMEPAD_Y;
+    const FXusbReport built = BuildXusbReport(context);
 
-    if (context.bDpadUp) report.wButtons |= XUSB_GAMEPAD_DPAD_UP;
-    if (context.bDpadDown) report.wButtons |= XUSB_GAMEPAD_DPAD_DOWN;
-    if (context.bDpadLeft) report.wButtons |= XUSB_GAMEPAD_DPAD_LEFT;
-    if (context.bDpadRight) report.wButtons |= XUSB_GAMEPAD_DPAD_RIGHT;
+    // Each update is a kernel round-trip: skip it when nothing moved since the last one
+    if (!m_ReportFilter.ShouldSubmit(built, std::chrono::steady_clock::now())) return;
 
-    if (context.bStart) report.wButtons |= XUSB_GAMEPAD_START;
-    if (context.bShare) report.wButtons |= XUSB_GAMEPAD_BACK;
+    static_assert(sizeof(XUSB_REPORT) == sizeof(FXusbReport), "FXusbReport must mirror XUSB_REPORT");
+    XUSB_REPORT report;
+    std::memcpy(&report, &built, sizeof(report));
 
-    if (context.bLeftShoulder) report.wButtons |= XUSB_GAMEPAD_LEFT_SHOULDER;
-    if (context.bRightShoulder) report.wButtons |= XUSB_GAMEPAD_RIGHT_SHOULDER;
+    if (!VIGEM_SUCCESS(vigem_target_x360_update(m_Client, m_Target, report))) {
+        m_ReportFilter.Invalidate();
+    }
+}
 
-    if (context.bLeftStick) report.wButtons |= XUSB_GAMEPAD_LEFT_THUMB;
-    if (context.bRightStick) report.wButtons |= XUSB_GAMEPAD_RIGHT_THUMB;
+void ViGEmAdapter::UpdateRaw(const FDualSenseReportView& report, const FInputContext& context) {
+    if (!m_Initialized) return;
 
-    if (context.bPSButton) report.wButtons |= XUSB_GAMEPAD_GUIDE;
+    if (m_Mode != EVirtualPadMode::DualShock4 || !report.IsValid()) {
+        Update(context);
+        return;
+    }
 
-    // Triggers (0-255)
-    report.bLeftTrigger = static_cast<BYTE>(context.LeftTriggerAnalog * 255.0f);
-    report.bRightTrigger = static_cast<BYTE>(context.RightTriggerAnalog * 255.0f);
+    SubmitDs4(BuildDs4Report(report));
+}
 
-    // Analogs (-32768 to 32767)
-    // Note: Y axis is inverted in DS compared to XInput (or vice versa depending on perspective)
-    // GamepadCore: Y is up (+1.0), down (-1.0)
-    // XInput: Y is up (+32767), down (-32768)
-    report.sThumbLX = static_cast<SHORT>(std::clamp(context.LeftAnalog.X * 32767.0f, -32768.0f, 32767.0f));
-    report.sThumbLY = static_cast<SHORT>(std::clamp(context.LeftAnalog.Y * 32767.0f, -32768.0f, 32767.0f));
-    report.sThumbRX = static_cast<SHORT>(std::clamp(context.RightAnalog.X * 32767.0f, -32768.0f, 32767.0f));
-    report.sThumbRY = static_cast<SHORT>(std::clamp(context.RightAnalog.Y * 32767.0f, -32768.0f, 32767.0f));
+void ViGEmAdapter::SubmitDs4(const FDs4ReportEx& built) {
+    if (!m_Ds4ReportFilter.ShouldSubmit(built, std::chrono::steady_clock::now())) return;
 
-    vigem_target_x360_update(m_Client, m_Target, report);
+    static_assert(sizeof(DS4_REPORT_EX) == sizeof(FDs4ReportEx), "FDs4ReportEx must mirror DS4_REPORT_EX");
+    DS4_REPORT_EX report;
+    std::memcpy(&report, &built, sizeof(report));
+
+    if (!VIGEM_SUCCESS(vigem_target_ds4_update_ex(m_Client, m_Target, report))) {
+        m_Ds4ReportFilter.Invalidate();
+    }
 }
 
 } // namespace GamepadCore
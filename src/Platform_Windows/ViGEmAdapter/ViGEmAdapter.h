@@ -4,22 +4,56 @@
 #include <windows.h>
 #include <ViGEm/Client.h>
 #include "GCore/Types/Structs/Context/InputContext.h"
+#include "Audio/RumbleBridge.h"
+#include "Config/GameProfile.h"
+#include "VirtualPad/Ds4Report.h"
+#include "VirtualPad/IVirtualGamepadSink.h"
+#include "VirtualPad/ReportChangeFilter.h"
+#include "VirtualPad/XusbReport.h"
+#include <chrono>
 
 namespace GamepadCore {
 
-class ViGEmAdapter {
+class ViGEmAdapter final : public IVirtualGamepadSink {
 public:
-    ViGEmAdapter();
-    ~ViGEmAdapter();
+    explicit ViGEmAdapter(EVirtualPadMode mode = EVirtualPadMode::Xbox360);
+    ~ViGEmAdapter() override;
 
-    bool Initialize();
-    void Shutdown();
+    bool Initialize() override;
+    void Shutdown() override;
 
-    void Update(const FInputContext& context);
+    void Update(const FInputContext& context) override;
+    const char* GetName() const override { return m_Mode == EVirtualPadMode::DualShock4 ? "ViGEm DS4" : "ViGEm X360"; }
+
+    // DS4 mode passes the raw report through so gyro, accelerometer and touchpad survive
+    bool AcceptsRawReports() const override { return m_Mode == EVirtualPadMode::DualShock4; }
+    void UpdateRaw(const FDualSenseReportView& report, const FInputContext& context) override;
+
+    // Rumble sent by the game to the virtual pad is forwarded from ViGEm's notification thread
+    void SetRumbleMailbox(FRumbleMailbox* mailbox) override { m_RumbleMailbox = mailbox; }
+
+    // Unchanged reports are resent at most once per interval (0 = never)
+    void SetKeepAliveInterval(std::chrono::milliseconds interval) {
+        m_ReportFilter.SetKeepAlive(interval);
+        m_Ds4ReportFilter.SetKeepAlive(interval);
+    }
+    uint64_t GetSubmittedReports() const { return m_ReportFilter.GetSubmittedCount() + m_Ds4ReportFilter.GetSubmittedCount(); }
+    uint64_t GetSkippedReports() const { return m_ReportFilter.GetSkippedCount() + m_Ds4ReportFilter.GetSkippedCount(); }
 
 private:
+    void SubmitDs4(const FDs4ReportEx& built);
+    void RegisterRumbleNotification();
+
+    static VOID CALLBACK OnX360Notification(PVIGEM_CLIENT client, PVIGEM_TARGET target, UCHAR largeMotor, UCHAR smallMotor, UCHAR ledNumber, LPVOID userData);
+    static VOID CALLBACK OnDs4Notification(PVIGEM_CLIENT client, PVIGEM_TARGET target, UCHAR largeMotor, UCHAR smallMotor, DS4_LIGHTBAR_COLOR lightbarColor, LPVOID userData);
+
+    EVirtualPadMode m_Mode;
+    TReportChangeFilter<FXusbReport> m_ReportFilter;
+    TReportChangeFilter<FDs4ReportEx> m_Ds4ReportFilter;
     PVIGEM_CLIENT m_Client = nullptr;
     PVIGEM_TARGET m_Target = nullptr;
+    FRumbleMailbox* m_RumbleMailbox = nullptr;
+    bool m_NotificationRegistered = false;
     bool m_Initialized = false;
 };
 
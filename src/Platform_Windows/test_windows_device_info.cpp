@@ -14,11 +14,79 @@ extern "C"
 #include "GCore/Types/Structs/Config/GamepadCalibration.h"
 #include "GCore/Types/Structs/Context/DeviceContext.h"
 #include "GImplementations/Utils/GamepadSensors.h"
+#include "Input/CalibrationCache.h"
+#include "Input/DualSenseReport.h"
+#include <algorithm>
+#include <cfgmgr32.h>
+#include <cstdio>
 #include <filesystem>
 #include <initguid.h>
 #include <setupapi.h>
 #include <vector>
 
+namespace
+{
+	bool ReadFeatureReport(HANDLE Handle, std::uint8_t* Report, std::size_t Length)
+	{
+		return HidD_GetFeature(Handle, Report, static_cast<ULONG>(Length)) != FALSE;
+	}
+
+	// Firmware info (0x20), then the calibration (0x05): what the cache needs from a Bluetooth pad
+	bool ReadFirmwareAndCalibration(HANDLE Handle, std::uint32_t& OutFirmware, std::uint8_t* Report)
+	{
+		std::uint8_t FirmwareInfo[GamepadCore::DualSenseFeatureReport::FirmwareInfoSize] = {GamepadCore::DualSenseFeatureReport::FirmwareInfoId};
+		if (ReadFeatureReport(Handle, FirmwareInfo, sizeof(FirmwareInfo)))
+		{
+			OutFirmware = GamepadCore::DualSenseFeatureReport::FirmwareFromFirmwareInfo(FirmwareInfo);
+		}
+		return ReadFeatureReport(Handle, Report, GamepadCore::DualSenseCalibrationReport::Size);
+	}
+
+	// A background read outlives the connect: it gets its own handle, which may survive a disconnection
+	HANDLE DuplicateDeviceHandle(HANDLE Handle)
+	{
+		HANDLE Duplicated = INVALID_HANDLE_VALUE;
+		if (!DuplicateHandle(GetCurrentProcess(), Handle, GetCurrentProcess(), &Duplicated, 0, FALSE, DUPLICATE_SAME_ACCESS))
+		{
+			return INVALID_HANDLE_VALUE;
+		}
+		return Duplicated;
+	}
+
+	// The HID interface of a Bluetooth pad hangs off its BTHENUM device, whose instance ID ends in the
+	// address: BTHENUM\{00001124-...}_VID&0002054c_PID&0ce6\9&73b8b28&0&A0AB51123456_C00000000
+	std::string GetBluetoothMacFromDeviceTree(const std::string& Path)
+	{
+		// \\?\hid#{...}_vid&0002054c_pid&0ce6#9&2ab36b8&7&0000#{4d1e55b2-...} -> hid\{...}_vid&..._pid&0ce6\9&2ab36b8&7&0000
+		std::string InstanceId = Path.rfind("\\\\?\\", 0) == 0 ? Path.substr(4) : Path;
+		const std::size_t InterfaceGuid = InstanceId.rfind("#{");
+		if (InterfaceGuid != std::string::npos)
+		{
+			InstanceId.resize(InterfaceGuid);
+		}
+		std::replace(InstanceId.begin(), InstanceId.end(), '#', '\\');
+
+		DEVINST Device = 0;
+		DEVINST Parent = 0;
+		char ParentId[MAX_DEVICE_ID_LEN] = {};
+		if (CM_Locate_DevNodeA(&Device, InstanceId.data(), CM_LOCATE_DEVNODE_NORMAL) != CR_SUCCESS ||
+		    CM_Get_Parent(&Parent, Device, 0) != CR_SUCCESS ||
+		    CM_Get_Device_IDA(Parent, ParentId, MAX_DEVICE_ID_LEN, 0) != CR_SUCCESS)
+		{
+			return std::string();
+		}
+
+		const std::string Id = ParentId;
+		const std::size_t Start = Id.rfind('&');
+		const std::size_t End = Id.find('_', Start == std::string::npos ? 0 : Start);
+		if (Start == std::string::npos || End == std::string::npos)
+		{
+			return std::string();
+		}
+		return GamepadCore::DualSenseFeatureReport::NormalizeMac(Id.substr(Start + 1, End - Start - 1));
+	}
+} // namespace
+
 void Ftest_windows_device_info::Detect(std::vector<FDeviceContext>& Devices)
 {
 	GUID HidGuid;
@@ -140,6 +208,11 @@ void Ftest_windows_device_info::Read(FDeviceContext* Context)
 	{
 		const size_t InputBufferSize = Context->ConnectionType == EDSDeviceConnection::Bluetooth ? 78 : 64;
 		PollTick(Context->Handle, Context->Buffer, InputBufferSize, BytesRead);
+		// Until the calibration read on the cache worker lands, a Bluetooth pad sends basic reports
+		if (Context->ConnectionType == EDSDeviceConnection::Bluetooth)
+		{
+			GamepadCore::ExpandBasicBtReport(Context->Buffer, InputBufferSize);
+		}
 	}
 }
 
@@ -284,15 +357,106 @@ void Ftest_windows_device_info::ProcessAudioHapitc(FDeviceContext* Context)
 	}
 }
 
+bool Ftest_windows_device_info::GetCalibrationKey(const FDeviceContext* Context, GamepadCore::FCalibrationKey& OutKey)
+{
+	using namespace GamepadCore::DualSenseFeatureReport;
+	HIDD_ATTRIBUTES Attributes = {};
+	Attributes.Size = sizeof(HIDD_ATTRIBUTES);
+	if (!HidD_GetAttributes(Context->Handle, &Attributes))
+	{
+		return false;
+	}
+
+	std::string Mac;
+	OutKey.Firmware = GamepadCore::FCalibrationKey::AnyFirmware;
+	if (Context->ConnectionType == EDSDeviceConnection::Bluetooth)
+	{
+		// The Bluetooth HID driver reports the address as the serial number; the device tree has it too
+		wchar_t Serial[128] = {};
+		if (HidD_GetSerialNumberString(Context->Handle, Serial, sizeof(Serial)))
+		{
+			Mac = NormalizeMac(std::filesystem::path(Serial).string());
+		}
+		if (Mac.empty())
+		{
+			Mac = GetBluetoothMacFromDeviceTree(Context->Path);
+		}
+	}
+	else
+	{
+		std::uint8_t PairingInfo[PairingInfoSize] = {PairingInfoId};
+		std::uint8_t FirmwareInfo[FirmwareInfoSize] = {FirmwareInfoId};
+		if (ReadFeatureReport(Context->Handle, PairingInfo, sizeof(PairingInfo)) && ReadFeatureReport(Context->Handle, FirmwareInfo, sizeof(FirmwareInfo)))
+		{
+			Mac = MacFromPairingInfo(PairingInfo);
+			OutKey.Firmware = FirmwareFromFirmwareInfo(FirmwareInfo);
+		}
+	}
+	if (Mac.empty())
+	{
+		return false;
+	}
+
+	char Id[64];
+	std::snprintf(Id, sizeof(Id), "%04X:%04X:%s", Attributes.VendorID, Attributes.ProductID, Mac.c_str());
+	OutKey.DeviceId = Id;
+	return true;
+}
+
 void Ftest_windows_device_info::ConfigureFeatures(FDeviceContext* Context)
 {
 	unsigned char FeatureBuffer[41] = {0};
 	std::memset(FeatureBuffer, 0, sizeof(FeatureBuffer));
 
-	FeatureBuffer[0] = 0x05;
-	if (!HidD_GetFeature(Context->Handle, FeatureBuffer, 41))
+	// O report 0x05 é uma ida e volta bloqueante ao controle (lenta no BT): vem do cache quando possível.
+	// No BT a leitura é o que tira o controle do report básico 0x01: com o cache ela roda num worker,
+	// com um handle duplicado, e os reports básicos viram reports completos sem sensores até ela chegar
+	GamepadCore::FCalibrationKey Key;
+	const bool bHasKey = GetCalibrationKey(Context, Key);
+	const HANDLE DeviceHandle = Context->Handle;
+	GamepadCore::FCalibrationCache& Cache = GamepadCore::FCalibrationCache::Get();
+	bool bResolved = false;
+	if (Context->ConnectionType == EDSDeviceConnection::Bluetooth)
+	{
+		bResolved = Cache.ResolveFromDevice(bHasKey ? &Key : nullptr, FeatureBuffer,
+		    [DeviceHandle](std::uint32_t& OutFirmware, std::uint8_t* Report) { return ReadFirmwareAndCalibration(DeviceHandle, OutFirmware, Report); },
+		    [DeviceHandle]() -> GamepadCore::FCalibrationCache::FReadDevice
+		    {
+			    const HANDLE ReadHandle = DuplicateDeviceHandle(DeviceHandle);
+			    if (ReadHandle == INVALID_HANDLE_VALUE)
+			    {
+				    return nullptr;
+			    }
+			    return [ReadHandle](std::uint32_t& OutFirmware, std::uint8_t* Report)
+			    {
+				    const bool bRead = ReadFirmwareAndCalibration(ReadHandle, OutFirmware, Report);
+				    CloseHandle(ReadHandle);
+				    return bRead;
+			    };
+		    });
+	}
+	else
+	{
+		bResolved = Cache.Resolve(bHasKey ? &Key : nullptr, FeatureBuffer,
+		    [DeviceHandle](std::uint8_t* Report) { return ReadFeatureReport(DeviceHandle, Report, GamepadCore::DualSenseCalibrationReport::Size); },
+		    [DeviceHandle]() -> GamepadCore::FCalibrationCache::FReadFeature
+		    {
+			    const HANDLE RefreshHandle = DuplicateDeviceHandle(DeviceHandle);
+			    if (RefreshHandle == INVALID_HANDLE_VALUE)
+			    {
+				    return nullptr;
+			    }
+			    return [RefreshHandle](std::uint8_t* Report)
+			    {
+				    const bool bRead = ReadFeatureReport(RefreshHandle, Report, GamepadCore::DualSenseCalibrationReport::Size);
+				    CloseHandle(RefreshHandle);
+				    return bRead;
+			    };
+		    });
+	}
+
+	if (!bResolved)
 	{
-		const unsigned long Error = GetLastError();
 		return;
 	}
 
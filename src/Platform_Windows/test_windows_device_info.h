@@ -9,6 +9,11 @@
 #include "GCore/Types/Structs/Context/DeviceContext.h"
 #include <Windows.h>
 
+namespace GamepadCore
+{
+	struct FCalibrationKey;
+}
+
 /**
  * @brief Enumerates the possible outcomes of a polling operation in HID device communication.
  *
@@ -46,6 +51,19 @@ public:
 	 * @return A boolean indicating whether the Bluetooth feature configuration was successful (true) or failed (false).
 	 */
 	static void ConfigureFeatures(FDeviceContext* Context);
+	/**
+	 * @brief Builds the calibration cache key of an open device: VID/PID, controller MAC and firmware.
+	 *
+	 * On USB the MAC comes from the pairing info feature report (0x09) and the firmware version from
+	 * the firmware info report (0x20), both cheap there. On Bluetooth, where every feature read is a
+	 * slow round trip, the MAC comes from the serial number string or the Bluetooth device instance
+	 * and the firmware is left as AnyFirmware; the cache worker reads it with the calibration.
+	 *
+	 * @param Context Device context with an open handle, its path and connection type.
+	 * @param OutKey Receives the key.
+	 * @return False when the MAC could not be found; the calibration is then never cached.
+	 */
+	static bool GetCalibrationKey(const FDeviceContext* Context, GamepadCore::FCalibrationKey& OutKey);
 	/**
 	 * @brief Reads data from the specified HID device context.
 	 *
@@ -6,7 +6,9 @@
 #ifdef BUILD_GAMEPAD_CORE_TESTS
 #include "GCore/Templates/TGenericHardwareInfo.h"
 #include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "AudioEndpointCache/AudioEndpointCache.h"
 #include "test_windows_device_info.h"
+#include <memory>
 #include <string>
 
 namespace Ftest_windows_platform
@@ -50,9 +52,9 @@ namespace Ftest_windows_platform
 		/**
 		 * @brief Initializes the audio device for a DualSense controller.
 		 *
-		 * Enumerates available audio playback devices, searches for one matching
-		 * the DualSense controller (by name containing "DualSense" or "Wireless Controller"),
-		 * and initializes the FAudioDeviceContext with the found device.
+		 * Looks up the playback device matching the DualSense controller (by name containing "DualSense"
+		 * or "Wireless Controller") through the process-wide endpoint cache, so reconnects only enumerate
+		 * again after an audio device change, and initializes the FAudioDeviceContext with it.
 		 *
 		 * @param Context The device context to store the audio device in
 		 */
@@ -63,57 +65,24 @@ namespace Ftest_windows_platform
 				return;
 			}
 
-			// Initialize miniaudio context for device enumeration
-			ma_context maContext;
-			if (ma_context_init(nullptr, 0, nullptr, &maContext) != MA_SUCCESS)
-			{
-				return;
-			}
-
-			// Get playback devices
-			ma_device_info* pPlaybackInfos;
-			ma_uint32 playbackCount;
-			ma_device_info* pCaptureInfos;
-			ma_uint32 captureCount;
-
-			if (ma_context_get_devices(&maContext, &pPlaybackInfos, &playbackCount, &pCaptureInfos, &captureCount) != MA_SUCCESS)
-			{
-				ma_context_uninit(&maContext);
-				return;
-			}
-
-			// Search for DualSense audio device
-			ma_device_id* pFoundDeviceId = nullptr;
+			FAudioEndpointCache& AudioEndpoints = FAudioEndpointCache::Get();
 			ma_device_id foundDeviceId;
-
-			for (ma_uint32 i = 0; i < playbackCount; i++)
-			{
-				std::string deviceName(pPlaybackInfos[i].name);
-
-				// Check if device name contains DualSense identifiers
-				// DualSense appears as "Wireless Controller" or "DualSense Wireless Controller"
-				if (deviceName.find("DualSense") != std::string::npos ||
-				    deviceName.find("Wireless Controller") != std::string::npos)
-				{
-					// Verify it has 4 channels (stereo + haptic L/R)
-					// DualSense audio device typically has 4 channels for haptics
-					foundDeviceId = pPlaybackInfos[i].id;
-					pFoundDeviceId = &foundDeviceId;
-					break;
-				}
-			}
+			const bool bFound = AudioEndpoints.FindDualSenseDevice(foundDeviceId);
 
 			// Initialize audio context with found device (or default if not found)
 			Context->AudioContext = std::make_shared<FAudioDeviceContext>();
 
-			if (pFoundDeviceId)
+			if (bFound)
 			{
 				// Initialize with specific DualSense device
 				// DualSense haptics use 4 channels at 48000 Hz
-				Context->AudioContext->InitializeWithDeviceId(pFoundDeviceId, 48000, 4);
+				Context->AudioContext->InitializeWithDeviceId(&foundDeviceId, 48000, 4);
+				if (!Context->AudioContext->IsValid())
+				{
+					// The cached endpoint went away without a notification reaching us
+					AudioEndpoints.Invalidate();
+				}
 			}
-
-			ma_context_uninit(&maContext);
 		}
 	};
 } // namespace Ftest_windows_platform
@@ -0,0 +1,613 @@
+#include "GamepadService.h"
+#include "Diagnostics/FrameTrace.h"
+#include "GCore/Interfaces/IPlatformHardwareInfo.h"
+#include "Input/CalibrationCache.h"
+#include "Input/DualSenseReport.h"
+#include "logger.h"
+#include <chrono>
+#include <cstdlib>
+
+namespace GamepadCore
+{
+	namespace
+	{
+		// Without arrival notifications: interval between detection attempts (polling)
+		constexpr std::chrono::milliseconds kDetectionInterval(200);
+		// With notifications detection runs on arrival; the timeout only covers a lost notification
+		constexpr std::chrono::milliseconds kArrivalFallbackInterval(2000);
+		// Periodic resend of the settings (LED, triggers), ~100 Bluetooth reports
+		constexpr std::chrono::milliseconds kSettingsResendInterval(400);
+		// On USB UpdateInput is not called and nothing blocks the loop: fixed polling cadence
+		constexpr std::chrono::milliseconds kUsbPollInterval(1);
+		// Impacts queued while the controller was disconnected do not become late kicks
+		constexpr std::int64_t kTelemetryImpactMaxAgeNs = 100000000;
+		constexpr std::chrono::milliseconds kUsbHapticsTick(16);
+		// A Bluetooth block is 1024 frames (~21 ms); short wait until the next one is ready
+		constexpr std::chrono::milliseconds kBtHapticsIdleWait(1);
+
+		bool IsEnvironmentFlagSet(const char* Name)
+		{
+			const char* Setting = std::getenv(Name);
+			return Setting && Setting[0] == '1';
+		}
+
+		void ApplyGamepadSettings(ISonyGamepad* Gamepad)
+		{
+			Gamepad->DualSenseSettings(1, 1, 1, 0, 30, 0xFC, 0x00, 0x00);
+			Gamepad->SetLightbar({200, 160, 80});
+		}
+	} // namespace
+
+	FGamepadServiceSettings FGamepadServiceSettings::FromEnvironment()
+	{
+		FGamepadServiceSettings Settings;
+		Settings.bPhaseAlign = IsEnvironmentFlagSet("DUALSENSE_MOD_PHASE_ALIGN");
+		Settings.bTriggerTilt = IsEnvironmentFlagSet("DUALSENSE_MOD_TRIGGER_TILT");
+		Settings.bInputHaptics = IsEnvironmentFlagSet("DUALSENSE_MOD_INPUT_HAPTICS");
+		return Settings;
+	}
+
+	FGamepadService::FGamepadService()
+	    : PushedPcmInput(HapticPcmInput.GetRing())
+	    , SourcePipelineInput(HapticSources.GetRing())
+	    , HapticEventSynth(HapticEventQueue)
+	    , EffectSynthInput(HapticEventSynth.GetEffectBank())
+	    , RumbleSynthInput(HapticEventSynth.GetRumbleBank())
+	{
+	}
+
+	void FGamepadService::SetGameProfile(const FGameProfile& Profile)
+	{
+		GameProfile = Profile;
+		LeftStickCurve.Compile(GameProfile.LeftStick);
+		RightStickCurve.Compile(GameProfile.RightStick);
+	}
+
+	void FGamepadService::OnCapture(const float* Interleaved, std::size_t Frames)
+	{
+		// The capture device keeps running; a block only becomes haptics if the current source is the loopback
+		const std::size_t FramesRendered = HapticSources.OnCapture(Interleaved, Frames);
+
+		GAMEPAD_TRACE_THREAD(Capture);
+		GAMEPAD_TRACE_INSTANT(AudioBlockCaptured, FramesRendered);
+		CapturedFrames.fetch_add(FramesRendered, std::memory_order_relaxed);
+	}
+
+	void FGamepadService::PostHapticEvent(EHapticEventType Type, float Value0, float Value1, std::int64_t PostedNs)
+	{
+		FHapticEvent Event;
+		Event.Type = Type;
+		Event.Values[0] = Value0;
+		Event.Values[1] = Value1;
+		Event.PostedNs = PostedNs;
+		HapticEventQueue.Push(Event);
+	}
+
+	void FGamepadService::InitializeHapticBus()
+	{
+		if (HapticBus.GetInputCount() > 0)
+		{
+			return;
+		}
+		// Game PCM (already equalized) only ducks the current source, usually the loopback carrying the same audio
+		HapticBus.AddInput(&PushedPcmInput, {1.0f, 2, 0.0f, false, HapticSourceGroup, HapticSourceGroup});
+		// Clips go through the mixer EQ and duck the current source by half
+		HapticBus.AddInput(&HapticClip, {1.0f, 1, 0.5f, true, HapticEffectGroup, HapticSourceGroup});
+		// Cache clips come out equalized and limited already, with the same ducking as live clips
+		CachedClipInputIndex = HapticBus.AddInput(&CachedClipInput, {1.0f, 1, 0.5f, false, HapticEffectGroup, HapticSourceGroup});
+		HapticBus.AddInput(&SourcePipelineInput, {1.0f, 0, 1.0f, false, HapticSourceGroup});
+		// Synth voices without EQ, like the rumble before them; they only render while sounding
+		HapticBus.AddInput(&EffectSynthInput, {1.0f, 0, 1.0f, false, HapticEffectGroup});
+		HapticBus.AddInput(&RumbleSynthInput, {1.0f, 0, 1.0f, false, HapticEffectGroup});
+	}
+
+	void FGamepadService::InitializeHapticClipCache(const std::string& Directory)
+	{
+		std::call_once(HapticClipCacheDirectoryOnce, [this, &Directory] { HapticClipCache.SetDirectory(Directory); });
+	}
+
+	bool FGamepadService::InitializeTelemetry(const char* Name)
+	{
+		std::call_once(TelemetryOnce, [this, Name] { bTelemetryCreated = Telemetry.Create(Name); });
+		return bTelemetryCreated;
+	}
+
+	std::uint32_t FGamepadService::PublishRegisteredHapticClip(const FEncodedHapticClip* Usb, const FEncodedHapticClip* Bluetooth)
+	{
+		if (!Usb || !Bluetooth)
+		{
+			return 0;
+		}
+
+		std::lock_guard<std::mutex> Lock(HapticClipRegistrationMutex);
+		const std::uint32_t Count = RegisteredHapticClipCount.load(std::memory_order_relaxed);
+		for (std::uint32_t i = 0; i < Count; ++i)
+		{
+			if (RegisteredHapticClips[i].Usb == Usb && RegisteredHapticClips[i].Bluetooth == Bluetooth)
+			{
+				return i + 1;
+			}
+		}
+		if (Count == MaxRegisteredHapticClips)
+		{
+			GAMEPAD_LOG_ERROR("[AppDLL] Haptic clip registry full ({} clips).", MaxRegisteredHapticClips);
+			return 0;
+		}
+		RegisteredHapticClips[Count] = FRegisteredHapticClip{Usb, Bluetooth};
+		RegisteredHapticClipCount.store(Count + 1, std::memory_order_release);
+		return Count + 1;
+	}
+
+	std::uint32_t FGamepadService::RegisterHapticClipFrames(std::uint64_t ContentHash, const float* Interleaved, std::size_t Frames, float Gain)
+	{
+		const FEncodedHapticClip* Clips[2] = {};
+		const EHapticTransport Transports[2] = {EHapticTransport::Usb, EHapticTransport::Bluetooth};
+		for (int i = 0; i < 2; ++i)
+		{
+			Clips[i] = HapticClipCache.Find(ContentHash, Transports[i], Gain);
+			if (!Clips[i] && Interleaved)
+			{
+				Clips[i] = HapticClipCache.Render(ContentHash, Interleaved, Frames, Transports[i], Gain);
+			}
+		}
+		return PublishRegisteredHapticClip(Clips[0], Clips[1]);
+	}
+
+	bool FGamepadService::PlayCachedHapticClip(std::uint32_t ClipId)
+	{
+		if (ClipId == 0 || ClipId > RegisteredHapticClipCount.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		CachedClipRequests.Publish(ClipId);
+		return true;
+	}
+
+	void FGamepadTriggerSink::WriteTrigger(ETriggerSide Side, const FTriggerEffectBytes& Bytes)
+	{
+		auto Trigger = Gamepad ? Gamepad->GetIGamepadTrigger() : nullptr;
+		if (!Trigger)
+		{
+			return;
+		}
+		const EDSGamepadHand Hand = Side == ETriggerSide::Left ? EDSGamepadHand::Left : EDSGamepadHand::Right;
+		if (Bytes.IsOff())
+		{
+			Trigger->StopTrigger(Hand);
+			return;
+		}
+		// Zone 0 / full level = SetResistance(0, 0xff), the fixed effect from before
+		Trigger->SetResistance(static_cast<std::uint8_t>(Bytes.Zone * 255 / FTriggerEffectBytes::MaxZone), static_cast<std::uint8_t>(Bytes.Level * 255 / FTriggerEffectBytes::MaxLevel), Hand);
+	}
+
+	FInputLoop::FInputLoop(FGamepadService& InService, FServiceDeviceRegistry& InRegistry, const FGamepadServiceSettings& InSettings)
+	    : Service(InService)
+	    , Registry(InRegistry)
+	    , Settings(InSettings)
+	{
+		const std::int64_t NowNs = IServiceClock::Get().NowNs();
+		for (ETriggerSide Side : {ETriggerSide::Left, ETriggerSide::Right})
+		{
+			BaseTriggerEffects[static_cast<std::size_t>(Side)] = TriggerEngine.Play(Settings.bTriggerTilt ? TriggerEffects::Inclination(Side, 0.25f, 1.0f) : TriggerEffects::Constant(Side, 0.0f, 1.0f), NowNs);
+		}
+		LastDetectionNs = NowNs;
+		GAMEPAD_LOG_INFO("[AppDLL] Input Loop Started.");
+	}
+
+	FInputLoop::~FInputLoop()
+	{
+		Service.AttachedGamepad.store(nullptr, std::memory_order_release);
+		if (ReportClock.GetLatency().GetCount() > 0)
+		{
+			const FReportTimingMetrics& Timing = ReportClock.GetMetrics();
+			ReportClock.GetLatency().Print("Input");
+			GAMEPAD_LOG_INFO("[AppDLL] Input reports: {} received, {} dropped, jitter {} us, clock skew {} ppm", Timing.Reports, Timing.DroppedReports, Timing.JitterNs / 1000, Timing.ClockSkewPpm);
+		}
+		GAMEPAD_LOG_INFO("[AppDLL] Trigger effects: {} writes in {} ticks", TriggerEngine.GetWriteCount(), TriggerEngine.GetTickCount());
+		GAMEPAD_LOG_INFO("[AppDLL] Input Loop Stopped.");
+	}
+
+	void FInputLoop::Run()
+	{
+		while (Service.IsRunning())
+		{
+			Tick();
+		}
+	}
+
+	void FInputLoop::Tick()
+	{
+		GAMEPAD_TRACE_THREAD(Input);
+		IServiceClock& Clock = IServiceClock::Get();
+		const float DeltaTime = 0.0166f;
+		ISonyGamepad* Gamepad = Registry.GetLibrary(0);
+		if (!Gamepad)
+		{
+			// Read before detecting: an arrival during PlugAndPlay wakes the sleep below right away
+			ArrivalGeneration = Service.DeviceArrival.GetGeneration();
+			const std::int64_t DetectionNs = Clock.NowNs();
+			Registry.PlugAndPlay(static_cast<float>(DetectionNs - LastDetectionNs) / 1e9f);
+			LastDetectionNs = DetectionNs;
+			Gamepad = Registry.GetLibrary(0);
+		}
+
+		if (Gamepad != AttachedGamepad)
+		{
+			AttachedGamepad = Gamepad;
+			Service.AttachedGamepad.store(Gamepad, std::memory_order_release);
+			if (Gamepad)
+			{
+				Service.StartupMetrics.MarkDeviceAttached();
+				FrameCounter = 0;
+				NextSettingsNs = 0;
+				Motion.Reset();
+				ReportClock.Reset();
+				TriggerSink.Gamepad = Gamepad;
+			}
+		}
+
+		if (!Gamepad)
+		{
+			if (Clock.NowNs() >= NextWaitLogNs)
+			{
+				GAMEPAD_LOG_INFO("[AppDLL] Waiting for controller connection via USB/BT (ID {})...", Registry.Policy.deviceId);
+				NextWaitLogNs = Clock.NowNs() + std::chrono::nanoseconds(std::chrono::seconds(5)).count();
+			}
+			const bool bNotified = Service.bArrivalNotifications.load(std::memory_order_acquire);
+			const std::chrono::nanoseconds Wait = bNotified ? std::chrono::nanoseconds(kArrivalFallbackInterval) : std::chrono::nanoseconds(kDetectionInterval);
+			if (Clock.SleepUntilNs(Clock.NowNs() + Wait.count(), Service.DeviceArrival, ArrivalGeneration))
+			{
+				Registry.RequestImmediateDetection();
+			}
+			return;
+		}
+
+		if (Clock.NowNs() >= NextSettingsNs)
+		{
+			GAMEPAD_TRACE_SCOPE(OutputWrite, FrameCounter);
+			ApplyGamepadSettings(Gamepad);
+			TriggerEngine.Invalidate(); // triggers resent with the next tick
+			Gamepad->UpdateOutput();
+			NextSettingsNs = Clock.NowNs() + std::chrono::nanoseconds(kSettingsResendInterval).count();
+		}
+
+		if (Gamepad->GetConnectionType() == EDSDeviceConnection::Bluetooth)
+		{
+			GAMEPAD_TRACE_SCOPE(InputReportReceived, FrameCounter);
+			Gamepad->UpdateInput(DeltaTime);
+		}
+		else if (Settings.bPhaseAlign)
+		{
+			Clock.SleepUntilNs(ReportClock.GetNextPollNs(Clock.NowNs(), std::chrono::nanoseconds(kUsbPollInterval).count()));
+		}
+		else
+		{
+			Clock.SleepFor(kUsbPollInterval);
+		}
+		const std::int64_t ReceiveNs = Clock.NowNs();
+
+		FDeviceContext* DeviceContext = Gamepad->IsConnected() ? Gamepad->GetMutableDeviceContext() : nullptr;
+		FInputContext* CurrentState = DeviceContext ? DeviceContext->GetInputState() : nullptr;
+		if (CurrentState)
+		{
+			Service.InputState.Publish(*CurrentState);
+			GAMEPAD_TRACE_INSTANT(InputDecoded, FrameCounter);
+			Service.StartupMetrics.MarkFirstInputReport();
+			if (DeviceContext->DeviceType != EDSDeviceType::DualShock4)
+			{
+				ProcessDualSenseReport(Gamepad, DeviceContext, *CurrentState, ReceiveNs);
+			}
+			ForwardToVirtualPad(Gamepad, DeviceContext);
+		}
+		else if (!Gamepad->IsConnected() && ++NullGamepadTicks % 60 == 0)
+		{
+			GAMEPAD_LOG_WARNING("[AppDLL] Gamepad Object is NULL for ID {}", Registry.Policy.deviceId);
+		}
+
+		FrameCounter++;
+	}
+
+	void FInputLoop::ProcessDualSenseReport(ISonyGamepad* Gamepad, FDeviceContext* DeviceContext, const FInputContext& CurrentState, std::int64_t ReceiveNs)
+	{
+		// New calibration on every CreateHandle (cache or feature report)
+		const std::uint64_t CalibrationGeneration = FCalibrationCache::Get().GetResolvedGeneration();
+		if (CalibrationGeneration != MotionCalibrationGeneration)
+		{
+			FCalibrationCache::FReport CalibrationReport;
+			MotionCalibrationGeneration = FCalibrationCache::Get().GetResolvedReport(CalibrationReport);
+			Motion.SetCalibration(FMotionCalibration::FromReport(CalibrationReport));
+		}
+
+		const bool bBluetooth = Gamepad->GetConnectionType() == EDSDeviceConnection::Bluetooth;
+		const FDualSenseReportView SensorReport = FDualSenseReportView::FromBuffer(DeviceContext->Buffer, sizeof(DeviceContext->Buffer), bBluetooth);
+		ReportClock.SetPolled(!bBluetooth);
+		if (SensorReport.IsValid() && ReportClock.OnReport(SensorReport.GetSensorTimestamp(), SensorReport.GetSequence(), ReceiveNs))
+		{
+			Service.ReportTiming.Publish(ReportClock.GetMetrics());
+		}
+		if (SensorReport.IsValid() && Motion.Process(SensorReport))
+		{
+			Service.MotionState.Publish(Motion.GetState());
+		}
+
+		// Game telemetry: the board state feeds the effects, impacts become kicks
+		FTelemetryRecord Telemetry[64];
+		const std::size_t TelemetryCount = Service.Telemetry.Drain(Telemetry, 64);
+		for (std::size_t i = 0; i < TelemetryCount; ++i)
+		{
+			const FTelemetryRecord& Record = Telemetry[i];
+			if (Record.Type == static_cast<std::uint16_t>(ETelemetryType::BoardState))
+			{
+				TriggerInputs.BoardPitch = Record.Values[0];
+				TriggerInputs.BoardRoll = Record.Values[1];
+				TriggerInputs.BoardSpeed = Record.Values[2];
+				TriggerInputs.TruckTightness = Record.Values[3];
+				Service.PostHapticEvent(EHapticEventType::BoardState, Record.Values[2], 0.0f, ReceiveNs);
+				if (!bBoardTelemetry)
+				{
+					// From the first board state on, the resistance follows the game's curve
+					bBoardTelemetry = true;
+					for (ETriggerSide Side : {ETriggerSide::Left, ETriggerSide::Right})
+					{
+						TriggerEngine.Stop(BaseTriggerEffects[static_cast<std::size_t>(Side)]);
+						BaseTriggerEffects[static_cast<std::size_t>(Side)] = TriggerEngine.Play(TriggerEffects::BoardLean(Side, 0.2f, 1.0f), ReceiveNs);
+					}
+				}
+			}
+			else if (Record.Type == static_cast<std::uint16_t>(ETelemetryType::Impact) && ReceiveNs - Record.TimestampNs < kTelemetryImpactMaxAgeNs)
+			{
+				const float KickSeconds = Record.Values[1] > 0.0f ? Record.Values[1] / 4.0f : 0.05f;
+				TriggerEngine.Play(TriggerEffects::ImpactKick(ETriggerSide::Left, Record.Values[0], KickSeconds), ReceiveNs);
+				TriggerEngine.Play(TriggerEffects::ImpactKick(ETriggerSide::Right, Record.Values[0], KickSeconds), ReceiveNs);
+				Service.PostHapticEvent(EHapticEventType::Impact, Record.Values[0], Record.Values[1], ReceiveNs);
+			}
+			else if (Record.Type == static_cast<std::uint16_t>(ETelemetryType::Grind))
+			{
+				Service.PostHapticEvent(EHapticEventType::Grind, Record.Values[0], Record.Values[1], ReceiveNs);
+			}
+		}
+
+		if (Settings.bInputHaptics)
+		{
+			FHapticInputSample HapticSample;
+			HapticSample.LeftX = CurrentState.LeftAnalog.X;
+			HapticSample.LeftY = CurrentState.LeftAnalog.Y;
+			HapticSample.RightX = CurrentState.RightAnalog.X;
+			HapticSample.RightY = CurrentState.RightAnalog.Y;
+			HapticSample.LeftTrigger = CurrentState.LeftTriggerAnalog;
+			HapticSample.RightTrigger = CurrentState.RightTriggerAnalog;
+			HapticDetector.Process(HapticSample, ReceiveNs, Service.HapticEventQueue);
+		}
+
+		TriggerInputs.Pitch = Motion.GetState().Pitch;
+		TriggerInputs.Roll = Motion.GetState().Roll;
+		TriggerInputs.LeftTrigger = CurrentState.LeftTriggerAnalog;
+		TriggerInputs.RightTrigger = CurrentState.RightTriggerAnalog;
+		if (TriggerEngine.Tick(ReceiveNs, TriggerInputs, TriggerSink) > 0)
+		{
+			GAMEPAD_TRACE_SCOPE(OutputWrite, FrameCounter);
+			Gamepad->UpdateOutput();
+		}
+	}
+
+	void FInputLoop::ForwardToVirtualPad(ISonyGamepad* Gamepad, FDeviceContext* DeviceContext)
+	{
+		IVirtualGamepadSink* VirtualPad = Service.VirtualPad.load(std::memory_order_acquire);
+		if (!VirtualPad)
+		{
+			return;
+		}
+		VirtualPad->PollFeedback();
+		if (Gamepad->GetConnectionType() != EDSDeviceConnection::Bluetooth)
+		{
+			return;
+		}
+
+		GAMEPAD_TRACE_SCOPE(VirtualPadSubmit, FrameCounter);
+		// The feeder reads the published snapshot like any other reader, not the device state
+		FInputContext PadState;
+		Service.InputState.Snapshot(PadState);
+		if (VirtualPad->AcceptsRawReports() && DeviceContext->DeviceType != EDSDeviceType::DualShock4)
+		{
+			const FDualSenseReportView RawReport = FDualSenseReportView::FromBuffer(DeviceContext->Buffer, sizeof(DeviceContext->Buffer), true);
+			VirtualPad->UpdateRaw(RawReport, PadState);
+		}
+		else
+		{
+			// Deadzones and curves only apply to the virtual pad; the published state stays raw
+			ApplyStickCurves(Service.LeftStickCurve, Service.RightStickCurve, PadState.LeftAnalog.X, PadState.LeftAnalog.Y, PadState.RightAnalog.X, PadState.RightAnalog.Y);
+			VirtualPad->Update(PadState);
+		}
+	}
+
+	FHapticsLoop::FHapticsLoop(FGamepadService& InService, IHapticCaptureDevice& InCapture)
+	    : Service(InService)
+	    , Capture(InCapture)
+	{
+		GAMEPAD_LOG_INFO("[AppDLL] Audio Loop Started.");
+		Service.InitializeHapticBus();
+		// The capture device does not depend on the controller: it is created now, in parallel with the detection
+		Capture.Initialize();
+	}
+
+	FHapticsLoop::~FHapticsLoop()
+	{
+		Capture.Shutdown();
+		if (Service.RumbleBridge.GetLatency().GetCount() > 0)
+		{
+			Service.RumbleBridge.GetLatency().Print("Rumble");
+		}
+		GAMEPAD_LOG_INFO("[AppDLL] Audio Loop Stopped.");
+	}
+
+	void FHapticsLoop::Run()
+	{
+		while (Service.IsRunning())
+		{
+			Tick();
+		}
+	}
+
+	void FHapticsLoop::Tick()
+	{
+		GAMEPAD_TRACE_THREAD(Audio);
+		ISonyGamepad* Gamepad = Service.GetAttachedGamepad();
+		IGamepadAudioHaptics* AudioHaptics = Gamepad && Gamepad->IsConnected() ? Gamepad->GetIGamepadHaptics() : nullptr;
+		if (AudioHaptics)
+		{
+			const EDSDeviceConnection Connection = Gamepad->GetConnectionType();
+			const bool bIsWireless = Connection == EDSDeviceConnection::Bluetooth;
+			if (Gamepad != PreparedGamepad || Connection != PreparedConnection)
+			{
+				GAMEPAD_LOG_INFO("[AppDLL] Preparing Haptics for {}...", bIsWireless ? "Bluetooth" : "USB");
+
+				FDeviceContext* Context = Gamepad->GetMutableDeviceContext();
+				if (!bIsWireless && Context && (!Context->AudioContext || !Context->AudioContext->IsValid()))
+				{
+					IPlatformHardwareInfo::Get().InitializeAudioDevice(Context);
+				}
+
+				PreparedGamepad = Gamepad;
+				PreparedConnection = Connection;
+			}
+
+			if (!bCaptureStarted && Capture.Initialize())
+			{
+				bCaptureStarted = Capture.Start();
+				if (bCaptureStarted)
+				{
+					GAMEPAD_LOG_INFO("[AppDLL] Audio Loopback Started.");
+				}
+				else
+				{
+					GAMEPAD_LOG_ERROR("[AppDLL] Failed to start audio device.");
+				}
+			}
+
+			ConsumeHapticsQueue(AudioHaptics, bIsWireless);
+			return;
+		}
+
+		if (PreparedGamepad)
+		{
+			PreparedGamepad = nullptr;
+			GAMEPAD_LOG_INFO("[AppDLL] Haptics paused (Controller Disconnected), loopback kept running.");
+		}
+
+		// Keep only the latest audio for the reconnect, bounding the accumulated latency
+		IServiceClock& Clock = IServiceClock::Get();
+		Service.HapticSources.Pump(Clock.NowNs());
+		Service.HapticSources.GetRing().TrimTo(FHapticEncoder::MaxSwitchBacklogFrames);
+		Service.HapticPcmInput.GetRing().TrimTo(FHapticEncoder::MaxSwitchBacklogFrames);
+		Clock.SleepFor(kUsbHapticsTick);
+	}
+
+	void FHapticsLoop::HandCachedClipToMixer()
+	{
+		// Direct sending stops and the rest of the clip continues through the mixer, from what was already sent
+		if (CachedClipPlayer.IsPlaying() && PlayingCachedClip)
+		{
+			Service.CachedClipInput.Play(PlayingCachedClip->Usb, CachedClipPlayer.GetSentFrames());
+		}
+		CachedClipPlayer.Stop();
+	}
+
+	void FHapticsLoop::ServeCachedClipRequests(bool bIsWireless, std::int64_t NowNs)
+	{
+		// Pre-encoded clip requested by the game: nothing is rendered here, only pointers change
+		std::uint32_t RequestedClip = 0;
+		const std::uint64_t ClipRequests = Service.CachedClipRequests.Snapshot(RequestedClip);
+		const bool bLiveMixActive = Service.HapticBus.IsAnyInputActive(Service.CachedClipInputIndex);
+		if (ClipRequests != SeenCachedClipRequests)
+		{
+			SeenCachedClipRequests = ClipRequests;
+			CachedClipPlayer.Stop();
+			Service.CachedClipInput.Stop();
+			PlayingCachedClip = nullptr;
+			if (RequestedClip > 0 && RequestedClip <= Service.RegisteredHapticClipCount.load(std::memory_order_acquire))
+			{
+				PlayingCachedClip = &Service.RegisteredHapticClips[RequestedClip - 1];
+				if (bLiveMixActive)
+				{
+					// Same behavior as PlayGamepadHapticClip: added to the mix, ducking the current source
+					Service.CachedClipInput.Play(PlayingCachedClip->Usb);
+				}
+				else
+				{
+					CachedClipPlayer.Play(bIsWireless ? PlayingCachedClip->Bluetooth : PlayingCachedClip->Usb, NowNs);
+				}
+			}
+		}
+		else if (bLiveMixActive)
+		{
+			// Something live started playing (rumble, game PCM, loopback...): it must not be dropped
+			HandCachedClipToMixer();
+		}
+	}
+
+	void FHapticsLoop::ConsumeHapticsQueue(IGamepadAudioHaptics* AudioHaptics, bool bIsWireless)
+	{
+		// Hot encoder switch: audio already captured goes to the new transport, the capture is not restarted
+		if (Encoder.SetTransport(bIsWireless ? EHapticTransport::Bluetooth : EHapticTransport::Usb, Service.HapticSources.GetRing()))
+		{
+			GAMEPAD_LOG_INFO("[AppDLL] Haptics encoder switched to {}.", bIsWireless ? "Bluetooth" : "USB");
+			++TransportSwitches;
+			// A pre-encoded clip in progress belonged to the other transport
+			HandCachedClipToMixer();
+		}
+
+		// File, pipe and tone sources render here, at the clock's pace; the loopback arrives through OnCapture
+		IServiceClock& Clock = IServiceClock::Get();
+		const std::int64_t NowNs = Clock.NowNs();
+		Service.HapticSources.Pump(NowNs);
+
+		// Game rumble (virtual pad) and pending events become synth voices, mixer inputs; the bridge only
+		// delivers the latest request (and measures its latency), the synth does the rest
+		Service.RumbleBridge.Update(NowNs);
+		const FRumbleState& Rumble = Service.RumbleBridge.GetLastRequest();
+		Service.HapticEventSynth.SetRumble(Rumble.LargeMotor, Rumble.SmallMotor);
+		Service.HapticEventSynth.Update(NowNs);
+
+		ServeCachedClipRequests(bIsWireless, NowNs);
+
+		// Game PCM, current source, clips (cache clips included) and rumble summed straight into the encoder buffer
+		Service.HapticBus.Stage(Encoder, NowNs);
+		const auto SendUsb = [AudioHaptics](std::vector<std::int16_t>& Samples)
+		{
+			GAMEPAD_TRACE_SCOPE(HapticPacketSent, Samples.size() * sizeof(std::int16_t));
+			AudioHaptics->AudioHapticUpdate(Samples);
+		};
+		const auto SendBt = [AudioHaptics](std::vector<std::uint8_t>& Packet)
+		{
+			GAMEPAD_TRACE_SCOPE(HapticPacketSent, Packet.size());
+			AudioHaptics->AudioHapticUpdate(Packet);
+		};
+
+		std::size_t Sent = 0;
+		if (CachedClipPlayer.IsPlaying())
+		{
+			// Direct sending only with the live mix silent: what it produced this tick is silence and is dropped
+			Encoder.DiscardPending();
+			Sent = CachedClipPlayer.Send(NowNs, SendUsb, SendBt);
+		}
+		else
+		{
+			Sent = Encoder.Flush(SendUsb, SendBt);
+		}
+
+		if (Sent > 0)
+		{
+			Service.StartupMetrics.MarkFirstHapticPacket();
+			SentPackets += Sent;
+		}
+
+		if (!bIsWireless)
+		{
+			Clock.SleepFor(kUsbHapticsTick);
+		}
+		else if (Sent == 0)
+		{
+			Clock.SleepFor(kBtHapticsIdleWait);
+		}
+	}
+} // namespace GamepadCore
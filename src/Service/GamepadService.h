@@ -0,0 +1,317 @@
+#pragma once
+#include "Audio/HapticClipCache.h"
+#include "Audio/HapticEvents.h"
+#include "Audio/HapticMixer.h"
+#include "Audio/HapticPcmInput.h"
+#include "Audio/HapticSource.h"
+#include "Audio/HapticStream.h"
+#include "Audio/HapticSynth.h"
+#include "Audio/RumbleBridge.h"
+#include "Config/GameProfile.h"
+#include "Diagnostics/ReportTiming.h"
+#include "Diagnostics/StartupMetrics.h"
+#include "GCore/Interfaces/ISonyGamepad.h"
+#include "GCore/Templates/TBasicDeviceRegistry.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "Input/InputStateBuffer.h"
+#include "Input/MotionFusion.h"
+#include "Input/StickResponseCurve.h"
+#include "Output/TriggerEffects.h"
+#include "Telemetry/TelemetryChannel.h"
+#include "Timing/ServiceClock.h"
+#include "VirtualPad/IVirtualGamepadSink.h"
+#include "Adapters/Tests/test_device_registry_policy.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace GamepadCore
+{
+	using FServiceDeviceRegistry = TBasicDeviceRegistry<Ftest_device_registry_policy>;
+
+	/**
+	 * @brief Run-time switches of the service loops, read once when the loops start.
+	 */
+	struct FGamepadServiceSettings
+	{
+		bool bPhaseAlign = false;   // DUALSENSE_MOD_PHASE_ALIGN=1: the USB poll wakes right after the next report is due
+		bool bTriggerTilt = false;  // DUALSENSE_MOD_TRIGGER_TILT=1: trigger resistance follows the controller tilt
+		bool bInputHaptics = false; // DUALSENSE_MOD_INPUT_HAPTICS=1: stick flicks and trigger pulls click on the actuators
+
+		static FGamepadServiceSettings FromEnvironment();
+	};
+
+	/**
+	 * @brief Audio capture feeding the haptics (WASAPI loopback in the mod, a fake in tests).
+	 *
+	 * Delivers blocks to FGamepadService::OnCapture() from its own thread once started. The device
+	 * does not depend on the controller or its transport: it is created when the haptics loop starts,
+	 * started with the first controller and keeps running across reconnects and USB <-> Bluetooth switches.
+	 */
+	class IHapticCaptureDevice
+	{
+	public:
+		virtual ~IHapticCaptureDevice() = default;
+
+		/** @brief Creates the device if it does not exist yet. */
+		virtual bool Initialize() = 0;
+		virtual bool Start() = 0;
+		virtual void Shutdown() = 0;
+	};
+
+	/**
+	 * @brief A clip registered by the game, in its two encoded forms (entries of the clip cache).
+	 */
+	struct FRegisteredHapticClip
+	{
+		const FEncodedHapticClip* Usb = nullptr;
+		const FEncodedHapticClip* Bluetooth = nullptr;
+	};
+
+	/**
+	 * @brief State shared by the service loops and the game-facing API.
+	 *
+	 * The input loop (FInputLoop) publishes the decoded state and posts haptic events, the haptics loop
+	 * (FHapticsLoop) mixes and sends the haptics, and the game reads and submits through the exported
+	 * functions, which only touch the members below. Nothing here depends on the platform: the mod
+	 * runs it against HID, ViGEm and WASAPI, the tests against the simulated bus and a fake capture.
+	 */
+	class FGamepadService
+	{
+	public:
+		static constexpr std::uint32_t MaxRegisteredHapticClips = 256;
+
+		FGamepadService();
+		FGamepadService(const FGamepadService&) = delete;
+		FGamepadService& operator=(const FGamepadService&) = delete;
+
+		void Start() { bRunning.store(true, std::memory_order_release); }
+		void Stop() { bRunning.store(false, std::memory_order_release); }
+		bool IsRunning() const { return bRunning.load(std::memory_order_acquire); }
+
+		/** @brief Loads the profile and compiles its stick curves. Call before the loops start. */
+		void SetGameProfile(const FGameProfile& Profile);
+		const FGameProfile& GetGameProfile() const { return GameProfile; }
+
+		/**
+		 * @brief Virtual pad the input loop forwards to; nullptr while none is ready. The caller keeps
+		 * it alive until it is replaced, and clears it before shutting the pad down.
+		 */
+		void SetVirtualPad(IVirtualGamepadSink* Pad) { VirtualPad.store(Pad, std::memory_order_release); }
+
+		/**
+		 * @brief Whether device arrivals are notified through GetDeviceArrival(). Without notifications
+		 * the input loop polls for controllers; with them, polling only covers a lost notification.
+		 */
+		void SetArrivalNotifications(bool bEnabled) { bArrivalNotifications.store(bEnabled, std::memory_order_release); }
+		FServiceWakeSignal& GetDeviceArrival() { return DeviceArrival; }
+
+		/** @brief Controller attached by the input loop. Other threads only read this pointer, never the registry. */
+		ISonyGamepad* GetAttachedGamepad() const { return AttachedGamepad.load(std::memory_order_acquire); }
+
+		/** @brief Capture thread: hands a block to the current haptic source (dropped unless it is the loopback). */
+		void OnCapture(const float* Interleaved, std::size_t Frames);
+
+		/** @brief Input loop only: queues an input or telemetry event for the synth; dropped when the queue is full. */
+		void PostHapticEvent(EHapticEventType Type, float Value0, float Value1, std::int64_t PostedNs);
+
+		/** @brief Registers the mixer inputs once; they stay registered across Stop/Start cycles. */
+		void InitializeHapticBus();
+
+		/**
+		 * @brief Sets the clip cache directory, once, before the first registration (which may come
+		 * from the game before the service starts): registered ids point into cache entries.
+		 */
+		void InitializeHapticClipCache(const std::string& Directory);
+
+		/**
+		 * @brief Creates the telemetry channel, once per process: game threads and external producers
+		 * keep writing to it across Stop/Start cycles, so it is never closed or recreated.
+		 * @return Whether the channel exists.
+		 */
+		bool InitializeTelemetry(const char* Name);
+
+		/**
+		 * @brief Finds both encoded versions of a clip in the cache, rendering the missing ones (only
+		 * looks them up when Interleaved is null).
+		 * @return Id of the clip (1..MaxRegisteredHapticClips), the same for a clip registered again; 0 on error.
+		 */
+		std::uint32_t RegisterHapticClipFrames(std::uint64_t ContentHash, const float* Interleaved, std::size_t Frames, float Gain);
+
+		/** @brief Game: requests a registered clip, picked up by the haptics loop. False if the id does not exist. */
+		bool PlayCachedHapticClip(std::uint32_t ClipId);
+		void StopCachedHapticClip() { CachedClipRequests.Publish(0); }
+
+		// Published by the input loop, read lock-free by any thread
+		TSeqLock<FInputContext> InputState;
+		TSeqLock<FMotionState> MotionState;
+		TSeqLock<FReportTimingMetrics> ReportTiming;
+
+		// Game telemetry (board, impacts) in shared memory; one producer, consumed by the input loop
+		FTelemetryChannel Telemetry;
+
+		FStartupMetrics StartupMetrics;
+		FRumbleBridge RumbleBridge;
+
+		// Haptic source (loopback, file, pipe, tone...) -> EQ -> ring; swappable at run time
+		FHapticSourcePipeline HapticSources;
+		// Haptic PCM submitted by the game; ducks the current source while active
+		FHapticPcmInput HapticPcmInput;
+		// Pre-rendered clip triggered by the game (PlayGamepadHapticClip)
+		FHapticClipCache HapticClipCache;
+		FClipHapticSource HapticClip;
+
+	private:
+		friend class FInputLoop;
+		friend class FHapticsLoop;
+
+		// Ducking groups: a ducking input only affects the groups in its DuckGroups
+		static constexpr std::uint32_t HapticSourceGroup = 1u << 0; // current source (loopback, file, pipe...)
+		static constexpr std::uint32_t HapticEffectGroup = 1u << 1; // clips, synth and rumble: play over everything
+
+		std::uint32_t PublishRegisteredHapticClip(const FEncodedHapticClip* Usb, const FEncodedHapticClip* Bluetooth);
+
+		std::atomic<bool> bRunning{false};
+		FGameProfile GameProfile = kDefaultGameProfile;
+		// Profile stick curves, compiled into tables when the profile loads
+		FStickResponseCurve LeftStickCurve;
+		FStickResponseCurve RightStickCurve;
+		std::atomic<IVirtualGamepadSink*> VirtualPad{nullptr};
+		std::atomic<bool> bArrivalNotifications{false};
+		FServiceWakeSignal DeviceArrival;
+		std::atomic<ISonyGamepad*> AttachedGamepad{nullptr};
+		std::atomic<std::uint64_t> CapturedFrames{0};
+
+		// Cache clip (PlayGamepadCachedHapticClip) when it has to share the bus with the live mix
+		FEncodedClipHapticSource CachedClipInput;
+		int CachedClipInputIndex = -1;
+
+		// Mixer inputs; their priority decides who ducks whom and who sets the pace
+		FRingHapticSource PushedPcmInput;
+		FRingHapticSource SourcePipelineInput;
+		FHapticMixer HapticBus;
+
+		// Procedural synth: input and telemetry events (input loop) and the rumble become voices on the
+		// haptics thread. Effects and motors are separate banks, one mixer input each.
+		FHapticEventQueue HapticEventQueue;
+		FHapticEventSynth HapticEventSynth;
+		FSynthHapticSource EffectSynthInput;
+		FSynthHapticSource RumbleSynthInput;
+
+		std::once_flag HapticClipCacheDirectoryOnce;
+		std::once_flag TelemetryOnce;
+		bool bTelemetryCreated = false;
+		FRegisteredHapticClip RegisteredHapticClips[MaxRegisteredHapticClips];
+		std::atomic<std::uint32_t> RegisteredHapticClipCount{0};
+		std::mutex HapticClipRegistrationMutex;
+		// Latest clip the game asked for (id, 0 = stop); the haptics loop compares it with what it served
+		TSeqLock<std::uint32_t> CachedClipRequests;
+	};
+
+	/**
+	 * @brief Writes the trigger states the FTriggerEffectEngine decided to change to the controller.
+	 */
+	class FGamepadTriggerSink : public ITriggerEffectSink
+	{
+	public:
+		ISonyGamepad* Gamepad = nullptr;
+
+		void WriteTrigger(ETriggerSide Side, const FTriggerEffectBytes& Bytes) override;
+	};
+
+	/**
+	 * @brief The input thread: controller detection, input publishing, motion, report timing,
+	 * telemetry-driven trigger effects and haptic events, and the virtual pad feed.
+	 *
+	 * Run() loops until the service stops; Tick() is one iteration, for single-threaded drivers such as
+	 * FScenarioRunner. Every wait goes through the service clock: run it on a thread registered with
+	 * FServiceClockThreadScope, or with no participants at all.
+	 */
+	class FInputLoop
+	{
+	public:
+		FInputLoop(FGamepadService& InService, FServiceDeviceRegistry& InRegistry, const FGamepadServiceSettings& InSettings);
+		~FInputLoop();
+
+		FInputLoop(const FInputLoop&) = delete;
+		FInputLoop& operator=(const FInputLoop&) = delete;
+
+		void Run();
+		void Tick();
+
+		const FTriggerEffectEngine& GetTriggerEngine() const { return TriggerEngine; }
+
+	private:
+		void ProcessDualSenseReport(ISonyGamepad* Gamepad, FDeviceContext* DeviceContext, const FInputContext& CurrentState, std::int64_t ReceiveNs);
+		void ForwardToVirtualPad(ISonyGamepad* Gamepad, FDeviceContext* DeviceContext);
+
+		FGamepadService& Service;
+		FServiceDeviceRegistry& Registry;
+		const FGamepadServiceSettings Settings;
+
+		std::uint64_t FrameCounter = 0;
+		std::int64_t NextSettingsNs = 0;
+		ISonyGamepad* AttachedGamepad = nullptr;
+		FMotionStage Motion;
+		std::uint64_t MotionCalibrationGeneration = 0;
+		FReportClockEstimator ReportClock;
+		FTriggerEffectEngine TriggerEngine;
+		FGamepadTriggerSink TriggerSink;
+		FTriggerEffectHandle BaseTriggerEffects[2];
+		FTriggerEffectInputs TriggerInputs;
+		bool bBoardTelemetry = false;
+		FHapticInputEventDetector HapticDetector;
+		std::uint64_t ArrivalGeneration = 0;
+		std::int64_t LastDetectionNs = 0;
+		std::int64_t NextWaitLogNs = 0;
+		std::uint64_t NullGamepadTicks = 0;
+	};
+
+	/**
+	 * @brief The haptics thread: prepares the controller's audio path, pumps the haptic sources, turns
+	 * rumble and events into synth voices, mixes everything and sends it over the current transport.
+	 *
+	 * Creates the capture device on construction and shuts it down on destruction. Run() loops until
+	 * the service stops; Tick() is one iteration. Same clock rules as FInputLoop.
+	 */
+	class FHapticsLoop
+	{
+	public:
+		FHapticsLoop(FGamepadService& InService, IHapticCaptureDevice& InCapture);
+		~FHapticsLoop();
+
+		FHapticsLoop(const FHapticsLoop&) = delete;
+		FHapticsLoop& operator=(const FHapticsLoop&) = delete;
+
+		void Run();
+		void Tick();
+
+		std::uint64_t GetTransportSwitches() const { return TransportSwitches; }
+		std::uint64_t GetSentPackets() const { return SentPackets; }
+
+	private:
+		void ConsumeHapticsQueue(IGamepadAudioHaptics* AudioHaptics, bool bIsWireless);
+		void ServeCachedClipRequests(bool bIsWireless, std::int64_t NowNs);
+		void HandCachedClipToMixer();
+
+		FGamepadService& Service;
+		IHapticCaptureDevice& Capture;
+
+		// The USB/BT encoder runs here, on the frames the source pipeline already filtered
+		FHapticEncoder Encoder;
+		ISonyGamepad* PreparedGamepad = nullptr;
+		EDSDeviceConnection PreparedConnection = EDSDeviceConnection::Usb;
+		bool bCaptureStarted = false;
+
+		// With the live mix silent a cache clip goes out straight from the cache, by pointer; otherwise
+		// through the mixer (CachedClipInput)
+		FEncodedHapticClipPlayer CachedClipPlayer;
+		const FRegisteredHapticClip* PlayingCachedClip = nullptr;
+		std::uint64_t SeenCachedClipRequests = 0;
+
+		std::uint64_t TransportSwitches = 0;
+		std::uint64_t SentPackets = 0;
+	};
+} // namespace GamepadCore
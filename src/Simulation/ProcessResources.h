@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#else
+#include <dirent.h>
+#include <fstream>
+#include <malloc.h>
+#include <string>
+#endif
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Point-in-time sample of the resources a long-running service can leak.
+	 *
+	 * Handles are open OS handles (file descriptors on Linux), heap is the in-use allocator bytes
+	 * (private committed bytes on Windows). A field is -1 when the platform cannot report it.
+	 */
+	struct FProcessResources
+	{
+		std::int64_t HandleCount = -1;
+		std::int64_t HeapBytes = -1;
+		std::int64_t ThreadCount = -1;
+
+		static FProcessResources Sample()
+		{
+			FProcessResources Out;
+#if defined(_WIN32)
+			DWORD Handles = 0;
+			if (GetProcessHandleCount(GetCurrentProcess(), &Handles))
+			{
+				Out.HandleCount = Handles;
+			}
+
+			PROCESS_MEMORY_COUNTERS_EX Memory = {};
+			if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&Memory), sizeof(Memory)))
+			{
+				Out.HeapBytes = static_cast<std::int64_t>(Memory.PrivateUsage);
+			}
+
+			HANDLE Snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+			if (Snapshot != INVALID_HANDLE_VALUE)
+			{
+				THREADENTRY32 Entry = {};
+				Entry.dwSize = sizeof(Entry);
+				std::int64_t Threads = 0;
+				for (BOOL bMore = Thread32First(Snapshot, &Entry); bMore; bMore = Thread32Next(Snapshot, &Entry))
+				{
+					Threads += Entry.th32OwnerProcessID == GetCurrentProcessId() ? 1 : 0;
+				}
+				CloseHandle(Snapshot);
+				Out.ThreadCount = Threads;
+			}
+#else
+			if (DIR* Fds = opendir("/proc/self/fd"))
+			{
+				std::int64_t Count = 0;
+				while (const dirent* Entry = readdir(Fds))
+				{
+					Count += Entry->d_name[0] != '.' ? 1 : 0;
+				}
+				closedir(Fds);
+				Out.HandleCount = Count - 1; // the descriptor opendir itself holds
+			}
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+			Out.HeapBytes = static_cast<std::int64_t>(mallinfo2().uordblks);
+#endif
+
+			std::ifstream Status("/proc/self/status");
+			std::string Line;
+			while (std::getline(Status, Line))
+			{
+				if (Line.rfind("Threads:", 0) == 0)
+				{
+					Out.ThreadCount = std::stoll(Line.substr(8));
+				}
+			}
+#endif
+			return Out;
+		}
+	};
+} // namespace GamepadCore
@@ -0,0 +1,124 @@
+#pragma once
+#include "Simulation/SimulatedClock.h"
+#include "Simulation/SimulatedDualSense.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Runs a timeline of steps against the simulated bus under a virtual clock.
+	 *
+	 * Steps are scheduled at absolute virtual times; Run() advances the clock in fixed ticks, calls the
+	 * tick callback (the service loop body under test) and fires every step that came due. Expect()
+	 * records failures instead of aborting, so one run reports every broken assertion.
+	 */
+	class FScenarioRunner
+	{
+	public:
+		using FAction = std::function<void()>;
+		using FTick = std::function<void(std::int64_t NowNs)>;
+
+		// The runner's clock is the service clock while the runner lives
+		FScenarioRunner() { IServiceClock::SetInstance(&Clock); }
+		~FScenarioRunner() { IServiceClock::SetInstance(nullptr); }
+
+		FScenarioRunner(const FScenarioRunner&) = delete;
+		FScenarioRunner& operator=(const FScenarioRunner&) = delete;
+
+		FSimulatedClock& GetClock() { return Clock; }
+		std::int64_t NowNs() const { return Clock.NowNs(); }
+
+		void At(std::chrono::milliseconds Time, std::string Name, FAction Action)
+		{
+			const std::int64_t TimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Time).count();
+			FStep Step{TimeNs, Sequence++, std::move(Name), std::move(Action)};
+			Steps.insert(std::upper_bound(Steps.begin(), Steps.end(), Step, [](const FStep& A, const FStep& B) { return A.TimeNs < B.TimeNs || (A.TimeNs == B.TimeNs && A.Order < B.Order); }), std::move(Step));
+		}
+
+		/**
+		 * @brief Advances virtual time to Until in Tick increments, firing due steps after each tick.
+		 *
+		 * The runner's thread takes part in the timeline while it runs, so a helper thread the code under
+		 * test starts (a calibration read on the cache worker) holds virtual time until it sleeps or ends.
+		 */
+		void Run(std::chrono::milliseconds Until, std::chrono::microseconds Tick, const FTick& OnTick)
+		{
+			const std::int64_t UntilNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Until).count();
+			FServiceClockThreadScope ClockScope;
+			while (true)
+			{
+				FireDueSteps();
+				if (Clock.NowNs() >= UntilNs)
+				{
+					break;
+				}
+
+				Clock.Advance(Tick);
+				if (OnTick)
+				{
+					OnTick(Clock.NowNs());
+				}
+			}
+		}
+
+		bool Expect(bool bCondition, const std::string& Message)
+		{
+			++ExpectationCount;
+			if (!bCondition)
+			{
+				Failures.push_back("[" + std::to_string(Clock.NowMs()) + " ms] " + (CurrentStep.empty() ? "" : CurrentStep + ": ") + Message);
+				std::cerr << "  [Fail] " << Failures.back() << std::endl;
+			}
+			return bCondition;
+		}
+
+		/**
+		 * @brief Prints the summary and returns the process exit code (0 when every expectation held).
+		 */
+		int Report() const
+		{
+			std::cout << "[Scenario] " << ExpectationCount - Failures.size() << "/" << ExpectationCount << " expectations passed, "
+			          << Clock.NowMs() << " ms simulated." << std::endl;
+			return Failures.empty() ? 0 : 1;
+		}
+
+	private:
+		struct FStep
+		{
+			std::int64_t TimeNs;
+			std::uint64_t Order;
+			std::string Name;
+			FAction Action;
+		};
+
+		void FireDueSteps()
+		{
+			while (NextStep < Steps.size() && Steps[NextStep].TimeNs <= Clock.NowNs())
+			{
+				// Copied out: an action may schedule further steps and reallocate the list
+				const FAction Action = Steps[NextStep].Action;
+				CurrentStep = Steps[NextStep++].Name;
+				std::cout << "[Scenario] " << Clock.NowMs() << " ms: " << CurrentStep << std::endl;
+				if (Action)
+				{
+					Action();
+				}
+				CurrentStep.clear();
+			}
+		}
+
+		FSimulatedClock Clock;
+		std::vector<FStep> Steps;
+		std::size_t NextStep = 0;
+		std::uint64_t Sequence = 0;
+		std::string CurrentStep;
+		std::size_t ExpectationCount = 0;
+		std::vector<std::string> Failures;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,141 @@
+#pragma once
+#include "Timing/ServiceClock.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Virtual service clock for simulated scenarios.
+	 *
+	 * Time only moves when Advance() is called or when every participating thread is asleep: the
+	 * clock then jumps straight to the earliest pending deadline and wakes that sleeper. A service
+	 * loop that "waits" an hour therefore costs only the work it does, and every run sees exactly the
+	 * same timestamps. With no participants registered, SleepUntilNs() simply advances the clock,
+	 * which suits a single-threaded driver such as FScenarioRunner. A sleeper whose wake signal was
+	 * notified counts as awake from that moment, so time never moves past it before it runs.
+	 */
+	class FSimulatedClock final : public IServiceClock
+	{
+	public:
+		std::int64_t NowNs() const override { return Now.load(std::memory_order_acquire); }
+		double NowMs() const { return static_cast<double>(NowNs()) / 1e6; }
+
+		void Advance(std::chrono::nanoseconds Step) { AdvanceTo(NowNs() + Step.count()); }
+
+		void AdvanceTo(std::int64_t TimeNs)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				if (TimeNs <= Now.load(std::memory_order_relaxed))
+				{
+					return;
+				}
+				Now.store(TimeNs, std::memory_order_release);
+			}
+			WakeUp.notify_all();
+		}
+
+		void SleepUntilNs(std::int64_t DeadlineNs) override
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			if (DeadlineNs <= Now.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			const auto Entry = Deadlines.insert(DeadlineNs);
+			AdvanceIfAllAsleep();
+			WakeUp.wait(Lock, [this, DeadlineNs] { return Now.load(std::memory_order_relaxed) >= DeadlineNs; });
+			Deadlines.erase(Entry);
+		}
+
+		bool SleepUntilNs(std::int64_t DeadlineNs, const FServiceWakeSignal& Signal, std::uint64_t SeenGeneration) override
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			const auto Signaled = [&Signal, SeenGeneration] { return Signal.GetGeneration() != SeenGeneration; };
+			if (Signaled() || DeadlineNs <= Now.load(std::memory_order_relaxed))
+			{
+				return Signaled();
+			}
+
+			FSignalSleeper Sleeper{&Signal, SeenGeneration, false};
+			SignalSleepers.insert(&Sleeper);
+			const auto Entry = Deadlines.insert(DeadlineNs);
+			AdvanceIfAllAsleep();
+			WakeUp.wait(Lock, [this, DeadlineNs, &Sleeper] { return Sleeper.bWoken || Now.load(std::memory_order_relaxed) >= DeadlineNs; });
+			Deadlines.erase(Entry);
+			SignalSleepers.erase(&Sleeper);
+			WokenSignalSleepers -= Sleeper.bWoken ? 1 : 0;
+			return Sleeper.bWoken;
+		}
+
+		void WakeSignalSleepers() override
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				for (FSignalSleeper* Sleeper : SignalSleepers)
+				{
+					if (!Sleeper->bWoken && Sleeper->Signal->GetGeneration() != Sleeper->SeenGeneration)
+					{
+						Sleeper->bWoken = true;
+						++WokenSignalSleepers;
+					}
+				}
+			}
+			WakeUp.notify_all();
+		}
+
+		void EnterThread() override
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			++Participants;
+		}
+
+		void LeaveThread() override
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				--Participants;
+				AdvanceIfAllAsleep();
+			}
+			WakeUp.notify_all();
+		}
+
+	private:
+		struct FSignalSleeper
+		{
+			const FServiceWakeSignal* Signal;
+			std::uint64_t SeenGeneration;
+			bool bWoken;
+		};
+
+		// Caller holds Mutex. A sleeper that was already woken but has not run yet still counts as awake.
+		void AdvanceIfAllAsleep()
+		{
+			if (Deadlines.empty() || Deadlines.size() - WokenSignalSleepers < Participants)
+			{
+				return;
+			}
+
+			const std::int64_t Earliest = *Deadlines.begin();
+			if (Earliest > Now.load(std::memory_order_relaxed))
+			{
+				Now.store(Earliest, std::memory_order_release);
+				WakeUp.notify_all();
+			}
+		}
+
+		std::atomic<std::int64_t> Now{0};
+		std::mutex Mutex;
+		std::condition_variable WakeUp;
+		std::multiset<std::int64_t> Deadlines;
+		std::size_t Participants = 0;
+		std::set<FSignalSleeper*> SignalSleepers;
+		std::size_t WokenSignalSleepers = 0;
+	};
+} // namespace GamepadCore
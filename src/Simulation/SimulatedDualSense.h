@@ -0,0 +1,433 @@
+#pragma once
+#include "Input/CalibrationCache.h"
+#include "Input/DualSenseReport.h"
+#include "Timing/ServiceClock.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Byte layout of the DualSense output report (USB 0x02 / BT 0x31), relative to the common
+	 * part that follows the report ID on USB and the report ID plus tag byte on Bluetooth.
+	 */
+	namespace DualSenseOutputReport
+	{
+		constexpr std::uint8_t UsbReportId = 0x02;
+		constexpr std::uint8_t BtReportId = 0x31;
+		constexpr std::size_t UsbHeaderSize = 1;
+		constexpr std::size_t BtHeaderSize = 2;
+		constexpr std::size_t BtReportSize = 78;
+
+		constexpr std::size_t ValidFlag0 = 0;
+		constexpr std::size_t ValidFlag1 = 1;
+		constexpr std::size_t MotorRight = 2;
+		constexpr std::size_t MotorLeft = 3;
+		constexpr std::size_t MuteLed = 8;
+		constexpr std::size_t RightTrigger = 10; // 11 bytes: mode + parameters
+		constexpr std::size_t LeftTrigger = 21;
+		constexpr std::size_t TriggerEffectSize = 11;
+		constexpr std::size_t ValidFlag2 = 38;
+		constexpr std::size_t PlayerLeds = 43;
+		constexpr std::size_t LightbarRed = 44;
+		constexpr std::size_t LightbarGreen = 45;
+		constexpr std::size_t LightbarBlue = 46;
+		constexpr std::size_t CommonSize = 47;
+	} // namespace DualSenseOutputReport
+
+	enum class ESimulatedTransport : std::uint8_t
+	{
+		Usb,
+		Bluetooth
+	};
+
+	/**
+	 * @brief Input state the simulated controller reports. Sticks and triggers use raw report units.
+	 */
+	struct FSimulatedPadState
+	{
+		std::uint8_t LeftStickX = 0x80;
+		std::uint8_t LeftStickY = 0x80;
+		std::uint8_t RightStickX = 0x80;
+		std::uint8_t RightStickY = 0x80;
+		std::uint8_t LeftTrigger = 0;
+		std::uint8_t RightTrigger = 0;
+		std::uint8_t Buttons0 = 0x08; // D-pad released
+		std::uint8_t Buttons1 = 0;
+		std::uint8_t Buttons2 = 0;
+		std::uint8_t Battery = 0x08;
+	};
+
+	/**
+	 * @brief One output report received by the simulated controller, decoded for assertions.
+	 */
+	struct FRecordedOutput
+	{
+		std::int64_t TimeNs = 0;
+		ESimulatedTransport Transport = ESimulatedTransport::Usb;
+		std::vector<std::uint8_t> Bytes;
+		bool bValidReportId = false;
+		bool bValidCrc = true; // USB reports carry no CRC
+
+		const std::uint8_t* Common() const
+		{
+			const std::size_t Header = Transport == ESimulatedTransport::Bluetooth ? DualSenseOutputReport::BtHeaderSize : DualSenseOutputReport::UsbHeaderSize;
+			return Bytes.size() >= Header + DualSenseOutputReport::CommonSize ? Bytes.data() + Header : nullptr;
+		}
+
+		std::array<std::uint8_t, 3> GetLightbar() const
+		{
+			const std::uint8_t* C = Common();
+			if (!C)
+			{
+				return {0, 0, 0};
+			}
+			return {C[DualSenseOutputReport::LightbarRed], C[DualSenseOutputReport::LightbarGreen], C[DualSenseOutputReport::LightbarBlue]};
+		}
+
+		std::uint8_t GetPlayerLeds() const
+		{
+			const std::uint8_t* C = Common();
+			return C ? C[DualSenseOutputReport::PlayerLeds] : 0;
+		}
+
+		const std::uint8_t* GetTriggerEffect(bool bRight) const
+		{
+			const std::uint8_t* C = Common();
+			return C ? C + (bRight ? DualSenseOutputReport::RightTrigger : DualSenseOutputReport::LeftTrigger) : nullptr;
+		}
+	};
+
+	/**
+	 * @brief Behavioral model of one DualSense: produces input reports, records output reports.
+	 *
+	 * All timing comes from the caller (simulated clock), nothing here sleeps. Faults can be injected:
+	 * unplugging, switching between USB and Bluetooth, and extra input latency (a state change only
+	 * shows up in reports LatencyNs after it was set). Like the real pad, a Bluetooth connection sends
+	 * the basic 0x01 report until the host reads feature report 0x05.
+	 */
+	class FSimulatedDualSense
+	{
+	public:
+		explicit FSimulatedDualSense(std::string InPath, ESimulatedTransport InTransport = ESimulatedTransport::Usb)
+		    : Path(std::move(InPath))
+		    , Transport(InTransport)
+		    , bFullReports(InTransport == ESimulatedTransport::Usb)
+		{
+		}
+
+		const std::string& GetPath() const { return Path; }
+		ESimulatedTransport GetTransport() const { return Transport; }
+		bool IsPlugged() const { return bPlugged; }
+		bool IsSendingFullReports() const { return bFullReports; }
+
+		void Unplug() { bPlugged = false; }
+
+		/**
+		 * @brief Plugs the controller back, optionally on another transport (a USB <-> BT switch is an unplug + plug).
+		 */
+		void Plug(ESimulatedTransport NewTransport)
+		{
+			Transport = NewTransport;
+			bPlugged = true;
+			bFullReports = NewTransport == ESimulatedTransport::Usb;
+			++ConnectionCount;
+		}
+
+		std::uint32_t GetConnectionCount() const { return ConnectionCount; }
+
+		void SetInputLatency(std::int64_t InLatencyNs) { LatencyNs = std::max<std::int64_t>(InLatencyNs, 0); }
+
+		/**
+		 * @brief Input report period. A read issued earlier than that blocks until the next report is due,
+		 * like a HID read does.
+		 */
+		void SetReportInterval(std::int64_t InIntervalNs) { ReportIntervalNs = std::max<std::int64_t>(InIntervalNs, 1); }
+		std::int64_t GetNextInputReportNs() const { return LastReportNs < 0 ? 0 : LastReportNs + ReportIntervalNs; }
+
+		/**
+		 * @brief Identity: the MAC (the Bluetooth serial string, feature report 0x09 on USB) and the
+		 * firmware version (feature report 0x20).
+		 */
+		void SetIdentity(std::string InMac, std::uint32_t InFirmware)
+		{
+			Mac = std::move(InMac);
+			Firmware = InFirmware;
+		}
+
+		/**
+		 * @brief Serial string the host gets without a feature read: the MAC on Bluetooth, empty on USB.
+		 */
+		std::string GetSerialString() const { return Transport == ESimulatedTransport::Bluetooth ? Mac : std::string(); }
+
+		/**
+		 * @brief Round-trip time of a feature report read on Transport. The caller waits it out on the service clock.
+		 */
+		void SetFeatureLatency(ESimulatedTransport InTransport, std::int64_t InLatencyNs)
+		{
+			(InTransport == ESimulatedTransport::Bluetooth ? BluetoothFeatureLatencyNs : UsbFeatureLatencyNs) = std::max<std::int64_t>(InLatencyNs, 0);
+		}
+		std::int64_t GetFeatureLatencyNs() const { return Transport == ESimulatedTransport::Bluetooth ? BluetoothFeatureLatencyNs : UsbFeatureLatencyNs; }
+
+		/**
+		 * @brief Answers a feature report request; Report[0] holds the requested ID. The IMU calibration
+		 * (0x05), pairing info (0x09, MAC) and firmware info (0x20) reports are modelled. Reading the
+		 * calibration switches a Bluetooth pad to full reports.
+		 */
+		bool ReadFeatureReport(std::uint8_t* Report, std::size_t Length)
+		{
+			if (!bPlugged)
+			{
+				return false;
+			}
+			if (Report[0] == DualSenseFeatureReport::PairingInfoId && Length >= DualSenseFeatureReport::PairingInfoSize)
+			{
+				std::memset(Report + 1, 0, DualSenseFeatureReport::PairingInfoSize - 1);
+				unsigned Bytes[6] = {};
+				std::sscanf(Mac.c_str(), "%x:%x:%x:%x:%x:%x", &Bytes[0], &Bytes[1], &Bytes[2], &Bytes[3], &Bytes[4], &Bytes[5]);
+				for (std::size_t i = 0; i < 6; ++i)
+				{
+					Report[DualSenseFeatureReport::PairingInfoMac + i] = static_cast<std::uint8_t>(Bytes[5 - i]); // little endian
+				}
+				++FeatureReadCount;
+				return true;
+			}
+			if (Report[0] == DualSenseFeatureReport::FirmwareInfoId && Length >= DualSenseFeatureReport::FirmwareInfoSize)
+			{
+				std::memset(Report + 1, 0, DualSenseFeatureReport::FirmwareInfoSize - 1);
+				std::memcpy(Report + DualSenseFeatureReport::FirmwareInfoVersion, &Firmware, sizeof(Firmware));
+				++FeatureReadCount;
+				return true;
+			}
+			if (Length < DualSenseCalibrationReport::Size || Report[0] != DualSenseCalibrationReport::ReportId)
+			{
+				return false;
+			}
+
+			auto Put = [Report](std::size_t Offset, std::int16_t Value)
+			{
+				Report[Offset] = static_cast<std::uint8_t>(Value & 0xFF);
+				Report[Offset + 1] = static_cast<std::uint8_t>((Value >> 8) & 0xFF);
+			};
+			std::memset(Report + 1, 0, DualSenseCalibrationReport::Size - 1);
+			Put(DualSenseCalibrationReport::GyroPitchBias, 3);
+			Put(DualSenseCalibrationReport::GyroYawBias, -2);
+			Put(DualSenseCalibrationReport::GyroRollBias, 1);
+			Put(DualSenseCalibrationReport::GyroPitchPlus, 8650);
+			Put(DualSenseCalibrationReport::GyroPitchMinus, -8640);
+			Put(DualSenseCalibrationReport::GyroYawPlus, 8660);
+			Put(DualSenseCalibrationReport::GyroYawMinus, -8655);
+			Put(DualSenseCalibrationReport::GyroRollPlus, 8645);
+			Put(DualSenseCalibrationReport::GyroRollMinus, -8650);
+			Put(DualSenseCalibrationReport::GyroSpeedPlus, 540);
+			Put(DualSenseCalibrationReport::GyroSpeedMinus, 540);
+			Put(DualSenseCalibrationReport::AccelXPlus, 8200);
+			Put(DualSenseCalibrationReport::AccelXMinus, -8180);
+			Put(DualSenseCalibrationReport::AccelYPlus, 8190);
+			Put(DualSenseCalibrationReport::AccelYMinus, -8195);
+			Put(DualSenseCalibrationReport::AccelZPlus, 8210);
+			Put(DualSenseCalibrationReport::AccelZMinus, -8185);
+
+			++FeatureReadCount;
+			bFullReports = true;
+			return true;
+		}
+		std::uint64_t GetFeatureReadCount() const { return FeatureReadCount; }
+
+		void SetState(const FSimulatedPadState& State, std::int64_t NowNs)
+		{
+			PendingStates.push_back({NowNs + LatencyNs, State});
+		}
+
+		/**
+		 * @brief Writes the next input report for the current transport into Out.
+		 * @return Report length in bytes (64 on USB, 78 on Bluetooth, 10 for the basic Bluetooth report),
+		 * 0 when unplugged or Out is too small.
+		 */
+		std::size_t ReadInputReport(std::uint8_t* Out, std::size_t Capacity, std::int64_t NowNs)
+		{
+			const bool bBluetooth = Transport == ESimulatedTransport::Bluetooth;
+			const std::size_t Length = !bFullReports ? DualSenseReport::BtBasicReportSize : bBluetooth ? DualSenseOutputReport::BtReportSize : 64;
+			if (!bPlugged || Capacity < Length)
+			{
+				return 0;
+			}
+
+			while (!PendingStates.empty() && PendingStates.front().VisibleAtNs <= NowNs)
+			{
+				Visible = PendingStates.front().State;
+				PendingStates.pop_front();
+			}
+
+			if (!bFullReports)
+			{
+				const std::uint8_t Basic[DualSenseReport::BtBasicReportSize] = {
+				    DualSenseReport::UsbReportId, Visible.LeftStickX, Visible.LeftStickY, Visible.RightStickX, Visible.RightStickY,
+				    Visible.Buttons0, Visible.Buttons1, Visible.Buttons2, Visible.LeftTrigger, Visible.RightTrigger};
+				std::memcpy(Out, Basic, sizeof(Basic));
+				++InputReportCount;
+				LastReportNs = NowNs;
+				return Length;
+			}
+
+			std::memset(Out, 0, Length);
+			Out[0] = bBluetooth ? DualSenseReport::BtReportId : DualSenseReport::UsbReportId;
+			std::uint8_t* Payload = Out + (bBluetooth ? DualSenseReport::BtHeaderSize : DualSenseReport::UsbHeaderSize);
+
+			Payload[DualSenseReport::LeftStickX] = Visible.LeftStickX;
+			Payload[DualSenseReport::LeftStickY] = Visible.LeftStickY;
+			Payload[DualSenseReport::RightStickX] = Visible.RightStickX;
+			Payload[DualSenseReport::RightStickY] = Visible.RightStickY;
+			Payload[DualSenseReport::LeftTrigger] = Visible.LeftTrigger;
+			Payload[DualSenseReport::RightTrigger] = Visible.RightTrigger;
+			Payload[DualSenseReport::Sequence] = Sequence++;
+			Payload[DualSenseReport::Buttons0] = Visible.Buttons0;
+			Payload[DualSenseReport::Buttons1] = Visible.Buttons1;
+			Payload[DualSenseReport::Buttons2] = Visible.Buttons2;
+			Payload[DualSenseReport::Status] = Visible.Battery;
+
+			// Accelerometer at rest: 1 g on the Y axis (8192 LSB/g)
+			Payload[DualSenseReport::Accel + 2] = 0x00;
+			Payload[DualSenseReport::Accel + 3] = 0x20;
+
+			const std::uint32_t SensorTicks = static_cast<std::uint32_t>((NowNs * 3) / 1000);
+			std::memcpy(Payload + DualSenseReport::SensorTimestamp, &SensorTicks, sizeof(SensorTicks));
+
+			// Both touch points inactive
+			Payload[DualSenseReport::TouchPoint0] = 0x80;
+			Payload[DualSenseReport::TouchPoint1] = 0x80;
+
+			if (bBluetooth)
+			{
+				const std::uint32_t Crc = DualSenseBtCrc32(0xA1, Out, Length - 4);
+				std::memcpy(Out + Length - 4, &Crc, sizeof(Crc));
+			}
+
+			++InputReportCount;
+			LastReportNs = NowNs;
+			return Length;
+		}
+
+		/**
+		 * @brief Accepts an output report write. Returns false (write failed) when unplugged.
+		 */
+		bool WriteOutputReport(const std::uint8_t* Data, std::size_t Length, std::int64_t NowNs)
+		{
+			if (!bPlugged || !Data || Length == 0)
+			{
+				return false;
+			}
+
+			FRecordedOutput Record;
+			Record.TimeNs = NowNs;
+			Record.Transport = Transport;
+			Record.Bytes.assign(Data, Data + Length);
+			if (Transport == ESimulatedTransport::Bluetooth)
+			{
+				Record.bValidReportId = Data[0] == DualSenseOutputReport::BtReportId;
+				if (Length >= DualSenseOutputReport::BtReportSize)
+				{
+					std::uint32_t Crc = 0;
+					std::memcpy(&Crc, Data + DualSenseOutputReport::BtReportSize - 4, sizeof(Crc));
+					Record.bValidCrc = Crc == DualSenseBtCrc32(0xA2, Data, DualSenseOutputReport::BtReportSize - 4);
+				}
+				else
+				{
+					Record.bValidCrc = false;
+				}
+			}
+			else
+			{
+				Record.bValidReportId = Data[0] == DualSenseOutputReport::UsbReportId;
+			}
+
+			Outputs.push_back(std::move(Record));
+			return true;
+		}
+
+		const std::vector<FRecordedOutput>& GetOutputs() const { return Outputs; }
+		void ClearOutputs() { Outputs.clear(); }
+		std::uint64_t GetInputReportCount() const { return InputReportCount; }
+
+	private:
+		struct FPendingState
+		{
+			std::int64_t VisibleAtNs;
+			FSimulatedPadState State;
+		};
+
+		std::string Path;
+		ESimulatedTransport Transport;
+		bool bPlugged = true;
+		bool bFullReports;
+		std::uint32_t ConnectionCount = 1;
+		std::int64_t LatencyNs = 0;
+		std::int64_t ReportIntervalNs = 4000000;
+		std::int64_t LastReportNs = -1;
+		std::string Mac = "a0:ab:51:00:00:01";
+		std::uint32_t Firmware = 0x0100;
+		std::int64_t UsbFeatureLatencyNs = 0;
+		std::int64_t BluetoothFeatureLatencyNs = 0;
+		std::uint64_t FeatureReadCount = 0;
+		std::uint8_t Sequence = 0;
+		std::uint64_t InputReportCount = 0;
+		FSimulatedPadState Visible;
+		std::deque<FPendingState> PendingStates;
+		std::vector<FRecordedOutput> Outputs;
+	};
+
+	/**
+	 * @brief The simulated controllers a simulated hardware policy enumerates. They run on the service clock.
+	 *
+	 * When the service loops run on their own threads, Devices and the counters below are only touched
+	 * with Mutex held; the policy never holds it while sleeping on the clock.
+	 */
+	struct FSimulatedBus
+	{
+		std::mutex Mutex;
+		std::vector<FSimulatedDualSense> Devices;
+
+		// Transport bookkeeping the policy keeps, for leak and protocol checks
+		std::uint64_t Connects = 0;
+		std::size_t OpenHandles = 0;
+		std::uint64_t InvalidOutputs = 0;      // wrong report ID or Bluetooth CRC
+		std::uint64_t CalibrationFailures = 0; // handle created without a valid calibration
+		std::uint64_t BasicReports = 0;        // basic Bluetooth reports read before the switch to full reports landed
+		bool bKeepOutputs = true;              // false: outputs are checked and dropped, for long runs
+		bool bCalibrationCache = true;         // false: every connect reads the calibration from the device
+
+		// Updated outside Mutex: haptics come from their own thread, calibration readers from the cache's
+		std::atomic<std::uint64_t> AudioHapticPackets{0};
+		std::atomic<std::uint64_t> RefreshReadersMade{0};
+		std::atomic<std::uint64_t> RefreshReadersRun{0};
+
+		std::int64_t NowNs() const { return IServiceClock::Get().NowNs(); }
+
+		FSimulatedDualSense* Find(const std::string& Path)
+		{
+			for (FSimulatedDualSense& Device : Devices)
+			{
+				if (Device.GetPath() == Path)
+				{
+					return &Device;
+				}
+			}
+			return nullptr;
+		}
+
+		static FSimulatedBus& Get()
+		{
+			static FSimulatedBus Bus;
+			return Bus;
+		}
+	};
+} // namespace GamepadCore
@@ -0,0 +1,144 @@
+#include "SharedMemoryRegion.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GamepadCore
+{
+#ifdef _WIN32
+	bool FSharedMemoryRegion::Create(const std::string& Name, std::size_t InSize)
+	{
+		Close();
+		const unsigned long long Size64 = InSize;
+		HANDLE Handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(Size64 >> 32), static_cast<DWORD>(Size64), Name.c_str());
+		if (!Handle)
+		{
+			return false;
+		}
+		void* View = MapViewOfFile(Handle, FILE_MAP_ALL_ACCESS, 0, 0, InSize);
+		if (!View)
+		{
+			CloseHandle(Handle);
+			return false;
+		}
+		Mapping = Handle;
+		Data = View;
+		Size = InSize;
+		return true;
+	}
+
+	bool FSharedMemoryRegion::Open(const std::string& Name)
+	{
+		Close();
+		HANDLE Handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, Name.c_str());
+		if (!Handle)
+		{
+			return false;
+		}
+		void* View = MapViewOfFile(Handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		MEMORY_BASIC_INFORMATION Info{};
+		if (!View || VirtualQuery(View, &Info, sizeof(Info)) == 0)
+		{
+			if (View)
+			{
+				UnmapViewOfFile(View);
+			}
+			CloseHandle(Handle);
+			return false;
+		}
+		Mapping = Handle;
+		Data = View;
+		Size = Info.RegionSize; // rounded up to pages, the layout header carries the real extent
+		return true;
+	}
+
+	void FSharedMemoryRegion::Close()
+	{
+		if (Data)
+		{
+			UnmapViewOfFile(Data);
+		}
+		if (Mapping)
+		{
+			CloseHandle(static_cast<HANDLE>(Mapping));
+		}
+		Mapping = nullptr;
+		Data = nullptr;
+		Size = 0;
+	}
+#else
+	bool FSharedMemoryRegion::Create(const std::string& Name, std::size_t InSize)
+	{
+		Close();
+		const int Descriptor = shm_open(Name.c_str(), O_CREAT | O_RDWR, 0600);
+		if (Descriptor < 0)
+		{
+			return false;
+		}
+		if (ftruncate(Descriptor, static_cast<off_t>(InSize)) != 0)
+		{
+			close(Descriptor);
+			shm_unlink(Name.c_str());
+			return false;
+		}
+		void* View = mmap(nullptr, InSize, PROT_READ | PROT_WRITE, MAP_SHARED, Descriptor, 0);
+		close(Descriptor); // the mapping keeps the object alive
+		if (View == MAP_FAILED)
+		{
+			shm_unlink(Name.c_str());
+			return false;
+		}
+		OwnedName = Name;
+		Data = View;
+		Size = InSize;
+		return true;
+	}
+
+	bool FSharedMemoryRegion::Open(const std::string& Name)
+	{
+		Close();
+		const int Descriptor = shm_open(Name.c_str(), O_RDWR, 0);
+		if (Descriptor < 0)
+		{
+			return false;
+		}
+		struct stat Info{};
+		if (fstat(Descriptor, &Info) != 0 || Info.st_size <= 0)
+		{
+			close(Descriptor);
+			return false;
+		}
+		const std::size_t InSize = static_cast<std::size_t>(Info.st_size);
+		void* View = mmap(nullptr, InSize, PROT_READ | PROT_WRITE, MAP_SHARED, Descriptor, 0);
+		close(Descriptor);
+		if (View == MAP_FAILED)
+		{
+			return false;
+		}
+		Data = View;
+		Size = InSize;
+		return true;
+	}
+
+	void FSharedMemoryRegion::Close()
+	{
+		if (Data)
+		{
+			munmap(Data, Size);
+		}
+		if (!OwnedName.empty())
+		{
+			shm_unlink(OwnedName.c_str());
+			OwnedName.clear();
+		}
+		Data = nullptr;
+		Size = 0;
+	}
+#endif
+} // namespace GamepadCore
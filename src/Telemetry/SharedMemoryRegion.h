@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief A named shared-memory mapping (file mapping on Windows, POSIX shm elsewhere).
+	 *
+	 * The creator owns the name: on POSIX it unlinks the object when closed, on Windows the mapping
+	 * goes away with its last handle. Openers map the whole existing object and learn its size.
+	 */
+	class FSharedMemoryRegion
+	{
+	public:
+		FSharedMemoryRegion() = default;
+		~FSharedMemoryRegion() { Close(); }
+
+		FSharedMemoryRegion(const FSharedMemoryRegion&) = delete;
+		FSharedMemoryRegion& operator=(const FSharedMemoryRegion&) = delete;
+
+		/**
+		 * @brief Creates the region (or reuses a stale one of the same name) with at least Size bytes.
+		 */
+		bool Create(const std::string& Name, std::size_t Size);
+
+		/**
+		 * @brief Maps an existing region created by another process or component.
+		 */
+		bool Open(const std::string& Name);
+
+		void Close();
+
+		void* GetData() const { return Data; }
+		std::size_t GetSize() const { return Size; }
+		bool IsOpen() const { return Data != nullptr; }
+
+	private:
+#ifdef _WIN32
+		void* Mapping = nullptr; // HANDLE
+#else
+		std::string OwnedName; // unlinked on Close()
+#endif
+		void* Data = nullptr;
+		std::size_t Size = 0;
+	};
+} // namespace GamepadCore
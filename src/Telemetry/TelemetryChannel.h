@@ -0,0 +1,256 @@
+#pragma once
+#include "Telemetry/SharedMemoryRegion.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Kinds of game telemetry record, and what their Values mean.
+	 */
+	enum class ETelemetryType : std::uint16_t
+	{
+		None = 0,
+		BoardState = 1, // pitch, roll (rad, > 0 leaning right), speed (m/s), truck tightness (0..1)
+		Impact = 2,     // strength (0..1), duration (s)
+		Grind = 3,      // intensity (0..1), surface id
+	};
+
+	/**
+	 * @brief One telemetry record as it sits in the shared ring.
+	 */
+	struct FTelemetryRecord
+	{
+		std::uint16_t Type;       // ETelemetryType
+		std::uint16_t Flags;
+		std::uint32_t Sequence;   // producer's counter, lets a reader see its own losses
+		std::int64_t TimestampNs; // std::chrono::steady_clock ns since its epoch (IServiceClock time base)
+		float Values[4];
+	};
+	static_assert(sizeof(FTelemetryRecord) == 32, "FTelemetryRecord is part of the shared-memory layout");
+
+	/**
+	 * @brief Start of the shared region; Capacity records follow at HeaderSize.
+	 *
+	 * Head and Tail are free-running record counts on separate cache lines, so the producer and the
+	 * consumer each write only their own line. Magic is stored last, once the rest is initialized.
+	 */
+	struct FTelemetryChannelHeader
+	{
+		static constexpr std::uint32_t ExpectedMagic = 0x544D4C54; // "TLMT"
+		static constexpr std::uint32_t CurrentVersion = 1;
+
+		std::atomic<std::uint32_t> Magic;
+		std::uint32_t Version;
+		std::uint32_t RecordSize;
+		std::uint32_t Capacity; // power of two
+		alignas(64) std::atomic<std::uint64_t> Head;    // written by the producer
+		alignas(64) std::atomic<std::uint64_t> Dropped; // producer: pushes refused because the ring was full
+		alignas(64) std::atomic<std::uint64_t> Tail;    // written by the consumer
+	};
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+	              "shared-memory atomics must be lock-free to work across processes");
+	static_assert(sizeof(FTelemetryChannelHeader) == 256, "FTelemetryChannelHeader is part of the shared-memory layout");
+
+	/**
+	 * @brief Lock-free single-producer / single-consumer ring of telemetry records in shared memory.
+	 *
+	 * The service creates the channel; a game script (through the exported push function) or an
+	 * external process (by mapping the same name) produces into it, at up to ~1 kHz. The input thread
+	 * drains it once per report. Neither side blocks or makes a system call after setup: a push into a
+	 * full ring is refused and counted, never waits. Each side caches the other side's index and only
+	 * rereads it when the cached value says the ring is full or empty.
+	 *
+	 * Exactly one producer at a time; records from a second concurrent producer would be corrupted.
+	 * Timestamps are on the service's steady clock: an external producer stamps records with
+	 * std::chrono::steady_clock (QueryPerformanceCounter scaled to ns on Windows, CLOCK_MONOTONIC on
+	 * Linux), so the consumer can compare them with IServiceClock::NowNs() directly.
+	 */
+	class FTelemetryChannel
+	{
+	public:
+		static constexpr std::uint32_t DefaultCapacity = 1024; // ~1 s of records at 1 kHz
+		static constexpr std::size_t HeaderSize = sizeof(FTelemetryChannelHeader);
+#ifdef _WIN32
+		static constexpr const char* DefaultName = "Local\\DualSenseModTelemetry";
+#else
+		static constexpr const char* DefaultName = "/dualsense-mod-telemetry";
+#endif
+
+		static std::size_t GetRequiredBytes(std::uint32_t Capacity) { return HeaderSize + static_cast<std::size_t>(Capacity) * sizeof(FTelemetryRecord); }
+
+		FTelemetryChannel() = default;
+		FTelemetryChannel(const FTelemetryChannel&) = delete;
+		FTelemetryChannel& operator=(const FTelemetryChannel&) = delete;
+
+		/**
+		 * @brief Creates the named channel (service side). Capacity is rounded up to a power of two.
+		 */
+		bool Create(const std::string& Name, std::uint32_t Capacity = DefaultCapacity)
+		{
+			Close();
+			Capacity = RoundUpPowerOfTwo(std::max<std::uint32_t>(Capacity, 2));
+			return Region.Create(Name, GetRequiredBytes(Capacity)) && Initialize(Region.GetData(), Region.GetSize(), Capacity);
+		}
+
+		/**
+		 * @brief Maps a channel created elsewhere (producer side). Fails until the service created it.
+		 */
+		bool Open(const std::string& Name)
+		{
+			Close();
+			if (!Region.Open(Name) || !Attach(Region.GetData(), Region.GetSize()))
+			{
+				Close();
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Lays a fresh channel out in caller memory (64-byte aligned, GetRequiredBytes() long).
+		 */
+		bool Initialize(void* Memory, std::size_t Size, std::uint32_t Capacity)
+		{
+			if (!Memory || (Capacity & (Capacity - 1)) != 0 || Capacity == 0 || Size < GetRequiredBytes(Capacity) ||
+			    reinterpret_cast<std::uintptr_t>(Memory) % alignof(FTelemetryChannelHeader) != 0)
+			{
+				return false;
+			}
+			FTelemetryChannelHeader* NewHeader = static_cast<FTelemetryChannelHeader*>(Memory);
+			NewHeader->Magic.store(0, std::memory_order_relaxed);
+			NewHeader->Version = FTelemetryChannelHeader::CurrentVersion;
+			NewHeader->RecordSize = sizeof(FTelemetryRecord);
+			NewHeader->Capacity = Capacity;
+			NewHeader->Head.store(0, std::memory_order_relaxed);
+			NewHeader->Dropped.store(0, std::memory_order_relaxed);
+			NewHeader->Tail.store(0, std::memory_order_relaxed);
+			NewHeader->Magic.store(FTelemetryChannelHeader::ExpectedMagic, std::memory_order_release);
+			return Attach(Memory, Size);
+		}
+
+		/**
+		 * @brief Uses a channel already laid out in Memory, after validating its header.
+		 */
+		bool Attach(void* Memory, std::size_t Size)
+		{
+			FTelemetryChannelHeader* Candidate = static_cast<FTelemetryChannelHeader*>(Memory);
+			if (!Memory || Size < HeaderSize || Candidate->Magic.load(std::memory_order_acquire) != FTelemetryChannelHeader::ExpectedMagic ||
+			    Candidate->Version != FTelemetryChannelHeader::CurrentVersion || Candidate->RecordSize != sizeof(FTelemetryRecord) ||
+			    Candidate->Capacity == 0 || (Candidate->Capacity & (Candidate->Capacity - 1)) != 0 || Size < GetRequiredBytes(Candidate->Capacity))
+			{
+				return false;
+			}
+			Header = Candidate;
+			Records = reinterpret_cast<FTelemetryRecord*>(static_cast<std::uint8_t*>(Memory) + HeaderSize);
+			Mask = Candidate->Capacity - 1;
+			CachedHead = Header->Head.load(std::memory_order_acquire);
+			CachedTail = Header->Tail.load(std::memory_order_acquire);
+			return true;
+		}
+
+		void Close()
+		{
+			Header = nullptr;
+			Records = nullptr;
+			Mask = 0;
+			Region.Close();
+		}
+
+		bool IsOpen() const { return Header != nullptr; }
+		std::uint32_t GetCapacity() const { return Header ? Header->Capacity : 0; }
+		std::uint64_t GetDroppedCount() const { return Header ? Header->Dropped.load(std::memory_order_relaxed) : 0; }
+
+		/**
+		 * @brief Producer: appends Record. Returns false (and counts a drop) when the ring is full.
+		 */
+		bool Push(const FTelemetryRecord& Record)
+		{
+			if (!Header)
+			{
+				return false;
+			}
+			const std::uint64_t Head = Header->Head.load(std::memory_order_relaxed);
+			if (Head - CachedTail > Mask)
+			{
+				CachedTail = Header->Tail.load(std::memory_order_acquire);
+				if (Head - CachedTail > Mask)
+				{
+					Header->Dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+			}
+			std::memcpy(&Records[Head & Mask], &Record, sizeof(FTelemetryRecord));
+			Header->Head.store(Head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief Producer convenience: fills in the sequence number; unused values are zero.
+		 */
+		bool Push(ETelemetryType Type, const float* Values, std::size_t Count, std::int64_t TimestampNs)
+		{
+			FTelemetryRecord Record{};
+			Record.Type = static_cast<std::uint16_t>(Type);
+			Record.Sequence = NextSequence++;
+			Record.TimestampNs = TimestampNs;
+			if (Values)
+			{
+				std::memcpy(Record.Values, Values, std::min<std::size_t>(Count, 4) * sizeof(float));
+			}
+			return Push(Record);
+		}
+
+		/**
+		 * @brief Consumer: moves up to MaxRecords records, oldest first, into Out.
+		 *
+		 * @return Number of records copied.
+		 */
+		std::size_t Drain(FTelemetryRecord* Out, std::size_t MaxRecords)
+		{
+			if (!Header)
+			{
+				return 0;
+			}
+			const std::uint64_t Tail = Header->Tail.load(std::memory_order_relaxed);
+			if (CachedHead == Tail)
+			{
+				CachedHead = Header->Head.load(std::memory_order_acquire);
+				if (CachedHead == Tail)
+				{
+					return 0;
+				}
+			}
+			const std::size_t Count = static_cast<std::size_t>(std::min<std::uint64_t>(CachedHead - Tail, MaxRecords));
+			const std::size_t First = static_cast<std::size_t>(Tail & Mask);
+			const std::size_t BeforeWrap = std::min<std::size_t>(Count, static_cast<std::size_t>(Mask) + 1 - First);
+			std::memcpy(Out, &Records[First], BeforeWrap * sizeof(FTelemetryRecord));
+			std::memcpy(Out + BeforeWrap, &Records[0], (Count - BeforeWrap) * sizeof(FTelemetryRecord));
+			Header->Tail.store(Tail + Count, std::memory_order_release);
+			return Count;
+		}
+
+	private:
+		static std::uint32_t RoundUpPowerOfTwo(std::uint32_t Value)
+		{
+			std::uint32_t Power = 1;
+			while (Power < Value)
+			{
+				Power <<= 1;
+			}
+			return Power;
+		}
+
+		FSharedMemoryRegion Region;
+		FTelemetryChannelHeader* Header = nullptr;
+		FTelemetryRecord* Records = nullptr;
+		std::uint32_t Mask = 0;
+		std::uint64_t CachedHead = 0; // consumer's view of Head
+		std::uint64_t CachedTail = 0; // producer's view of Tail
+		std::uint32_t NextSequence = 0;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,36 @@
+#include "Testing/AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::size_t> g_Allocations{0};
+} // namespace
+
+std::size_t GamepadCore::GetAllocationCount()
+{
+	return g_Allocations.load(std::memory_order_relaxed);
+}
+
+// Counts every allocation of the process; the replacements must live in exactly one translation unit
+void* operator new(std::size_t Size)
+{
+	g_Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* Memory = std::malloc(Size ? Size : 1))
+	{
+		return Memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t Size)
+{
+	return ::operator new(Size);
+}
+
+void operator delete(void* Memory) noexcept { std::free(Memory); }
+void operator delete(void* Memory, std::size_t) noexcept { std::free(Memory); }
+void operator delete[](void* Memory) noexcept { std::free(Memory); }
+void operator delete[](void* Memory, std::size_t) noexcept { std::free(Memory); }
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Number of global operator new calls made by the process so far.
+	 *
+	 * Only defined in test executables that compile Testing/AllocationCounter.cpp, which replaces the
+	 * global allocation operators; benchmarks sample it around a hot loop to prove the loop never allocates.
+	 */
+	std::size_t GetAllocationCount();
+} // namespace GamepadCore
@@ -0,0 +1,47 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Pass/fail bookkeeping shared by the portable test executables.
+	 *
+	 * Prints the "--- Name Test ---" banner on construction, one "  [Fail] message" line per failed
+	 * expectation, and the "--- Name Completed/Failed ---" footer from Finish(), whose result is the
+	 * process exit code.
+	 */
+	class FTestReport
+	{
+	public:
+		explicit FTestReport(std::string InName, const std::string& Detail = {})
+			: Name(std::move(InName))
+		{
+			std::cout << "--- " << Name << " Test" << (Detail.empty() ? "" : " (" + Detail + ")") << " ---" << std::endl;
+		}
+
+		bool Expect(bool bCondition, const char* Message)
+		{
+			if (!bCondition)
+			{
+				std::cerr << "  [Fail] " << Message << std::endl;
+				++Failures;
+			}
+			return bCondition;
+		}
+
+		bool Passed() const { return Failures == 0; }
+		int GetFailures() const { return Failures; }
+
+		int Finish() const
+		{
+			std::cout << "--- " << Name << " " << (Failures == 0 ? "Completed" : "Failed") << " ---" << std::endl;
+			return Failures == 0 ? 0 : 1;
+		}
+
+	private:
+		std::string Name;
+		int Failures = 0;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,161 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace GamepadCore
+{
+	class FServiceWakeSignal;
+
+	/**
+	 * @brief Time source and sleep service for the service threads.
+	 *
+	 * Every wait and timestamp in the input, audio and haptics loops goes through the installed
+	 * instance. Production runs on FSteadyServiceClock; tests install an FSimulatedClock so the same
+	 * loops run against virtual time, deterministically and as fast as the CPU allows.
+	 */
+	class IServiceClock
+	{
+	public:
+		virtual ~IServiceClock() = default;
+
+		virtual std::int64_t NowNs() const = 0;
+
+		/**
+		 * @brief Blocks the calling thread until NowNs() >= DeadlineNs.
+		 */
+		virtual void SleepUntilNs(std::int64_t DeadlineNs) = 0;
+
+		void SleepFor(std::chrono::nanoseconds Duration) { SleepUntilNs(NowNs() + Duration.count()); }
+
+		/**
+		 * @brief SleepUntilNs() that also returns once Signal moved past SeenGeneration.
+		 *
+		 * @return True when the signal ended the sleep, false when the deadline did.
+		 */
+		virtual bool SleepUntilNs(std::int64_t DeadlineNs, const FServiceWakeSignal& Signal, std::uint64_t SeenGeneration) = 0;
+
+		/**
+		 * @brief Makes every signal sleeper recheck its signal. Called by FServiceWakeSignal::Notify().
+		 */
+		virtual void WakeSignalSleepers() = 0;
+
+		/**
+		 * @brief Declares that the calling thread takes part in the timeline (see FServiceClockThreadScope).
+		 * A simulated clock only moves time forward once every participant is asleep.
+		 */
+		virtual void EnterThread() {}
+		virtual void LeaveThread() {}
+
+		/**
+		 * @brief The clock in use. Defaults to the steady clock.
+		 */
+		static IServiceClock& Get();
+
+		/**
+		 * @brief Installs Clock (not owned) for every later Get(). nullptr restores the steady clock.
+		 * Install before the service threads start, and keep it alive until they stopped.
+		 */
+		static void SetInstance(IServiceClock* Clock) { Installed().store(Clock, std::memory_order_release); }
+
+	private:
+		static std::atomic<IServiceClock*>& Installed()
+		{
+			static std::atomic<IServiceClock*> Instance{nullptr};
+			return Instance;
+		}
+	};
+
+	/**
+	 * @brief An event a service thread can sleep on with a timeout (device arrival and the like).
+	 *
+	 * Read GetGeneration() before checking for the condition, then sleep with it; a Notify() in
+	 * between is never lost. Notify() may come from any thread, including OS callback threads that
+	 * do not take part in the service clock timeline.
+	 */
+	class FServiceWakeSignal
+	{
+	public:
+		std::uint64_t GetGeneration() const { return Generation.load(std::memory_order_acquire); }
+
+		void Notify()
+		{
+			Generation.fetch_add(1, std::memory_order_acq_rel);
+			IServiceClock::Get().WakeSignalSleepers();
+		}
+
+	private:
+		std::atomic<std::uint64_t> Generation{0};
+	};
+
+	/**
+	 * @brief The production clock: std::chrono::steady_clock and std::this_thread::sleep_until.
+	 */
+	class FSteadyServiceClock final : public IServiceClock
+	{
+	public:
+		std::int64_t NowNs() const override
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		void SleepUntilNs(std::int64_t DeadlineNs) override
+		{
+			std::this_thread::sleep_until(ToTimePoint(DeadlineNs));
+		}
+
+		bool SleepUntilNs(std::int64_t DeadlineNs, const FServiceWakeSignal& Signal, std::uint64_t SeenGeneration) override
+		{
+			std::unique_lock<std::mutex> Lock(SignalMutex);
+			return SignalWake.wait_until(Lock, ToTimePoint(DeadlineNs), [&Signal, SeenGeneration] { return Signal.GetGeneration() != SeenGeneration; });
+		}
+
+		void WakeSignalSleepers() override
+		{
+			// Taking the lock orders the wake after a sleeper's predicate check, so it cannot be missed
+			{
+				std::lock_guard<std::mutex> Lock(SignalMutex);
+			}
+			SignalWake.notify_all();
+		}
+
+	private:
+		static std::chrono::steady_clock::time_point ToTimePoint(std::int64_t Ns)
+		{
+			return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(Ns)));
+		}
+
+		std::mutex SignalMutex;
+		std::condition_variable SignalWake;
+	};
+
+	inline IServiceClock& IServiceClock::Get()
+	{
+		static FSteadyServiceClock Steady;
+		IServiceClock* Clock = Installed().load(std::memory_order_acquire);
+		return Clock ? *Clock : Steady;
+	}
+
+	/**
+	 * @brief Registers the current thread with the service clock for the lifetime of the scope.
+	 */
+	class FServiceClockThreadScope
+	{
+	public:
+		FServiceClockThreadScope()
+		    : Clock(IServiceClock::Get())
+		{
+			Clock.EnterThread();
+		}
+		~FServiceClockThreadScope() { Clock.LeaveThread(); }
+
+		FServiceClockThreadScope(const FServiceClockThreadScope&) = delete;
+		FServiceClockThreadScope& operator=(const FServiceClockThreadScope&) = delete;
+
+	private:
+		IServiceClock& Clock;
+	};
+} // namespace GamepadCore
@@ -0,0 +1,33 @@
+#include "CacheFile.h"
+#include <filesystem>
+#include <fstream>
+
+namespace GamepadCore
+{
+	bool WriteCacheFile(const std::string& Path, std::initializer_list<FCacheFileChunk> Chunks)
+	{
+		std::uint64_t Checksum = Fnv1a64OffsetBasis;
+		for (const FCacheFileChunk& Chunk : Chunks)
+		{
+			Checksum = Fnv1a64(Chunk.Data, Chunk.Size, Checksum);
+		}
+
+		const std::string TempPath = Path + ".tmp";
+		{
+			std::ofstream File(TempPath, std::ios::binary | std::ios::trunc);
+			for (const FCacheFileChunk& Chunk : Chunks)
+			{
+				File.write(static_cast<const char*>(Chunk.Data), static_cast<std::streamsize>(Chunk.Size));
+			}
+			File.write(reinterpret_cast<const char*>(&Checksum), sizeof(Checksum));
+			if (!File)
+			{
+				return false;
+			}
+		}
+
+		std::error_code Error;
+		std::filesystem::rename(TempPath, Path, Error);
+		return !Error;
+	}
+} // namespace GamepadCore
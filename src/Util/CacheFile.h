@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+namespace GamepadCore
+{
+	inline constexpr std::uint64_t Fnv1a64OffsetBasis = 0xcbf29ce484222325ull;
+
+	/**
+	 * @brief 64-bit FNV-1a. Pass the previous result as Hash to hash several buffers as one.
+	 */
+	inline std::uint64_t Fnv1a64(const void* Data, std::size_t Length, std::uint64_t Hash = Fnv1a64OffsetBasis)
+	{
+		const auto* Bytes = static_cast<const std::uint8_t*>(Data);
+		for (std::size_t i = 0; i < Length; ++i)
+		{
+			Hash = (Hash ^ Bytes[i]) * 0x100000001b3ull;
+		}
+		return Hash;
+	}
+
+	struct FCacheFileChunk
+	{
+		const void* Data;
+		std::size_t Size;
+	};
+
+	/**
+	 * @brief Writes the chunks followed by the Fnv1a64 checksum of all of them, as one cache entry.
+	 *
+	 * The entry goes to Path + ".tmp" first and is renamed over Path, so a crash never leaves a
+	 * half-written entry behind; a leftover ".tmp" file is never read as an entry. The directory must exist.
+	 */
+	bool WriteCacheFile(const std::string& Path, std::initializer_list<FCacheFileChunk> Chunks);
+} // namespace GamepadCore
@@ -0,0 +1,164 @@
+#pragma once
+#include "GCore/Types/Structs/Context/InputContext.h"
+#include "Input/DualSenseReport.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace GamepadCore
+{
+#pragma pack(push, 1)
+	struct FDs4Touch
+	{
+		std::uint8_t PacketCounter;
+		std::uint8_t IsUpTrackingNum1;
+		std::uint8_t TouchData1[3];
+		std::uint8_t IsUpTrackingNum2;
+		std::uint8_t TouchData2[3];
+	};
+
+	/**
+	 * @brief Platform-neutral mirror of ViGEm's DS4_REPORT_EX (63 bytes, packed).
+	 */
+	struct FDs4ReportEx
+	{
+		std::uint8_t ThumbLX;
+		std::uint8_t ThumbLY;
+		std::uint8_t ThumbRX;
+		std::uint8_t ThumbRY;
+		std::uint16_t Buttons;
+		std::uint8_t Special;
+		std::uint8_t TriggerL;
+		std::uint8_t TriggerR;
+		std::uint16_t Timestamp;
+		std::uint8_t BatteryLvl;
+		std::int16_t GyroX;
+		std::int16_t GyroY;
+		std::int16_t GyroZ;
+		std::int16_t AccelX;
+		std::int16_t AccelY;
+		std::int16_t AccelZ;
+		std::uint8_t Unknown1[5];
+		std::uint8_t BatteryLvlSpecial;
+		std::uint8_t Unknown2[2];
+		std::uint8_t TouchPacketsN;
+		FDs4Touch CurrentTouch;
+		FDs4Touch PreviousTouch[2];
+		std::uint8_t Padding[3];
+	};
+#pragma pack(pop)
+	static_assert(sizeof(FDs4ReportEx) == 63, "FDs4ReportEx must match the DS4_REPORT_EX layout");
+
+	namespace Ds4Report
+	{
+		constexpr std::uint8_t DpadNone = 0x08;
+		constexpr std::uint16_t TouchpadHeight = 942;
+
+		/**
+		 * @brief Neutral report: sticks centered, D-pad released, no touch.
+		 */
+		inline FDs4ReportEx MakeNeutral()
+		{
+			FDs4ReportEx Report;
+			std::memset(&Report, 0, sizeof(Report));
+			Report.ThumbLX = Report.ThumbLY = Report.ThumbRX = Report.ThumbRY = 0x80;
+			Report.Buttons = DpadNone;
+			Report.CurrentTouch.IsUpTrackingNum1 = 0x80;
+			Report.CurrentTouch.IsUpTrackingNum2 = 0x80;
+			return Report;
+		}
+
+		/**
+		 * @brief Copies a DualSense touch point, rescaling Y from the 1080-line pad to the DS4's 942 lines.
+		 */
+		inline void CopyTouchPoint(const std::uint8_t* Source, std::uint8_t& OutIsUpTracking, std::uint8_t OutData[3])
+		{
+			OutIsUpTracking = Source[0];
+			const std::uint32_t X = Source[1] | ((Source[2] & 0x0F) << 8);
+			const std::uint32_t Y = ((Source[2] & 0xF0) >> 4) | (Source[3] << 4);
+			const std::uint32_t ScaledY = std::min<std::uint32_t>(Y * TouchpadHeight / DualSenseReport::TouchpadHeight, TouchpadHeight - 1);
+			OutData[0] = static_cast<std::uint8_t>(X & 0xFF);
+			OutData[1] = static_cast<std::uint8_t>(((X >> 8) & 0x0F) | ((ScaledY & 0x0F) << 4));
+			OutData[2] = static_cast<std::uint8_t>(ScaledY >> 4);
+		}
+	} // namespace Ds4Report
+
+	/**
+	 * @brief Builds a DS4 report straight from the raw DualSense payload.
+	 *
+	 * The DualSense keeps the DS4 byte semantics for sticks, triggers, the button bytes (hat + face
+	 * buttons, shoulder/option/thumb bits, PS/touchpad bits), the raw IMU words and the touch point
+	 * encoding, so almost everything is a plain copy. Only the timestamp unit (1/3 us -> 16/3 us),
+	 * the touch Y range and the battery nibble are converted.
+	 */
+	inline FDs4ReportEx BuildDs4Report(const FDualSenseReportView& View)
+	{
+		using namespace DualSenseReport;
+		FDs4ReportEx Report = Ds4Report::MakeNeutral();
+
+		Report.ThumbLX = View.Byte(LeftStickX);
+		Report.ThumbLY = View.Byte(LeftStickY);
+		Report.ThumbRX = View.Byte(RightStickX);
+		Report.ThumbRY = View.Byte(RightStickY);
+		Report.Buttons = static_cast<std::uint16_t>(View.Byte(Buttons0) | (View.Byte(Buttons1) << 8));
+		Report.Special = View.Byte(Buttons2) & 0x03;
+		Report.TriggerL = View.Byte(LeftTrigger);
+		Report.TriggerR = View.Byte(RightTrigger);
+		Report.Timestamp = static_cast<std::uint16_t>(View.GetSensorTimestamp() / 16);
+
+		Report.GyroX = View.GetGyro(0);
+		Report.GyroY = View.GetGyro(1);
+		Report.GyroZ = View.GetGyro(2);
+		Report.AccelX = View.GetAccel(0);
+		Report.AccelY = View.GetAccel(1);
+		Report.AccelZ = View.GetAccel(2);
+
+		const std::uint8_t Status = View.Byte(DualSenseReport::Status);
+		Report.BatteryLvlSpecial = static_cast<std::uint8_t>((Status & 0x0F) | ((Status & 0xF0) ? 0x10 : 0x00));
+
+		Report.TouchPacketsN = 1;
+		Report.CurrentTouch.PacketCounter = View.GetSequence();
+		Ds4Report::CopyTouchPoint(View.GetTouchPoint(0), Report.CurrentTouch.IsUpTrackingNum1, Report.CurrentTouch.TouchData1);
+		Ds4Report::CopyTouchPoint(View.GetTouchPoint(1), Report.CurrentTouch.IsUpTrackingNum2, Report.CurrentTouch.TouchData2);
+		return Report;
+	}
+
+	/**
+	 * @brief Fallback for when no raw report is available: buttons, sticks and triggers only.
+	 */
+	inline FDs4ReportEx BuildDs4Report(const FInputContext& Context)
+	{
+		FDs4ReportEx Report = Ds4Report::MakeNeutral();
+
+		auto ToByte = [](float Value) { return static_cast<std::uint8_t>(std::clamp(Value * 127.5f + 127.5f, 0.0f, 255.0f)); };
+		// DS4 axes grow downwards, GamepadCore Y is up (+1.0)
+		Report.ThumbLX = ToByte(Context.LeftAnalog.X);
+		Report.ThumbLY = ToByte(-Context.LeftAnalog.Y);
+		Report.ThumbRX = ToByte(Context.RightAnalog.X);
+		Report.ThumbRY = ToByte(-Context.RightAnalog.Y);
+		Report.TriggerL = static_cast<std::uint8_t>(Context.LeftTriggerAnalog * 255.0f);
+		Report.TriggerR = static_cast<std::uint8_t>(Context.RightTriggerAnalog * 255.0f);
+
+		// Hat index: N, NE, E, SE, S, SW, W, NW, none
+		constexpr std::uint8_t kHat[3][3] = {{7, 0, 1}, {6, Ds4Report::DpadNone, 2}, {5, 4, 3}};
+		const int Vertical = (Context.bDpadDown ? 1 : 0) - (Context.bDpadUp ? 1 : 0);
+		const int Horizontal = (Context.bDpadRight ? 1 : 0) - (Context.bDpadLeft ? 1 : 0);
+		std::uint16_t Buttons = kHat[Vertical + 1][Horizontal + 1];
+
+		Buttons |= Context.bSquare ? 1 << 4 : 0;
+		Buttons |= Context.bCross ? 1 << 5 : 0;
+		Buttons |= Context.bCircle ? 1 << 6 : 0;
+		Buttons |= Context.bTriangle ? 1 << 7 : 0;
+		Buttons |= Context.bLeftShoulder ? 1 << 8 : 0;
+		Buttons |= Context.bRightShoulder ? 1 << 9 : 0;
+		Buttons |= Report.TriggerL > 0 ? 1 << 10 : 0;
+		Buttons |= Report.TriggerR > 0 ? 1 << 11 : 0;
+		Buttons |= Context.bShare ? 1 << 12 : 0;
+		Buttons |= Context.bStart ? 1 << 13 : 0;
+		Buttons |= Context.bLeftStick ? 1 << 14 : 0;
+		Buttons |= Context.bRightStick ? 1 << 15 : 0;
+		Report.Buttons = Buttons;
+		Report.Special = Context.bPSButton ? 0x01 : 0x00;
+		return Report;
+	}
+} // namespace GamepadCore
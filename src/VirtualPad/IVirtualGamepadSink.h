@@ -0,0 +1,45 @@
+#pragma once
+#include "GCore/Types/Structs/Context/InputContext.h"
+#include "Input/DualSenseReport.h"
+
+namespace GamepadCore
+{
+	class FRumbleMailbox;
+
+	/**
+	 * @brief Destination for the decoded controller state (virtual Xbox pad, uinput device, recorder...).
+	 *
+	 * InputLoop only talks to this interface, so the forwarding path is the same whichever backend is
+	 * active. Update() is called from the input thread once per decoded report.
+	 */
+	class IVirtualGamepadSink
+	{
+	public:
+		virtual ~IVirtualGamepadSink() = default;
+
+		virtual bool Initialize() = 0;
+		virtual void Shutdown() = 0;
+		virtual void Update(const FInputContext& Context) = 0;
+		virtual const char* GetName() const = 0;
+
+		/**
+		 * @brief Backends that can forward the raw DualSense report (motion, touchpad) opt in here.
+		 *
+		 * When this returns true and a raw report is available, InputLoop calls UpdateRaw() instead of Update().
+		 */
+		virtual bool AcceptsRawReports() const { return false; }
+		virtual void UpdateRaw(const FDualSenseReportView&, const FInputContext& Context) { Update(Context); }
+
+		/**
+		 * @brief Where the backend posts force feedback sent by the game (Xbox rumble, evdev FF_RUMBLE).
+		 *
+		 * Must be set before Initialize(). Backends without a feedback channel ignore it.
+		 */
+		virtual void SetRumbleMailbox(FRumbleMailbox*) {}
+
+		/**
+		 * @brief Handles pending feedback requests for backends that have to poll for them. Input thread only.
+		 */
+		virtual void PollFeedback() {}
+	};
+} // namespace GamepadCore
@@ -0,0 +1,75 @@
+#pragma once
+#include "VirtualPad/IVirtualGamepadSink.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Virtual pad backend that keeps the last N submitted states in memory, with timestamps.
+	 *
+	 * Used to inspect or time the forwarding path without any driver. Storage is allocated once in the
+	 * constructor; Update() never allocates. Not synchronized: read it from the feeding thread or
+	 * after the input loop stopped.
+	 */
+	class FMemoryRecorderSink final : public IVirtualGamepadSink
+	{
+	public:
+		struct FFrame
+		{
+			std::int64_t TimestampNs = 0;
+			FInputContext State;
+		};
+
+		explicit FMemoryRecorderSink(std::size_t Capacity = 4096)
+		    : Frames(Capacity > 0 ? Capacity : 1)
+		{
+		}
+
+		bool Initialize() override
+		{
+			bInitialized = true;
+			return true;
+		}
+
+		void Shutdown() override { bInitialized = false; }
+
+		void Update(const FInputContext& Context) override
+		{
+			if (!bInitialized)
+			{
+				return;
+			}
+
+			FFrame& Frame = Frames[FrameCount % Frames.size()];
+			Frame.TimestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			Frame.State = Context;
+			++FrameCount;
+		}
+
+		const char* GetName() const override { return "Memory Recorder"; }
+
+		std::uint64_t GetFrameCount() const { return FrameCount; }
+
+		/**
+		 * @brief Returns the frame with the given submission index, or nullptr if it was already overwritten.
+		 */
+		const FFrame* GetFrame(std::uint64_t Index) const
+		{
+			if (Index >= FrameCount || FrameCount - Index > Frames.size())
+			{
+				return nullptr;
+			}
+			return &Frames[Index % Frames.size()];
+		}
+
+		void Clear() { FrameCount = 0; }
+
+	private:
+		std::vector<FFrame> Frames;
+		std::uint64_t FrameCount = 0;
+		bool bInitialized = false;
+	};
+} // namespace GamepadCore
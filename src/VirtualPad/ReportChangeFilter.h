@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Skips virtual-pad submissions whose report is identical to the last one sent.
+	 *
+	 * An unchanged report is still resent once KeepAlive has elapsed, so consumers that time out idle
+	 * devices keep seeing traffic; a KeepAlive of zero disables the resend. Counts submitted and
+	 * skipped reports for diagnostics.
+	 */
+	template<typename TReport>
+	class TReportChangeFilter
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit TReportChangeFilter(std::chrono::milliseconds InKeepAlive = std::chrono::milliseconds(100))
+		    : KeepAlive(InKeepAlive)
+		{
+		}
+
+		void SetKeepAlive(std::chrono::milliseconds InKeepAlive) { KeepAlive = InKeepAlive; }
+
+		/**
+		 * @brief Returns true if Report must be submitted now, and records it as the last submission.
+		 */
+		bool ShouldSubmit(const TReport& Report, Clock::time_point Now)
+		{
+			if (bHasLast && std::memcmp(&Report, &Last, sizeof(TReport)) == 0)
+			{
+				if (KeepAlive.count() == 0 || Now - LastSubmit < KeepAlive)
+				{
+					++Skipped;
+					return false;
+				}
+			}
+
+			std::memcpy(&Last, &Report, sizeof(TReport));
+			bHasLast = true;
+			LastSubmit = Now;
+			++Submitted;
+			return true;
+		}
+
+		/**
+		 * @brief Forces the next report through (after a failed submission or a reconnect).
+		 */
+		void Invalidate() { bHasLast = false; }
+
+		std::uint64_t GetSubmittedCount() const { return Submitted; }
+		std::uint64_t GetSkippedCount() const { return Skipped; }
+
+	private:
+		TReport Last{};
+		bool bHasLast = false;
+		Clock::time_point LastSubmit{};
+		std::chrono::milliseconds KeepAlive;
+		std::uint64_t Submitted = 0;
+		std::uint64_t Skipped = 0;
+	};
+} // namespace GamepadCore
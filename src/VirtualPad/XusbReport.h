@@ -0,0 +1,86 @@
+#pragma once
+#include "GCore/Types/Structs/Context/InputContext.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace GamepadCore
+{
+	/**
+	 * @brief Platform-neutral mirror of ViGEm's XUSB_REPORT (same field order, size and packing).
+	 */
+	struct FXusbReport
+	{
+		std::uint16_t Buttons = 0;
+		std::uint8_t LeftTrigger = 0;
+		std::uint8_t RightTrigger = 0;
+		std::int16_t ThumbLX = 0;
+		std::int16_t ThumbLY = 0;
+		std::int16_t ThumbRX = 0;
+		std::int16_t ThumbRY = 0;
+
+		bool operator==(const FXusbReport&) const = default;
+	};
+	static_assert(sizeof(FXusbReport) == 12, "FXusbReport must match the XUSB_REPORT layout");
+
+	struct FXusbButtonMapping
+	{
+		bool FInputContext::* Field;
+		std::uint16_t Mask;
+	};
+
+	/**
+	 * @brief DualSense button -> XUSB button bit. Values are the XUSB_GAMEPAD_* constants.
+	 */
+	inline constexpr FXusbButtonMapping kXusbButtonMap[] = {
+	    {&FInputContext::bCross, 0x1000},         // A
+	    {&FInputContext::bCircle, 0x2000},        // B
+	    {&FInputContext::bSquare, 0x4000},        // X
+	    {&FInputContext::bTriangle, 0x8000},      // Y
+	    {&FInputContext::bDpadUp, 0x0001},
+	    {&FInputContext::bDpadDown, 0x0002},
+	    {&FInputContext::bDpadLeft, 0x0004},
+	    {&FInputContext::bDpadRight, 0x0008},
+	    {&FInputContext::bStart, 0x0010},
+	    {&FInputContext::bShare, 0x0020},         // Back
+	    {&FInputContext::bLeftShoulder, 0x0100},
+	    {&FInputContext::bRightShoulder, 0x0200},
+	    {&FInputContext::bLeftStick, 0x0040},
+	    {&FInputContext::bRightStick, 0x0080},
+	    {&FInputContext::bPSButton, 0x0400},      // Guide
+	};
+
+	/**
+	 * @brief Converts a float stick axis (-1..1) to the XInput range without branches.
+	 */
+	inline std::int16_t ToXusbAxis(float Value)
+	{
+		return static_cast<std::int16_t>(std::clamp(Value * 32767.0f, -32768.0f, 32767.0f));
+	}
+
+	/**
+	 * @brief Builds the X360 report for a decoded input state.
+	 *
+	 * Each button contributes its mask through a 0/0xFFFF select, so the loop has no data-dependent branches.
+	 * GamepadCore and XInput both use Y up as positive, so the sticks are scaled without inversion.
+	 */
+	inline FXusbReport BuildXusbReport(const FInputContext& Context)
+	{
+		FXusbReport Report;
+
+		std::uint16_t Buttons = 0;
+		for (const FXusbButtonMapping& Mapping : kXusbButtonMap)
+		{
+			Buttons |= static_cast<std::uint16_t>(-static_cast<std::int32_t>(Context.*Mapping.Field)) & Mapping.Mask;
+		}
+		Report.Buttons = Buttons;
+
+		Report.LeftTrigger = static_cast<std::uint8_t>(Context.LeftTriggerAnalog * 255.0f);
+		Report.RightTrigger = static_cast<std::uint8_t>(Context.RightTriggerAnalog * 255.0f);
+
+		Report.ThumbLX = ToXusbAxis(Context.LeftAnalog.X);
+		Report.ThumbLY = ToXusbAxis(Context.LeftAnalog.Y);
+		Report.ThumbRX = ToXusbAxis(Context.RightAnalog.X);
+		Report.ThumbRY = ToXusbAxis(Context.RightAnalog.Y);
+		return Report;
+	}
+} // namespace GamepadCore
@@ -1,71 +1,550 @@
-﻿#pragma once
-#if defined(_WIN32) && defined(USE_VIGEM)
+#pragma once
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
 #include <iostream>
-#include <fstream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
 #include <string>
-#include <filesystem>
-#include <chrono>
-#include <iomanip>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Compile-time level filter: 0 = trace, 1 = debug, 2 = info, 3 = warning, 4 = error, 5 = off.
+// Calls below the level compile to nothing, arguments included.
+#ifndef GAMEPAD_LOG_LEVEL
+#define GAMEPAD_LOG_LEVEL 2
+#endif
 
 namespace GamepadCore {
 
+enum class ELogLevel : std::uint8_t { Trace, Debug, Info, Warning, Error };
+
+namespace LogDetail {
+
+// Records are built on the stack and copied into the ring in one go; longer strings are cut.
+constexpr std::size_t MaxRecordSize = 512;
+
+using FFormatFn = void (*)(const char* format, const std::uint8_t* payload, std::size_t payloadSize, std::string& out);
+
+struct FRecordHeader {
+    std::int64_t TimestampNs;
+    FFormatFn Format;
+    const char* FormatString;
+    ELogLevel Level;
+};
+
+// Single-producer, single-consumer byte ring holding length-prefixed records. One per logging thread.
+class FLogRing {
+public:
+    static constexpr std::size_t Capacity = 256 * 1024;
+
+    bool Write(const std::uint8_t* record, std::uint32_t size) {
+        const std::size_t write = m_Write.load(std::memory_order_relaxed);
+        const std::size_t read = m_Read.load(std::memory_order_acquire);
+        if (Capacity - (write - read) < sizeof(size) + size) {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        CopyIn(write, reinterpret_cast<const std::uint8_t*>(&size), sizeof(size));
+        CopyIn(write + sizeof(size), record, size);
+        m_Write.store(write + sizeof(size) + size, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Out must hold MaxRecordSize bytes. Returns the record size, 0 when empty.
+    std::uint32_t Read(std::uint8_t* out) {
+        const std::size_t read = m_Read.load(std::memory_order_relaxed);
+        if (m_Write.load(std::memory_order_acquire) == read) return 0;
+
+        std::uint32_t size = 0;
+        CopyOut(read, reinterpret_cast<std::uint8_t*>(&size), sizeof(size));
+        CopyOut(read + sizeof(size), out, size);
+        m_Read.store(read + sizeof(size) + size, std::memory_order_release);
+        return size;
+    }
+
+    std::uint64_t TakeDropped() { return m_Dropped.exchange(0, std::memory_order_relaxed); }
+
+    std::atomic<bool> Orphaned{false};
+
+private:
+    void CopyIn(std::size_t position, const std::uint8_t* data, std::size_t size) {
+        const std::size_t offset = position % Capacity;
+        const std::size_t first = std::min(size, Capacity - offset);
+        std::memcpy(m_Buffer + offset, data, first);
+        std::memcpy(m_Buffer, data + first, size - first);
+    }
+
+    void CopyOut(std::size_t position, std::uint8_t* data, std::size_t size) const {
+        const std::size_t offset = position % Capacity;
+        const std::size_t first = std::min(size, Capacity - offset);
+        std::memcpy(data, m_Buffer + offset, first);
+        std::memcpy(data + first, m_Buffer, size - first);
+    }
+
+    alignas(64) std::atomic<std::size_t> m_Write{0};
+    alignas(64) std::atomic<std::size_t> m_Read{0};
+    std::atomic<std::uint64_t> m_Dropped{0};
+    std::uint8_t m_Buffer[Capacity];
+};
+
+// Arguments are stored raw and formatted later on the flusher thread. Strings are copied
+// (length-prefixed) since the caller's buffer may be gone by then; everything else is memcpy'd.
+template<typename T>
+constexpr bool IsStringArg = std::is_convertible_v<const T&, std::string_view>;
+
+template<typename T>
+using TStoredArg = std::conditional_t<IsStringArg<T>, std::string_view,
+                   std::conditional_t<std::is_pointer_v<T>, const void*, T>>;
+
+class FRecordWriter {
+public:
+    explicit FRecordWriter(std::uint8_t* buffer) : m_Buffer(buffer) {}
+
+    template<typename T>
+    void Put(const T& value) {
+        using TStored = TStoredArg<T>;
+        if constexpr (std::is_same_v<TStored, std::string_view>) {
+            const std::string_view text(value);
+            const std::size_t used = m_Size + sizeof(std::uint16_t);
+            const std::size_t room = used < MaxRecordSize ? MaxRecordSize - used : 0;
+            const std::uint16_t length = static_cast<std::uint16_t>(std::min(text.size(), room));
+            Raw(&length, sizeof(length));
+            Raw(text.data(), length);
+        } else {
+            static_assert(std::is_trivially_copyable_v<TStored>, "Log arguments must be strings or trivially copyable");
+            const TStored stored = static_cast<TStored>(value);
+            Raw(&stored, sizeof(stored));
+        }
+    }
+
+    void Raw(const void* data, std::size_t size) {
+        size = std::min(size, MaxRecordSize - m_Size);
+        std::memcpy(m_Buffer + m_Size, data, size);
+        m_Size += size;
+    }
+
+    std::uint32_t Size() const { return static_cast<std::uint32_t>(m_Size); }
+
+private:
+    std::uint8_t* m_Buffer;
+    std::size_t m_Size = 0;
+};
+
+// Truncated records decode the missing arguments as empty/zero instead of reading past the end.
+template<typename TStored>
+TStored Decode(const std::uint8_t*& payload, const std::uint8_t* end) {
+    if constexpr (std::is_same_v<TStored, std::string_view>) {
+        std::uint16_t length = 0;
+        if (static_cast<std::size_t>(end - payload) < sizeof(length)) {
+            payload = end;
+            return {};
+        }
+        std::memcpy(&length, payload, sizeof(length));
+        payload += sizeof(length);
+        length = static_cast<std::uint16_t>(std::min<std::size_t>(length, static_cast<std::size_t>(end - payload)));
+        const std::string_view text(reinterpret_cast<const char*>(payload), length);
+        payload += length;
+        return text;
+    } else {
+        TStored value{};
+        if (static_cast<std::size_t>(end - payload) < sizeof(value)) {
+            payload = end;
+            return value;
+        }
+        std::memcpy(&value, payload, sizeof(value));
+        payload += sizeof(value);
+        return value;
+    }
+}
+
+template<typename T>
+void AppendArg(std::string& out, const T& value) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        out.append(value);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        out.append(value ? "true" : "false");
+    } else if constexpr (std::is_same_v<T, char>) {
+        out.push_back(value);
+    } else if constexpr (std::is_same_v<T, const void*>) {
+        char text[2 + 2 * sizeof(void*)] = {'0', 'x'};
+        const auto result = std::to_chars(text + 2, std::end(text), reinterpret_cast<std::uintptr_t>(value), 16);
+        out.append(text, result.ptr);
+    } else if constexpr (std::is_enum_v<T>) {
+        AppendArg(out, static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        char text[32];
+        const auto result = std::to_chars(std::begin(text), std::end(text), value);
+        out.append(text, result.ptr);
+    }
+}
+
+// Replaces each "{}" of the format string with the next argument, in order.
+class FFormatCursor {
+public:
+    FFormatCursor(const char* format, std::string& out) : m_Format(format), m_Out(out) {}
+
+    template<typename T>
+    void Next(const T& value) {
+        const char* placeholder = std::strstr(m_Format, "{}");
+        if (!placeholder) return;
+        m_Out.append(m_Format, placeholder);
+        AppendArg(m_Out, value);
+        m_Format = placeholder + 2;
+    }
+
+    void Finish() { m_Out.append(m_Format); }
+
+private:
+    const char* m_Format;
+    std::string& m_Out;
+};
+
+template<typename... Args>
+void FormatRecord(const char* format, const std::uint8_t* payload, std::size_t payloadSize, std::string& out) {
+    [[maybe_unused]] const std::uint8_t* end = payload + payloadSize;
+    FFormatCursor cursor(format, out);
+    (cursor.Next(Decode<TStoredArg<Args>>(payload, end)), ...);
+    cursor.Finish();
+}
+
+} // namespace LogDetail
+
+/**
+ * Asynchronous logger behind GAMEPAD_LOG_*.
+ *
+ * Each thread writes binary records (format pointer + raw arguments) into its own lock-free ring;
+ * a background thread formats them and appends to GamepadService.log, rotating the file by size.
+ * Initialize() also routes std::cout/std::cerr through the same rings line by line, so the
+ * existing stream logging stays off the file system on the calling thread.
+ */
 class Logger {
 public:
-    static void Initialize(const std::string& directoryPath) {
+    struct FOptions {
+        std::uintmax_t MaxFileBytes = 4 * 1024 * 1024;
+        int MaxBackupFiles = 3;
+        bool MirrorToConsole = true;
+        std::chrono::milliseconds FlushInterval{20};
+    };
+
+    static void Initialize(const std::string& directoryPath) { Initialize(directoryPath, FOptions{}); }
+
+    static void Initialize(const std::string& directoryPath, const FOptions& options) {
+        FState& state = State();
+        std::lock_guard<std::mutex> lock(state.LifecycleMutex);
+        if (state.Running.load()) return;
+
         try {
-            if (!std::filesystem::exists(directoryPath)) {
-                std::filesystem::create_directories(directoryPath);
+            std::filesystem::create_directories(directoryPath);
+        } catch (const std::exception&) {
+            // Fall through: opening the file reports the failure
+        }
+
+        state.Options = options;
+        state.LogPath = (std::filesystem::path(directoryPath) / "GamepadService.log").string();
+        if (!OpenLogFile(state)) {
+            std::cerr << "[Logger] Failed to open " << state.LogPath << ", logging to console only." << std::endl;
+        }
+
+        state.ConsoleOut = std::cout.rdbuf();
+        state.ConsoleErr = std::cerr.rdbuf();
+        std::cout.rdbuf(&state.CoutCapture);
+        std::cerr.rdbuf(&state.CerrCapture);
+
+        state.Running.store(true);
+        state.Flusher = std::thread(&Logger::FlusherLoop);
+
+        Log(ELogLevel::Info, "[Logger] System Initialized. Logging to: {}", state.LogPath);
+    }
+
+    static void Shutdown() {
+        FState& state = State();
+        std::lock_guard<std::mutex> lock(state.LifecycleMutex);
+        if (!state.Running.load()) return;
+
+        Log(ELogLevel::Info, "[Logger] System Shutting down.");
+        {
+            std::lock_guard<std::mutex> wakeLock(state.WakeMutex);
+            state.Running.store(false);
+        }
+        state.Wake.notify_one();
+        if (state.Flusher.joinable()) state.Flusher.join();
+
+        std::cout.rdbuf(state.ConsoleOut);
+        std::cerr.rdbuf(state.ConsoleErr);
+        if (state.File) {
+            std::fclose(state.File);
+            state.File = nullptr;
+        }
+    }
+
+    /**
+     * Drains all rings from the calling thread without waiting for the flusher. Safe where joining
+     * is not (e.g. DLL_PROCESS_DETACH): it gives up if the flusher is busy.
+     */
+    static void Flush() {
+        FState& state = State();
+        std::unique_lock<std::mutex> lock(state.DrainMutex, std::try_to_lock);
+        if (lock.owns_lock()) DrainLocked(state);
+    }
+
+    static bool IsRunning() { return State().Running.load(std::memory_order_relaxed); }
+
+    template<typename... Args>
+    static void Log(ELogLevel level, const char* format, const Args&... args) {
+        std::uint8_t record[LogDetail::MaxRecordSize];
+        LogDetail::FRecordWriter writer(record);
+        const LogDetail::FRecordHeader header{NowNs(), &LogDetail::FormatRecord<Args...>, format, level};
+        writer.Raw(&header, sizeof(header));
+        (writer.Put(args), ...);
+
+        if (IsRunning()) {
+            ThreadRing().Write(record, writer.Size());
+        } else {
+            // No flusher yet (tools, early startup): format in place
+            std::string line;
+            const std::size_t payloadSize = writer.Size() - sizeof(header);
+            header.Format(format, payloadSize ? record + sizeof(header) : nullptr, payloadSize, line);
+            std::fprintf(level >= ELogLevel::Warning ? stderr : stdout, "%s\n", line.c_str());
+        }
+    }
+
+private:
+    // std::streambuf that turns complete lines into log records. Partial lines are kept per thread,
+    // so concurrent writers never share state.
+    class FLineCapture final : public std::streambuf {
+    public:
+        explicit FLineCapture(ELogLevel level) : m_Level(level) {}
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (ch != traits_type::eof()) {
+                const char c = traits_type::to_char_type(ch);
+                xsputn(&c, 1);
             }
+            return traits_type::not_eof(ch);
+        }
 
-            std::string logFilePath = directoryPath + "\\GamepadService.log";
-            
-            // Se o arquivo já existir e for muito grande, podemos rotacionar ou apenas abrir em modo append
-            logFile.open(logFilePath, std::ios::out | std::ios::app);
-            
-            if (logFile.is_open()) {
-                originalCoutBuffer = std::cout.rdbuf();
-                std::cout.rdbuf(logFile.rdbuf());
-                
-                originalCerrBuffer = std::cerr.rdbuf();
-                std::cerr.rdbuf(logFile.rdbuf());
-
-                LogTimestamp();
-                std::cout << "[Logger] System Initialized. Logging to: " << logFilePath << std::endl;
+        std::streamsize xsputn(const char* text, std::streamsize count) override {
+            std::string& line = PendingLine();
+            const char* end = text + count;
+            while (text < end) {
+                const char* newline = static_cast<const char*>(std::memchr(text, '\n', static_cast<std::size_t>(end - text)));
+                if (!newline) {
+                    line.append(text, end);
+                    break;
+                }
+                line.append(text, newline);
+                Log(m_Level, "{}", line);
+                line.clear();
+                text = newline + 1;
             }
-        } catch (const std::exception& e) {
-            // Se falhar ao inicializar o log no arquivo, continuamos com o console padrão
-            // (ou podemos tratar de outra forma)
+            return count;
+        }
+
+        int sync() override { return 0; }
+
+    private:
+        std::string& PendingLine() {
+            thread_local std::string lines[2];
+            return lines[m_Level == ELogLevel::Error ? 1 : 0];
         }
+
+        ELogLevel m_Level;
+    };
+
+    struct FState {
+        FOptions Options;
+        std::string LogPath;
+        std::FILE* File = nullptr;
+        std::uintmax_t FileBytes = 0;
+        std::streambuf* ConsoleOut = nullptr;
+        std::streambuf* ConsoleErr = nullptr;
+        FLineCapture CoutCapture{ELogLevel::Info};
+        FLineCapture CerrCapture{ELogLevel::Error};
+
+        std::mutex RingsMutex;
+        std::vector<std::shared_ptr<LogDetail::FLogRing>> Rings;
+
+        std::atomic<bool> Running{false};
+        std::mutex LifecycleMutex;
+        std::mutex DrainMutex;
+        std::mutex WakeMutex;
+        std::condition_variable Wake;
+        std::thread Flusher;
+    };
+
+    // Never destroyed: a flusher still running at process exit must not hit ~thread()
+    static FState& State() {
+        static FState* state = new FState();
+        return *state;
     }
 
-    static void Shutdown() {
-        if (logFile.is_open()) {
-            std::cout << "[Logger] System Shutting down." << std::endl;
-            
-            // Restaura os buffers originais
-            if (originalCoutBuffer) {
-                std::cout.rdbuf(originalCoutBuffer);
+    static std::int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static LogDetail::FLogRing& ThreadRing() {
+        struct FOwner {
+            std::shared_ptr<LogDetail::FLogRing> Ring;
+            ~FOwner() {
+                if (Ring) Ring->Orphaned.store(true, std::memory_order_release);
             }
-            if (originalCerrBuffer) {
-                std::cerr.rdbuf(originalCerrBuffer);
+        };
+        thread_local FOwner owner;
+        if (!owner.Ring) {
+            owner.Ring = std::make_shared<LogDetail::FLogRing>();
+            FState& state = State();
+            std::lock_guard<std::mutex> lock(state.RingsMutex);
+            state.Rings.push_back(owner.Ring);
+        }
+        return *owner.Ring;
+    }
+
+    static void FlusherLoop() {
+        FState& state = State();
+        while (state.Running.load()) {
+            {
+                std::unique_lock<std::mutex> lock(state.WakeMutex);
+                state.Wake.wait_for(lock, state.Options.FlushInterval, [&state] { return !state.Running.load(); });
             }
-            
-            logFile.close();
+            std::lock_guard<std::mutex> lock(state.DrainMutex);
+            DrainLocked(state);
         }
+        std::lock_guard<std::mutex> lock(state.DrainMutex);
+        DrainLocked(state);
     }
 
-private:
-    static void LogTimestamp() {
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
-        std::cout << "[" << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S") << "] ";
+    static void DrainLocked(FState& state) {
+        std::vector<std::shared_ptr<LogDetail::FLogRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(state.RingsMutex);
+            rings = state.Rings;
+        }
+
+        std::string text;
+        std::uint8_t record[LogDetail::MaxRecordSize];
+        for (const std::shared_ptr<LogDetail::FLogRing>& ring : rings) {
+            const bool orphaned = ring->Orphaned.load(std::memory_order_acquire);
+            while (const std::uint32_t size = ring->Read(record)) {
+                LogDetail::FRecordHeader header;
+                std::memcpy(&header, record, sizeof(header));
+                AppendPrefix(text, header);
+                header.Format(header.FormatString, record + sizeof(header), size - sizeof(header), text);
+                text.push_back('\n');
+            }
+            if (const std::uint64_t dropped = ring->TakeDropped()) {
+                text.append("[Logger] Dropped ").append(std::to_string(dropped)).append(" records (ring full)\n");
+            }
+            if (orphaned) {
+                std::lock_guard<std::mutex> lock(state.RingsMutex);
+                std::erase(state.Rings, ring);
+            }
+        }
+
+        if (!text.empty()) WriteOut(state, text);
+    }
+
+    static void AppendPrefix(std::string& out, const LogDetail::FRecordHeader& header) {
+        static constexpr const char* kLevels[] = {"T", "D", "I", "W", "E"};
+        const std::time_t seconds = static_cast<std::time_t>(header.TimestampNs / 1000000000);
+        std::tm local{};
+#if defined(_WIN32)
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+        char prefix[48];
+        const std::size_t length = std::strftime(prefix, sizeof(prefix), "[%Y-%m-%d %H:%M:%S", &local);
+        std::snprintf(prefix + length, sizeof(prefix) - length, ".%03d] [%s] ",
+                      static_cast<int>((header.TimestampNs / 1000000) % 1000), kLevels[static_cast<int>(header.Level)]);
+        out.append(prefix);
+    }
+
+    static void WriteOut(FState& state, const std::string& text) {
+        if (state.Options.MirrorToConsole && state.ConsoleOut) {
+            state.ConsoleOut->sputn(text.data(), static_cast<std::streamsize>(text.size()));
+            state.ConsoleOut->pubsync();
+        }
+
+        if (!state.File) return;
+        if (state.FileBytes + text.size() > state.Options.MaxFileBytes && state.FileBytes > 0) {
+            Rotate(state);
+            if (!state.File) return;
+        }
+        std::fwrite(text.data(), 1, text.size(), state.File);
+        std::fflush(state.File);
+        state.FileBytes += text.size();
+    }
+
+    // GamepadService.log -> GamepadService.1.log -> ... -> GamepadService.<MaxBackupFiles>.log (dropped)
+    static void Rotate(FState& state) {
+        std::fclose(state.File);
+        state.File = nullptr;
+
+        std::error_code error;
+        const std::filesystem::path base(state.LogPath);
+        auto backup = [&base](int index) {
+            return base.parent_path() / (base.stem().string() + "." + std::to_string(index) + base.extension().string());
+        };
+        std::filesystem::remove(backup(state.Options.MaxBackupFiles), error);
+        for (int index = state.Options.MaxBackupFiles - 1; index >= 1; --index) {
+            std::filesystem::rename(backup(index), backup(index + 1), error);
+        }
+        if (state.Options.MaxBackupFiles > 0) {
+            std::filesystem::rename(base, backup(1), error);
+        } else {
+            std::filesystem::remove(base, error);
+        }
+        OpenLogFile(state);
     }
 
-    static inline std::ofstream logFile;
-    static inline std::streambuf* originalCoutBuffer = nullptr;
-    static inline std::streambuf* originalCerrBuffer = nullptr;
+    static bool OpenLogFile(FState& state) {
+        state.File = std::fopen(state.LogPath.c_str(), "ab");
+        if (!state.File) return false;
+
+        std::error_code error;
+        const std::uintmax_t size = std::filesystem::file_size(state.LogPath, error);
+        state.FileBytes = error ? 0 : size;
+        return true;
+    }
 };
 
 } // namespace GamepadCore
 
+#define GAMEPAD_LOG_AT(level, ...) ::GamepadCore::Logger::Log(level, __VA_ARGS__)
+
+#if GAMEPAD_LOG_LEVEL <= 0
+#define GAMEPAD_LOG_TRACE(...) GAMEPAD_LOG_AT(::GamepadCore::ELogLevel::Trace, __VA_ARGS__)
+#else
+#define GAMEPAD_LOG_TRACE(...) ((void)0)
+#endif
+#if GAMEPAD_LOG_LEVEL <= 1
+#define GAMEPAD_LOG_DEBUG(...) GAMEPAD_LOG_AT(::GamepadCore::ELogLevel::Debug, __VA_ARGS__)
+#else
+#define GAMEPAD_LOG_DEBUG(...) ((void)0)
+#endif
+#if GAMEPAD_LOG_LEVEL <= 2
+#define GAMEPAD_LOG_INFO(...) GAMEPAD_LOG_AT(::GamepadCore::ELogLevel::Info, __VA_ARGS__)
+#else
+#define GAMEPAD_LOG_INFO(...) ((void)0)
+#endif
+#if GAMEPAD_LOG_LEVEL <= 3
+#define GAMEPAD_LOG_WARNING(...) GAMEPAD_LOG_AT(::GamepadCore::ELogLevel::Warning, __VA_ARGS__)
+#else
+#define GAMEPAD_LOG_WARNING(...) ((void)0)
+#endif
+#if GAMEPAD_LOG_LEVEL <= 4
+#define GAMEPAD_LOG_ERROR(...) GAMEPAD_LOG_AT(::GamepadCore::ELogLevel::Error, __VA_ARGS__)
+#else
+#define GAMEPAD_LOG_ERROR(...) ((void)0)
 #endif
@@ -7,6 +7,7 @@
 #include <string>
 #include <mutex>
 #include <queue>
+#include <future>
 
 #include "GImplementations/Utils/GamepadAudio.h"
 using namespace FGamepadAudio;
@@ -16,6 +17,30 @@ using namespace FGamepadAudio;
 #include "GCore/Templates/TBasicDeviceRegistry.h"
 #include "GCore/Types/Structs/Context/DeviceContext.h"
 #include "../Examples/Adapters/Tests/test_device_registry_policy.h"
+#include "Input/InputStateBuffer.h"
+#include "Input/RawInputDeviceFilter.h"
+#include "Input/CalibrationCache.h"
+#include "Input/MotionFusion.h"
+#include "Diagnostics/StartupMetrics.h"
+#include "Diagnostics/FrameTrace.h"
+#include "Diagnostics/ReportTiming.h"
+#include "Output/TriggerEffects.h"
+#include "Telemetry/TelemetryChannel.h"
+#include "Audio/HapticStream.h"
+#include "Audio/HapticPcmInput.h"
+#include "Audio/HapticSource.h"
+#include "Audio/HapticFileSources.h"
+#include "Audio/HapticMixer.h"
+#include "Audio/HapticClipCache.h"
+#include "Audio/HapticEvents.h"
+#include "Audio/HapticSynth.h"
+#include "Audio/RumbleBridge.h"
+#include "Timing/ServiceClock.h"
+#include "logger.h"
+#include "VirtualPad/IVirtualGamepadSink.h"
+#include "Config/GameProfile.h"
+#include "Input/StickResponseCurve.h"
+#include "Service/GamepadService.h"
 
 #ifdef USE_VIGEM
 #include "../Examples/Platform_Windows/ViGEmAdapter/ViGEmAdapter.h"
@@ -23,12 +48,14 @@ using namespace FGamepadAudio;
 
 #if _WIN32
 #include "../Examples/Platform_Windows/test_windows_hardware_policy.h"
+#include "AudioEndpointCache/AudioEndpointCache.h"
+#include "HidArrivalWatcher/HidArrivalWatcher.h"
 using TestHardwarePolicy = Ftest_windows_platform::Ftest_windows_hardware_policy;
 using TestHardwareInfo = Ftest_windows_platform::Ftest_windows_hardware;
 #endif
 
 using namespace GamepadCore;
-using TestDeviceRegistry = GamepadCore::TBasicDeviceRegistry<Ftest_device_registry_policy>;
+using TestDeviceRegistry = GamepadCore::FServiceDeviceRegistry;
 // Definição do ponteiro da função original
 typedef UINT (WINAPI* PGETRAWINPUTDEVICELIST)(PRAWINPUTDEVICELIST, PUINT, UINT);
 PGETRAWINPUTDEVICELIST Original_GetRawInputDeviceList = NULL;
@@ -36,6 +63,23 @@ PGETRAWINPUTDEVICELIST Original_GetRawInputDeviceList = NULL;
 // O VID que queremos esconder (Sony DualSense)
 const int HID_VID_SONY = 0x054C;
 
+// Consulta real do VID, usada apenas quando o handle ainda não está no cache
+bool LookupRawInputVendorId(void* hDevice, std::uint32_t& OutVendorId)
+{
+	RID_DEVICE_INFO info;
+	info.cbSize = sizeof(RID_DEVICE_INFO);
+	UINT size = sizeof(RID_DEVICE_INFO);
+
+	if (GetRawInputDeviceInfoA(static_cast<HANDLE>(hDevice), RIDI_DEVICEINFO, &info, &size) > 0 && info.dwType == RIM_TYPEHID)
+	{
+		OutVendorId = info.hid.dwVendorId;
+		return true;
+	}
+	return false;
+}
+
+FRawInputVendorCache g_RawInputVendorCache(LookupRawInputVendorId);
+
 // -----------------------------------------------------------------------------
 // SUA FUNÇÃO MODIFICADA (O DETOUR)
 // -----------------------------------------------------------------------------
@@ -48,41 +92,12 @@ UINT WINAPI My_GetRawInputDeviceList(PRAWINPUTDEVICELIST pRawInputDeviceList, PU
     UINT result = pFunc(pRawInputDeviceList, puiNumDevices, cbSize);
 
     // Se for erro ou apenas consulta de tamanho (NULL), retorna o original
-    if (result == (UINT)-1 || pRawInputDeviceList == NULL) {
+    if (result == (UINT)-1 || pRawInputDeviceList == NULL || cbSize != sizeof(RAWINPUTDEVICELIST)) {
         return result;
     }
 
-    // 2. Filtragem: Vamos reconstruir a lista sem o DualSense
-    UINT realCount = *puiNumDevices;
-    std::vector<RAWINPUTDEVICELIST> cleanList;
-
-    for (UINT i = 0; i < realCount; i++) {
-        RAWINPUTDEVICELIST& device = pRawInputDeviceList[i];
-        bool bIsBlocked = false;
-
-        if (device.dwType == RIM_TYPEHID) {
-            RID_DEVICE_INFO info;
-            info.cbSize = sizeof(RID_DEVICE_INFO);
-            UINT size = sizeof(RID_DEVICE_INFO);
-
-            // Verifica o VID
-            if (GetRawInputDeviceInfoA(device.hDevice, RIDI_DEVICEINFO, &info, &size) > 0) {
-                if (info.hid.dwVendorId == HID_VID_SONY) {
-                    bIsBlocked = true; // É o DualSense, marca para não incluir
-                }
-            }
-        }
-
-        if (!bIsBlocked) {
-            cleanList.push_back(device);
-        }
-    }
-
-    // 3. Sobrescreve o buffer original com a lista limpa
-    UINT finalCount = (UINT)cleanList.size();
-    for (UINT i = 0; i < finalCount; i++) {
-        pRawInputDeviceList[i] = cleanList[i];
-    }
+    // 2. Filtragem: remove o DualSense compactando o próprio buffer, sem alocar (VIDs vêm do cache)
+    UINT finalCount = FilterRawInputDevices(pRawInputDeviceList, result, RIM_TYPEHID, HID_VID_SONY, g_RawInputVendorCache);
 
     // Atualiza o contador para a Unreal não ler lixo de memória
     *puiNumDevices = finalCount;
@@ -170,575 +185,235 @@ void InitMod() {
     }
 }
 
-std::atomic<bool> g_Running(false);
 std::atomic<bool> g_ServiceInitialized(false);
 std::thread g_ServiceThread;
 std::thread g_AudioThread;
 std::unique_ptr<TestDeviceRegistry> g_Registry;
-#ifdef USE_VIGEM
-std::unique_ptr<ViGEmAdapter> g_ViGEmAdapter;
-#endif
-FInputContext g_LastInputState;
-
-constexpr float kLowPassAlpha = 1.0f;
-constexpr float kOneMinusAlpha = 1.0f - kLowPassAlpha;
-
-constexpr float kLowPassAlphaBt = 1.0f;
-constexpr float kOneMinusAlphaBt = 1.0f - kLowPassAlphaBt;
-
-// Estrutura para filtro Bi-quad (EQ)
-struct BiquadFilter {
-	float b0, b1, b2, a1, a2;
-	float x1, x2, y1, y2;
-
-	BiquadFilter() : b0(1), b1(0), b2(0), a1(0), a2(0), x1(0), x2(0), y1(0), y2(0) {}
-
-	void ConfigurePeaking(float sampleRate, float frequency, float q, float gainDb) {
-		float a = powf(10.0f, gainDb / 40.0f);
-		float omega = 2.0f * 3.14159265f * frequency / sampleRate;
-		float sn = sinf(omega);
-		float cs = cosf(omega);
-		float alpha = sn / (2.0f * q);
-
-		b0 = 1.0f + alpha * a;
-		b1 = -2.0f * cs;
-		b2 = 1.0f - alpha * a;
-		float a0 = 1.0f + alpha / a;
-		a1 = -2.0f * cs;
-		a2 = 1.0f - alpha / a;
+// Estado compartilhado pelas loops de input e haptics e pelos exports; as loops ficam em Service/GamepadService
+FGamepadService g_Service;
+// Backend do controle virtual (ViGEm X360 no Windows); a InputLoop só conhece a interface
+std::unique_ptr<IVirtualGamepadSink> g_VirtualPad;
+std::future<void> g_VirtualPadInitTask;
+// Dono do g_VirtualPad entre a init assíncrona e o shutdown (serviço ou DllMain), sem lock: quem perde
+// a troca de estado é quem desliga o pad, então nenhum dos dois lados vaza ou usa um pad já desligado
+enum class EVirtualPadState : int
+{
+	Pending,
+	Installing,
+	Ready,
+	Cancelled
+};
+std::atomic<EVirtualPadState> g_VirtualPadState(EVirtualPadState::Pending);
 
-		b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
+void ShutdownVirtualPad()
+{
+	// Pending/Installing: a init ainda vai ver o Cancelled e desliga o próprio pad
+	if (g_VirtualPadState.exchange(EVirtualPadState::Cancelled, std::memory_order_acq_rel) == EVirtualPadState::Ready && g_VirtualPad)
+	{
+		g_Service.SetVirtualPad(nullptr);
+		g_VirtualPad->Shutdown();
+		g_VirtualPad.reset();
 	}
+}
+// Chegada de um HID da Sony: acorda a detecção da InputLoop, que não faz polling enquanto há notificações
+Ftest_windows_platform::FHidArrivalWatcher g_HidArrival(g_Service.GetDeviceArrival());
 
-	float Process(float in) {
-		float out = b0 * in + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
-		x2 = x1; x1 = in;
-		y2 = y1; y1 = out;
-		return out;
-	}
-};
+std::string GetModuleDirectory();
+
+// Clipes pré-codificados: renderizados uma vez por transporte (EQ + limitador + encoder), guardados em
+// arquivos mapeados e enviados por ponteiro. O diretório é definido uma vez só, antes do primeiro registro
+// (que pode vir de um export antes do serviço subir): os ids registrados apontam para entradas do cache.
+void InitializeHapticClipCache()
+{
+	g_Service.InitializeHapticClipCache(GetModuleDirectory() + "\\haptic-clips");
+}
 
+uint32_t RegisterHapticClipFrames(uint64_t ContentHash, const float* Interleaved, size_t Frames, float Gain)
+{
+	InitializeHapticClipCache();
+	return g_Service.RegisterHapticClipFrames(ContentHash, Interleaved, Frames, Gain);
+}
 
-template<typename T>
-class ThreadSafeQueue
+/**
+ * @brief Arquivo de áudio qualquer decodificado pelo miniaudio (mp3, flac, wav...), convertido para 48 kHz estéreo.
+ */
+class FDecoderHapticSource final : public IHapticAudioSource
 {
 public:
-	void Push(const T& item)
+	~FDecoderHapticSource() override
 	{
-		std::lock_guard<std::mutex> lock(mMutex);
-		mQueue.push(item);
+		if (bInitialized)
+		{
+			ma_decoder_uninit(&Decoder);
+		}
 	}
 
-	void Push(T&& item)
+	bool Open(const std::string& Path)
 	{
-		std::lock_guard<std::mutex> lock(mMutex);
-		mQueue.push(std::move(item));
+		const ma_decoder_config Config = ma_decoder_config_init(ma_format_f32, 2, 48000);
+		bInitialized = ma_decoder_init_file(Path.c_str(), &Config, &Decoder) == MA_SUCCESS;
+		return bInitialized;
 	}
 
-	bool Pop(T& item)
+	const char* GetName() const override { return "decoder"; }
+	EHapticSourceDrive GetDrive() const override { return EHapticSourceDrive::Clock; }
+	bool IsFinished() const override { return bFinished; }
+
+	std::size_t Read(float* Interleaved, std::size_t Frames) override
 	{
-		std::lock_guard<std::mutex> lock(mMutex);
-		if (mQueue.empty())
+		ma_uint64 framesRead = 0;
+		const ma_result result = ma_decoder_read_pcm_frames(&Decoder, Interleaved, Frames, &framesRead);
+		if (result != MA_SUCCESS || framesRead < Frames)
 		{
-			return false;
+			bFinished = true;
 		}
-		item = mQueue.front();
-		mQueue.pop();
-		return true;
-	}
-
-	bool Empty()
-	{
-		std::lock_guard<std::mutex> lock(mMutex);
-		return mQueue.empty();
+		return static_cast<std::size_t>(framesRead);
 	}
 
 private:
-	std::queue<T> mQueue;
-	std::mutex mMutex;
-};
-
-struct AudioCallbackData
-{
-	ma_decoder* pDecoder = nullptr;
-	bool bIsSystemAudio = false;
-	float LowPassStateLeft = 0.0f;
-	float LowPassStateRight = 0.0f;
-	std::atomic<bool> bFinished{false};
-	std::atomic<uint64_t> framesPlayed{0};
-	bool bIsWireless = false;
-
-	// Filtros para atenuação de frequências específicas (Skate sliding, etc)
-	BiquadFilter FilterRailLeft, FilterRailRight;
-	BiquadFilter FilterConcreteLeft, FilterConcreteRight;
-	bool bFiltersConfigured = false;
-
-	ThreadSafeQueue<std::vector<uint8_t>> btPacketQueue;
-	ThreadSafeQueue<std::vector<int16_t>> usbSampleQueue;
-	std::mutex usbMutex;
-
-	std::vector<float> btAccumulator;
-	std::mutex btAccumulatorMutex;
+	ma_decoder Decoder{};
+	bool bInitialized = false;
+	bool bFinished = false;
 };
 
-void AudioDataCallback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+// "decoder:<arquivo>" é resolvido aqui (miniaudio); os demais tipos em CreateHapticSource
+std::unique_ptr<IHapticAudioSource> CreateModHapticSource(const std::string& Spec)
 {
-	auto* pData = static_cast<AudioCallbackData*>(pDevice->pUserData);
-	if (!pData)
-	{
-		return;
-	}
-
-	std::vector<float> tempBuffer(frameCount * 2);
-	ma_uint64 framesRead = 0;
-
-	if (pData->bIsSystemAudio)
+	static const std::string DecoderPrefix = "decoder:";
+	if (Spec.compare(0, DecoderPrefix.size(), DecoderPrefix) == 0)
 	{
-		if (pInput == nullptr)
-		{
-			return;
-		}
-
-		if (!pData->bFiltersConfigured)
-		{
-			float sr = static_cast<float>(pDevice->sampleRate);
-
-			pData->FilterRailLeft.ConfigurePeaking(sr, 4500.0f, 1.0f, 5.0f);
-			pData->FilterRailRight.ConfigurePeaking(sr, 4500.0f, 1.0f, 5.0f);
-			pData->FilterConcreteLeft.ConfigurePeaking(sr, 1200.0f, 0.7f, 6.0f);
-			pData->FilterConcreteRight.ConfigurePeaking(sr, 1200.0f, 0.7f, 6.0f);
-			pData->FilterConcreteLeft.ConfigurePeaking(sr, 200.0f, 0.7f, 5.0f);
-			pData->FilterConcreteRight.ConfigurePeaking(sr, 200.0f, 0.7f, 5.0f);
-
-			pData->bFiltersConfigured = true;
-		}
-
-		auto pInputFloat = static_cast<const float*>(pInput);
-		for (ma_uint32 i = 0; i < frameCount * 2; i += 2)
-		{
-			float l = pInputFloat[i];
-			float r = pInputFloat[i + 1];
-
-			// Aplica os filtros
-			l = pData->FilterRailLeft.Process(l);
-			l = pData->FilterConcreteLeft.Process(l);
-			r = pData->FilterRailRight.Process(r);
-			r = pData->FilterConcreteRight.Process(r);
-
-			tempBuffer[i] = l;
-			tempBuffer[i + 1] = r;
-		}
-		framesRead = frameCount;
-
-		if (pOutput)
+		auto Source = std::make_unique<FDecoderHapticSource>();
+		if (Source->Open(Spec.substr(DecoderPrefix.size())))
 		{
-			std::memcpy(pOutput, tempBuffer.data(), frameCount * 2 * sizeof(float));
+			return Source;
 		}
+		return nullptr;
 	}
-	else
-	{
-		if (!pData->pDecoder)
-		{
-			if (pOutput)
-			{
-				std::memset(pOutput, 0, frameCount * pDevice->playback.channels * ma_get_bytes_per_sample(pDevice->playback.format));
-			}
-			return;
-		}
+	return CreateHapticSource(Spec);
+}
 
-		ma_result result = ma_decoder_read_pcm_frames(pData->pDecoder, tempBuffer.data(), frameCount, &framesRead);
+/**
+ * @brief Captura WASAPI loopback (miniaudio) que entrega os blocos ao serviço.
+ *
+ * O device é criado quando a thread de haptics sobe, iniciado com o primeiro controle e continua rodando
+ * entre reconexões, trocas USB <-> BT e trocas de fonte.
+ */
+class FLoopbackCaptureDevice final : public IHapticCaptureDevice
+{
+public:
+	explicit FLoopbackCaptureDevice(FGamepadService& InService)
+		: Service(InService)
+	{
+	}
 
-		if (result != MA_SUCCESS || framesRead == 0)
+	bool Initialize() override
+	{
+		if (bInitialized)
 		{
-			pData->bFinished = true;
-			if (pOutput)
-			{
-				std::memset(pOutput, 0, frameCount * pDevice->playback.channels * ma_get_bytes_per_sample(pDevice->playback.format));
-			}
-			return;
+			return true;
 		}
 
-		if (!pData->bFiltersConfigured)
-		{
-			float sr = static_cast<float>(pDevice->sampleRate);
-			pData->FilterRailLeft.ConfigurePeaking(sr, 4500.0f, 1.0f, 5.0f);
-			pData->FilterRailRight.ConfigurePeaking(sr, 4500.0f, 1.0f, 5.0f);
-			pData->FilterConcreteLeft.ConfigurePeaking(sr, 1200.0f, 0.7f, 6.0f);
-			pData->FilterConcreteRight.ConfigurePeaking(sr, 1200.0f, 0.7f, 6.0f);
-			pData->FilterConcreteLeft.ConfigurePeaking(sr, 200.0f, 0.7f, 5.0f);
-			pData->FilterConcreteRight.ConfigurePeaking(sr, 200.0f, 0.7f, 5.0f);
-			pData->bFiltersConfigured = true;
-		}
+		ma_device_config deviceConfig = ma_device_config_init(ma_device_type_loopback);
+		deviceConfig.capture.format = ma_format_f32;
+		deviceConfig.capture.channels = 2;
+		deviceConfig.sampleRate = 48000;
+		deviceConfig.dataCallback = DataCallback;
+		deviceConfig.pUserData = &Service;
+		deviceConfig.wasapi.loopbackProcessID = 0;
 
-		for (ma_uint64 i = 0; i < framesRead; i++)
+		ma_result result = ma_device_init(nullptr, &deviceConfig, &Device);
+		if (result != MA_SUCCESS)
 		{
-			float l = tempBuffer[i * 2];
-			float r = tempBuffer[i * 2 + 1];
-
-			l = pData->FilterRailLeft.Process(l);
-			l = pData->FilterConcreteLeft.Process(l);
-			r = pData->FilterRailRight.Process(r);
-			r = pData->FilterConcreteRight.Process(r);
-
-			tempBuffer[i * 2] = l;
-			tempBuffer[i * 2 + 1] = r;
+			GAMEPAD_LOG_ERROR("[AppDLL] Failed to initialize audio device (Error: {}).", static_cast<int>(result));
+			return false;
 		}
 
-		if (pOutput)
-		{
-			auto* pOutputFloat = static_cast<float*>(pOutput);
-			std::memcpy(pOutputFloat, tempBuffer.data(), framesRead * 2 * sizeof(float));
-
-			if (framesRead < frameCount)
-			{
-				std::memset(&pOutputFloat[framesRead * 2], 0, (frameCount - framesRead) * 2 * sizeof(float));
-			}
-		}
+		bInitialized = true;
+		return true;
 	}
 
-	if (!pData->bIsWireless)
+	bool Start() override
 	{
-		// std::cout << "[AppDLL] Audio Loop USB." << std::endl;
-		for (ma_uint64 i = 0; i < framesRead; ++i)
-		{
-			float inLeft = tempBuffer[i * 2];
-			float inRight = tempBuffer[i * 2 + 1];
-
-			pData->LowPassStateLeft = kOneMinusAlpha * inLeft + kLowPassAlpha * pData->LowPassStateLeft;
-			pData->LowPassStateRight = kOneMinusAlpha * inRight + kLowPassAlpha * pData->LowPassStateRight;
-
-			float outLeft = std::clamp(inLeft - pData->LowPassStateLeft, -1.0f, 1.0f);
-			float outRight = std::clamp(inRight - pData->LowPassStateRight, -1.0f, 1.0f);
-
-			std::vector<int16_t> stereoSample = {
-				static_cast<int16_t>(outLeft * 32767.0f),
-				static_cast<int16_t>(outRight * 32767.0f)};
-			pData->usbSampleQueue.Push(stereoSample);
-		}
+		return bInitialized && ma_device_start(&Device) == MA_SUCCESS;
 	}
-	else
+
+	void Shutdown() override
 	{
-		// std::cout << "[AppDLL] Audio Loop BT." << std::endl;
+		if (bInitialized)
 		{
-			std::lock_guard<std::mutex> lock(pData->btAccumulatorMutex);
-
-			const size_t maxAccumulatorFrames = 24000 * 2;
-			if (pData->btAccumulator.size() > maxAccumulatorFrames)
-			{
-				pData->btAccumulator.clear();
-			}
-
-			for (ma_uint64 i = 0; i < framesRead; ++i)
-			{
-				pData->btAccumulator.push_back(tempBuffer[i * 2]);
-				pData->btAccumulator.push_back(tempBuffer[i * 2 + 1]);
-			}
-		}
-
-		const size_t requiredSamples = 1024 * 2;
-
-		while (true)
-		{
-			std::vector<float> framesToProcess;
-
-			{
-				std::lock_guard<std::mutex> lock(pData->btAccumulatorMutex);
-				if (pData->btAccumulator.size() < requiredSamples)
-				{
-					break;
-				}
-
-				framesToProcess.assign(pData->btAccumulator.begin(), pData->btAccumulator.begin() + requiredSamples);
-				pData->btAccumulator.erase(pData->btAccumulator.begin(), pData->btAccumulator.begin() + requiredSamples);
-			}
-
-			const float ratio = 3000.0f / 48000.0f;
-			const std::int32_t numInputFrames = 1024;
-
-			std::vector<float> resampledData(128, 0.0f);
-
-			for (std::int32_t outFrame = 0; outFrame < 64; ++outFrame)
-			{
-				float srcPos = static_cast<float>(outFrame) / ratio;
-				std::int32_t srcIndex = static_cast<std::int32_t>(srcPos);
-				float frac = srcPos - static_cast<float>(srcIndex);
-
-				if (srcIndex >= numInputFrames - 1)
-				{
-					srcIndex = numInputFrames - 2;
-					frac = 1.0f;
-				}
-				if (srcIndex < 0)
-				{
-					srcIndex = 0;
-				}
-
-				float left0 = framesToProcess[srcIndex * 2];
-				float left1 = framesToProcess[(srcIndex + 1) * 2];
-				float right0 = framesToProcess[srcIndex * 2 + 1];
-				float right1 = framesToProcess[(srcIndex + 1) * 2 + 1];
-
-				resampledData[outFrame * 2] = left0 + frac * (left1 - left0);
-				resampledData[outFrame * 2 + 1] = right0 + frac * (right1 - right0);
-			}
-
-			for (std::int32_t i = 0; i < 64; ++i)
-			{
-				const std::int32_t dataIndex = i * 2;
-
-				float inLeft = resampledData[dataIndex];
-				float inRight = resampledData[dataIndex + 1];
-
-				pData->LowPassStateLeft = kOneMinusAlphaBt * inLeft + kLowPassAlphaBt * pData->LowPassStateLeft;
-				pData->LowPassStateRight = kOneMinusAlphaBt * inRight + kLowPassAlphaBt * pData->LowPassStateRight;
-
-				resampledData[dataIndex] = inLeft - pData->LowPassStateLeft;
-				resampledData[dataIndex + 1] = inRight - pData->LowPassStateRight;
-			}
-
-			std::vector<std::int8_t> packet1(64, 0);
-			for (std::int32_t i = 0; i < 32; ++i)
-			{
-				const std::int32_t dataIndex = i * 2;
-
-				float leftSample = resampledData[dataIndex];
-				float rightSample = resampledData[dataIndex + 1];
-
-				std::int8_t leftInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(leftSample * 127.0f)), -128, 127));
-				std::int8_t rightInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(rightSample * 127.0f)), -128, 127));
-
-				packet1[dataIndex] = leftInt8;
-				packet1[dataIndex + 1] = rightInt8;
-			}
-
-			std::vector<std::int8_t> packet2(64, 0);
-			for (std::int32_t i = 0; i < 32; ++i)
-			{
-				const std::int32_t dataIndex = (i + 32) * 2;
-
-				float leftSample = resampledData[dataIndex];
-				float rightSample = resampledData[dataIndex + 1];
-
-				std::int8_t leftInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(leftSample * 127.0f)), -128, 127));
-				std::int8_t rightInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(rightSample * 127.0f)), -128, 127));
-
-				const std::int32_t packetIndex = i * 2;
-				packet2[packetIndex] = leftInt8;
-				packet2[packetIndex + 1] = rightInt8;
-			}
-
-			std::vector<std::uint8_t> packet1Unsigned(packet1.begin(), packet1.end());
-			std::vector<std::uint8_t> packet2Unsigned(packet2.begin(), packet2.end());
-
-			pData->btPacketQueue.Push(packet1Unsigned);
-			pData->btPacketQueue.Push(packet2Unsigned);
+			ma_device_uninit(&Device);
+			bInitialized = false;
 		}
 	}
 
-	pData->framesPlayed += framesRead;
-}
-
-void ConsumeHapticsQueue(IGamepadAudioHaptics* AudioHaptics, AudioCallbackData& callbackData, bool IsWireless = false)
-{
-
-	if (IsWireless)
+private:
+	static void DataCallback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
 	{
-		std::vector<std::uint8_t> packet;
-		while (callbackData.btPacketQueue.Pop(packet))
-		{
-			AudioHaptics->AudioHapticUpdate(packet);
-		}
+		static_cast<FGamepadService*>(pDevice->pUserData)->OnCapture(static_cast<const float*>(pInput), frameCount);
 	}
-	else
-	{
-		std::lock_guard<std::mutex> lock(callbackData.usbMutex);
-		std::vector<std::int16_t> allSamples;
-		allSamples.reserve(2048 * 2);
 
-		std::vector<std::int16_t> stereoSample;
-		while (callbackData.usbSampleQueue.Pop(stereoSample))
-		{
-			if (stereoSample.size() >= 2)
-			{
-				allSamples.push_back(stereoSample[0]);
-				allSamples.push_back(stereoSample[1]);
-			}
-		}
-
-		if (!allSamples.empty())
-		{
-			AudioHaptics->AudioHapticUpdate(allSamples);
-		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(16));
-	}
-}
+	FGamepadService& Service;
+	ma_device Device{};
+	bool bInitialized = false;
+};
 
-ma_device g_AudioDevice;
-bool g_AudioDeviceInitialized = false;
-AudioCallbackData g_AudioCallbackData;
+FLoopbackCaptureDevice g_LoopbackCapture(g_Service);
 
 void AudioLoop()
 {
-	std::cout << "[AppDLL] Audio Loop Started." << std::endl;
+	FServiceClockThreadScope ClockScope;
 
-	ISonyGamepad* Gamepad = g_Registry->GetLibrary(0);
-	while (g_Running)
+	// DUALSENSE_MOD_HAPTIC_SOURCE: loopback (padrão), decoder:<arquivo>, file:<wav/f32>, pipe:<caminho>, tone[:Hz]
+	const char* SourceSetting = std::getenv("DUALSENSE_MOD_HAPTIC_SOURCE");
+	const std::string SourceSpec = SourceSetting && SourceSetting[0] ? SourceSetting : "loopback";
+	std::unique_ptr<IHapticAudioSource> Source = CreateModHapticSource(SourceSpec);
+	if (!Source)
 	{
-		if (Gamepad && Gamepad->IsConnected())
-		{
-			IGamepadAudioHaptics* AudioHaptics = Gamepad->GetIGamepadHaptics();
-			if (AudioHaptics)
-			{
-				if (!g_AudioDeviceInitialized)
-				{
-					if (g_AudioDeviceInitialized)
-					{
-						ma_device_uninit(&g_AudioDevice);
-						g_AudioDeviceInitialized = false;
-
-						{
-							std::lock_guard<std::mutex> lock(g_AudioCallbackData.btAccumulatorMutex);
-							g_AudioCallbackData.btAccumulator.clear();
-						}
-						std::vector<uint8_t> dummy;
-						while (g_AudioCallbackData.btPacketQueue.Pop(dummy));
-						std::vector<int16_t> dummy2;
-						while (g_AudioCallbackData.usbSampleQueue.Pop(dummy2));
-					}
-
-					static bool bIsWireless = Gamepad->GetConnectionType() == EDSDeviceConnection::Bluetooth;
-					std::cout << "[AppDLL] Initializing Audio Loopback for Haptics (" << (bIsWireless ? "Bluetooth" : "USB") << ")..." << std::endl;
-
-					FDeviceContext* Context = Gamepad->GetMutableDeviceContext();
-					if (!bIsWireless && Context)
-					{
-						if (!Context->AudioContext || !Context->AudioContext->IsValid())
-						{
-							IPlatformHardwareInfo::Get().InitializeAudioDevice(Context);
-						}
-					}
-
-					g_AudioCallbackData.bIsSystemAudio = true;
-					g_AudioCallbackData.bIsWireless = bIsWireless;
-					g_AudioCallbackData.bFinished = false;
-
-					ma_device_config deviceConfig = ma_device_config_init(ma_device_type_loopback);
-					deviceConfig.capture.format = ma_format_f32;
-					deviceConfig.capture.channels = 2;
-					deviceConfig.sampleRate = 48000;
-					deviceConfig.dataCallback = AudioDataCallback;
-					deviceConfig.pUserData = &g_AudioCallbackData;
-					deviceConfig.wasapi.loopbackProcessID = 0;
-
-					ma_result result = ma_device_init(nullptr, &deviceConfig, &g_AudioDevice);
-					if (result == MA_SUCCESS)
-					{
-						if (ma_device_start(&g_AudioDevice) == MA_SUCCESS)
-						{
-							g_AudioDeviceInitialized = true;
-							std::cout << "[AppDLL] Audio Loopback Started." << std::endl;
-						}
-						else
-						{
-							ma_device_uninit(&g_AudioDevice);
-							std::cerr << "[AppDLL] Failed to start audio device." << std::endl;
-						}
-					}
-					else
-					{
-						std::cerr << "[AppDLL] Failed to initialize audio device (Error: " << result << ")." << std::endl;
-					}
-				}
-				ConsumeHapticsQueue(AudioHaptics, g_AudioCallbackData, Gamepad->GetConnectionType() == EDSDeviceConnection::Bluetooth);
-			}
-		}
-		else
-		{
-			if (g_AudioDeviceInitialized)
-			{
-				ma_device_uninit(&g_AudioDevice);
-				g_AudioDeviceInitialized = false;
-				std::cout << "[AppDLL] Audio Loopback Stopped (Controller Disconnected)." << std::endl;
-			}
-		}
-
+		GAMEPAD_LOG_ERROR("[AppDLL] Haptic source '{}' unavailable, using loopback.", SourceSpec);
+		Source = std::make_unique<FLoopbackHapticSource>();
 	}
+	GAMEPAD_LOG_INFO("[AppDLL] Haptic source: {}.", Source->GetName());
+	g_Service.HapticSources.SetSource(std::move(Source));
 
-	if (g_AudioDeviceInitialized)
+	// O loopback é criado já, em paralelo à detecção HID
+	FHapticsLoop Loop(g_Service, g_LoopbackCapture);
+
+	// A enumeração dos endpoints de áudio também roda agora, em paralelo à detecção: no attach USB
+	// o InitializeAudioDevice já acha o endpoint do DualSense no cache
 	{
-		ma_device_uninit(&g_AudioDevice);
-		g_AudioDeviceInitialized = false;
+		ma_device_id EndpointId;
+		Ftest_windows_platform::FAudioEndpointCache::Get().FindDualSenseDevice(EndpointId);
 	}
 
-	std::cout << "[AppDLL] Audio Loop Stopped." << std::endl;
+	Loop.Run();
 }
 
 void InputLoop()
 {
-	std::cout << "[AppDLL] Input Loop Started." << std::endl;
-
-	uint64_t FrameCounter = 0;
-	while (g_Running)
-	{
-		float DeltaTime = 0.0166f;
-		ISonyGamepad* Gamepad = g_Registry->GetLibrary(0);
-		if (!Gamepad)
-		{
-			g_Registry->PlugAndPlay(DeltaTime);
-		}
-
-
-		if (Gamepad)
-		{
-			if (FrameCounter % 100 == 0)
-			{
-				Gamepad->DualSenseSettings(1, 1, 1, 0, 30, 0xFC, 0x00, 0x00);
-				auto Trigger = Gamepad->GetIGamepadTrigger();
-				if (Trigger)
-				{
-					Trigger->SetResistance(0, 0xff, EDSGamepadHand::AnyHand);
-				}
-				Gamepad->SetLightbar({200, 160, 80});
-				Gamepad->UpdateOutput();
-			}
-		}
-
-		if (Gamepad && Gamepad->GetConnectionType() == EDSDeviceConnection::Bluetooth)
-		{
-			Gamepad->UpdateInput(DeltaTime);
-		}
-
-		if (Gamepad && Gamepad->IsConnected())
-		{
-			FDeviceContext* DeviceContext = Gamepad->GetMutableDeviceContext();
-			if (DeviceContext)
-			{
-				FInputContext* CurrentState = DeviceContext->GetInputState();
-				if (CurrentState)
-				{
-#ifdef USE_VIGEM
-					if (g_ViGEmAdapter && Gamepad->GetConnectionType() == EDSDeviceConnection::Bluetooth)
-					{
-						g_ViGEmAdapter->Update(*CurrentState);
-					}
-#endif
-				}
-			}
-
-		}
-		else
-		{
-			static int NullCounter = 0;
-			if (++NullCounter % 60 == 0)
-			{
-				std::cout << "[AppDLL] Gamepad Object is NULL for ID " << g_Registry->Policy.deviceId << std::endl;
-			}
-		}
+	FServiceClockThreadScope ClockScope;
+	FInputLoop Loop(g_Service, *g_Registry, FGamepadServiceSettings::FromEnvironment());
+	Loop.Run();
+}
 
-		FrameCounter++;
-	}
+std::string GetModuleDirectory()
+{
+	HMODULE module = NULL;
+	GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+	                   reinterpret_cast<LPCSTR>(&GetModuleDirectory), &module);
+	char path[MAX_PATH] = {};
+	const DWORD length = GetModuleFileNameA(module, path, MAX_PATH);
+	std::string fullPath(path, length);
+	const size_t separator = fullPath.find_last_of("\\/");
+	return separator == std::string::npos ? std::string(".") : fullPath.substr(0, separator);
+}
 
-	std::cout << "[AppDLL] Input Loop Stopped." << std::endl;
+std::string GetHostExecutableName()
+{
+	char path[MAX_PATH] = {};
+	const DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+	std::string fullPath(path, length);
+	const size_t separator = fullPath.find_last_of("\\/");
+	return separator == std::string::npos ? fullPath : fullPath.substr(separator + 1);
 }
 
 void CreateConsole()
@@ -768,12 +443,39 @@ void StartServiceThread()
 
 	CreateConsole();
 
+	// Daqui em diante std::cout/std::cerr passam pelo logger assíncrono (arquivo + console)
+	Logger::Initialize(GetModuleDirectory());
+
 	InitMod();
 
+	// Calibração IMU por controle/firmware, para o reconnect não esperar o feature report 0x05
+	FCalibrationCache::Get().SetDirectory(GetModuleDirectory() + "\\calibration");
+
+	// Clipes de haptics pré-codificados, reaproveitados entre sessões; nos ciclos Stop/Start não muda mais
+	InitializeHapticClipCache();
+
+#if GAMEPAD_TRACE_ENABLED
+	if (FFrameTrace::Get().Open(GetModuleDirectory() + "\\GamepadService.trace"))
+	{
+		const char* TraceSetting = std::getenv("DUALSENSE_MOD_TRACE");
+		FFrameTrace::Get().SetEnabled(TraceSetting && TraceSetting[0] == '1');
+	}
+#endif
+
+	g_Service.StartupMetrics.Begin();
+
 	std::cout << "[AppDLL] Service Thread Starting..." << std::endl;
 	std::cout.flush();
 
-	g_LastInputState = FInputContext();
+	// Criado uma vez por processo: nos ciclos Stop/Start o jogo e produtores externos seguem com o canal mapeado
+	if (g_Service.InitializeTelemetry(FTelemetryChannel::DefaultName))
+	{
+		std::cout << "[System] Telemetry channel: " << FTelemetryChannel::DefaultName << " (" << g_Service.Telemetry.GetCapacity() << " records)" << std::endl;
+	}
+	else
+	{
+		std::cerr << "[System] Telemetry channel could not be created, game telemetry disabled." << std::endl;
+	}
 
 	std::cout << "[System] Initializing Hardware Layer..." << std::endl;
 	std::cout.flush();
@@ -784,53 +486,62 @@ void StartServiceThread()
 	g_Registry = std::make_unique<TestDeviceRegistry>();
 	g_Registry->Policy.deviceId = 0;
 
-	std::cout << "[System] Requesting Immediate Detection..." << std::endl;
-	std::cout.flush();
-
-	while (true)
+	g_Service.SetGameProfile(ResolveGameProfile(GetHostExecutableName()));
+	const FGameProfile& GameProfile = g_Service.GetGameProfile();
+	std::cout << "[System] Game profile: " << (GameProfile.ExecutableName[0] ? GameProfile.ExecutableName : "default")
+	          << " (virtual pad: " << (GameProfile.VirtualPadMode == EVirtualPadMode::DualShock4 ? "DS4" : "X360") << ")" << std::endl;
+	// Curvas do usuário (DUALSENSE_MOD_LEFT_STICK / _RIGHT_STICK): inner,outer,anti,exponent
+	auto PrintStickCurve = [](const char* Stick, const FStickCurveConfig& Curve)
 	{
-		ISonyGamepad* Gamepad = g_Registry->GetLibrary(0);
-		if (Gamepad)
+		if (!Curve.IsIdentity())
 		{
-			Gamepad->DualSenseSettings(1, 1, 1, 0, 30, 0xFC, 0x00, 0x00);
-			auto Trigger = Gamepad->GetIGamepadTrigger();
-			if (Trigger)
-			{
-				Trigger->SetResistance(0, 0xff, EDSGamepadHand::AnyHand);
-			}
-			Gamepad->SetLightbar({200, 160, 80});
-
-			break;
+			std::cout << "[System] Stick curve (" << Stick << "): " << Curve.InnerDeadzone << "," << Curve.OuterDeadzone << "," << Curve.AntiDeadzone << ","
+			          << Curve.Exponent << std::endl;
 		}
-
-		g_Registry->PlugAndPlay(2.0f);
-		std::this_thread::sleep_for(std::chrono::milliseconds(200));
-	}
-
-	ISonyGamepad* Gamepad = g_Registry->GetLibrary(0);
+	};
+	PrintStickCurve("left", GameProfile.LeftStick);
+	PrintStickCurve("right", GameProfile.RightStick);
 
 #ifdef USE_VIGEM
-	if (Gamepad)
+	// A conexão com o ViGEm Bus é lenta e independe do controle: roda em paralelo com a detecção
+	g_VirtualPadState.store(EVirtualPadState::Pending, std::memory_order_release);
+	g_VirtualPadInitTask = std::async(std::launch::async, []
 	{
-		std::cout << "[System] Initializing ViGEm Adapter (Bluetooth Mode)..." << std::endl;
-		g_ViGEmAdapter = std::make_unique<ViGEmAdapter>();
-		if (!g_ViGEmAdapter->Initialize())
+		std::unique_ptr<IVirtualGamepadSink> Sink = std::make_unique<ViGEmAdapter>(g_Service.GetGameProfile().VirtualPadMode);
+		std::cout << "[System] Initializing Virtual Pad (" << Sink->GetName() << ", Bluetooth Mode)..." << std::endl;
+		Sink->SetRumbleMailbox(&g_Service.RumbleBridge.GetMailbox());
+		if (!Sink->Initialize())
 		{
-			std::cerr << "[System] ViGEm Adapter failed to initialize. Xbox Emulation will not be available." << std::endl;
+			std::cerr << "[System] Virtual Pad failed to initialize. Xbox Emulation will not be available." << std::endl;
+			return;
 		}
-	}
-#endif
 
+		EVirtualPadState Expected = EVirtualPadState::Pending;
+		if (!g_VirtualPadState.compare_exchange_strong(Expected, EVirtualPadState::Installing, std::memory_order_acq_rel))
+		{
+			Sink->Shutdown(); // o serviço parou durante a conexão com o bus
+			return;
+		}
+		g_VirtualPad = std::move(Sink);
+		// Publicado antes do Ready: depois dele o ShutdownVirtualPad pode limpar e desligar a qualquer momento
+		g_Service.SetVirtualPad(g_VirtualPad.get());
+		Expected = EVirtualPadState::Installing;
+		if (!g_VirtualPadState.compare_exchange_strong(Expected, EVirtualPadState::Ready, std::memory_order_acq_rel))
+		{
+			g_Service.SetVirtualPad(nullptr);
+			g_VirtualPad->Shutdown();
+			g_VirtualPad.reset();
+		}
+	});
+#endif
 
-	std::cout << "[System] Waiting for controller connection via USB/BT..." << std::endl;
+	// Detecção por evento: registrada antes da primeira detecção, para nenhuma chegada cair no meio
+	g_Service.SetArrivalNotifications(g_HidArrival.Register());
+	std::cout << "[System] Requesting Immediate Detection..." << std::endl;
 	std::cout.flush();
+	g_Registry->RequestImmediateDetection();
 
-	if (Gamepad)
-	{
-		Gamepad->UpdateOutput();
-	}
-
-	g_Running = true;
+	g_Service.Start();
 
 	std::cout << "[AppDLL] Gamepad Service Started." << std::endl;
 	std::cout.flush();
@@ -844,8 +555,21 @@ void StartServiceThread()
 		g_AudioThread.join();
 	}
 
+	if (g_VirtualPadInitTask.valid())
+	{
+		g_VirtualPadInitTask.wait();
+	}
+	ShutdownVirtualPad();
+	g_HidArrival.Unregister();
+	g_Service.SetArrivalNotifications(false);
+
+	FCalibrationCache::Get().Shutdown();
+	Ftest_windows_platform::FAudioEndpointCache::Get().Shutdown();
+	FFrameTrace::Get().Close();
+	// g_Service.Telemetry fica mapeado: uma thread do jogo ainda pode estar em PushGamepadTelemetry
+
 	std::cout << "[AppDLL] Gamepad Service Stopped." << std::endl;
-	std::cout.flush();
+	Logger::Shutdown();
 	g_ServiceInitialized = false;
 }
 
@@ -854,7 +578,7 @@ extern "C"
 
 __declspec(dllexport) void StartGamepadService()
 {
-	if (g_Running || g_ServiceInitialized)
+	if (g_Service.IsRunning() || g_ServiceInitialized)
 	{
 		return;
 	}
@@ -869,7 +593,171 @@ __declspec(dllexport) void StartGamepadService()
 
 __declspec(dllexport) void StopGamepadService()
 {
-	g_Running = false;
+	g_Service.Stop();
+}
+
+// Copia o último estado publicado pela InputLoop. Retorna o número do frame (0 = nenhum input ainda).
+__declspec(dllexport) uint64_t GetGamepadInputState(FInputContext* OutState)
+{
+	if (!OutState)
+	{
+		return 0;
+	}
+	return g_Service.InputState.Snapshot(*OutState);
+}
+
+// Copia a última orientação publicada (quaternion Z-up, pitch/roll em radianos). Retorna o número da publicação.
+__declspec(dllexport) uint64_t GetGamepadMotionState(FMotionState* OutState)
+{
+	if (!OutState)
+	{
+		return 0;
+	}
+	return g_Service.MotionState.Snapshot(*OutState);
+}
+
+// Copia as métricas de timing dos reports (latência acima do piso, jitter, perdas, skew do relógio do controle).
+__declspec(dllexport) uint64_t GetGamepadReportTiming(FReportTimingMetrics* OutMetrics)
+{
+	if (!OutMetrics)
+	{
+		return 0;
+	}
+	return g_Service.ReportTiming.Snapshot(*OutMetrics);
+}
+
+// Envia um registro de telemetria (ETelemetryType + até 4 valores) para os efeitos. Um produtor por vez:
+// este export ou um processo externo escrevendo no canal FTelemetryChannel::DefaultName (com timestamp em
+// ns do std::chrono::steady_clock, a mesma base do IServiceClock). Nunca bloqueia; retorna false se o
+// canal ainda não foi criado (serviço nunca iniciado) ou o anel está cheio. Depois do Stop o canal segue
+// mapeado e o push segue retornando true enquanto houver espaço: o registro fica no anel até o próximo Start.
+__declspec(dllexport) bool PushGamepadTelemetry(uint16_t Type, const float* Values, uint32_t Count)
+{
+	return g_Service.Telemetry.Push(static_cast<ETelemetryType>(Type), Values, Count, IServiceClock::Get().NowNs());
+}
+
+// Nome do canal de memória compartilhada para produtores externos
+__declspec(dllexport) const char* GetGamepadTelemetryChannelName()
+{
+	return FTelemetryChannel::DefaultName;
+}
+
+// PCM de haptics do jogo, 48 kHz estéreo float intercalado. Uma thread produtora; nunca bloqueia.
+// Sem cópia: AcquireGamepadHapticBuffer entrega até Frames posições do anel (em dois trechos quando ele
+// dá a volta), o jogo escreve nelas e CommitGamepadHapticBuffer publica. Retornam o número de frames.
+__declspec(dllexport) uint32_t AcquireGamepadHapticBuffer(uint32_t Frames, float** OutFirst, uint32_t* OutFirstFrames, float** OutSecond, uint32_t* OutSecondFrames)
+{
+	const FHapticRingSpan Span = g_Service.HapticPcmInput.Acquire(Frames);
+	if (OutFirst) *OutFirst = Span.Data[0];
+	if (OutFirstFrames) *OutFirstFrames = static_cast<uint32_t>(Span.Frames[0]);
+	if (OutSecond) *OutSecond = Span.Data[1];
+	if (OutSecondFrames) *OutSecondFrames = static_cast<uint32_t>(Span.Frames[1]);
+	return static_cast<uint32_t>(Span.Total());
+}
+
+__declspec(dllexport) uint32_t CommitGamepadHapticBuffer(uint32_t Frames)
+{
+	return static_cast<uint32_t>(g_Service.HapticPcmInput.Commit(Frames, IServiceClock::Get().NowNs()));
+}
+
+// Alternativa com o buffer do jogo (ponteiro + frames): o EQ lê dele e escreve direto no anel
+__declspec(dllexport) uint32_t SubmitGamepadHapticPcm(const float* Interleaved, uint32_t Frames)
+{
+	if (!Interleaved)
+	{
+		return 0;
+	}
+	return static_cast<uint32_t>(g_Service.HapticPcmInput.Submit(Interleaved, Frames, IServiceClock::Get().NowNs()));
+}
+
+// Toca um clipe de haptics (48 kHz estéreo float intercalado) por cima da fonte atual, que é abafada.
+// A memória é do jogo e precisa continuar válida até o clipe acabar ou outro ser disparado. Uma thread por vez.
+__declspec(dllexport) void PlayGamepadHapticClip(const float* Interleaved, uint32_t Frames, float Gain)
+{
+	g_Service.HapticClip.Play(Interleaved, Interleaved ? Frames : 0, Gain);
+}
+
+__declspec(dllexport) void StopGamepadHapticClip()
+{
+	g_Service.HapticClip.Stop();
+}
+
+// Registra um clipe recorrente (48 kHz estéreo float intercalado) no cache de clipes pré-codificados e retorna
+// seu id, 0 em caso de erro. Renderiza para USB e BT só na primeira vez; depois, inclusive em outras sessões,
+// vem do cache. Chamar no carregamento, não a cada disparo; a memória pode ser liberada ao retornar.
+__declspec(dllexport) uint32_t RegisterGamepadHapticClip(const float* Interleaved, uint32_t Frames, float Gain)
+{
+	if (!Interleaved || Frames == 0)
+	{
+		return 0;
+	}
+	const uint64_t ContentHash = FHapticClipCache::HashContent(Interleaved, static_cast<size_t>(Frames) * 2 * sizeof(float));
+	return RegisterHapticClipFrames(ContentHash, Interleaved, Frames, Gain);
+}
+
+// Mesmo registro a partir de um arquivo de áudio (mp3, flac, wav...). A chave é o conteúdo do arquivo,
+// então com o cache quente ele nem chega a ser decodificado.
+__declspec(dllexport) uint32_t RegisterGamepadHapticClipFile(const char* Path, float Gain)
+{
+	FMappedFile File;
+	if (!Path || !File.Open(Path))
+	{
+		return 0;
+	}
+	const uint64_t ContentHash = FHapticClipCache::HashContent(File.GetData(), File.GetSize());
+	if (const uint32_t ClipId = RegisterHapticClipFrames(ContentHash, nullptr, 0, Gain))
+	{
+		return ClipId;
+	}
+
+	ma_decoder_config Config = ma_decoder_config_init(ma_format_f32, 2, 48000);
+	ma_uint64 Frames = 0;
+	void* Samples = nullptr;
+	if (ma_decode_memory(File.GetData(), File.GetSize(), &Config, &Frames, &Samples) != MA_SUCCESS)
+	{
+		GAMEPAD_LOG_ERROR("[AppDLL] Failed to decode haptic clip '{}'.", Path);
+		return 0;
+	}
+	const uint32_t ClipId = RegisterHapticClipFrames(ContentHash, static_cast<const float*>(Samples), static_cast<size_t>(Frames), Gain);
+	ma_free(Samples, nullptr);
+	return ClipId;
+}
+
+// Dispara um clipe registrado, com a mesma mixagem do PlayGamepadHapticClip: soma ao mix ao vivo (rumble,
+// PCM do jogo) e abafa a fonte atual. Enquanto o mix ao vivo está em silêncio o clipe é enviado direto do
+// cache, sem custo de mixagem. Uma thread por vez. False se o id não existe.
+__declspec(dllexport) bool PlayGamepadCachedHapticClip(uint32_t ClipId)
+{
+	return g_Service.PlayCachedHapticClip(ClipId);
+}
+
+__declspec(dllexport) void StopGamepadCachedHapticClip()
+{
+	g_Service.StopCachedHapticClip();
+}
+
+// Troca a fonte de áudio dos haptics sem reiniciar nada (mesmas descrições de DUALSENSE_MOD_HAPTIC_SOURCE).
+// Retorna false, mantendo a fonte atual, se a descrição for inválida ou o arquivo/pipe não abrir.
+__declspec(dllexport) bool SetGamepadHapticSource(const char* Spec)
+{
+	if (!Spec)
+	{
+		return false;
+	}
+	std::unique_ptr<IHapticAudioSource> Source = CreateModHapticSource(Spec);
+	if (!Source)
+	{
+		return false;
+	}
+	g_Service.HapticSources.SetSource(std::move(Source));
+	return true;
+}
+
+// Liga/desliga o trace em tempo de execução (builds com GAMEPAD_TRACE). Retorna se o trace ficou ativo.
+__declspec(dllexport) bool SetGamepadTraceEnabled(bool bEnable)
+{
+	FFrameTrace::Get().SetEnabled(bEnable);
+	return FFrameTrace::Get().IsEnabled();
 }
 
 }
@@ -883,15 +771,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
 			break;
 
 		case DLL_PROCESS_DETACH:
-			g_Running = false;
+			g_Service.Stop();
 
-#ifdef USE_VIGEM
-			if (g_ViGEmAdapter)
-			{
-				g_ViGEmAdapter->Shutdown();
-				g_ViGEmAdapter.reset();
-			}
-#endif
+			ShutdownVirtualPad();
 
 			if (g_Registry)
 			{
@@ -906,6 +788,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
 					g_ServiceThread.detach();
 			}
 
+			// Sem join aqui (loader lock): só descarrega o que já está nos buffers
+			Logger::Flush();
 			g_ServiceInitialized = false;
 			break;
 	}
@@ -0,0 +1,189 @@
+// Audio endpoint lookup test: the cached DualSense endpoint match the Windows audio path uses on each
+// USB reconnect, against a fake enumeration backend that lists thousands of endpoints. Checks the
+// match (by cached ID, then name, then the DualSense name rule) across device changes, then benchmarks
+// reconnect cost with the cache against a fresh enumeration per reconnect.
+//
+//   test-audio-endpoints [endpoints] [reconnects] [enumeration-cost-us-per-endpoint]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Audio/AudioEndpointLookup.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::size_t kDefaultEndpoints = 2000;
+    constexpr std::size_t kDefaultReconnects = 500;
+    constexpr double kDefaultCostUs = 2.0;      // per endpoint and enumeration (property store reads)
+    constexpr std::size_t kNotificationEvery = 50; // unrelated device change every N reconnects
+
+    /**
+     * Fake backend: a list of endpoints and a busy-wait per listed endpoint, like the real
+     * enumeration's cost that grows with the number of devices.
+     */
+    class FFakeEndpointBackend : public IAudioEndpointBackend
+    {
+    public:
+        bool EnumeratePlayback(std::vector<FAudioEndpoint>& OutEndpoints) override
+        {
+            ++Enumerations;
+            if (bFail)
+            {
+                return false;
+            }
+            const auto Deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(static_cast<std::int64_t>(CostUs * 1000.0 * Endpoints.size()));
+            while (std::chrono::steady_clock::now() < Deadline)
+            {
+            }
+            OutEndpoints = Endpoints;
+            return true;
+        }
+
+        std::vector<FAudioEndpoint> Endpoints;
+        double CostUs = 0.0;
+        bool bFail = false;
+        std::uint64_t Enumerations = 0;
+    };
+
+    FAudioEndpoint MakeEndpoint(std::size_t Index, const std::string& Name)
+    {
+        return {"{0.0.0.00000000}.{" + std::to_string(100000 + Index) + "}", Name};
+    }
+
+    std::vector<FAudioEndpoint> MakeEndpointList(std::size_t Count)
+    {
+        std::vector<FAudioEndpoint> Endpoints;
+        Endpoints.reserve(Count);
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            Endpoints.push_back(MakeEndpoint(i, "Speakers " + std::to_string(i) + " (High Definition Audio Device)"));
+        }
+        return Endpoints;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t EndpointCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultEndpoints;
+    const std::size_t Reconnects = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : kDefaultReconnects;
+    const double CostUs = argc > 3 ? std::strtod(argv[3], nullptr) : kDefaultCostUs;
+    FTestReport Test("Audio Endpoints", std::to_string(EndpointCount) + " endpoints");
+
+    const FAudioEndpoint DualSense = MakeEndpoint(EndpointCount, "Speakers (DualSense Wireless Controller)");
+    const FAudioEndpoint SecondPad = MakeEndpoint(EndpointCount + 1, "Speakers (2- DualSense Wireless Controller)");
+
+    // 1. The DualSense is found among thousands of endpoints; later lookups do not enumerate
+    {
+        FFakeEndpointBackend Backend;
+        Backend.Endpoints = MakeEndpointList(EndpointCount);
+        Backend.Endpoints.insert(Backend.Endpoints.begin() + static_cast<std::ptrdiff_t>(EndpointCount / 2), DualSense);
+
+        FAudioEndpointLookup Lookup;
+        FAudioEndpoint Found;
+        Test.Expect(Lookup.Find(Backend, Found, true) && Found.Id == DualSense.Id, "DualSense endpoint not found");
+        for (int i = 0; i < 10; ++i)
+        {
+            Lookup.Find(Backend, Found, true);
+        }
+        Test.Expect(Backend.Enumerations == 1 && Found.Id == DualSense.Id, "cached lookup enumerated again");
+
+        Backend.bFail = true;
+        Lookup.Invalidate();
+        Test.Expect(!Lookup.Find(Backend, Found, true), "failed enumeration reported an endpoint");
+        Backend.bFail = false;
+        Test.Expect(Lookup.Find(Backend, Found, true) && Found.Id == DualSense.Id, "lookup did not retry after a failed enumeration");
+    }
+
+    // 2. Device changes keep the cached endpoint: by ID over a second pad listed first, by name when the ID changed
+    {
+        FFakeEndpointBackend Backend;
+        Backend.Endpoints = MakeEndpointList(EndpointCount);
+        Backend.Endpoints.push_back(DualSense);
+
+        FAudioEndpointLookup Lookup;
+        FAudioEndpoint Found;
+        Lookup.Find(Backend, Found, true);
+
+        Backend.Endpoints.insert(Backend.Endpoints.begin(), SecondPad);
+        std::shuffle(Backend.Endpoints.begin() + 1, Backend.Endpoints.end(), std::mt19937(7));
+        Lookup.Invalidate();
+        Test.Expect(Lookup.Find(Backend, Found, true) && Found.Id == DualSense.Id, "a second DualSense took over the cached endpoint");
+
+        // Same controller, endpoint re-created under a new ID
+        for (FAudioEndpoint& Endpoint : Backend.Endpoints)
+        {
+            if (Endpoint.Id == DualSense.Id)
+            {
+                Endpoint.Id += "-recreated";
+            }
+        }
+        Lookup.Invalidate();
+        Test.Expect(Lookup.Find(Backend, Found, true) && Found.Id == DualSense.Id + "-recreated", "re-created endpoint not followed by name");
+
+        // Open failure forgets the match: the name rule picks again from scratch (first DualSense listed)
+        Lookup.Forget();
+        Test.Expect(Lookup.Find(Backend, Found, true) && Found.Id == SecondPad.Id, "forgotten endpoint still preferred");
+
+        Backend.Endpoints.erase(Backend.Endpoints.begin());
+        std::erase_if(Backend.Endpoints, [&](const FAudioEndpoint& Endpoint) { return Endpoint.Name == DualSense.Name; });
+        Lookup.Invalidate();
+        Test.Expect(!Lookup.Find(Backend, Found, true), "endpoint reported after the controller was removed");
+    }
+
+    // 3. Without notifications every lookup enumerates
+    {
+        FFakeEndpointBackend Backend;
+        Backend.Endpoints = {DualSense};
+        FAudioEndpointLookup Lookup;
+        FAudioEndpoint Found;
+        for (int i = 0; i < 5; ++i)
+        {
+            Lookup.Find(Backend, Found, false);
+        }
+        Test.Expect(Backend.Enumerations == 5, "lookup without notifications served a stale cache");
+    }
+
+    // 4. Benchmark: reconnect cost, fresh enumeration per reconnect vs the cache with periodic device changes
+    {
+        FFakeEndpointBackend Backend;
+        Backend.Endpoints = MakeEndpointList(EndpointCount);
+        Backend.Endpoints.push_back(DualSense);
+        Backend.CostUs = CostUs;
+
+        auto Run = [&](bool bCached) {
+            FAudioEndpointLookup Lookup;
+            Backend.Enumerations = 0;
+            FAudioEndpoint Found;
+            std::size_t Misses = 0;
+            const auto Start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < Reconnects; ++i)
+            {
+                if (bCached && i % kNotificationEvery == kNotificationEvery - 1)
+                {
+                    Lookup.Invalidate();
+                }
+                Misses += Lookup.Find(Backend, Found, bCached) && Found.Id == DualSense.Id ? 0 : 1;
+            }
+            const double Us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Reconnects);
+            std::cout << "[Endpoints] " << (bCached ? "Cached:   " : "Uncached: ") << Reconnects << " reconnects, " << Backend.Enumerations
+                      << " enumerations, " << Us << " us per reconnect" << std::endl;
+            Test.Expect(Misses == 0, "benchmark lookup missed the DualSense endpoint");
+            return Backend.Enumerations;
+        };
+
+        const std::uint64_t Uncached = Run(false);
+        const std::uint64_t Cached = Run(true);
+        Test.Expect(Uncached == Reconnects, "uncached run skipped enumerations");
+        Test.Expect(Cached == 1 + Reconnects / kNotificationEvery, "cached run enumerated outside device changes");
+    }
+
+    return Test.Finish();
+}
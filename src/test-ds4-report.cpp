@@ -0,0 +1,191 @@
+// DS4 report test: BuildDs4Report on raw DualSense reports from the simulated controller (USB and
+// Bluetooth) and on decoded states, i.e. everything ViGEmAdapter copies into DS4_REPORT_EX, with no
+// ViGEm client involved. Checks the plain copies, the timestamp, touch Y and battery conversions, that
+// both transports give the same report, and that the D-pad hat and face buttons agree between the raw
+// and the decoded path, then benchmarks both builds.
+//
+//   test-ds4-report [builds]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Simulation/SimulatedDualSense.h"
+#include "Testing/TestReport.h"
+#include "VirtualPad/Ds4Report.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::size_t kDefaultBuilds = 2000000;
+    constexpr std::int64_t kReportTimeNs = 123456789;
+
+    // D-pad (up, down, left, right) -> hat value shared by the DualSense and the DS4: N, NE, E, SE, S, SW, W, NW, none
+    struct FHatCase
+    {
+        bool bUp, bDown, bLeft, bRight;
+        std::uint8_t Hat;
+    };
+    constexpr FHatCase kHatCases[] = {
+        {true, false, false, false, 0}, {true, false, false, true, 1}, {false, false, false, true, 2},
+        {false, true, false, true, 3},  {false, true, false, false, 4}, {false, true, true, false, 5},
+        {false, false, true, false, 6}, {true, false, true, false, 7},  {false, false, false, false, Ds4Report::DpadNone},
+    };
+
+    struct FRawReport
+    {
+        std::uint8_t Bytes[DualSenseOutputReport::BtReportSize] = {};
+        bool bBluetooth = false;
+
+        FDualSenseReportView View() const { return FDualSenseReportView::FromBuffer(Bytes, sizeof(Bytes), bBluetooth); }
+        std::uint8_t* Payload() { return Bytes + (bBluetooth ? DualSenseReport::BtHeaderSize : DualSenseReport::UsbHeaderSize); }
+    };
+
+    FRawReport ReadReport(const FSimulatedPadState& State, ESimulatedTransport Transport)
+    {
+        FSimulatedDualSense Device("sim://dualsense/ds4", Transport);
+        if (Transport == ESimulatedTransport::Bluetooth)
+        {
+            std::uint8_t Calibration[DualSenseCalibrationReport::Size] = {DualSenseCalibrationReport::ReportId};
+            Device.ReadFeatureReport(Calibration, sizeof(Calibration)); // full reports from here on
+        }
+        Device.SetState(State, 0);
+        FRawReport Report;
+        Report.bBluetooth = Transport == ESimulatedTransport::Bluetooth;
+        Device.ReadInputReport(Report.Bytes, sizeof(Report.Bytes), kReportTimeNs);
+        return Report;
+    }
+
+    // DualSense touch point: bit 7 set = no touch, 12-bit X, 12-bit Y
+    void PutTouchPoint(std::uint8_t* Point, bool bActive, std::uint8_t Id, std::uint32_t X, std::uint32_t Y)
+    {
+        Point[0] = static_cast<std::uint8_t>((bActive ? 0x00 : 0x80) | (Id & 0x7F));
+        Point[1] = static_cast<std::uint8_t>(X & 0xFF);
+        Point[2] = static_cast<std::uint8_t>(((X >> 8) & 0x0F) | ((Y & 0x0F) << 4));
+        Point[3] = static_cast<std::uint8_t>(Y >> 4);
+    }
+
+    void GetTouchPoint(const std::uint8_t Data[3], std::uint32_t& OutX, std::uint32_t& OutY)
+    {
+        OutX = Data[0] | ((Data[1] & 0x0F) << 8);
+        OutY = ((Data[1] & 0xF0) >> 4) | (Data[2] << 4);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t Builds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultBuilds;
+    FTestReport Test("DS4 Report", std::to_string(Builds) + " builds");
+
+    FSimulatedPadState State;
+    State.LeftStickX = 0x10;
+    State.LeftStickY = 0xF0;
+    State.RightStickX = 0x81;
+    State.RightStickY = 0x7F;
+    State.LeftTrigger = 0x40;
+    State.RightTrigger = 0xFF;
+    State.Buttons0 = 0x20 | 2;    // cross, D-pad east
+    State.Buttons1 = 0x01 | 0x20; // L1, options
+    State.Buttons2 = 0x01 | 0x04; // PS, mute
+    State.Battery = 0x27;         // level 7, charging
+
+    // 1. Raw path: copies, conversions, and the same report over both transports
+    {
+        FRawReport Usb = ReadReport(State, ESimulatedTransport::Usb);
+        FRawReport Bluetooth = ReadReport(State, ESimulatedTransport::Bluetooth);
+        Test.Expect(Usb.View().IsValid() && Bluetooth.View().IsValid(), "simulated report not recognized as a full input report");
+
+        PutTouchPoint(Usb.Payload() + DualSenseReport::TouchPoint0, true, 5, DualSenseReport::TouchpadWidth - 1, DualSenseReport::TouchpadHeight - 1);
+        PutTouchPoint(Usb.Payload() + DualSenseReport::TouchPoint1, true, 6, 0, 540);
+        std::memcpy(Bluetooth.Payload() + DualSenseReport::TouchPoint0, Usb.Payload() + DualSenseReport::TouchPoint0, 8);
+
+        const FDs4ReportEx Report = BuildDs4Report(Usb.View());
+        const FDs4ReportEx ReportBt = BuildDs4Report(Bluetooth.View());
+        Test.Expect(std::memcmp(&Report, &ReportBt, sizeof(Report)) == 0, "USB and Bluetooth reports of the same state map differently");
+
+        Test.Expect(Report.ThumbLX == 0x10 && Report.ThumbLY == 0xF0 && Report.ThumbRX == 0x81 && Report.ThumbRY == 0x7F, "sticks not copied as-is");
+        Test.Expect(Report.TriggerL == 0x40 && Report.TriggerR == 0xFF, "triggers not copied as-is");
+        Test.Expect(Report.Buttons == (State.Buttons0 | (State.Buttons1 << 8)), "button bytes not copied as-is");
+        Test.Expect(Report.Special == 0x01, "PS / touchpad bits wrong, or mute leaked into them");
+        Test.Expect(Report.BatteryLvlSpecial == 0x17, "battery level or charging flag converted wrongly");
+
+        const std::uint32_t SensorTicks = static_cast<std::uint32_t>(kReportTimeNs * 3 / 1000);
+        Test.Expect(Report.Timestamp == static_cast<std::uint16_t>(SensorTicks / 16), "sensor timestamp not converted to 16/3 us units");
+        Test.Expect(Report.AccelY == 0x2000 && Report.AccelX == 0 && Report.GyroX == 0, "IMU words not copied as-is");
+        Test.Expect(Report.CurrentTouch.PacketCounter == Usb.View().GetSequence() && Report.TouchPacketsN == 1, "touch packet header wrong");
+
+        std::uint32_t X = 0, Y = 0;
+        GetTouchPoint(Report.CurrentTouch.TouchData1, X, Y);
+        Test.Expect(Report.CurrentTouch.IsUpTrackingNum1 == 5 && X == DualSenseReport::TouchpadWidth - 1 && Y == Ds4Report::TouchpadHeight - 1,
+                    "touch point at the bottom-right corner mapped off the DS4 pad");
+        GetTouchPoint(Report.CurrentTouch.TouchData2, X, Y);
+        Test.Expect(Report.CurrentTouch.IsUpTrackingNum2 == 6 && X == 0 && Y == 540 * Ds4Report::TouchpadHeight / DualSenseReport::TouchpadHeight,
+                    "touch Y not rescaled to the DS4 pad");
+
+        const FDs4ReportEx Idle = BuildDs4Report(ReadReport(FSimulatedPadState{}, ESimulatedTransport::Usb).View());
+        Test.Expect(Idle.CurrentTouch.IsUpTrackingNum1 == 0x80 && Idle.CurrentTouch.IsUpTrackingNum2 == 0x80, "released touch points reported as touching");
+    }
+
+    // 2. Decoded path: Y inversion, trigger bits, and the same hat and face buttons as the raw path
+    {
+        FInputContext Context;
+        Context.LeftAnalog.Y = 1.0f;
+        Context.RightAnalog.X = -1.0f;
+        Context.LeftTriggerAnalog = 1.0f;
+        Context.bPSButton = true;
+        const FDs4ReportEx Report = BuildDs4Report(Context);
+        Test.Expect(Report.ThumbLY == 0 && Report.ThumbRX == 0 && Report.ThumbLX == 127, "decoded sticks scaled or inverted wrongly");
+        Test.Expect(Report.TriggerL == 255 && (Report.Buttons & (1 << 10)) && !(Report.Buttons & (1 << 11)), "L2 / R2 digital bits do not follow the triggers");
+        Test.Expect(Report.Special == 0x01, "PS button not mapped");
+
+        std::size_t HatMismatches = 0;
+        for (const FHatCase& Case : kHatCases)
+        {
+            FInputContext Decoded;
+            Decoded.bDpadUp = Case.bUp;
+            Decoded.bDpadDown = Case.bDown;
+            Decoded.bDpadLeft = Case.bLeft;
+            Decoded.bDpadRight = Case.bRight;
+            Decoded.bSquare = Decoded.bTriangle = true;
+
+            FSimulatedPadState Raw;
+            Raw.Buttons0 = static_cast<std::uint8_t>(0x10 | 0x80 | Case.Hat);
+            const FDs4ReportEx FromContext = BuildDs4Report(Decoded);
+            const FDs4ReportEx FromRaw = BuildDs4Report(ReadReport(Raw, ESimulatedTransport::Usb).View());
+            HatMismatches += (FromContext.Buttons & 0xFF) == Raw.Buttons0 && (FromRaw.Buttons & 0xFF) == Raw.Buttons0 ? 0 : 1;
+        }
+        Test.Expect(HatMismatches == 0, "D-pad hat or face buttons differ between the decoded and the raw path");
+    }
+
+    // 3. Benchmark: raw copy vs decoded fallback
+    {
+        const FRawReport Raw = ReadReport(State, ESimulatedTransport::Bluetooth);
+        const FDualSenseReportView View = Raw.View();
+        FInputContext Context;
+        Context.LeftAnalog.X = 0.5f;
+        Context.bCross = true;
+
+        std::uint64_t Checksum = 0;
+        auto Start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < Builds; ++i)
+        {
+            Checksum += BuildDs4Report(View).Buttons + i;
+        }
+        const double RawNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Builds);
+
+        Start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < Builds; ++i)
+        {
+            Context.RightTriggerAnalog = static_cast<float>(i & 0xFF) / 255.0f;
+            Checksum += BuildDs4Report(Context).TriggerR;
+        }
+        const double DecodedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Builds);
+
+        std::cout << "[Ds4] ns per report: raw " << RawNs << ", decoded " << DecodedNs << " (checksum " << Checksum << ")" << std::endl;
+    }
+
+    return Test.Finish();
+}
@@ -0,0 +1,384 @@
+// Haptic clip cache test: clips rendered once per transport must match the live mixer/encoder path
+// byte for byte, survive in mapped cache files across cache instances, miss on any content or
+// parameter change and on corrupt files, stay within the directory byte budget, play back at the
+// real-time rate and resume on the mixer bus where the player left off. Then a benchmark of playback
+// CPU time, cold (live path on every play) against warm (cached payloads sent by pointer).
+//
+//   test-haptic-clip-cache [plays per benchmark point]
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Audio/HapticClipCache.h"
+#include "Audio/HapticMixer.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::size_t ClipFrames = 24000; // 0.5 s
+
+    // CPU time of the calling thread, the one that would play the clip
+    double CpuSeconds()
+    {
+#ifdef _WIN32
+        return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#else
+        timespec Now{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Now);
+        return static_cast<double>(Now.tv_sec) + static_cast<double>(Now.tv_nsec) * 1e-9;
+#endif
+    }
+
+    // A landing: a decaying 60 Hz thump under a short noise burst, loud enough to reach the limiter
+    std::vector<float> MakeLandingClip(std::uint32_t Seed)
+    {
+        std::mt19937 Rng(Seed);
+        std::uniform_real_distribution<float> Noise(-1.0f, 1.0f);
+        std::vector<float> Samples(ClipFrames * 2);
+        for (std::size_t i = 0; i < ClipFrames; ++i)
+        {
+            const float Time = static_cast<float>(i) / 48000.0f;
+            const float Thump = 1.1f * std::exp(-Time * 9.0f) * std::sin(2.0f * 3.14159265f * 60.0f * Time);
+            const float Burst = 0.4f * std::exp(-Time * 30.0f);
+            Samples[i * 2] = Thump + Burst * Noise(Rng);
+            Samples[i * 2 + 1] = Thump + Burst * Noise(Rng);
+        }
+        return Samples;
+    }
+
+    // What the bus sends for the clip alone: FClipHapticSource on the mixer, then the encoder
+    std::vector<std::uint8_t> EncodeLive(FHapticMixer& Mixer, FClipHapticSource& Clip, FHapticEncoder& Encoder, const std::vector<float>& Samples, std::size_t Frames)
+    {
+        std::vector<std::uint8_t> Payload;
+        const auto OnUsb = [&Payload](std::vector<std::int16_t>& Batch)
+        {
+            const auto* Bytes = reinterpret_cast<const std::uint8_t*>(Batch.data());
+            Payload.insert(Payload.end(), Bytes, Bytes + Batch.size() * sizeof(std::int16_t));
+        };
+        const auto OnBt = [&Payload](std::vector<std::uint8_t>& Packet) { Payload.insert(Payload.end(), Packet.begin(), Packet.end()); };
+
+        Clip.Play(Samples.data(), ClipFrames);
+        for (std::size_t Offset = 0; Offset < Frames; Offset += FHapticMixer::BlockFrames)
+        {
+            std::size_t Count = std::min(FHapticMixer::BlockFrames, Frames - Offset);
+            float* Block = Encoder.AppendFrames(Count);
+            Mixer.Mix(Block, Count);
+            Encoder.Flush(OnUsb, OnBt);
+        }
+        return Payload;
+    }
+
+    std::vector<std::uint8_t> ClipBytes(const FEncodedHapticClip& Clip)
+    {
+        if (Clip.Transport == EHapticTransport::Usb)
+        {
+            const auto* Bytes = reinterpret_cast<const std::uint8_t*>(Clip.UsbSamples);
+            return std::vector<std::uint8_t>(Bytes, Bytes + Clip.UsbFrames * 2 * sizeof(std::int16_t));
+        }
+        return std::vector<std::uint8_t>(Clip.BtPackets, Clip.BtPackets + Clip.BtPacketCount * FHapticEncoder::BtPacketSize);
+    }
+
+    std::vector<std::filesystem::path> ListEntries(const std::filesystem::path& Directory)
+    {
+        std::vector<std::filesystem::path> Files;
+        for (const auto& Item : std::filesystem::directory_iterator(Directory))
+        {
+            Files.push_back(Item.path());
+        }
+        return Files;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int Plays = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+    FTestReport Test("Haptic Clip Cache");
+
+    const std::vector<float> Landing = MakeLandingClip(7);
+    const std::filesystem::path Directory = std::filesystem::temp_directory_path() /
+        ("dualsense-mod-clip-cache-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::error_code Error;
+    std::filesystem::remove_all(Directory, Error);
+
+    // 1. Cached bytes equal what the live bus sends for the same clip, on both transports
+    for (EHapticTransport Transport : {EHapticTransport::Usb, EHapticTransport::Bluetooth})
+    {
+        FHapticClipCache Cache;
+        const FEncodedHapticClip* Clip = Cache.Acquire(Landing.data(), ClipFrames, Transport, 1.0f);
+        Test.Expect(Clip && Clip->Transport == Transport, "clip not rendered");
+        if (!Clip)
+        {
+            continue;
+        }
+
+        FClipHapticSource Source;
+        FHapticMixer Mixer;
+        Mixer.AddInput(&Source, {1.0f, 1, 0.5f, true});
+        FHapticFrameRing Unused(1);
+        FHapticEncoder Encoder;
+        Encoder.SetTransport(Transport, Unused);
+        const std::size_t LiveFrames = Transport == EHapticTransport::Usb ? ClipFrames : Clip->GetDurationFrames();
+        const std::vector<std::uint8_t> Live = EncodeLive(Mixer, Source, Encoder, Landing, LiveFrames);
+        const bool bMatch = Live == ClipBytes(*Clip);
+        Test.Expect(bMatch, Transport == EHapticTransport::Usb ? "cached USB frames differ from the live path" : "cached BT packets differ from the live path");
+        std::cout << "[ClipCache] " << (Transport == EHapticTransport::Usb ? "USB" : "BT") << ": " << Live.size() << " bytes, "
+                  << (bMatch ? "identical to" : "DIFFERENT from") << " the live path" << std::endl;
+    }
+
+    // 2. Cache files: reused by a new cache, missed on any key change, discarded when corrupt
+    {
+        std::vector<std::uint8_t> UsbBytes;
+        {
+            FHapticClipCache Cache;
+            Cache.SetDirectory(Directory.string());
+            const FEncodedHapticClip* Usb = Cache.Acquire(Landing.data(), ClipFrames, EHapticTransport::Usb, 1.0f);
+            Cache.Acquire(Landing.data(), ClipFrames, EHapticTransport::Bluetooth, 1.0f);
+            Test.Expect(Cache.Acquire(Landing.data(), ClipFrames, EHapticTransport::Usb, 1.0f) == Usb, "second acquire not served from memory");
+            Test.Expect(Cache.GetRenderCount() == 2 && Cache.GetMemoryHitCount() == 1, "unexpected renders for two transports");
+            Test.Expect(ListEntries(Directory).size() == 2, "expected one cache file per transport and nothing else");
+            UsbBytes = Usb ? ClipBytes(*Usb) : std::vector<std::uint8_t>();
+
+            // Clips handed out must outlive any later directory change request
+            Test.Expect(Cache.SetDirectory(Directory.string()), "setting the same directory again was refused");
+            Test.Expect(!Cache.SetDirectory((Directory / "other").string()), "directory changed while clips were handed out");
+            Test.Expect(Usb && ClipBytes(*Usb) == UsbBytes && Cache.Find(FHapticClipCache::HashContent(Landing.data(), Landing.size() * sizeof(float)), EHapticTransport::Usb, 1.0f) == Usb,
+                        "handed-out clip invalidated by a directory change");
+        }
+
+        const std::uint64_t ContentHash = FHapticClipCache::HashContent(Landing.data(), Landing.size() * sizeof(float));
+        {
+            FHapticClipCache Cache;
+            Cache.SetDirectory(Directory.string());
+            const FEncodedHapticClip* Usb = Cache.Find(ContentHash, EHapticTransport::Usb, 1.0f);
+            Test.Expect(Usb && ClipBytes(*Usb) == UsbBytes && Cache.GetFileHitCount() == 1, "cache file not reused by a new cache");
+            Test.Expect(!Cache.Find(ContentHash, EHapticTransport::Usb, 0.5f), "gain change did not miss");
+
+            std::vector<float> Changed = Landing;
+            Changed[1000] += 0.001f;
+            Cache.Acquire(Changed.data(), ClipFrames, EHapticTransport::Usb, 1.0f);
+            Test.Expect(Cache.GetRenderCount() == 1, "content change did not miss");
+        }
+
+        // Flip one payload byte in every file, then truncate one of them
+        const std::vector<std::filesystem::path> Files = ListEntries(Directory);
+        for (const std::filesystem::path& File : Files)
+        {
+            std::fstream Stream(File, std::ios::binary | std::ios::in | std::ios::out);
+            Stream.seekg(100);
+            const char Byte = static_cast<char>(Stream.get() ^ 0x5a);
+            Stream.seekp(100);
+            Stream.put(Byte);
+        }
+        std::filesystem::resize_file(Files.front(), 40, Error);
+        {
+            FHapticClipCache Cache;
+            Cache.SetDirectory(Directory.string());
+            Test.Expect(!Cache.Find(ContentHash, EHapticTransport::Usb, 1.0f), "corrupt USB entry was used");
+            Test.Expect(!Cache.Find(ContentHash, EHapticTransport::Bluetooth, 1.0f), "corrupt BT entry was used");
+            const FEncodedHapticClip* Usb = Cache.Acquire(Landing.data(), ClipFrames, EHapticTransport::Usb, 1.0f);
+            Test.Expect(Usb && ClipBytes(*Usb) == UsbBytes && Cache.GetRenderCount() == 1, "corrupt entry not rendered again");
+        }
+        {
+            FHapticClipCache Cache;
+            Cache.SetDirectory(Directory.string());
+            Test.Expect(Cache.Find(ContentHash, EHapticTransport::Usb, 1.0f) != nullptr, "re-rendered entry not stored");
+        }
+        std::filesystem::remove_all(Directory, Error);
+        std::cout << "[ClipCache] Files: reused across caches, missed on gain/content change, corrupt entries re-rendered" << std::endl;
+
+        // Size bound: the least recently used files go first, loaded entries never
+        std::uintmax_t FileBytes = 0;
+        {
+            FHapticClipCache Cache;
+            Cache.SetDirectory(Directory.string());
+            for (int i = 0; i < 4; ++i)
+            {
+                std::vector<float> Variant = Landing;
+                Variant[0] += 0.001f * static_cast<float>(i + 1);
+                Cache.Acquire(Variant.data(), ClipFrames, EHapticTransport::Usb, 1.0f);
+            }
+            const std::vector<std::filesystem::path> Stored = ListEntries(Directory);
+            FileBytes = Stored.empty() ? 0 : std::filesystem::file_size(Stored.front());
+            Test.Expect(Stored.size() == 4, "bounded cache did not store its entries");
+        }
+        const auto Now = std::filesystem::file_time_type::clock::now();
+        std::vector<std::filesystem::path> Stored = ListEntries(Directory);
+        for (std::size_t i = 0; i < Stored.size(); ++i)
+        {
+            std::filesystem::last_write_time(Stored[i], Now - std::chrono::hours(Stored.size() - i), Error);
+        }
+        {
+            FHapticClipCache Cache;
+            Test.Expect(Cache.SetDirectory(Directory.string(), FileBytes * 2), "bounded directory refused");
+            const std::vector<std::filesystem::path> Kept = ListEntries(Directory);
+            Test.Expect(Kept.size() == 2 && Cache.GetEvictionCount() == 2, "directory not pruned to its byte budget");
+            Test.Expect(std::filesystem::exists(Stored[2]) && std::filesystem::exists(Stored[3]), "pruning did not evict the oldest entries");
+
+            // Over budget with every file loaded: nothing in use is deleted
+            std::vector<float> Variant = Landing;
+            Variant[0] += 0.5f;
+            Test.Expect(Cache.Acquire(Variant.data(), ClipFrames, EHapticTransport::Usb, 1.0f) != nullptr, "bounded cache did not render");
+            Test.Expect(ListEntries(Directory).size() == 2, "store over budget did not evict the least recently used entry");
+        }
+        std::filesystem::remove_all(Directory, Error);
+        std::cout << "[ClipCache] Bound: directory pruned to " << FileBytes * 2 << " bytes, oldest entries first" << std::endl;
+    }
+
+    // 3. Playback pacing: USB one 16 ms tick ahead of the clock, one BT packet pair per 1024 frames
+    {
+        FHapticClipCache Cache;
+        const FEncodedHapticClip* Usb = Cache.Acquire(Landing.data(), ClipFrames, EHapticTransport::Usb, 1.0f);
+        const FEncodedHapticClip* Bt = Cache.Acquire(Landing.data(), ClipFrames, EHapticTransport::Bluetooth, 1.0f);
+        if (Usb && Bt)
+        {
+            FEncodedHapticClipPlayer Player;
+            std::vector<std::int16_t> Sent;
+            std::size_t Packets = 0;
+            const auto OnUsb = [&Sent](std::vector<std::int16_t>& Batch) { Sent.insert(Sent.end(), Batch.begin(), Batch.end()); };
+            const auto OnBt = [&Packets](std::vector<std::uint8_t>&) { ++Packets; };
+
+            Player.Play(Usb, 1000000);
+            Player.Send(1000000, OnUsb, OnBt);
+            Test.Expect(Sent.size() == FEncodedHapticClipPlayer::UsbLeadFrames * 2, "USB playback did not start one tick ahead");
+            Player.Send(17000000, OnUsb, OnBt);
+            Test.Expect(Sent.size() == (768 + FEncodedHapticClipPlayer::UsbLeadFrames) * 2, "USB playback not paced by the clock");
+            Player.Send(1001000000, OnUsb, OnBt);
+            Test.Expect(!Player.IsPlaying() && std::equal(Sent.begin(), Sent.end(), Usb->UsbSamples) && Sent.size() == Usb->UsbFrames * 2,
+                   "USB playback incomplete or altered");
+
+            Player.Play(Bt, 0);
+            Player.Send(0, OnUsb, OnBt);
+            Player.Send(10000000, OnUsb, OnBt);
+            Test.Expect(Packets == 2, "BT playback sent ahead of its block");
+            Player.Send(21400000, OnUsb, OnBt);
+            Test.Expect(Packets == 4, "BT playback not paced per block");
+            Player.Send(1000000000, OnUsb, OnBt);
+            Test.Expect(!Player.IsPlaying() && Packets == Bt->BtPacketCount, "BT playback incomplete");
+            std::cout << "[ClipCache] Pacing: USB " << Usb->UsbFrames << " frames, BT " << Packets << " packets" << std::endl;
+        }
+        else
+        {
+            Test.Expect(false, "clips for the pacing test not rendered");
+        }
+    }
+
+    // 4. Cached clip on the bus: handed over from the player mid-clip, no frame lost or repeated
+    {
+        FHapticClipCache Cache;
+        const FEncodedHapticClip* Usb = Cache.Acquire(Landing.data(), ClipFrames, EHapticTransport::Usb, 1.0f);
+        if (Usb)
+        {
+            FEncodedHapticClipPlayer Player;
+            std::vector<std::int16_t> Sent;
+            const auto OnUsb = [&Sent](std::vector<std::int16_t>& Batch) { Sent.insert(Sent.end(), Batch.begin(), Batch.end()); };
+            const auto OnBt = [](std::vector<std::uint8_t>&) {};
+            Player.Play(Usb, 0);
+            Player.Send(0, OnUsb, OnBt);
+            Player.Send(16000000, OnUsb, OnBt);
+            const std::size_t SentFrames = Player.GetSentFrames();
+
+            FEncodedClipHapticSource Source;
+            FClipHapticSource Live;
+            FHapticMixer Mixer;
+            const int ClipIndex = Mixer.AddInput(&Source, {1.0f, 1, 0.5f, false});
+            Mixer.AddInput(&Live, {1.0f, 0, 1.0f, false});
+            Source.Play(Usb, SentFrames);
+
+            std::vector<float> Rest((Usb->UsbFrames - SentFrames) * 2);
+            const std::size_t Read = Source.Read(Rest.data(), Usb->UsbFrames);
+            bool bExact = Read == Usb->UsbFrames - SentFrames && SentFrames * 2 == Sent.size();
+            for (std::size_t i = 0; bExact && i < Rest.size(); ++i)
+            {
+                bExact = std::lround(Rest[i] * 32767.0f) == Usb->UsbSamples[SentFrames * 2 + i];
+            }
+            Test.Expect(bExact && Source.IsFinished(), "clip resumed on the bus at the wrong frame or altered");
+
+            std::vector<float> Out(FHapticMixer::BlockFrames * 2);
+            Source.Play(Usb);
+            Mixer.Mix(Out.data(), FHapticMixer::BlockFrames);
+            Test.Expect(Mixer.IsInputActive(ClipIndex) && !Mixer.IsAnyInputActive(ClipIndex), "cached clip alone counted as live audio");
+            Live.Play(Landing.data(), ClipFrames);
+            Mixer.Mix(Out.data(), FHapticMixer::BlockFrames);
+            Test.Expect(Mixer.IsAnyInputActive(ClipIndex), "live input next to the cached clip not detected");
+            std::cout << "[ClipCache] Bus: " << SentFrames << " frames sent by pointer, " << Read << " more through the mixer" << std::endl;
+        }
+        else
+        {
+            Test.Expect(false, "clip for the bus test not rendered");
+        }
+    }
+
+    // 5. Benchmark: CPU per play, live path every time against cached payloads sent by pointer
+    for (EHapticTransport Transport : {EHapticTransport::Usb, EHapticTransport::Bluetooth})
+    {
+        const char* Name = Transport == EHapticTransport::Usb ? "USB" : "BT";
+        std::uint64_t Sink = 0;
+        const auto OnUsb = [&Sink](std::vector<std::int16_t>& Batch) { Sink += static_cast<std::uint16_t>(Batch[Batch.size() / 2]); };
+        const auto OnBt = [&Sink](std::vector<std::uint8_t>& Packet) { Sink += Packet[17]; };
+
+        FClipHapticSource Source;
+        FHapticMixer Mixer;
+        Mixer.AddInput(&Source, {1.0f, 1, 0.5f, true});
+        FHapticFrameRing Unused(1);
+        FHapticEncoder Encoder;
+        Encoder.SetTransport(Transport, Unused);
+        const std::size_t LiveFrames = (ClipFrames + FHapticEncoder::BtBlockFrames - 1) / FHapticEncoder::BtBlockFrames * FHapticEncoder::BtBlockFrames;
+
+        double Start = CpuSeconds();
+        for (int Play = 0; Play < Plays; ++Play)
+        {
+            Source.Play(Landing.data(), ClipFrames);
+            for (std::size_t Offset = 0; Offset < LiveFrames; Offset += FHapticMixer::BlockFrames)
+            {
+                std::size_t Count = FHapticMixer::BlockFrames;
+                Mixer.Mix(Encoder.AppendFrames(Count), Count);
+                Encoder.Flush(OnUsb, OnBt);
+            }
+        }
+        const double ColdUs = (CpuSeconds() - Start) * 1e6 / Plays;
+
+        FHapticClipCache Cache;
+        Cache.SetDirectory(Directory.string());
+        const FEncodedHapticClip* Clip = Cache.Acquire(Landing.data(), ClipFrames, Transport, 1.0f);
+        FEncodedHapticClipPlayer Player;
+        Start = CpuSeconds();
+        for (int Play = 0; Play < Plays; ++Play)
+        {
+            Player.Play(Clip, 0);
+            Player.Send(1000000000, OnUsb, OnBt);
+        }
+        const double WarmUs = (CpuSeconds() - Start) * 1e6 / Plays;
+
+        // A new session: the clip comes from its mapped file (checksum verified), nothing is rendered
+        const std::uint64_t ContentHash = FHapticClipCache::HashContent(Landing.data(), Landing.size() * sizeof(float));
+        const int Loads = std::max(1, Plays / 10);
+        bool bAllFromFile = true;
+        Start = CpuSeconds();
+        for (int Load = 0; Load < Loads; ++Load)
+        {
+            FHapticClipCache Session;
+            Session.SetDirectory(Directory.string());
+            bAllFromFile = Session.Find(ContentHash, Transport, 1.0f) != nullptr && bAllFromFile;
+        }
+        const double LoadUs = (CpuSeconds() - Start) * 1e6 / Loads;
+
+        std::cout << "[ClipCache] " << Name << ": cold " << ColdUs << " us/play, warm " << WarmUs << " us/play (" << ColdUs / std::max(WarmUs, 1e-3)
+                  << "x less CPU), first play of a session from the cache file +" << LoadUs << " us" << std::endl;
+        Test.Expect(Sink != 0, "benchmark sinks received nothing");
+        Test.Expect(bAllFromFile, "cache file not found by a new session");
+        Test.Expect(WarmUs * 5.0 < ColdUs, "cached playback not at least 5x cheaper than the live path");
+    }
+
+    std::filesystem::remove_all(Directory, Error);
+    return Test.Finish();
+}
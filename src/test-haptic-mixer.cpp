@@ -0,0 +1,303 @@
+// Haptic mixer test: the SIMD block kernels against scalar references, the soft limiter, priority
+// ducking and duck groups, bus pacing, then a benchmark of the mixer with 1 to 16 sources that
+// checks the cost grows linearly and that mixing never allocates.
+//
+//   test-haptic-mixer [seconds of audio per benchmark point]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Audio/HapticEvents.h"
+#include "Audio/HapticMixer.h"
+#include "Audio/HapticSynth.h"
+#include "Testing/AllocationCounter.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    // Plays a fixed buffer in a loop; stands in for any source with no cost of its own
+    class FLoopSource final : public IHapticAudioSource
+    {
+    public:
+        explicit FLoopSource(std::vector<float> InSamples, EHapticSourceDrive InDrive = EHapticSourceDrive::Clock)
+            : Samples(std::move(InSamples))
+            , Drive(InDrive)
+        {
+        }
+
+        const char* GetName() const override { return "loop"; }
+        EHapticSourceDrive GetDrive() const override { return Drive; }
+        bool IsFinished() const override { return bMuted; }
+
+        std::size_t Read(float* Interleaved, std::size_t Frames) override
+        {
+            if (bMuted)
+            {
+                return 0;
+            }
+            const std::size_t Total = Samples.size() / 2;
+            for (std::size_t Done = 0; Done < Frames;)
+            {
+                const std::size_t Count = std::min(Frames - Done, Total - Position);
+                std::copy_n(Samples.data() + Position * 2, Count * 2, Interleaved + Done * 2);
+                Position = (Position + Count) % Total;
+                Done += Count;
+            }
+            return Frames;
+        }
+
+        bool bMuted = false;
+
+    private:
+        std::vector<float> Samples;
+        EHapticSourceDrive Drive;
+        std::size_t Position = 0;
+    };
+
+    std::vector<float> MakeNoise(std::size_t Frames, std::uint32_t Seed, float Amplitude)
+    {
+        std::mt19937 Rng(Seed);
+        std::uniform_real_distribution<float> Noise(-Amplitude, Amplitude);
+        std::vector<float> Samples(Frames * 2);
+        for (float& Sample : Samples)
+        {
+            Sample = Noise(Rng);
+        }
+        return Samples;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double Seconds = argc > 1 ? std::atof(argv[1]) : 20.0;
+    FTestReport Test("Haptic Mixer");
+
+    // 1. Kernels against scalar references, odd lengths included (vector body + scalar tail)
+    {
+        const std::vector<float> In = MakeNoise(1001, 1, 1.5f);
+        std::vector<float> Out = MakeNoise(1001, 2, 0.5f);
+        std::vector<float> Reference = Out;
+        HapticMixKernels::MixRamp(Out.data(), In.data(), 1001, 0.25f, 0.0005f);
+        double MaxError = 0.0;
+        for (std::size_t i = 0; i < 1001; ++i)
+        {
+            const float Gain = 0.25f + 0.0005f * static_cast<float>(i);
+            for (std::size_t Channel = 0; Channel < 2; ++Channel)
+            {
+                Reference[i * 2 + Channel] += In[i * 2 + Channel] * Gain;
+                MaxError = std::max(MaxError, static_cast<double>(std::fabs(Reference[i * 2 + Channel] - Out[i * 2 + Channel])));
+            }
+        }
+        Test.Expect(MaxError < 1e-5, "MixRamp differs from the scalar reference");
+
+        float ScalarPeak = 0.0f;
+        for (float Sample : In)
+        {
+            ScalarPeak = std::max(ScalarPeak, std::fabs(Sample));
+        }
+        Test.Expect(HapticMixKernels::Peak(In.data(), In.size()) == ScalarPeak, "Peak differs from the scalar reference");
+
+        std::vector<float> Limited = In;
+        HapticMixKernels::SoftLimit(Limited.data(), Limited.size());
+        bool bSame = true;
+        for (std::size_t i = 0; i < In.size(); ++i)
+        {
+            bSame = bSame && std::fabs(Limited[i] - HapticMixKernels::SoftLimitSample(In[i])) < 1e-6f;
+        }
+        Test.Expect(bSame, "SoftLimit differs from the scalar reference");
+    }
+
+    // 2. Limiter shape: identity below the knee, bounded, monotonic, continuous at the knee
+    {
+        std::vector<float> Ramp;
+        for (int i = -4000; i <= 4000; ++i)
+        {
+            Ramp.push_back(static_cast<float>(i) / 1000.0f);
+        }
+        std::vector<float> Limited = Ramp;
+        HapticMixKernels::SoftLimit(Limited.data(), Limited.size());
+        bool bIdentity = true;
+        bool bBounded = true;
+        bool bMonotonic = true;
+        float MaxJump = 0.0f;
+        for (std::size_t i = 0; i < Ramp.size(); ++i)
+        {
+            bIdentity = bIdentity && (std::fabs(Ramp[i]) > HapticMixKernels::LimiterKnee || Limited[i] == Ramp[i]);
+            bBounded = bBounded && std::fabs(Limited[i]) < 1.0f;
+            if (i > 0)
+            {
+                bMonotonic = bMonotonic && Limited[i] >= Limited[i - 1];
+                MaxJump = std::max(MaxJump, Limited[i] - Limited[i - 1]);
+            }
+        }
+        Test.Expect(bIdentity, "limiter changes samples below the knee");
+        Test.Expect(bBounded, "limiter output reaches full scale");
+        Test.Expect(bMonotonic && MaxJump <= 0.0011f, "limiter not monotonic or not continuous");
+        std::cout << "[Mixer] Limiter: 2.0 -> " << HapticMixKernels::SoftLimitSample(2.0f) << ", 4.0 -> " << HapticMixKernels::SoftLimitSample(4.0f) << std::endl;
+    }
+
+    // 3. Ducking: a high-priority input pulls the lower one down within the ramp and releases after the hold
+    {
+        FLoopSource Music(MakeNoise(4800, 3, 0.3f));
+        FLoopSource Effect(MakeNoise(4800, 4, 0.3f));
+        FHapticMixer Mixer;
+        const int MusicIndex = Mixer.AddInput(&Music, {1.0f, 0, 1.0f, false});
+        const int EffectIndex = Mixer.AddInput(&Effect, {0.8f, 5, 0.25f, false});
+        std::vector<float> Out((FHapticMixer::ActivityHoldFrames + FHapticMixer::DuckRampFrames) * 2);
+
+        Effect.bMuted = true;
+        Mixer.Mix(Out.data(), FHapticMixer::BlockFrames);
+        Test.Expect(Mixer.GetInputGain(MusicIndex) == 1.0f, "input ducked with nothing above it");
+
+        Effect.bMuted = false;
+        std::size_t Frames = 0;
+        while (Mixer.GetInputGain(MusicIndex) > 0.25f && Frames < 48000)
+        {
+            Mixer.Mix(Out.data(), 96);
+            Frames += 96;
+        }
+        std::cout << "[Mixer] Ducking: music at " << Mixer.GetInputGain(MusicIndex) << " after " << Frames << " frames, effect at "
+                  << Mixer.GetInputGain(EffectIndex) << std::endl;
+        Test.Expect(Frames <= FHapticMixer::DuckRampFrames, "ducking slower than the ramp");
+        Test.Expect(Mixer.IsInputActive(EffectIndex) && Mixer.GetInputGain(EffectIndex) == 0.8f, "high-priority input not active at its gain");
+
+        Effect.bMuted = true;
+        Mixer.Mix(Out.data(), FHapticMixer::ActivityHoldFrames - 512);
+        Test.Expect(Mixer.GetInputGain(MusicIndex) == 0.25f, "ducking released before the hold time");
+        Mixer.Mix(Out.data(), 512 + FHapticMixer::DuckRampFrames);
+        Test.Expect(Mixer.GetInputGain(MusicIndex) == 1.0f && !Mixer.IsInputActive(EffectIndex), "ducking not released after the hold time");
+    }
+
+    // 4. Duck groups: pushed PCM silences the source it replaces, rumble keeps playing on top of it
+    {
+        constexpr std::uint32_t SourceGroup = 1u << 0;
+        constexpr std::uint32_t RumbleGroup = 1u << 1;
+        FLoopSource Pushed(MakeNoise(4800, 6, 0.3f));
+        FLoopSource Loopback(MakeNoise(4800, 7, 0.3f));
+        FLoopSource Rumble(MakeNoise(4800, 8, 0.3f));
+        FHapticMixer Mixer;
+        const int PushedIndex = Mixer.AddInput(&Pushed, {1.0f, 2, 0.0f, false, SourceGroup, SourceGroup});
+        const int LoopbackIndex = Mixer.AddInput(&Loopback, {1.0f, 0, 1.0f, false, SourceGroup});
+        const int RumbleIndex = Mixer.AddInput(&Rumble, {1.0f, 0, 1.0f, false, RumbleGroup});
+        std::vector<float> Out(FHapticMixer::DuckRampFrames * 2 * 2);
+        Mixer.Mix(Out.data(), FHapticMixer::DuckRampFrames * 2);
+
+        std::cout << "[Mixer] Duck groups: pushed " << Mixer.GetInputGain(PushedIndex) << ", loopback " << Mixer.GetInputGain(LoopbackIndex)
+                  << ", rumble " << Mixer.GetInputGain(RumbleIndex) << std::endl;
+        Test.Expect(Mixer.IsInputActive(PushedIndex) && Mixer.GetInputGain(LoopbackIndex) == 0.0f, "pushed PCM did not silence the source it replaces");
+        Test.Expect(Mixer.GetInputGain(RumbleIndex) == 1.0f, "pushed PCM ducked rumble outside its duck groups");
+    }
+
+    // 5. EQ on the bus equals the EQ on the source, and a hot sum stays below full scale
+    {
+        const std::vector<float> Samples = MakeNoise(2048, 5, 0.2f);
+        FLoopSource Source(Samples);
+        FHapticMixer Mixer;
+        Mixer.AddInput(&Source, {1.0f, 0, 1.0f, true});
+        std::vector<float> Out(2048 * 2);
+        Mixer.Mix(Out.data(), 2048);
+
+        FHapticEqualizer Equalizer;
+        Equalizer.Configure(FHapticSourcePipeline::SampleRate);
+        std::vector<float> Reference(Samples.size());
+        Equalizer.Process(Samples.data(), Reference.data(), 2048);
+        HapticMixKernels::SoftLimit(Reference.data(), Reference.size());
+        Test.Expect(Out == Reference, "bus EQ differs from equalizing the source");
+
+        std::vector<std::unique_ptr<FLoopSource>> Hot;
+        FHapticMixer HotMixer;
+        for (std::uint32_t i = 0; i < 8; ++i)
+        {
+            Hot.push_back(std::make_unique<FLoopSource>(MakeNoise(4096, 10 + i, 0.9f)));
+            HotMixer.AddInput(Hot.back().get(), {1.0f, 0, 1.0f, i % 2 == 0});
+        }
+        HotMixer.Mix(Out.data(), 2048);
+        Test.Expect(HapticMixKernels::Peak(Out.data(), Out.size()) < 1.0f, "summed peaks not limited");
+    }
+
+    // 6. Pacing: the highest-priority stream with frames decides, clock sources fill at the real-time rate
+    {
+        FHapticFrameRing Pushed(4096);
+        FHapticFrameRing Captured(4096);
+        FRingHapticSource PushedInput(Pushed);
+        FRingHapticSource CapturedInput(Captured);
+        FHapticEventQueue Queue;
+        FHapticEventSynth Synth(Queue);
+        FSynthHapticSource Rumble(Synth.GetRumbleBank());
+        FHapticMixer Mixer;
+        Mixer.AddInput(&CapturedInput, {1.0f, 0, 1.0f, false});
+        Mixer.AddInput(&Rumble, {1.0f, 0, 1.0f, false});
+        Mixer.AddInput(&PushedInput, {1.0f, 2, 0.0f, false});
+        FHapticEncoder Encoder;
+
+        const std::vector<float> Block = MakeNoise(480, 20, 0.3f);
+        Test.Expect(Mixer.Stage(Encoder, 1000000) == 0, "staged frames while everything was silent");
+        Captured.Push(Block.data(), 480);
+        Test.Expect(Mixer.Stage(Encoder, 2000000) == 480, "captured stream not staged as it arrived");
+        Pushed.Push(Block.data(), 240);
+        Captured.Push(Block.data(), 480);
+        const std::size_t Staged = Mixer.Stage(Encoder, 3000000);
+        Test.Expect(Staged == 240 && Captured.Size() == 240, "bus not paced on the higher-priority stream");
+
+        Synth.SetRumble(255, 0);
+        Captured.TrimTo(0);
+        Mixer.Stage(Encoder, 4000000);
+        const std::size_t RumbleFrames = Mixer.Stage(Encoder, 14000000);
+        Test.Expect(RumbleFrames == 480, "rumble alone not staged at the real-time rate");
+        std::cout << "[Mixer] Pacing: pushed stream paced the bus (" << Staged << " frames), rumble alone " << RumbleFrames << " frames per 10 ms" << std::endl;
+    }
+
+    // 7. Benchmark: 1..16 sources, a third of them through the EQ; cost must grow linearly, no allocation
+    {
+        const std::size_t Frames = static_cast<std::size_t>(Seconds * 48000.0);
+        std::vector<std::unique_ptr<FLoopSource>> Sources;
+        for (std::uint32_t i = 0; i < FHapticMixer::MaxInputs; ++i)
+        {
+            Sources.push_back(std::make_unique<FLoopSource>(MakeNoise(4096, 100 + i, 0.2f)));
+        }
+        std::vector<float> Out(FHapticEncoder::BtBlockFrames * 2);
+
+        double NsPerFrameOne = 0.0;
+        double NsPerFrameSixteen = 0.0;
+        bool bAllocationFree = true;
+        for (std::size_t Count : {1, 2, 4, 8, 12, 16})
+        {
+            FHapticMixer Mixer;
+            for (std::size_t i = 0; i < Count; ++i)
+            {
+                Mixer.AddInput(Sources[i].get(), {0.5f, static_cast<int>(i % 3), 0.5f, i % 3 == 0});
+            }
+            Mixer.Mix(Out.data(), FHapticEncoder::BtBlockFrames); // warm up
+
+            const std::size_t AllocationsBefore = GetAllocationCount();
+            const auto Start = std::chrono::steady_clock::now();
+            for (std::size_t Done = 0; Done < Frames; Done += FHapticEncoder::BtBlockFrames)
+            {
+                Mixer.Mix(Out.data(), FHapticEncoder::BtBlockFrames);
+            }
+            const double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+            bAllocationFree = bAllocationFree && GetAllocationCount() == AllocationsBefore;
+
+            const double NsPerFrame = Elapsed * 1e9 / static_cast<double>(Frames);
+            NsPerFrameOne = Count == 1 ? NsPerFrame : NsPerFrameOne;
+            NsPerFrameSixteen = Count == 16 ? NsPerFrame : NsPerFrameSixteen;
+            std::cout << "[Mixer] " << Count << " sources: " << NsPerFrame << " ns/frame (" << NsPerFrame / static_cast<double>(Count)
+                      << " ns per source-frame), " << 1e9 / NsPerFrame / 48000.0 << "x real time" << std::endl;
+        }
+        Test.Expect(bAllocationFree, "mixing allocated memory");
+        // One source pays the fixed costs (EQ, limiter) alone, so 16 sources cost well under 16x
+        Test.Expect(NsPerFrameSixteen < NsPerFrameOne * 16.0 * 1.5, "mixing cost grows faster than linearly");
+        // Absolute speed depends on the machine and build type, so it is reported rather than asserted
+        std::cout << "[Mixer] 16 sources at " << 1e9 / NsPerFrameSixteen / 48000.0 << "x real time" << std::endl;
+    }
+
+    return Test.Finish();
+}
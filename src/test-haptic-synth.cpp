@@ -0,0 +1,342 @@
+// Haptic synth test: oscillator accuracy, pan and envelopes of the voice bank, voice stealing, the
+// input event detector, events and rumble turned into voices, the bank through the mixer bus into
+// the USB and Bluetooth encoders, then a benchmark of 0 to 32 voices that checks the cost follows
+// the number of sounding voices and that rendering never allocates.
+//
+//   test-haptic-synth [seconds of audio per benchmark point]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Audio/HapticEvents.h"
+#include "Audio/HapticMixer.h"
+#include "Audio/HapticSynth.h"
+#include "Testing/AllocationCounter.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::int64_t Ms = 1000000;
+
+    float Peak(const std::vector<float>& Interleaved, std::size_t Channel)
+    {
+        float Result = 0.0f;
+        for (std::size_t i = Channel; i < Interleaved.size(); i += 2)
+        {
+            Result = std::max(Result, std::fabs(Interleaved[i]));
+        }
+        return Result;
+    }
+
+    std::size_t CountEvents(FHapticEventQueue& Queue, EHapticEventType Type, FHapticEvent* Last = nullptr)
+    {
+        std::size_t Count = 0;
+        FHapticEvent Event;
+        while (Queue.Pop(Event))
+        {
+            if (Event.Type == Type)
+            {
+                ++Count;
+                if (Last)
+                {
+                    *Last = Event;
+                }
+            }
+        }
+        return Count;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double Seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+    FTestReport Test("Haptic Synth");
+
+    // 1. A held tone matches sin() once the attack is over, on both actuators at the center pan
+    {
+        FHapticSynthBank Bank;
+        Bank.Play(HapticVoices::Motor(100.0f, 0.5f, 0.5f));
+        std::vector<float> Out(48000 * 2, 0.0f);
+        Bank.Render(Out.data(), 48000);
+
+        const double Increment = 6.283185307179586 * 100.0 / 48000.0;
+        double MaxError = 0.0;
+        for (std::size_t i = 512; i < 48000; ++i)
+        {
+            const double Expected = 0.5 * std::sin(Increment * static_cast<double>(i + 1));
+            MaxError = std::max(MaxError, std::fabs(Out[i * 2] - Expected));
+            MaxError = std::max(MaxError, static_cast<double>(std::fabs(Out[i * 2] - Out[i * 2 + 1])));
+        }
+        std::cout << "[Synth] 100 Hz tone over 1 s: max error " << MaxError << std::endl;
+        Test.Expect(MaxError < 1e-3, "oscillator drifts from sin()");
+        Test.Expect(Bank.GetActiveVoiceCount() == 1, "held voice ended by itself");
+    }
+
+    // 2. Pan: the far side stays silent
+    {
+        for (float Pan : {0.0f, 1.0f})
+        {
+            FHapticSynthBank Bank;
+            Bank.Play(HapticVoices::Click(1.0f, Pan));
+            std::vector<float> Out(2048 * 2, 0.0f);
+            Bank.Render(Out.data(), 2048);
+            const std::size_t Near = Pan == 0.0f ? 0 : 1;
+            Test.Expect(Peak(Out, Near) > 0.1f && Peak(Out, 1 - Near) == 0.0f, "click not panned to one side");
+        }
+    }
+
+    // 3. Envelopes: a one-shot ends by itself, a released voice fades, an idle bank leaves the output alone
+    {
+        FHapticSynthBank Bank;
+        FSynthHapticSource Source(Bank);
+        const FHapticVoiceHandle Click = Bank.Play(HapticVoices::Click(1.0f, 0.5f));
+        const FHapticVoiceHandle Held = Bank.Play(HapticVoices::Texture(120.0f, 0.5f, 2000.0f, 0.4f));
+        std::vector<float> Out(4800 * 2, 0.0f);
+        Bank.Render(Out.data(), 4800);
+        Test.Expect(!Bank.IsPlaying(Click) && Bank.IsPlaying(Held), "one-shot still playing or held voice ended");
+
+        Test.Expect(Bank.Release(Held), "release of a playing voice refused");
+        std::fill(Out.begin(), Out.end(), 0.0f);
+        Bank.Render(Out.data(), 4800);
+        const float Tail = std::max(std::fabs(Out[4799 * 2]), std::fabs(Out[4799 * 2 + 1]));
+        Test.Expect(!Bank.IsActive() && Source.IsFinished() && Tail == 0.0f, "released voice still sounding");
+        Test.Expect(!Bank.Release(Held) && !Bank.Modulate(Held, 1.0f, 100.0f), "stale handle still controls a voice");
+
+        std::fill(Out.begin(), Out.end(), 0.25f);
+        Bank.Render(Out.data(), 4800);
+        Test.Expect(std::all_of(Out.begin(), Out.end(), [](float Sample) { return Sample == 0.25f; }), "idle bank touched the output");
+        Test.Expect(Source.Read(Out.data(), 4800) == 0, "idle source produced frames");
+    }
+
+    // 4. With all voices busy, a new one replaces the quietest
+    {
+        FHapticSynthBank Bank;
+        std::vector<FHapticVoiceHandle> Handles;
+        for (std::size_t i = 0; i < FHapticSynthBank::MaxVoices; ++i)
+        {
+            const float Amplitude = i == 7 ? 0.01f : 0.2f + 0.01f * static_cast<float>(i);
+            Handles.push_back(Bank.Play(HapticVoices::Texture(100.0f + static_cast<float>(i), 0.2f, 1000.0f, Amplitude)));
+        }
+        std::vector<float> Out(1024 * 2, 0.0f);
+        Bank.Render(Out.data(), 1024);
+
+        const FHapticVoiceHandle Extra = Bank.Play(HapticVoices::Click(1.0f, 0.5f));
+        std::size_t StillPlaying = 0;
+        for (const FHapticVoiceHandle& Handle : Handles)
+        {
+            StillPlaying += Bank.IsPlaying(Handle) ? 1 : 0;
+        }
+        Test.Expect(Bank.GetStolenCount() == 1 && Extra.Slot == 7 && !Bank.IsPlaying(Handles[7]) && Bank.IsPlaying(Extra), "quietest voice not stolen");
+        Test.Expect(StillPlaying == FHapticSynthBank::MaxVoices - 1, "stealing ended more than one voice");
+    }
+
+    // 5. Detector: fast flicks and pulls become events, slow motion and holding still do not
+    {
+        FHapticEventQueue Queue;
+        FHapticInputEventDetector Detector;
+        FHapticInputSample Sample;
+        FHapticEvent Event;
+
+        Detector.Process(Sample, 0, Queue);
+        Sample.RightX = -0.95f;
+        Detector.Process(Sample, 20 * Ms, Queue);
+        Detector.Process(Sample, 30 * Ms, Queue);
+        Test.Expect(CountEvents(Queue, EHapticEventType::StickFlick, &Event) == 1, "fast flick not reported once");
+        Test.Expect(Event.Side == 1 && Event.Values[1] < -0.99f && Event.Values[0] > 0.8f, "flick side, direction or strength wrong");
+
+        Sample.RightX = 0.0f;
+        Detector.Process(Sample, 100 * Ms, Queue);
+        for (std::int64_t Step = 1; Step <= 10; ++Step)
+        {
+            Sample.RightX = 0.1f * static_cast<float>(Step);
+            Detector.Process(Sample, 100 * Ms + Step * 30 * Ms, Queue);
+        }
+        Test.Expect(CountEvents(Queue, EHapticEventType::StickFlick) == 0, "slow stick motion reported as a flick");
+
+        Sample.RightX = 0.0f;
+        Detector.Process(Sample, 1000 * Ms, Queue);
+        Sample.LeftTrigger = 0.6f;
+        Detector.Process(Sample, 1010 * Ms, Queue);
+        Test.Expect(CountEvents(Queue, EHapticEventType::TriggerPull, &Event) == 1 && Event.Side == 0 && Event.Values[0] == 1.0f, "fast pull not reported at full strength");
+        Sample.LeftTrigger = 1.0f;
+        Detector.Process(Sample, 1020 * Ms, Queue);
+        Detector.Process(Sample, 1030 * Ms, Queue);
+        Test.Expect(CountEvents(Queue, EHapticEventType::TriggerBottom) == 1, "bottom-out not reported once");
+
+        Sample.LeftTrigger = 0.0f;
+        Detector.Process(Sample, 1100 * Ms, Queue);
+        Sample.LeftTrigger = 0.2f;
+        Detector.Process(Sample, 1200 * Ms, Queue);
+        Sample.LeftTrigger = 0.55f;
+        Detector.Process(Sample, 1400 * Ms, Queue);
+        Test.Expect(CountEvents(Queue, EHapticEventType::TriggerPull, &Event) == 1 && Event.Values[0] < 0.2f, "slow pull not reported as weak");
+    }
+
+    // 6. Events and rumble become voices; continuous ones end when their records stop
+    {
+        FHapticEventQueue Queue;
+        FHapticEventSynth Synth(Queue);
+        FHapticSynthBank& Bank = Synth.GetEffectBank();
+        FHapticSynthBank& Rumble = Synth.GetRumbleBank();
+        std::vector<float> Out(2400 * 2, 0.0f);
+
+        FHapticEvent Impact;
+        Impact.Type = EHapticEventType::Impact;
+        Impact.Values[0] = 0.8f;
+        Impact.Values[1] = 0.03f;
+        Queue.Push(Impact);
+        FHapticEvent Grind;
+        Grind.Type = EHapticEventType::Grind;
+        Grind.Values[0] = 0.5f;
+        Grind.Values[1] = 2.0f;
+        Queue.Push(Grind);
+        Test.Expect(Synth.Update(0) == 2 && Bank.GetActiveVoiceCount() == 2, "events did not start voices");
+
+        Grind.Values[0] = 0.9f;
+        Queue.Push(Grind);
+        Synth.Update(50 * Ms);
+        Bank.Render(Out.data(), 2400);
+        Test.Expect(Bank.GetActiveVoiceCount() == 1, "grind record started another voice instead of modulating");
+
+        Synth.Update(50 * Ms + FHapticEventSynth::ContinuousTimeoutNs + Ms);
+        Bank.Render(Out.data(), 4800 / 2);
+        Bank.Render(Out.data(), 4800 / 2);
+        Test.Expect(!Bank.IsActive(), "grind kept playing after its records stopped");
+
+        Synth.SetRumble(255, 0);
+        Synth.SetRumble(255, 0);
+        std::fill(Out.begin(), Out.end(), 0.0f);
+        Rumble.Render(Out.data(), 2400);
+        Test.Expect(Rumble.GetActiveVoiceCount() == 1 && Peak(Out, 0) > 0.8f && Peak(Out, 1) == 0.0f, "large motor not on the left actuator alone");
+
+        // A burst of more events than the bank has voices steals effect voices, never a motor
+        for (std::size_t i = 0; i < FHapticSynthBank::MaxVoices + 8; ++i)
+        {
+            Queue.Push(Impact);
+        }
+        Synth.Update(400 * Ms);
+        Test.Expect(Bank.GetActiveVoiceCount() == FHapticSynthBank::MaxVoices && Rumble.GetActiveVoiceCount() == 1, "event burst stole a rumble motor");
+
+        Synth.SetRumble(0, 128);
+        std::fill(Out.begin(), Out.end(), 0.0f);
+        Rumble.Render(Out.data(), 2400);
+        Test.Expect(Rumble.GetActiveVoiceCount() == 1 && Peak(Out, 1) > 0.4f, "small motor not started while the large one stopped");
+        Synth.SetRumble(0, 0);
+        Rumble.Render(Out.data(), 2400);
+        Test.Expect(!Rumble.IsActive(), "rumble voices kept playing at zero strength");
+    }
+
+    // 7. Through the bus into the encoders: frames flow only while a voice sounds
+    {
+        for (EHapticTransport Transport : {EHapticTransport::Usb, EHapticTransport::Bluetooth})
+        {
+            FHapticEventQueue Queue;
+            FHapticEventSynth Synth(Queue);
+            FSynthHapticSource Effects(Synth.GetEffectBank());
+            FSynthHapticSource Rumble(Synth.GetRumbleBank());
+            FHapticMixer Mixer;
+            Mixer.AddInput(&Effects, {1.0f, 0, 1.0f, false});
+            Mixer.AddInput(&Rumble, {1.0f, 0, 1.0f, false});
+            FHapticFrameRing Unused(1024);
+            FHapticEncoder Encoder;
+            Encoder.SetTransport(Transport, Unused);
+
+            std::size_t UsbFrames = 0;
+            std::size_t BtPackets = 0;
+            std::int16_t UsbPeak = 0;
+            auto OnUsb = [&](std::vector<std::int16_t>& Samples) {
+                UsbFrames += Samples.size() / 2;
+                for (std::int16_t Sample : Samples)
+                {
+                    UsbPeak = std::max<std::int16_t>(UsbPeak, static_cast<std::int16_t>(std::abs(Sample)));
+                }
+            };
+            auto OnBt = [&](std::vector<std::uint8_t>&) { ++BtPackets; };
+
+            std::int64_t NowNs = 1000 * Ms;
+            Test.Expect(Mixer.Stage(Encoder, NowNs) == 0, "idle synth staged frames");
+            Synth.SetRumble(200, 200);
+            std::size_t Staged = 0;
+            for (int Tick = 0; Tick < 30; ++Tick)
+            {
+                NowNs += 4 * Ms;
+                Synth.Update(NowNs);
+                Staged += Mixer.Stage(Encoder, NowNs);
+                Encoder.Flush(OnUsb, OnBt);
+            }
+            Synth.SetRumble(0, 0);
+            for (int Tick = 0; Tick < 5; ++Tick)
+            {
+                NowNs += 4 * Ms;
+                Staged += Mixer.Stage(Encoder, NowNs);
+                Encoder.Flush(OnUsb, OnBt);
+            }
+            const std::size_t StagedWhileIdle = Mixer.Stage(Encoder, NowNs + 4 * Ms);
+
+            if (Transport == EHapticTransport::Usb)
+            {
+                std::cout << "[Synth] USB: " << Staged << " frames staged, " << UsbFrames << " sent, peak " << UsbPeak << std::endl;
+                Test.Expect(UsbFrames == Staged && UsbFrames >= 5000 && UsbPeak > 1000, "rumble voices did not reach the USB encoder");
+            }
+            else
+            {
+                std::cout << "[Synth] Bluetooth: " << Staged << " frames staged, " << BtPackets << " packets" << std::endl;
+                Test.Expect(BtPackets >= 2 * (Staged / FHapticEncoder::BtBlockFrames) && BtPackets > 0, "rumble voices did not reach the Bluetooth encoder");
+            }
+            Test.Expect(StagedWhileIdle == 0, "bus kept staging after the voices ended");
+        }
+    }
+
+    // 8. Benchmark: cost per frame with 0..32 held voices; groups of four cost one vector, no allocation
+    {
+        const std::size_t Frames = static_cast<std::size_t>(Seconds * 48000.0);
+        constexpr std::size_t Block = 512;
+        std::vector<float> Out(Block * 2);
+
+        double NsPerFrame[FHapticSynthBank::MaxVoices + 1] = {};
+        bool bAllocationFree = true;
+        for (std::size_t Count : {0, 1, 4, 8, 16, 32})
+        {
+            FHapticSynthBank Bank;
+            FSynthHapticSource Source(Bank);
+            for (std::size_t i = 0; i < Count; ++i)
+            {
+                Bank.Play(HapticVoices::Texture(60.0f + 10.0f * static_cast<float>(i), 0.5f, 800.0f, 0.03f));
+            }
+            Source.Read(Out.data(), Block); // warm up
+
+            const std::size_t AllocationsBefore = GetAllocationCount();
+            const auto Start = std::chrono::steady_clock::now();
+            for (std::size_t Done = 0; Done < Frames; Done += Block)
+            {
+                Source.Read(Out.data(), Block);
+            }
+            const double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+            bAllocationFree = bAllocationFree && GetAllocationCount() == AllocationsBefore;
+            Test.Expect(Bank.GetActiveVoiceCount() == Count, "held voices ended during the benchmark");
+
+            NsPerFrame[Count] = Elapsed * 1e9 / static_cast<double>(Frames);
+            std::cout << "[Synth] " << Count << " voices: " << NsPerFrame[Count] << " ns/frame";
+            if (Count > 0)
+            {
+                std::cout << " (" << NsPerFrame[Count] / static_cast<double>(Count) << " ns per voice-frame), " << 1e9 / NsPerFrame[Count] / 48000.0 << "x real time";
+            }
+            std::cout << std::endl;
+        }
+        Test.Expect(bAllocationFree, "rendering allocated memory");
+        Test.Expect(NsPerFrame[0] < NsPerFrame[1] * 0.1, "idle bank not close to free");
+        // Four voices share one vector, so they cost about as much as one; beyond that, one vector per four
+        Test.Expect(NsPerFrame[4] < NsPerFrame[1] * 2.0, "four voices cost much more than one");
+        Test.Expect(NsPerFrame[32] < NsPerFrame[4] * 8.0 * 1.5, "cost grows faster than linearly with voices");
+        // Absolute speed depends on the machine and build type, so it is reported rather than asserted
+        std::cout << "[Synth] 32 voices at " << 1e9 / NsPerFrame[32] / 48000.0 << "x real time" << std::endl;
+    }
+
+    return Test.Finish();
+}
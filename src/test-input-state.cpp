@@ -0,0 +1,241 @@
+// Input state buffer test: the sequence lock the input thread publishes each decoded report through.
+// A writer publishes frames whose every word derives from the frame number while reader threads
+// snapshot as fast as they can, so a torn copy or an out-of-order frame is caught. Then benchmarks
+// publish-to-snapshot latency for a polling reader and snapshot throughput with and without a writer.
+//
+//   test-input-state [frames] [readers]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "Input/InputStateBuffer.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::uint64_t kDefaultFrames = 2000000;
+    constexpr std::uint64_t kLatencySamples = 20000;
+    constexpr auto kThroughputDuration = std::chrono::milliseconds(250);
+
+    // About the size of FInputContext: the copy has to be long enough for a writer to land in the middle
+    struct FTestState
+    {
+        std::uint64_t Frame;
+        std::int64_t PublishedNs;
+        std::uint64_t Words[24];
+
+        static FTestState Make(std::uint64_t Frame, std::int64_t PublishedNs = 0)
+        {
+            FTestState State{};
+            State.Frame = Frame;
+            State.PublishedNs = PublishedNs;
+            for (std::size_t i = 0; i < std::size(State.Words); ++i)
+            {
+                State.Words[i] = Frame * 0x9E3779B97F4A7C15ull + i;
+            }
+            return State;
+        }
+
+        bool IsConsistent() const
+        {
+            for (std::size_t i = 0; i < std::size(Words); ++i)
+            {
+                if (Words[i] != Frame * 0x9E3779B97F4A7C15ull + i)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    std::int64_t SteadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct FReaderResult
+    {
+        std::uint64_t Snapshots = 0;
+        std::uint64_t Torn = 0;
+        std::uint64_t OutOfOrder = 0;
+        std::uint64_t CounterMismatches = 0;
+    };
+
+    // Snapshots until bStop; checks every copy and that frames never go backwards for one reader
+    void ReadUntilStopped(const TSeqLock<FTestState>& Buffer, const std::atomic<bool>& bStop, FReaderResult& Result)
+    {
+        std::uint64_t LastFrame = 0;
+        FTestState State;
+        while (!bStop.load(std::memory_order_relaxed))
+        {
+            const std::uint64_t Counter = Buffer.Snapshot(State);
+            ++Result.Snapshots;
+            if (Counter == 0)
+            {
+                continue;
+            }
+            Result.Torn += State.IsConsistent() ? 0 : 1;
+            Result.OutOfOrder += State.Frame < LastFrame ? 1 : 0;
+            Result.CounterMismatches += Counter == State.Frame ? 0 : 1;
+            LastFrame = State.Frame;
+        }
+    }
+
+    std::int64_t Percentile(std::vector<std::int64_t>& Values, double P)
+    {
+        if (Values.empty())
+        {
+            return 0;
+        }
+        std::sort(Values.begin(), Values.end());
+        return Values[std::min(Values.size() - 1, static_cast<std::size_t>(Values.size() * P / 100.0))];
+    }
+
+    double MeasureSnapshotRate(TSeqLock<FTestState>& Buffer, bool bWithWriter)
+    {
+        std::atomic<bool> bStop{false};
+        std::thread Writer;
+        if (bWithWriter)
+        {
+            Writer = std::thread([&] {
+                for (std::uint64_t Frame = 1; !bStop.load(std::memory_order_relaxed); ++Frame)
+                {
+                    Buffer.Publish(FTestState::Make(Frame));
+                }
+            });
+        }
+
+        FTestState State;
+        std::uint64_t Snapshots = 0;
+        const auto Start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - Start < kThroughputDuration)
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                Buffer.Snapshot(State);
+            }
+            Snapshots += 1000;
+        }
+        const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+        bStop = true;
+        if (Writer.joinable())
+        {
+            Writer.join();
+        }
+        return Snapshots / Seconds / 1e6;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::uint64_t Frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultFrames;
+    const unsigned ReaderCount = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : std::max(3u, std::thread::hardware_concurrency() - 1);
+    FTestReport Test("Input State", std::to_string(Frames) + " frames, " + std::to_string(ReaderCount) + " readers");
+
+    // 1. Nothing published yet reads as frame 0
+    {
+        TSeqLock<FTestState> Buffer;
+        FTestState State;
+        Test.Expect(Buffer.Snapshot(State) == 0 && Buffer.GetPublishCount() == 0, "empty buffer: expected publication 0");
+        Buffer.Publish(FTestState::Make(1));
+        Test.Expect(Buffer.Snapshot(State) == 1 && State.IsConsistent(), "first publication not returned as frame 1");
+    }
+
+    // 2. Concurrent readers never see a torn or out-of-order frame
+    {
+        TSeqLock<FTestState> Buffer;
+        std::atomic<bool> bStop{false};
+        std::vector<FReaderResult> Results(ReaderCount);
+        std::vector<std::thread> Readers;
+        for (unsigned i = 0; i < ReaderCount; ++i)
+        {
+            Readers.emplace_back([&, i] { ReadUntilStopped(Buffer, bStop, Results[i]); });
+        }
+
+        for (std::uint64_t Frame = 1; Frame <= Frames; ++Frame)
+        {
+            Buffer.Publish(FTestState::Make(Frame));
+        }
+        bStop = true;
+        for (std::thread& Reader : Readers)
+        {
+            Reader.join();
+        }
+
+        FReaderResult Total;
+        for (const FReaderResult& Result : Results)
+        {
+            Total.Snapshots += Result.Snapshots;
+            Total.Torn += Result.Torn;
+            Total.OutOfOrder += Result.OutOfOrder;
+            Total.CounterMismatches += Result.CounterMismatches;
+        }
+        std::cout << "[InputState] " << Frames << " publications against " << ReaderCount << " readers: " << Total.Snapshots << " snapshots, "
+                  << Total.Torn << " torn, " << Total.OutOfOrder << " out of order" << std::endl;
+        Test.Expect(Total.Torn == 0, "a reader copied a torn state");
+        Test.Expect(Total.OutOfOrder == 0, "a reader saw frames go backwards");
+        Test.Expect(Total.CounterMismatches == 0, "snapshot counter does not match the copied frame");
+        Test.Expect(Buffer.GetPublishCount() == Frames, "publish count does not match the frames written");
+    }
+
+    // 3. Benchmark: publish-to-snapshot latency for a reader polling GetPublishCount()
+    {
+        TSeqLock<FTestState> Buffer;
+        std::atomic<bool> bReady{false};
+        std::vector<std::int64_t> LatencyNs;
+        LatencyNs.reserve(kLatencySamples);
+        std::thread Reader([&] {
+            FTestState State;
+            std::uint64_t Seen = 0;
+            bReady = true;
+            while (Seen < kLatencySamples)
+            {
+                const std::uint64_t Count = Buffer.GetPublishCount();
+                if (Count == Seen)
+                {
+                    continue;
+                }
+                Seen = Buffer.Snapshot(State);
+                LatencyNs.push_back(SteadyNowNs() - State.PublishedNs);
+            }
+        });
+        while (!bReady)
+        {
+            std::this_thread::yield();
+        }
+
+        // Paced so every publication is observed on its own, like 1 kHz reports
+        for (std::uint64_t Frame = 1; Frame <= kLatencySamples; ++Frame)
+        {
+            Buffer.Publish(FTestState::Make(Frame, SteadyNowNs()));
+            const std::int64_t NextNs = SteadyNowNs() + 20000;
+            while (SteadyNowNs() < NextNs)
+            {
+            }
+        }
+        Reader.join();
+        std::cout << "[InputState] Publish to snapshot (spinning reader): p50 " << Percentile(LatencyNs, 50.0) << " ns, p99 "
+                  << Percentile(LatencyNs, 99.0) << " ns, max " << Percentile(LatencyNs, 100.0) << " ns" << std::endl;
+    }
+
+    // 4. Benchmark: snapshot throughput with an idle and with a publishing writer
+    {
+        TSeqLock<FTestState> Buffer;
+        Buffer.Publish(FTestState::Make(1));
+        const double Idle = MeasureSnapshotRate(Buffer, false);
+        const double Contended = MeasureSnapshotRate(Buffer, true);
+        std::cout << "[InputState] Snapshots: " << Idle << " M/s idle, " << Contended << " M/s against a writer publishing back to back" << std::endl;
+    }
+
+    return Test.Finish();
+}
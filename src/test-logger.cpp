@@ -0,0 +1,180 @@
+// Async logger test: several threads log through GAMEPAD_LOG_* while the flusher formats records
+// into GamepadService.log with a small rotation size. Checks that every record lands
+// in the files exactly once (or is reported as dropped), in per-thread order, that std::cout lines are
+// captured and rotation keeps its backup count, then benchmarks ns per log call against the previous
+// path (std::cout redirected into an std::ofstream, one std::endl flush per line).
+//
+//   test-logger [records per thread] [threads]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Testing/TestReport.h"
+#include "logger.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::size_t kDefaultRecords = 20000;
+    constexpr std::size_t kDefaultThreads = 4;
+    constexpr std::size_t kBenchmarkCalls = 200000;
+    constexpr std::size_t kBenchmarkBurst = 1000; // drained between bursts so the rings never fill
+    constexpr std::uintmax_t kRotationBytes = 256 * 1024;
+    constexpr int kBackupFiles = 64;
+
+    std::vector<std::string> ReadLogLines(const std::filesystem::path& Directory, int& OutFiles)
+    {
+        // Oldest backup first, so lines come out in write order
+        std::vector<std::string> Lines;
+        OutFiles = 0;
+        for (int Index = kBackupFiles + 1; Index >= 0; --Index)
+        {
+            const std::filesystem::path File = Directory / (Index == 0 ? std::string("GamepadService.log") : "GamepadService." + std::to_string(Index) + ".log");
+            std::ifstream Input(File);
+            if (!Input)
+            {
+                continue;
+            }
+            ++OutFiles;
+            for (std::string Line; std::getline(Input, Line);)
+            {
+                Lines.push_back(std::move(Line));
+            }
+        }
+        return Lines;
+    }
+
+    template<typename TFunc>
+    double MeasureNsPerCall(std::size_t Calls, TFunc&& Call, void (*BetweenBursts)())
+    {
+        std::chrono::nanoseconds Elapsed{0};
+        for (std::size_t Done = 0; Done < Calls; Done += kBenchmarkBurst)
+        {
+            const auto Start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < kBenchmarkBurst; ++i)
+            {
+                Call(Done + i);
+            }
+            Elapsed += std::chrono::steady_clock::now() - Start;
+            BetweenBursts();
+        }
+        return static_cast<double>(Elapsed.count()) / static_cast<double>(Calls);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t Records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultRecords;
+    const std::size_t Threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : kDefaultThreads;
+    FTestReport Test("Logger", std::to_string(Threads) + " threads x " + std::to_string(Records) + " records");
+
+    const std::filesystem::path Directory = std::filesystem::temp_directory_path() / ("gamepad-logger-test-" + std::to_string(std::random_device{}()));
+    Logger::FOptions Options;
+    Options.MaxFileBytes = kRotationBytes;
+    Options.MaxBackupFiles = kBackupFiles;
+    Options.MirrorToConsole = false;
+
+    // 1. Concurrent writers, typed and stream logging, rotation
+    {
+        Logger::Initialize(Directory.string(), Options);
+        std::vector<std::thread> Writers;
+        for (std::size_t Thread = 0; Thread < Threads; ++Thread)
+        {
+            Writers.emplace_back([Thread, Records] {
+                const std::string Payload = "payload-" + std::to_string(Thread);
+                for (std::size_t Sequence = 0; Sequence < Records; ++Sequence)
+                {
+                    GAMEPAD_LOG_INFO("[Test] thread {} seq {} {} {}", Thread, Sequence, Payload, 0.5 * static_cast<double>(Sequence));
+                    if (Sequence % 32 == 31) // well under one ring per flush interval
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }
+            });
+        }
+        for (std::thread& Writer : Writers)
+        {
+            Writer.join();
+        }
+        Logger::Flush();
+        for (std::size_t Thread = 0; Thread < Threads; ++Thread)
+        {
+            std::cout << "[Test] stream thread " << Thread << " done" << std::endl;
+        }
+        GAMEPAD_LOG_WARNING("[Test] long {}", std::string(2 * LogDetail::MaxRecordSize, 'x'));
+        Logger::Shutdown();
+
+        int Files = 0;
+        const std::vector<std::string> Lines = ReadLogLines(Directory, Files);
+        std::vector<std::int64_t> NextSequence(Threads, 0);
+        std::uint64_t Found = 0, Dropped = 0, OutOfOrder = 0, StreamLines = 0;
+        std::size_t LongLine = 0;
+        for (const std::string& Line : Lines)
+        {
+            std::size_t Position = Line.find("[Test] thread ");
+            if (Position != std::string::npos)
+            {
+                std::istringstream Fields(Line.substr(Position + 14));
+                std::size_t Thread = 0;
+                std::string Seq;
+                std::int64_t Sequence = 0;
+                Fields >> Thread >> Seq >> Sequence;
+                if (Thread < Threads)
+                {
+                    OutOfOrder += Sequence < NextSequence[Thread] ? 1 : 0;
+                    NextSequence[Thread] = Sequence + 1;
+                    ++Found;
+                }
+            }
+            else if ((Position = Line.find("[Logger] Dropped ")) != std::string::npos)
+            {
+                Dropped += std::strtoull(Line.c_str() + Position + 17, nullptr, 10);
+            }
+            else if (Line.find("[Test] stream thread ") != std::string::npos)
+            {
+                ++StreamLines;
+            }
+            else if (Line.find("[Test] long ") != std::string::npos)
+            {
+                LongLine = Line.size();
+            }
+        }
+
+        std::cout << "[Logger] " << Lines.size() << " lines in " << Files << " files, " << Found << " records, " << Dropped << " dropped" << std::endl;
+        Test.Expect(Found + Dropped == Records * Threads, "records lost without a drop report, or duplicated");
+        Test.Expect(OutOfOrder == 0, "records of one thread written out of order");
+        Test.Expect(StreamLines == Threads, "std::cout lines not captured");
+        Test.Expect(LongLine > 0 && LongLine < 2 * LogDetail::MaxRecordSize, "oversized record not truncated");
+        Test.Expect(Files > 1 && Files <= kBackupFiles + 1, "log not rotated by size");
+    }
+
+    // 2. Benchmark: caller-side cost of one log line, async records vs the old redirected std::cout
+    {
+        Logger::Initialize(Directory.string(), Options);
+        const double AsyncNs = MeasureNsPerCall(
+            kBenchmarkCalls, [](std::size_t i) { GAMEPAD_LOG_INFO("[Bench] input tick {} report {} ok", i, static_cast<std::uint32_t>(i * 3)); },
+            [] { Logger::Flush(); });
+        Logger::Shutdown();
+
+        std::ofstream File(Directory / "Redirected.log", std::ios::app);
+        std::streambuf* const Console = std::cout.rdbuf(File.rdbuf());
+        const double RedirectedNs = MeasureNsPerCall(
+            kBenchmarkCalls, [](std::size_t i) { std::cout << "[Bench] input tick " << i << " report " << i * 3 << " ok" << std::endl; }, [] {});
+        std::cout.rdbuf(Console);
+
+        std::cout << "[Logger] ns per log call: async " << AsyncNs << ", redirected std::cout + std::endl " << RedirectedNs << std::endl;
+    }
+
+    std::error_code Error;
+    std::filesystem::remove_all(Directory, Error);
+    return Test.Finish();
+}
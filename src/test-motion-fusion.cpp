@@ -0,0 +1,354 @@
+// Motion stage test: accuracy of the batched IMU calibration and of the Madgwick fusion, plus a
+// throughput benchmark. The built-in recording is a synthetic 250 Hz trajectory with known ground
+// truth, quantized into raw DualSense samples through a real calibration report. A capture of raw
+// USB input reports (64-byte report 0x01 records, e.g. from /dev/hidrawN) can be benchmarked instead.
+//
+//   test-motion-fusion [usb-report-capture.bin]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Input/MotionFusion.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr double kPi = 3.14159265358979323846;
+    constexpr double kRadToDeg = 180.0 / kPi;
+    constexpr double kSampleRate = 250.0;
+    constexpr double kDurationSeconds = 120.0;
+    constexpr double kConvergenceSeconds = 2.0;
+    constexpr std::size_t kBenchmarkSamples = 4000000;
+
+    // Accuracy budgets
+    constexpr double kCalibrationTolerance = 2.0 * std::numeric_limits<float>::epsilon(); // relative (~2.4e-7), SIMD vs double reference: one rounding each for the multiply and the add
+    constexpr double kReferenceToleranceDeg = 0.1;  // float filter vs double reference filter (float drift over 2 min)
+    constexpr double kTiltMaxErrorDeg = 3.0;        // fused tilt vs ground truth
+    constexpr double kTiltRmsErrorDeg = 1.0;
+
+    struct FQuat
+    {
+        double W = 1.0, X = 0.0, Y = 0.0, Z = 0.0;
+
+        FQuat Normalized() const
+        {
+            const double Norm = std::sqrt(W * W + X * X + Y * Y + Z * Z);
+            return {W / Norm, X / Norm, Y / Norm, Z / Norm};
+        }
+
+        // World up seen from the body frame (R^T * [0, 0, 1])
+        void Up(double Out[3]) const
+        {
+            Out[0] = 2.0 * (X * Z - W * Y);
+            Out[1] = 2.0 * (W * X + Y * Z);
+            Out[2] = W * W - X * X - Y * Y + Z * Z;
+        }
+    };
+
+    double AngleBetweenDeg(const double A[3], const double B[3])
+    {
+        const double Dot = A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
+        const double NormA = std::sqrt(A[0] * A[0] + A[1] * A[1] + A[2] * A[2]);
+        const double NormB = std::sqrt(B[0] * B[0] + B[1] * B[1] + B[2] * B[2]);
+        return std::acos(std::clamp(Dot / (NormA * NormB), -1.0, 1.0)) * kRadToDeg;
+    }
+
+    double QuatAngleDeg(const FQuat& A, const float* B)
+    {
+        const double Dot = std::fabs(A.W * B[0] + A.X * B[1] + A.Y * B[2] + A.Z * B[3]);
+        return 2.0 * std::acos(std::min(Dot, 1.0)) * kRadToDeg;
+    }
+
+    /**
+     * Reference Madgwick IMU filter in double precision, written from the paper's matrix form
+     * (gradient = J^T * f) rather than from the expanded expressions FMadgwickFilter uses.
+     */
+    class FReferenceMadgwick
+    {
+    public:
+        explicit FReferenceMadgwick(double InBeta) : Beta(InBeta) {}
+
+        void Update(double Gx, double Gy, double Gz, double Ax, double Ay, double Az, double Dt)
+        {
+            const double AccelNorm = std::sqrt(Ax * Ax + Ay * Ay + Az * Az);
+            if (!bInitialized)
+            {
+                const double Ux = Ax / AccelNorm, Uy = Ay / AccelNorm, Uz = Az / AccelNorm;
+                Q = FQuat{1.0 + Uz, Uy, -Ux, 0.0}.Normalized();
+                bInitialized = true;
+            }
+
+            const double Q0 = Q.W, Q1 = Q.X, Q2 = Q.Y, Q3 = Q.Z;
+            double Dot[4] = {0.5 * (-Q1 * Gx - Q2 * Gy - Q3 * Gz), 0.5 * (Q0 * Gx + Q2 * Gz - Q3 * Gy),
+                             0.5 * (Q0 * Gy - Q1 * Gz + Q3 * Gx), 0.5 * (Q0 * Gz + Q1 * Gy - Q2 * Gx)};
+
+            if (AccelNorm > 0.5 && AccelNorm < 1.5)
+            {
+                const double A[3] = {Ax / AccelNorm, Ay / AccelNorm, Az / AccelNorm};
+                const double F[3] = {2.0 * (Q1 * Q3 - Q0 * Q2) - A[0], 2.0 * (Q0 * Q1 + Q2 * Q3) - A[1], 2.0 * (0.5 - Q1 * Q1 - Q2 * Q2) - A[2]};
+                const double J[3][4] = {{-2.0 * Q2, 2.0 * Q3, -2.0 * Q0, 2.0 * Q1}, {2.0 * Q1, 2.0 * Q0, 2.0 * Q3, 2.0 * Q2}, {0.0, -4.0 * Q1, -4.0 * Q2, 0.0}};
+                double Gradient[4] = {};
+                for (int Col = 0; Col < 4; ++Col)
+                {
+                    for (int Row = 0; Row < 3; ++Row)
+                    {
+                        Gradient[Col] += J[Row][Col] * F[Row];
+                    }
+                }
+                const double Norm = std::sqrt(Gradient[0] * Gradient[0] + Gradient[1] * Gradient[1] + Gradient[2] * Gradient[2] + Gradient[3] * Gradient[3]);
+                for (int i = 0; Norm > 0.0 && i < 4; ++i)
+                {
+                    Dot[i] -= Beta * Gradient[i] / Norm;
+                }
+            }
+
+            Q = FQuat{Q0 + Dot[0] * Dt, Q1 + Dot[1] * Dt, Q2 + Dot[2] * Dt, Q3 + Dot[3] * Dt}.Normalized();
+        }
+
+        FQuat Q;
+
+    private:
+        double Beta;
+        bool bInitialized = false;
+    };
+
+    // Calibration report with the plausible per-unit spread of a real controller
+    void MakeCalibrationReport(FCalibrationCache::FReport& Report)
+    {
+        using namespace DualSenseCalibrationReport;
+        std::memset(Report, 0, sizeof(FCalibrationCache::FReport));
+        Report[0] = ReportId;
+        auto Put = [&Report](std::size_t Offset, std::int16_t Value)
+        {
+            Report[Offset] = static_cast<std::uint8_t>(Value & 0xff);
+            Report[Offset + 1] = static_cast<std::uint8_t>((Value >> 8) & 0xff);
+        };
+        Put(GyroPitchBias, 3);
+        Put(GyroYawBias, -2);
+        Put(GyroRollBias, 1);
+        Put(GyroPitchPlus, 8650);
+        Put(GyroPitchMinus, -8640);
+        Put(GyroYawPlus, 8660);
+        Put(GyroYawMinus, -8655);
+        Put(GyroRollPlus, 8645);
+        Put(GyroRollMinus, -8650);
+        Put(GyroSpeedPlus, 540);
+        Put(GyroSpeedMinus, 540);
+        Put(AccelXPlus, 8200);
+        Put(AccelXMinus, -8180);
+        Put(AccelYPlus, 8190);
+        Put(AccelYMinus, -8195);
+        Put(AccelZPlus, 8210);
+        Put(AccelZMinus, -8185);
+    }
+
+    struct FRecording
+    {
+        std::vector<std::int16_t> Raw; // 6 per sample, report order
+        std::vector<std::uint32_t> Timestamps;
+        std::vector<FQuat> Truth;      // filter frame, empty for captures
+
+        std::size_t Size() const { return Timestamps.size(); }
+    };
+
+    /**
+     * Smooth tumbling motion integrated in double, then sensed as a controller would: device axes,
+     * gyro and accelerometer noise, quantized through the inverse of the calibration.
+     */
+    FRecording Synthesize(const FMotionCalibration& Calibration)
+    {
+        FRecording Out;
+        std::mt19937 Rng(42);
+        std::normal_distribution<double> GyroNoise(0.0, 0.01);
+        std::normal_distribution<double> AccelNoise(0.0, 0.01);
+
+        const std::size_t Count = static_cast<std::size_t>(kDurationSeconds * kSampleRate);
+        const double Dt = 1.0 / kSampleRate;
+        constexpr int kSubSteps = 16;
+        FQuat Q = FQuat{std::cos(0.2), std::sin(0.2), 0.0, 0.0}; // start tilted 23 degrees
+        std::uint32_t Timestamp = 0x12345678;
+
+        auto Omega = [](double T, double Out[3])
+        {
+            Out[0] = 0.8 * std::sin(2.0 * kPi * 0.30 * T);
+            Out[1] = 1.2 * std::sin(2.0 * kPi * 0.17 * T + 1.0);
+            Out[2] = 0.6 * std::sin(2.0 * kPi * 0.41 * T + 2.0);
+        };
+
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            const double T = static_cast<double>(i) * Dt;
+            for (int Step = 0; Step < kSubSteps; ++Step)
+            {
+                double W[3];
+                Omega(T + (Step + 0.5) * Dt / kSubSteps, W);
+                const double H = 0.5 * Dt / kSubSteps;
+                Q = FQuat{Q.W - H * (Q.X * W[0] + Q.Y * W[1] + Q.Z * W[2]), Q.X + H * (Q.W * W[0] + Q.Y * W[2] - Q.Z * W[1]),
+                          Q.Y + H * (Q.W * W[1] - Q.X * W[2] + Q.Z * W[0]), Q.Z + H * (Q.W * W[2] + Q.X * W[1] - Q.Y * W[0])}
+                        .Normalized();
+            }
+
+            double Gyro[3];
+            Omega(T + Dt, Gyro);
+            double Up[3];
+            Q.Up(Up);
+
+            // Filter frame (X right, Y forward, Z up) -> device frame (X right, Y up, Z toward player)
+            const double Device[6] = {Gyro[0] + GyroNoise(Rng), Gyro[2] + GyroNoise(Rng), -Gyro[1] + GyroNoise(Rng),
+                                      Up[0] + AccelNoise(Rng), Up[2] + AccelNoise(Rng), -Up[1] + AccelNoise(Rng)};
+            for (std::size_t Axis = 0; Axis < 6; ++Axis)
+            {
+                const double Raw = std::round((Device[Axis] - Calibration.Offset[Axis]) / Calibration.Scale[Axis]);
+                Out.Raw.push_back(static_cast<std::int16_t>(std::clamp(Raw, -32768.0, 32767.0)));
+            }
+
+            Timestamp += static_cast<std::uint32_t>(FMotionStage::TicksPerSecond / kSampleRate);
+            Out.Timestamps.push_back(Timestamp);
+            Out.Truth.push_back(Q);
+        }
+        return Out;
+    }
+
+    bool LoadCapture(const char* Path, FRecording& Out)
+    {
+        std::ifstream File(Path, std::ios::binary);
+        std::uint8_t Record[DualSenseReport::UsbHeaderSize + DualSenseReport::PayloadSize];
+        while (File.read(reinterpret_cast<char*>(Record), sizeof(Record)))
+        {
+            const FDualSenseReportView Report = FDualSenseReportView::FromBuffer(Record, sizeof(Record), false);
+            if (!Report.IsValid())
+            {
+                continue;
+            }
+            for (std::size_t Axis = 0; Axis < 3; ++Axis)
+            {
+                Out.Raw.push_back(Report.GetGyro(Axis));
+            }
+            for (std::size_t Axis = 0; Axis < 3; ++Axis)
+            {
+                Out.Raw.push_back(Report.GetAccel(Axis));
+            }
+            Out.Timestamps.push_back(Report.GetSensorTimestamp());
+        }
+        return Out.Size() > 0;
+    }
+
+    template<typename TFunc>
+    double MeasureSamplesPerSecond(std::size_t Samples, TFunc&& Func)
+    {
+        const auto Start = std::chrono::steady_clock::now();
+        Func();
+        const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        return static_cast<double>(Samples) / Seconds;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    FTestReport Test("Motion Fusion");
+
+    FCalibrationCache::FReport Report;
+    MakeCalibrationReport(Report);
+    const FMotionCalibration Calibration = FMotionCalibration::FromReport(Report);
+    FMotionCalibrator Calibrator;
+    Calibrator.Compile(Calibration);
+
+    const FRecording Synthetic = Synthesize(Calibration);
+    const std::size_t Count = Synthetic.Size();
+
+    // 1. Batched calibration against a double-precision reference (odd count exercises the scalar tail)
+    std::vector<float> Calibrated(Count * 6);
+    Calibrator.CalibrateBatch(Synthetic.Raw.data(), Count - 3, Calibrated.data());
+    Calibrator.CalibrateBatch(Synthetic.Raw.data() + (Count - 3) * 6, 3, Calibrated.data() + (Count - 3) * 6);
+    double MaxCalibrationError = 0.0;
+    for (std::size_t i = 0; i < Count * 6; ++i)
+    {
+        const double Reference = static_cast<double>(Synthetic.Raw[i]) * Calibration.Scale[i % 6] + Calibration.Offset[i % 6];
+        MaxCalibrationError = std::max(MaxCalibrationError, std::fabs(Calibrated[i] - Reference) / std::max(1.0, std::fabs(Reference)));
+    }
+    std::cout << "[Motion] Batch calibration vs reference: max relative error " << MaxCalibrationError << std::endl;
+    Test.Expect(MaxCalibrationError <= kCalibrationTolerance, "batched calibration diverges from the reference");
+
+    // 2. Fusion against the double reference filter and against ground truth
+    FMotionStage Stage;
+    Stage.SetCalibration(Calibration);
+    FReferenceMadgwick Reference(FMadgwickFilter::DefaultBeta);
+    double MaxReferenceDeg = 0.0, MaxTiltDeg = 0.0, TiltSquaredSum = 0.0;
+    std::size_t TiltSamples = 0;
+    for (std::size_t i = 0; i < Count; ++i)
+    {
+        Stage.ProcessBatch(Synthetic.Raw.data() + i * 6, &Synthetic.Timestamps[i], 1);
+
+        const float* Sample = Calibrated.data() + i * 6;
+        Reference.Update(Sample[0], -Sample[2], Sample[1], Sample[3], -Sample[5], Sample[4], i == 0 ? 0.0 : 1.0 / kSampleRate);
+        MaxReferenceDeg = std::max(MaxReferenceDeg, QuatAngleDeg(Reference.Q, Stage.GetState().Orientation));
+
+        if (static_cast<double>(i) / kSampleRate >= kConvergenceSeconds)
+        {
+            const float* Q = Stage.GetState().Orientation;
+            double Estimated[3], Truth[3];
+            FQuat{Q[0], Q[1], Q[2], Q[3]}.Up(Estimated);
+            Synthetic.Truth[i].Up(Truth);
+            const double TiltDeg = AngleBetweenDeg(Estimated, Truth);
+            MaxTiltDeg = std::max(MaxTiltDeg, TiltDeg);
+            TiltSquaredSum += TiltDeg * TiltDeg;
+            ++TiltSamples;
+        }
+    }
+    const double RmsTiltDeg = std::sqrt(TiltSquaredSum / static_cast<double>(TiltSamples));
+    std::cout << "[Motion] Filter vs double reference: max " << MaxReferenceDeg << " deg" << std::endl;
+    std::cout << "[Motion] Tilt vs ground truth: RMS " << RmsTiltDeg << " deg, max " << MaxTiltDeg << " deg" << std::endl;
+    Test.Expect(MaxReferenceDeg <= kReferenceToleranceDeg, "fusion diverges from the reference implementation");
+    Test.Expect(MaxTiltDeg <= kTiltMaxErrorDeg && RmsTiltDeg <= kTiltRmsErrorDeg, "fused tilt error over budget");
+    Test.Expect(Stage.GetState().SampleCount == Count, "samples were dropped");
+    Test.Expect(Stage.ProcessBatch(Synthetic.Raw.data(), &Synthetic.Timestamps[Count - 1], 1) == 0, "a repeated report was integrated twice");
+
+    // 3. Throughput on the recording (a capture when given, the synthetic one otherwise)
+    FRecording Capture;
+    const bool bCapture = argc > 1 && LoadCapture(argv[1], Capture);
+    if (argc > 1 && !bCapture)
+    {
+        std::cerr << "[Motion] No USB input reports in " << argv[1] << ", benchmarking the synthetic recording." << std::endl;
+    }
+    const FRecording& Recording = bCapture ? Capture : Synthetic;
+    const std::size_t Passes = std::max<std::size_t>(1, kBenchmarkSamples / Recording.Size());
+    const std::size_t Samples = Passes * Recording.Size();
+    std::vector<float> Output(Recording.Size() * 6);
+
+    const double ScalarRate = MeasureSamplesPerSecond(Samples, [&] {
+        for (std::size_t Pass = 0; Pass < Passes; ++Pass)
+        {
+            Calibrator.CalibrateScalar(Recording.Raw.data(), Recording.Size(), Output.data());
+        }
+    });
+    const double BatchRate = MeasureSamplesPerSecond(Samples, [&] {
+        for (std::size_t Pass = 0; Pass < Passes; ++Pass)
+        {
+            Calibrator.CalibrateBatch(Recording.Raw.data(), Recording.Size(), Output.data());
+        }
+    });
+    const double StageRate = MeasureSamplesPerSecond(Samples, [&] {
+        FMotionStage BenchStage;
+        BenchStage.SetCalibration(Calibration);
+        for (std::size_t Pass = 0; Pass < Passes; ++Pass)
+        {
+            BenchStage.Reset();
+            BenchStage.ProcessBatch(Recording.Raw.data(), Recording.Timestamps.data(), Recording.Size());
+        }
+    });
+    std::cout << "[Motion] " << (bCapture ? "Capture" : "Synthetic") << " recording, " << Recording.Size() << " samples x " << Passes << " passes" << std::endl;
+    std::cout << "[Motion] Calibration: scalar " << ScalarRate / 1e6 << " M samples/s, batch " << BatchRate / 1e6
+              << " M samples/s; calibration + fusion " << StageRate / 1e6 << " M samples/s" << std::endl;
+    Test.Expect(StageRate > 1000.0 * 100.0, "motion stage cannot keep up with 100 controllers at 1 kHz");
+
+    return Test.Finish();
+}
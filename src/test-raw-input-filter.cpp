@@ -0,0 +1,222 @@
+// Raw input filter test: the vendor ID cache and in-place device list compaction behind the
+// GetRawInputDeviceList detour, against thousands of synthetic devices whose vendor lookup costs
+// about as much as a GetRawInputDeviceInfo call. Checks that Sony HID devices are removed in order,
+// that lookups happen only after an arrival or removal, that failed lookups are retried and that the
+// filter never allocates, then benchmarks the cached filter against a lookup per device and call.
+//
+//   test-raw-input-filter [devices] [calls] [lookup-cost-ns]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Input/RawInputDeviceFilter.h"
+#include "Testing/AllocationCounter.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::size_t kDefaultDevices = 3000;
+    constexpr std::size_t kDefaultCalls = 2000;
+    constexpr std::int64_t kDefaultLookupCostNs = 2000;
+    constexpr std::uint32_t kTypeMouse = 0;
+    constexpr std::uint32_t kTypeHid = 2; // RIM_TYPEHID
+    constexpr std::uint32_t kSonyVendorId = 0x054C;
+
+    // Same members the filter reads from RAWINPUTDEVICELIST
+    struct FSyntheticDevice
+    {
+        void* hDevice;
+        std::uint32_t dwType;
+
+        bool operator==(const FSyntheticDevice&) const = default;
+    };
+
+    // Device table the injected lookup reads; handles are 1-based indexes into it
+    struct FSyntheticSystem
+    {
+        std::vector<std::uint32_t> VendorIds;
+        std::vector<bool> bInitializing;
+        std::int64_t LookupCostNs = 0;
+        std::uint64_t Lookups = 0;
+    };
+    FSyntheticSystem g_System;
+
+    bool SyntheticLookup(void* Handle, std::uint32_t& OutVendorId)
+    {
+        ++g_System.Lookups;
+        const auto Deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(g_System.LookupCostNs);
+        while (std::chrono::steady_clock::now() < Deadline)
+        {
+        }
+
+        const std::size_t Index = reinterpret_cast<std::uintptr_t>(Handle) - 1;
+        if (Index >= g_System.VendorIds.size() || g_System.bInitializing[Index])
+        {
+            return false;
+        }
+        OutVendorId = g_System.VendorIds[Index];
+        return true;
+    }
+
+    void* MakeHandle(std::size_t Index) { return reinterpret_cast<void*>(static_cast<std::uintptr_t>(Index + 1)); }
+
+    // One in 50 HID devices is a DualSense, one in 4 devices is not HID (mice and keyboards share vendors too)
+    std::vector<FSyntheticDevice> MakeDevices(std::size_t Count)
+    {
+        std::mt19937 Random(30);
+        g_System.VendorIds.assign(Count, 0);
+        g_System.bInitializing.assign(Count, false);
+        std::vector<FSyntheticDevice> Devices(Count);
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            const bool bHid = Random() % 4 != 0;
+            g_System.VendorIds[i] = Random() % 50 == 0 ? kSonyVendorId : 0x1000 + Random() % 0x8000;
+            Devices[i] = {MakeHandle(i), bHid ? kTypeHid : kTypeMouse};
+        }
+        return Devices;
+    }
+
+    // What the detour must return: every device except Sony HIDs, in the original order
+    std::vector<FSyntheticDevice> Expected(const std::vector<FSyntheticDevice>& Devices)
+    {
+        std::vector<FSyntheticDevice> Kept;
+        for (const FSyntheticDevice& Device : Devices)
+        {
+            const std::size_t Index = reinterpret_cast<std::uintptr_t>(Device.hDevice) - 1;
+            const bool bBlocked = Device.dwType == kTypeHid && !g_System.bInitializing[Index] && g_System.VendorIds[Index] == kSonyVendorId;
+            if (!bBlocked)
+            {
+                Kept.push_back(Device);
+            }
+        }
+        return Kept;
+    }
+
+    bool FilterMatches(const std::vector<FSyntheticDevice>& Devices, FRawInputVendorCache& Cache)
+    {
+        std::vector<FSyntheticDevice> Buffer = Devices;
+        const std::uint32_t Kept = FilterRawInputDevices(Buffer.data(), static_cast<std::uint32_t>(Buffer.size()), kTypeHid, kSonyVendorId, Cache);
+        Buffer.resize(Kept);
+        return Buffer == Expected(Devices);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t DeviceCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultDevices;
+    const std::size_t Calls = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : kDefaultCalls;
+    const std::int64_t LookupCostNs = argc > 3 ? std::strtoll(argv[3], nullptr, 10) : kDefaultLookupCostNs;
+    FTestReport Test("Raw Input Filter", std::to_string(DeviceCount) + " devices");
+
+    std::vector<FSyntheticDevice> Devices = MakeDevices(DeviceCount);
+    FRawInputVendorCache Cache(SyntheticLookup);
+
+    // 1. Filtering is exact and stable; only the first call looks vendors up
+    {
+        Test.Expect(FilterMatches(Devices, Cache), "filtered list differs from the expected one");
+        const std::uint64_t HidDevices = static_cast<std::uint64_t>(std::count_if(Devices.begin(), Devices.end(), [](const FSyntheticDevice& Device) { return Device.dwType == kTypeHid; }));
+        const std::uint64_t FirstLookups = g_System.Lookups;
+        Test.Expect(DeviceCount >= FRawInputVendorCache::Capacity || FirstLookups == HidDevices, "non-HID devices were looked up, or HID devices skipped");
+
+        Test.Expect(FilterMatches(Devices, Cache), "second call filtered differently");
+        Test.Expect(DeviceCount >= FRawInputVendorCache::Capacity || g_System.Lookups == FirstLookups, "unchanged device set looked up again");
+    }
+
+    // 2. Arrival, removal and a device still initializing
+    if (DeviceCount < FRawInputVendorCache::Capacity - 1)
+    {
+        const std::size_t Arrived = g_System.VendorIds.size();
+        g_System.VendorIds.push_back(kSonyVendorId);
+        g_System.bInitializing.push_back(true);
+        Devices.insert(Devices.begin() + static_cast<std::ptrdiff_t>(Devices.size() / 3), FSyntheticDevice{MakeHandle(Arrived), kTypeHid});
+
+        std::uint64_t Before = g_System.Lookups;
+        Test.Expect(FilterMatches(Devices, Cache), "arriving device filtered wrongly while its lookup fails");
+        Test.Expect(g_System.Lookups > Before, "arrival did not invalidate the cache");
+
+        // Same set, now initialized: the failed lookup was not cached, so it is asked again and blocked
+        g_System.bInitializing[Arrived] = false;
+        Before = g_System.Lookups;
+        Test.Expect(FilterMatches(Devices, Cache), "initialized DualSense not filtered out");
+        Test.Expect(g_System.Lookups == Before + 1, "failed lookup was cached, or cached entries looked up again");
+
+        Devices.erase(Devices.begin() + static_cast<std::ptrdiff_t>(Devices.size() / 2));
+        Before = g_System.Lookups;
+        Test.Expect(FilterMatches(Devices, Cache), "list filtered wrongly after a removal");
+        Test.Expect(g_System.Lookups > Before, "removal did not invalidate the cache");
+    }
+
+    // 3. More HID devices than the cache holds: still exact, and only the overflow is looked up again
+    {
+        std::vector<FSyntheticDevice> Crowd = MakeDevices(FRawInputVendorCache::Capacity * 2);
+        FRawInputVendorCache CrowdCache(SyntheticLookup);
+        Test.Expect(FilterMatches(Crowd, CrowdCache), "filter wrong once the cache overflowed");
+        const std::uint64_t Before = g_System.Lookups;
+        Test.Expect(FilterMatches(Crowd, CrowdCache), "filter wrong on a full cache");
+        const std::uint64_t HidDevices = static_cast<std::uint64_t>(std::count_if(Crowd.begin(), Crowd.end(), [](const FSyntheticDevice& Device) { return Device.dwType == kTypeHid; }));
+        Test.Expect(g_System.Lookups - Before == HidDevices - (FRawInputVendorCache::Capacity - 1), "full cache evicted entries instead of keeping them");
+        Devices = MakeDevices(DeviceCount);
+        Cache.Invalidate();
+    }
+
+    // 4. The filter never allocates, cached or not
+    {
+        std::vector<FSyntheticDevice> Buffer = Devices;
+        const std::size_t AllocationsBefore = GetAllocationCount();
+        Cache.Invalidate();
+        for (int Pass = 0; Pass < 3; ++Pass)
+        {
+            Buffer = Devices; // same capacity: no reallocation
+            FilterRawInputDevices(Buffer.data(), static_cast<std::uint32_t>(Buffer.size()), kTypeHid, kSonyVendorId, Cache);
+        }
+        Test.Expect(GetAllocationCount() == AllocationsBefore, "filtering allocated");
+    }
+
+    // 5. Benchmark: the cached in-place filter vs a lookup per device and call into a fresh vector
+    {
+        g_System.LookupCostNs = LookupCostNs;
+        std::vector<FSyntheticDevice> Buffer(Devices.size());
+        std::size_t Checksum = 0;
+
+        const std::uint64_t CachedLookupsBefore = g_System.Lookups;
+        Cache.Invalidate();
+        auto Start = std::chrono::steady_clock::now();
+        for (std::size_t Call = 0; Call < Calls; ++Call)
+        {
+            std::copy(Devices.begin(), Devices.end(), Buffer.begin());
+            Checksum += FilterRawInputDevices(Buffer.data(), static_cast<std::uint32_t>(Buffer.size()), kTypeHid, kSonyVendorId, Cache);
+        }
+        const double CachedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Calls);
+        const std::uint64_t CachedLookups = g_System.Lookups - CachedLookupsBefore;
+
+        const std::size_t UncachedCalls = std::max<std::size_t>(1, Calls / 20);
+        Start = std::chrono::steady_clock::now();
+        for (std::size_t Call = 0; Call < UncachedCalls; ++Call)
+        {
+            std::vector<FSyntheticDevice> Filtered;
+            for (const FSyntheticDevice& Device : Devices)
+            {
+                std::uint32_t VendorId = 0;
+                if (Device.dwType != kTypeHid || !SyntheticLookup(Device.hDevice, VendorId) || VendorId != kSonyVendorId)
+                {
+                    Filtered.push_back(Device);
+                }
+            }
+            Checksum += Filtered.size();
+        }
+        const double UncachedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(UncachedCalls);
+
+        std::cout << "[RawInput] " << Devices.size() << " devices: cached " << CachedUs << " us per call (" << CachedLookups << " lookups in " << Calls
+                  << " calls), lookup per device " << UncachedUs << " us per call (checksum " << Checksum << ")" << std::endl;
+        Test.Expect(DeviceCount >= FRawInputVendorCache::Capacity || CachedLookups < Devices.size(), "benchmark cache kept looking devices up");
+    }
+
+    return Test.Finish();
+}
@@ -0,0 +1,321 @@
+// Reconnect soak test: thousands of plug / unplug / USB <-> Bluetooth cycles against the simulated bus,
+// with the service's own input loop (FInputLoop), haptics loop (FHapticsLoop) and a fake capture device
+// on their own threads under the simulated clock, through the real registry and gamepad library.
+// Tracks open transport handles, process handles, heap and thread counts, and reconnect-to-first-report
+// latency, and fails when any of them regresses. No hardware, no sleeping in real time.
+//
+// Each connect resolves the IMU calibration in the simulated policy's ConfigureFeatures, through the
+// calibration cache unless "nocache" is given, against Bluetooth feature reports that take
+// feature-latency-ms to answer (1 ms on USB). Bluetooth connects always read the report, since that
+// read switches the pad to full reports; with the cache it runs on the cache worker, so the Bluetooth
+// reconnect must not wait for it.
+//
+//   test-reconnect-soak [cycles] [seed] [feature-latency-ms] [nocache]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GCore/Interfaces/IPlatformHardwareInfo.h"
+#include "Audio/HapticSource.h"
+#include "Input/CalibrationCache.h"
+#include "Platform_Simulated/test_simulated_hardware_policy.h"
+#include "Service/GamepadService.h"
+#include "Simulation/ProcessResources.h"
+#include "Simulation/SimulatedClock.h"
+#include "Simulation/SimulatedDualSense.h"
+#include "Testing/TestReport.h"
+#include "Timing/ServiceClock.h"
+
+using namespace GamepadCore;
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr auto kCaptureBlock = 10ms;
+    constexpr std::size_t kCaptureBlockFrames = 480;
+    constexpr auto kAttachPoll = 1ms;
+    constexpr auto kDetachPoll = 4ms;
+    constexpr auto kNoticeTimeout = 2s; // a plug or unplug the input loop has not seen by then is counted as missed
+
+    // Regression budgets
+    constexpr auto kReconnectP99Budget = 250ms; // one detection interval + calibration + first report + slack
+    constexpr std::int64_t kHeapGrowthBudget = 1 << 20;
+    constexpr std::int64_t kCalibrationMaxAgeSeconds = 600; // short enough for the soak to hit stale entries
+    constexpr auto kUsbFeatureLatency = 1ms;
+
+    std::int64_t ToNs(std::chrono::nanoseconds Duration) { return Duration.count(); }
+
+    /**
+     * Stands in for the WASAPI loopback: once started, a capture thread hands the service a 120 Hz
+     * tone every block, like the miniaudio callback does. Counts starts, which must happen once per run.
+     */
+    class FFakeCaptureDevice final : public IHapticCaptureDevice
+    {
+    public:
+        explicit FFakeCaptureDevice(FGamepadService& InService)
+            : Service(InService)
+        {
+        }
+
+        bool Initialize() override { return true; }
+        bool Start() override
+        {
+            Starts.fetch_add(1, std::memory_order_relaxed);
+            bStarted.store(true, std::memory_order_release);
+            return true;
+        }
+        void Shutdown() override { bStarted.store(false, std::memory_order_release); }
+
+        // The capture thread, until the service stops
+        void Run()
+        {
+            IServiceClock& Clock = IServiceClock::Get();
+            std::vector<float> Block(kCaptureBlockFrames * 2);
+            float Phase = 0.0f;
+            while (Service.IsRunning())
+            {
+                if (bStarted.load(std::memory_order_acquire))
+                {
+                    for (std::size_t i = 0; i < kCaptureBlockFrames; ++i)
+                    {
+                        Block[i * 2] = Block[i * 2 + 1] = 0.25f * std::sin(Phase);
+                        Phase = std::fmod(Phase + 2.0f * 3.14159265f * 120.0f / 48000.0f, 2.0f * 3.14159265f);
+                    }
+                    Service.OnCapture(Block.data(), kCaptureBlockFrames);
+                }
+                Clock.SleepFor(kCaptureBlock);
+            }
+        }
+
+        std::uint64_t GetStarts() const { return Starts.load(std::memory_order_relaxed); }
+
+    private:
+        FGamepadService& Service;
+        std::atomic<bool> bStarted{false};
+        std::atomic<std::uint64_t> Starts{0};
+    };
+
+    std::int64_t Percentile(std::vector<std::int64_t> Values, double P)
+    {
+        if (Values.empty())
+        {
+            return 0;
+        }
+        std::sort(Values.begin(), Values.end());
+        return Values[std::min(Values.size() - 1, static_cast<std::size_t>(Values.size() * P / 100.0))];
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t Cycles = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    const std::uint32_t Seed = argc > 2 ? static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    const auto FeatureLatency = std::chrono::milliseconds(argc > 3 ? std::strtol(argv[3], nullptr, 10) : 40);
+    const bool bUseCalibrationCache = !(argc > 4 && std::string(argv[4]) == "nocache");
+    FTestReport Test("Reconnect Soak", std::to_string(Cycles) + " cycles, seed " + std::to_string(Seed) + ", feature latency " +
+                                           std::to_string(FeatureLatency.count()) + " ms, calibration cache " + (bUseCalibrationCache ? "on" : "off"));
+
+    FSimulatedClock Clock;
+    IServiceClock::SetInstance(&Clock);
+
+    // Fresh on-disk cache per run, aged on the simulated clock
+    const std::filesystem::path CacheDirectory = std::filesystem::temp_directory_path() / "gamepad-soak-calibration";
+    std::error_code Error;
+    std::filesystem::remove_all(CacheDirectory, Error);
+    FCalibrationCache::Get().SetDirectory(CacheDirectory.string());
+    FCalibrationCache::Get().SetMaxAgeSeconds(kCalibrationMaxAgeSeconds);
+    FCalibrationCache::Get().SetTimeSource([] { return IServiceClock::Get().NowNs() / 1000000000; });
+
+    // One controller, unplugged until the first cycle; outputs are checked by the policy and dropped
+    FSimulatedBus& Bus = FSimulatedBus::Get();
+    Bus.bKeepOutputs = false;
+    Bus.bCalibrationCache = bUseCalibrationCache;
+    Bus.Devices.emplace_back("sim://dualsense/soak");
+    Bus.Devices.front().SetFeatureLatency(ESimulatedTransport::Bluetooth, ToNs(FeatureLatency));
+    Bus.Devices.front().SetFeatureLatency(ESimulatedTransport::Usb, ToNs(kUsbFeatureLatency));
+    Bus.Devices.front().Unplug();
+
+    IPlatformHardwareInfo::SetInstance(std::make_unique<Ftest_simulated_platform::Ftest_simulated_hardware>());
+    auto Registry = std::make_unique<FServiceDeviceRegistry>();
+    Registry->Policy.deviceId = 0;
+
+    // Configured like the mod: loopback source, arrival notifications (the driver plays the HID watcher)
+    FGamepadService Service;
+    Service.HapticSources.SetSource(std::make_unique<FLoopbackHapticSource>());
+    Service.SetArrivalNotifications(true);
+    FFakeCaptureDevice Capture(Service);
+    std::uint64_t TransportSwitches = 0;
+    std::uint64_t SentPackets = 0;
+
+    // Every thread, the driver included, joins the timeline before anyone sleeps
+    Service.Start();
+    std::latch Entered(4);
+    Clock.EnterThread();
+    std::thread InputThread([&] {
+        FServiceClockThreadScope ClockScope;
+        Entered.arrive_and_wait();
+        FInputLoop Loop(Service, *Registry, FGamepadServiceSettings{});
+        Loop.Run();
+    });
+    std::thread HapticsThread([&] {
+        FServiceClockThreadScope ClockScope;
+        Entered.arrive_and_wait();
+        FHapticsLoop Loop(Service, Capture);
+        Loop.Run();
+        TransportSwitches = Loop.GetTransportSwitches();
+        SentPackets = Loop.GetSentPackets();
+    });
+    std::thread CaptureThread([&] {
+        FServiceClockThreadScope ClockScope;
+        Entered.arrive_and_wait();
+        Capture.Run();
+    });
+    Entered.arrive_and_wait();
+
+    std::mt19937 Random(Seed);
+    std::uniform_int_distribution<int> DwellMs(300, 3000);
+    std::uniform_int_distribution<int> GapMs(20, 500);
+    std::bernoulli_distribution FlipTransport(0.5);
+
+    std::vector<std::int64_t> ReconnectLatencyNs;
+    std::vector<std::int64_t> BluetoothReconnectLatencyNs;
+    ReconnectLatencyNs.reserve(Cycles);
+    std::uint64_t MissedPlugs = 0;
+    std::uint64_t StuckOnBasicReports = 0;
+    std::uint64_t MissedUnplugs = 0;
+
+    const std::size_t WarmupCycles = std::max<std::size_t>(Cycles / 10, 1);
+    FProcessResources Baseline;
+    FProcessResources Peak;
+    ESimulatedTransport NextTransport = ESimulatedTransport::Usb;
+    const auto RealStart = std::chrono::steady_clock::now();
+
+    for (std::size_t Cycle = 0; Cycle < Cycles; ++Cycle)
+    {
+        if (FlipTransport(Random))
+        {
+            NextTransport = NextTransport == ESimulatedTransport::Usb ? ESimulatedTransport::Bluetooth : ESimulatedTransport::Usb;
+        }
+
+        // Plug, then wait for the input loop to attach and publish a report from this connection
+        const std::uint64_t PublishedBefore = Service.InputState.GetPublishCount();
+        const std::int64_t PluggedAtNs = Clock.NowNs();
+        {
+            std::lock_guard<std::mutex> Lock(Bus.Mutex);
+            Bus.Devices.front().Plug(NextTransport);
+        }
+        Service.GetDeviceArrival().Notify();
+        while (!(Service.GetAttachedGamepad() && Service.InputState.GetPublishCount() > PublishedBefore) && Clock.NowNs() - PluggedAtNs < ToNs(kNoticeTimeout))
+        {
+            Clock.SleepFor(kAttachPoll);
+        }
+        if (Service.GetAttachedGamepad())
+        {
+            ReconnectLatencyNs.push_back(Clock.NowNs() - PluggedAtNs);
+            if (NextTransport == ESimulatedTransport::Bluetooth)
+            {
+                BluetoothReconnectLatencyNs.push_back(ReconnectLatencyNs.back());
+            }
+        }
+        else
+        {
+            ++MissedPlugs;
+        }
+
+        Clock.SleepFor(std::chrono::milliseconds(DwellMs(Random)));
+        if (Cycle % 8 == 0)
+        {
+            Service.RumbleBridge.GetMailbox().Post(static_cast<std::uint8_t>(Cycle), 0x40);
+        }
+
+        // Unplug; on USB nothing reads, so it shows up at the next settings resend
+        const std::int64_t UnpluggedAtNs = Clock.NowNs();
+        {
+            std::lock_guard<std::mutex> Lock(Bus.Mutex);
+            StuckOnBasicReports += Bus.Devices.front().IsSendingFullReports() ? 0 : 1;
+            Bus.Devices.front().Unplug();
+        }
+        while (Service.GetAttachedGamepad() && Clock.NowNs() - UnpluggedAtNs < ToNs(kNoticeTimeout))
+        {
+            Clock.SleepFor(kDetachPoll);
+        }
+        MissedUnplugs += Service.GetAttachedGamepad() ? 1 : 0;
+        Clock.SleepFor(std::chrono::milliseconds(GapMs(Random)));
+
+        if (Cycle + 1 == WarmupCycles)
+        {
+            Baseline = FProcessResources::Sample();
+            Peak = Baseline;
+        }
+        else if (Cycle + 1 > WarmupCycles && Cycle % 64 == 0)
+        {
+            const FProcessResources Now = FProcessResources::Sample();
+            Peak.HandleCount = std::max(Peak.HandleCount, Now.HandleCount);
+            Peak.HeapBytes = std::max(Peak.HeapBytes, Now.HeapBytes);
+            Peak.ThreadCount = std::max(Peak.ThreadCount, Now.ThreadCount);
+        }
+    }
+
+    const FProcessResources End = FProcessResources::Sample();
+    std::size_t OpenHandles = 0;
+    {
+        std::lock_guard<std::mutex> Lock(Bus.Mutex);
+        OpenHandles = Bus.OpenHandles;
+    }
+
+    // The driver leaves the timeline after stopping the service, so the sleeping loops wake up to exit
+    Service.Stop();
+    Clock.LeaveThread();
+    InputThread.join();
+    HapticsThread.join();
+    CaptureThread.join();
+    Registry.reset();
+    IPlatformHardwareInfo::SetInstance(nullptr);
+    FCalibrationCache::Get().Shutdown();
+    IServiceClock::SetInstance(nullptr);
+    std::filesystem::remove_all(CacheDirectory, Error);
+
+    const double RealSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - RealStart).count();
+    std::cout << "[Soak] " << Clock.NowMs() / 1000.0 << " s simulated in " << RealSeconds << " s, " << Bus.Connects << " connects, " << TransportSwitches
+              << " encoder switches, " << SentPackets << " haptic sends (" << Bus.AudioHapticPackets.load() << " audio packets), "
+              << Service.RumbleBridge.GetLatency().GetCount() << " rumble requests staged." << std::endl;
+    std::cout << "[Soak] Reconnect to first report: p50 " << Percentile(ReconnectLatencyNs, 50.0) / 1e6 << " ms, p99 " << Percentile(ReconnectLatencyNs, 99.0) / 1e6
+              << " ms, max " << Percentile(ReconnectLatencyNs, 100.0) / 1e6 << " ms; " << Bus.Devices.front().GetFeatureReadCount() << " feature reads, cache "
+              << FCalibrationCache::Get().GetHitCount() << " hits / " << FCalibrationCache::Get().GetMissCount() << " misses" << std::endl;
+    std::cout << "[Soak] Bluetooth reconnect: p50 " << Percentile(BluetoothReconnectLatencyNs, 50.0) / 1e6 << " ms, p99 " << Percentile(BluetoothReconnectLatencyNs, 99.0) / 1e6
+              << " ms over " << BluetoothReconnectLatencyNs.size() << " connects (feature read " << FeatureLatency.count() << " ms); " << Bus.BasicReports
+              << " basic reports before the switch" << std::endl;
+    std::cout << "[Soak] Handles " << Baseline.HandleCount << " -> " << End.HandleCount << " (peak " << Peak.HandleCount << "), threads " << Baseline.ThreadCount
+              << " -> " << End.ThreadCount << ", heap " << Baseline.HeapBytes << " -> " << End.HeapBytes << " bytes (peak " << Peak.HeapBytes << ")" << std::endl;
+
+    Test.Expect(MissedPlugs == 0, "a plug was not attached by the input loop in time");
+    Test.Expect(MissedUnplugs == 0, "an unplug was not noticed by the input loop in time");
+    Test.Expect(Bus.Connects == Cycles, "a plug was missed or connected twice");
+    Test.Expect(OpenHandles == 0, "transport handles leaked");
+    Test.Expect(Bus.InvalidOutputs == 0, "invalid output report (report ID or BT CRC)");
+    Test.Expect(Bus.CalibrationFailures == 0, "a connect ended without valid calibration");
+    Test.Expect(StuckOnBasicReports == 0, "a Bluetooth connection stayed on basic input reports");
+    Test.Expect(Bus.RefreshReadersMade.load() == Bus.RefreshReadersRun.load(), "a calibration reader was made and never run (leaked handle)");
+    Test.Expect(!bUseCalibrationCache || FCalibrationCache::Get().GetMissCount() <= 1, "calibration cache missed after the first connect");
+    Test.Expect(!bUseCalibrationCache || FeatureLatency.count() == 0 || Percentile(BluetoothReconnectLatencyNs, 99.0) < ToNs(FeatureLatency),
+                "Bluetooth reconnect still waits for the calibration read");
+    Test.Expect(Capture.GetStarts() == 1, "capture device not started, or restarted on a reconnect");
+    Test.Expect(Percentile(ReconnectLatencyNs, 99.0) <= ToNs(kReconnectP99Budget), "reconnect p99 over budget");
+    Test.Expect(End.HandleCount <= Baseline.HandleCount, "process handle count grew");
+    Test.Expect(End.ThreadCount <= Baseline.ThreadCount, "thread count grew");
+    Test.Expect(End.HeapBytes < 0 || End.HeapBytes - Baseline.HeapBytes <= kHeapGrowthBudget, "heap grew over budget");
+
+    return Test.Finish();
+}
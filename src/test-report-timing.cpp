@@ -0,0 +1,217 @@
+// Report timing test: FReportClockEstimator against synthetic input report streams whose device
+// clock skew, transport latency, jitter and drops are known. Also compares fixed 1 ms USB polling
+// with phase-aligned polling on the same stream. Portable and deterministic (fixed seeds).
+//
+//   test-report-timing [seed]
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Diagnostics/ReportTiming.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr double kTicksPerNs = 3.0 / 1000.0;
+
+    /**
+     * One report as the controller emits it and as the host sees it arrive (before any polling).
+     */
+    struct FSyntheticReport
+    {
+        std::uint32_t Ticks;
+        std::uint8_t Sequence;
+        std::int64_t ArrivalNs;
+        std::int64_t ExcessNs; // latency above the stream's minimum
+        bool bDropped;
+    };
+
+    struct FStreamConfig
+    {
+        double PeriodNs;
+        double SkewPpm;      // device clock runs this much fast
+        double BaseLatencyNs;
+        double JitterMeanNs; // exponential latency above the base
+        double DropRate;
+        double Seconds;
+    };
+
+    std::vector<FSyntheticReport> MakeStream(const FStreamConfig& Config, std::uint32_t Seed)
+    {
+        std::mt19937 Rng(Seed);
+        std::exponential_distribution<double> Jitter(1.0 / Config.JitterMeanNs);
+        std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+
+        const std::size_t Count = static_cast<std::size_t>(Config.Seconds * 1e9 / Config.PeriodNs);
+        std::vector<FSyntheticReport> Stream(Count);
+        std::uint32_t StartTicks = 0xFFF00000u; // wraps a few seconds in
+        double MinExtra = 1e18;
+        std::vector<double> Extra(Count);
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            const double DeviceNs = static_cast<double>(i) * Config.PeriodNs;
+            const double HostEmitNs = DeviceNs / (1.0 + Config.SkewPpm * 1e-6);
+            Extra[i] = Jitter(Rng);
+            MinExtra = std::min(MinExtra, Extra[i]);
+
+            FSyntheticReport& Report = Stream[i];
+            Report.Ticks = StartTicks + static_cast<std::uint32_t>(std::llround(DeviceNs * kTicksPerNs));
+            Report.Sequence = static_cast<std::uint8_t>(i);
+            Report.ArrivalNs = 1000000000 + static_cast<std::int64_t>(HostEmitNs + Config.BaseLatencyNs + Extra[i]);
+            Report.bDropped = Uniform(Rng) < Config.DropRate;
+        }
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            Stream[i].ExcessNs = static_cast<std::int64_t>(Extra[i] - MinExtra);
+        }
+        return Stream;
+    }
+
+    struct FPollResult
+    {
+        std::size_t Polls = 0;
+        double MeanStalenessUs = 0.0; // poll time - arrival of the report it picked up
+        std::uint64_t Overwritten = 0;
+    };
+
+    /**
+     * USB-style consumer: the device keeps only its latest report, the host polls. With bAligned the
+     * next poll comes from the estimator, otherwise every PollNs.
+     */
+    FPollResult Poll(const std::vector<FSyntheticReport>& Stream, std::int64_t PollNs, bool bAligned, FReportClockEstimator& Estimator)
+    {
+        FPollResult Result;
+        Estimator.SetPolled(true);
+        double StalenessSum = 0.0;
+        std::size_t Picked = 0;
+        std::size_t Next = 0;
+        std::int64_t Now = Stream.front().ArrivalNs;
+        while (Next < Stream.size())
+        {
+            // Latest report that has arrived by now
+            std::size_t Latest = Next;
+            while (Latest + 1 < Stream.size() && Stream[Latest + 1].ArrivalNs <= Now)
+            {
+                ++Latest;
+            }
+            if (Stream[Latest].ArrivalNs <= Now)
+            {
+                Result.Overwritten += Latest - Next;
+                if (Estimator.OnReport(Stream[Latest].Ticks, Stream[Latest].Sequence, Now))
+                {
+                    StalenessSum += static_cast<double>(Now - Stream[Latest].ArrivalNs);
+                    ++Picked;
+                }
+                Next = Latest + 1;
+            }
+            else
+            {
+                // Nothing new: the previous report is read again
+                const FSyntheticReport& Previous = Stream[Next == 0 ? 0 : Next - 1];
+                Estimator.OnReport(Previous.Ticks, Previous.Sequence, Now);
+            }
+
+            ++Result.Polls;
+            Now = bAligned ? Estimator.GetNextPollNs(Now, PollNs) : Now + PollNs;
+        }
+        Result.MeanStalenessUs = StalenessSum / static_cast<double>(Picked) / 1000.0;
+        return Result;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::uint32_t Seed = argc > 1 ? static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    FTestReport Test("Report Timing", "seed " + std::to_string(Seed));
+
+    // 1. Bluetooth-like stream read as it arrives: 250 Hz, +80 ppm, 400 us mean jitter, 1% loss
+    {
+        const FStreamConfig Config{4000000.0, 80.0, 2500000.0, 400000.0, 0.01, 120.0};
+        const std::vector<FSyntheticReport> Stream = MakeStream(Config, Seed);
+
+        FReportClockEstimator Estimator;
+        std::uint64_t Dropped = 0;
+        double LatencyErrorSum = 0.0;
+        double JitterSum = 0.0;
+        std::size_t LatencySamples = 0;
+        for (const FSyntheticReport& Report : Stream)
+        {
+            if (Report.bDropped)
+            {
+                ++Dropped;
+                continue;
+            }
+            Estimator.OnReport(Report.Ticks, Report.Sequence, Report.ArrivalNs);
+            if (Estimator.IsLocked())
+            {
+                LatencyErrorSum += std::fabs(Estimator.GetLastLatencyNs() - static_cast<double>(Report.ExcessNs));
+                JitterSum += static_cast<double>(Estimator.GetMetrics().JitterNs);
+                ++LatencySamples;
+            }
+        }
+
+        const FReportTimingMetrics& Metrics = Estimator.GetMetrics();
+        const double LatencyErrorUs = LatencyErrorSum / static_cast<double>(LatencySamples) / 1000.0;
+        // For i.i.d. exponential latency, E|L(i) - L(i-1)| equals the mean. The 1/16 estimator is noisy
+        // on its own, so its average over the run is checked.
+        const double MeanJitterNs = JitterSum / static_cast<double>(LatencySamples);
+        const double JitterErrorPercent = 100.0 * std::fabs(MeanJitterNs - Config.JitterMeanNs) / Config.JitterMeanNs;
+        std::cout << "[Timing] BT stream: " << Metrics.Reports << " reports, " << Metrics.DroppedReports << " dropped (" << Dropped
+                  << " injected), period " << Metrics.ReportPeriodNs / 1e6 << " ms" << std::endl;
+        std::cout << "[Timing] Skew " << Metrics.ClockSkewPpm << " ppm (true " << Config.SkewPpm
+                  << "), mean jitter " << MeanJitterNs / 1000.0 << " us (" << JitterErrorPercent << "% off), per-report latency error "
+                  << LatencyErrorUs << " us, p99 < " << Metrics.LatencyP99Us << " us" << std::endl;
+
+        Test.Expect(Metrics.DroppedReports == Dropped, "dropped reports miscounted");
+        Test.Expect(std::fabs(Metrics.ClockSkewPpm - Config.SkewPpm) < 5.0, "clock skew estimate off by more than 5 ppm");
+        Test.Expect(std::fabs(static_cast<double>(Metrics.ReportPeriodNs) - Config.PeriodNs) < 2000.0, "report period estimate off");
+        Test.Expect(JitterErrorPercent < 10.0, "jitter estimate off by more than 10%");
+        Test.Expect(LatencyErrorUs < 50.0, "per-report latency above the floor off by more than 50 us on average");
+    }
+
+    // 2. Long outage: the sequence wraps, drops must come from the timestamps
+    {
+        const FStreamConfig Config{4000000.0, 0.0, 2000000.0, 100000.0, 0.0, 20.0};
+        const std::vector<FSyntheticReport> Stream = MakeStream(Config, Seed + 1);
+        FReportClockEstimator Estimator;
+        const std::size_t GapBegin = Stream.size() / 2;
+        const std::size_t GapLength = 1000; // 4 s, sequence wraps almost four times
+        for (std::size_t i = 0; i < Stream.size(); ++i)
+        {
+            if (i < GapBegin || i >= GapBegin + GapLength)
+            {
+                Estimator.OnReport(Stream[i].Ticks, Stream[i].Sequence, Stream[i].ArrivalNs);
+            }
+        }
+        std::cout << "[Timing] Outage: " << Estimator.GetMetrics().DroppedReports << " dropped (" << GapLength << " injected)" << std::endl;
+        Test.Expect(Estimator.GetMetrics().DroppedReports == GapLength, "long outage miscounted");
+    }
+
+    // 3. USB-like 1 kHz stream: fixed 1 ms polling vs phase-aligned polling
+    {
+        const FStreamConfig Config{1000000.0, -35.0, 1000000.0, 30000.0, 0.0, 30.0};
+        const std::vector<FSyntheticReport> Stream = MakeStream(Config, Seed + 2);
+
+        FReportClockEstimator FixedEstimator;
+        FReportClockEstimator AlignedEstimator;
+        const FPollResult Fixed = Poll(Stream, 1000000, false, FixedEstimator);
+        const FPollResult Aligned = Poll(Stream, 1000000, true, AlignedEstimator);
+        std::cout << "[Timing] USB fixed poll: " << Fixed.Polls << " polls, staleness " << Fixed.MeanStalenessUs << " us, "
+                  << Fixed.Overwritten << " overwritten, " << FixedEstimator.GetMetrics().DuplicateReads << " duplicate reads" << std::endl;
+        std::cout << "[Timing] USB aligned poll: " << Aligned.Polls << " polls, staleness " << Aligned.MeanStalenessUs << " us, "
+                  << Aligned.Overwritten << " overwritten, " << AlignedEstimator.GetMetrics().DuplicateReads << " duplicate reads" << std::endl;
+
+        Test.Expect(FixedEstimator.GetMetrics().DroppedReports == Fixed.Overwritten, "overwritten reports not counted as drops");
+        Test.Expect(Aligned.MeanStalenessUs < Fixed.MeanStalenessUs / 2.0, "phase-aligned polling does not halve the report staleness");
+        // Aligned polling retries about a quarter of the reports on purpose (that is what keeps the floor fed)
+        Test.Expect(Aligned.Polls <= Fixed.Polls * 16 / 10, "phase-aligned polling polls much more often");
+    }
+
+    return Test.Finish();
+}
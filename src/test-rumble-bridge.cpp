@@ -0,0 +1,184 @@
+// Rumble bridge test: a fake notification source thread posts game rumble the way the ViGEm callback
+// thread does, a haptics thread picks it up every tick, and a third thread stops the motors the way a
+// backend shutdown does. Checks the latest request always wins, that a stop never overrides a later
+// post, that the waveform staged through the haptic event synth and the mixer follows the motors,
+// then prints the post-to-pickup latency.
+//
+//   test-rumble-bridge [posts] [tick-us]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "Audio/HapticEvents.h"
+#include "Audio/HapticMixer.h"
+#include "Audio/HapticStream.h"
+#include "Audio/HapticSynth.h"
+#include "Audio/RumbleBridge.h"
+#include "Testing/TestReport.h"
+#include "Timing/ServiceClock.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::uint64_t kDefaultPosts = 20000;
+    constexpr std::int64_t kDefaultTickUs = 1000;
+
+    float PeakOf(FHapticEncoder& Encoder, std::size_t Frames, std::size_t Channel)
+    {
+        const float* Samples = Encoder.GetNewestFrames(Frames);
+        float Peak = 0.0f;
+        for (std::size_t i = 0; i < Frames; ++i)
+        {
+            Peak = std::max(Peak, std::fabs(Samples[i * 2 + Channel]));
+        }
+        return Peak;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::uint64_t Posts = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultPosts;
+    const std::int64_t TickUs = argc > 2 ? std::strtoll(argv[2], nullptr, 10) : kDefaultTickUs;
+    FTestReport Test("Rumble Bridge", std::to_string(Posts) + " posts, " + std::to_string(TickUs) + " us ticks");
+
+    // 1. Stop vs post ordering, single-threaded
+    {
+        FRumbleBridge Bridge;
+        FRumbleMailbox& Mailbox = Bridge.GetMailbox();
+
+        Mailbox.RequestStop();
+        Bridge.Update(1);
+        Test.Expect(Bridge.GetLastRequest().LargeMotor == 0 && Bridge.GetLastRequest().SmallMotor == 0, "stop before any post started the motors");
+
+        Mailbox.Post(200, 100, 2);
+        Bridge.Update(3);
+        Test.Expect(Bridge.GetLastRequest().LargeMotor == 200 && Bridge.GetLastRequest().SmallMotor == 100, "post after a stop was ignored");
+
+        Mailbox.RequestStop();
+        Bridge.Update(4);
+        Test.Expect(Bridge.GetLastRequest().LargeMotor == 0 && Bridge.GetLastRequest().SmallMotor == 0, "stop did not silence an earlier post");
+
+        Bridge.Update(5);
+        Test.Expect(Bridge.GetLastRequest().LargeMotor == 0, "stop picked up twice re-posted the old request");
+
+        // Stop and a later post seen in the same tick: the post wins
+        Mailbox.RequestStop();
+        Mailbox.Post(50, 60, 6);
+        Bridge.Update(7);
+        Test.Expect(Bridge.GetLastRequest().LargeMotor == 50 && Bridge.GetLastRequest().SmallMotor == 60, "stop overrode a request posted after it");
+        Test.Expect(Bridge.GetLatency().GetCount() == 2, "stops were recorded as posted requests");
+    }
+
+    // 2. Through the service's path (Update, FHapticEventSynth rumble bank, mixer): the staged waveform
+    //    follows the motors and ramps out after a stop
+    {
+        FRumbleBridge Bridge;
+        FHapticEventQueue Queue;
+        FHapticEventSynth Synth(Queue);
+        FSynthHapticSource Rumble(Synth.GetRumbleBank());
+        FHapticMixer Mixer;
+        Mixer.AddInput(&Rumble, {1.0f, 0, 1.0f, false});
+        FHapticEncoder Encoder;
+        const std::int64_t TickNs = 5000000; // 240 frames
+        std::int64_t NowNs = TickNs;
+        auto Tick = [&] {
+            Encoder.DiscardPending();
+            Bridge.Update(NowNs);
+            Synth.SetRumble(Bridge.GetLastRequest().LargeMotor, Bridge.GetLastRequest().SmallMotor);
+            Synth.Update(NowNs);
+            const std::size_t Staged = Mixer.Stage(Encoder, NowNs);
+            NowNs += TickNs;
+            return Staged;
+        };
+
+        Tick();
+        Bridge.GetMailbox().Post(255, 0, NowNs);
+        std::size_t Staged = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            Staged = Tick();
+        }
+        Test.Expect(Staged == 240, "rumble did not stage frames at the real-time rate while capture is idle");
+        Test.Expect(PeakOf(Encoder, Staged, 0) > 0.8f && PeakOf(Encoder, Staged, 1) == 0.0f, "large motor not on the left actuator alone");
+
+        Bridge.GetMailbox().RequestStop();
+        for (int i = 0; i < 4; ++i)
+        {
+            Tick();
+        }
+        Test.Expect(!Synth.GetRumbleBank().IsActive(), "waveform kept playing after a stop");
+        Test.Expect(Tick() == 0, "silence staged after the rumble stopped");
+    }
+
+    // 3. Threads: fake notification source, haptics consumer, shutdown stop
+    {
+        FRumbleBridge Bridge;
+        FRumbleMailbox& Mailbox = Bridge.GetMailbox();
+        IServiceClock& Clock = IServiceClock::Get();
+        std::atomic<bool> bRunning{true};
+        std::atomic<std::uint64_t> Mismatches{0};
+        std::atomic<std::uint16_t> SeenMotors{0}; // Large << 8 | Small as last picked up by the haptics thread
+        auto Seen = [&](std::uint8_t Large, std::uint8_t Small) { return SeenMotors.load(std::memory_order_acquire) == (Large << 8 | Small); };
+
+        std::thread Haptics([&] {
+            std::int64_t Deadline = Clock.NowNs();
+            while (bRunning.load(std::memory_order_acquire))
+            {
+                Deadline += TickUs * 1000;
+                Clock.SleepUntilNs(Deadline);
+                Bridge.Update(Clock.NowNs());
+
+                // Posts encode the motors as (n & 0xFF, ~n & 0xFF): a torn pick-up breaks the pair
+                const FRumbleState& Request = Bridge.GetLastRequest();
+                const bool bStopped = Request.LargeMotor == 0 && Request.SmallMotor == 0;
+                if (!bStopped && static_cast<std::uint8_t>(~Request.LargeMotor) != Request.SmallMotor)
+                {
+                    Mismatches.fetch_add(1, std::memory_order_relaxed);
+                }
+                SeenMotors.store(static_cast<std::uint16_t>(Request.LargeMotor << 8 | Request.SmallMotor), std::memory_order_release);
+            }
+        });
+
+        std::thread Notifications([&] {
+            std::mt19937 Random(35);
+            std::uniform_int_distribution<int> PauseUs(0, static_cast<int>(TickUs / 2));
+            for (std::uint64_t n = 1; n <= Posts; ++n)
+            {
+                const std::uint8_t Large = static_cast<std::uint8_t>(n | 1);
+                Mailbox.Post(Large, static_cast<std::uint8_t>(~Large));
+                if (n % 8 == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(PauseUs(Random)));
+                }
+            }
+        });
+
+        Notifications.join();
+        std::this_thread::sleep_for(std::chrono::microseconds(TickUs * 4));
+        const std::uint8_t LastLarge = static_cast<std::uint8_t>(Posts | 1);
+        Test.Expect(Seen(LastLarge, static_cast<std::uint8_t>(~LastLarge)), "latest request lost after the poster went quiet");
+
+        // Backend shutdown: the notification thread is gone, another thread stops the motors
+        std::thread Shutdown([&] { Mailbox.RequestStop(); });
+        Shutdown.join();
+        std::this_thread::sleep_for(std::chrono::microseconds(TickUs * 4));
+        Test.Expect(Seen(0, 0), "shutdown stop did not reach the haptics thread");
+
+        bRunning.store(false, std::memory_order_release);
+        Haptics.join();
+
+        Test.Expect(Mismatches.load() == 0, "haptics thread picked up a torn rumble request");
+        Test.Expect(Bridge.GetLatency().GetCount() > 0 && Bridge.GetLatency().GetCount() <= Posts, "post-to-pickup latency not recorded");
+        Bridge.GetLatency().Print("Rumble");
+    }
+
+    return Test.Finish();
+}
@@ -0,0 +1,245 @@
+// Service clock test: the haptics tick (16 ms, picking up rumble through FRumbleBridge and staging
+// it through the haptic event synth and the mixer) and the device detection wait (200 ms, posting a
+// rumble burst every 2 s) run as two threads on FSimulatedClock for one virtual hour. Checks every
+// wake lands exactly on its deadline, that iteration counts and the final time are identical on
+// every run, and that rumble posted by one loop is picked up by the other within a tick. Then checks
+// that FServiceWakeSignal notifications from a thread outside the timeline are never lost, on the
+// simulated and on the steady clock, and prints how long the virtual hour took.
+//
+//   test-service-clock [virtual minutes] [arrivals]
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <thread>
+
+#include "Audio/HapticEvents.h"
+#include "Audio/HapticMixer.h"
+#include "Audio/HapticStream.h"
+#include "Audio/HapticSynth.h"
+#include "Audio/RumbleBridge.h"
+#include "Simulation/SimulatedClock.h"
+#include "Testing/TestReport.h"
+#include "Timing/ServiceClock.h"
+
+using namespace GamepadCore;
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr double kDefaultMinutes = 60.0;
+    constexpr std::uint64_t kDefaultArrivals = 200;
+    constexpr std::int64_t kHapticsTickNs = std::chrono::nanoseconds(16ms).count();
+    constexpr std::int64_t kDetectionIntervalNs = std::chrono::nanoseconds(200ms).count();
+    constexpr std::uint64_t kRumbleEveryWakes = 10;
+    constexpr std::int64_t kArrivalWaitNs = std::chrono::nanoseconds(10min).count(); // a lost notify shows up as this wait running out
+
+    struct FTimelineResult
+    {
+        std::uint64_t HapticsTicks = 0;
+        std::uint64_t DetectionTicks = 0;
+        std::uint64_t OffDeadlineWakes = 0;
+        std::uint64_t RumblePickups = 0;
+        std::uint64_t MaxRumbleLatencyUs = 0;
+        std::int64_t FinalNs = 0;
+        double WallSeconds = 0.0;
+    };
+
+    /**
+     * The two service loops on a fresh simulated clock: the haptics thread stages rumble every tick,
+     * the detection thread wakes every interval and starts or stops a rumble burst, as a game would.
+     */
+    FTimelineResult RunTimeline(std::int64_t DurationNs)
+    {
+        FSimulatedClock Clock;
+        IServiceClock::SetInstance(&Clock);
+        FRumbleBridge Bridge;
+        FTimelineResult Result;
+        std::atomic<std::uint64_t> OffDeadline{0};
+        std::latch Entered(2); // both threads join the timeline before either sleeps
+
+        const auto WallStart = std::chrono::steady_clock::now();
+        std::thread Haptics([&] {
+            FServiceClockThreadScope ClockScope;
+            Entered.arrive_and_wait();
+            FHapticEventQueue Queue;
+            FHapticEventSynth Synth(Queue);
+            FSynthHapticSource Rumble(Synth.GetRumbleBank());
+            FHapticMixer Mixer;
+            Mixer.AddInput(&Rumble, {1.0f, 0, 1.0f, false});
+            FHapticEncoder Encoder;
+            for (std::int64_t Deadline = kHapticsTickNs; Deadline <= DurationNs; Deadline += kHapticsTickNs)
+            {
+                Clock.SleepUntilNs(Deadline);
+                OffDeadline.fetch_add(Clock.NowNs() != Deadline ? 1 : 0, std::memory_order_relaxed);
+                Bridge.Update(Clock.NowNs());
+                Synth.SetRumble(Bridge.GetLastRequest().LargeMotor, Bridge.GetLastRequest().SmallMotor);
+                Synth.Update(Clock.NowNs());
+                Mixer.Stage(Encoder, Clock.NowNs());
+                Encoder.DiscardPending();
+                ++Result.HapticsTicks;
+            }
+        });
+        std::thread Detection([&] {
+            FServiceClockThreadScope ClockScope;
+            Entered.arrive_and_wait();
+            for (std::int64_t Deadline = kDetectionIntervalNs; Deadline <= DurationNs; Deadline += kDetectionIntervalNs)
+            {
+                Clock.SleepUntilNs(Deadline);
+                OffDeadline.fetch_add(Clock.NowNs() != Deadline ? 1 : 0, std::memory_order_relaxed);
+                if (Result.DetectionTicks % kRumbleEveryWakes == 0)
+                {
+                    Bridge.GetMailbox().Post(200, 40);
+                }
+                else if (Result.DetectionTicks % kRumbleEveryWakes == 1)
+                {
+                    Bridge.GetMailbox().RequestStop();
+                }
+                ++Result.DetectionTicks;
+            }
+        });
+        Haptics.join();
+        Detection.join();
+
+        Result.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - WallStart).count();
+        Result.OffDeadlineWakes = OffDeadline.load();
+        Result.RumblePickups = Bridge.GetLatency().GetCount();
+        Result.MaxRumbleLatencyUs = Bridge.GetLatency().GetMaxUs();
+        Result.FinalNs = Clock.NowNs();
+        IServiceClock::SetInstance(nullptr);
+        return Result;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double Minutes = argc > 1 ? std::strtod(argv[1], nullptr) : kDefaultMinutes;
+    const std::uint64_t Arrivals = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : kDefaultArrivals;
+    FTestReport Test("Service Clock", std::to_string(Minutes) + " virtual minutes, " + std::to_string(Arrivals) + " arrivals");
+    const std::int64_t DurationNs = static_cast<std::int64_t>(Minutes * 60e9);
+
+    // 1. Two loops on the simulated clock: exact wakes, deterministic counts, cross-loop latency
+    {
+        const FTimelineResult First = RunTimeline(DurationNs);
+        const FTimelineResult Second = RunTimeline(DurationNs);
+
+        std::cout << "[Clock] " << Minutes << " virtual minutes in " << First.WallSeconds << " s / " << Second.WallSeconds << " s: " << First.HapticsTicks
+                  << " haptics ticks, " << First.DetectionTicks << " detection wakes, rumble staged within " << First.MaxRumbleLatencyUs << " us" << std::endl;
+        Test.Expect(First.HapticsTicks == static_cast<std::uint64_t>(DurationNs / kHapticsTickNs), "haptics loop missed ticks");
+        Test.Expect(First.DetectionTicks == static_cast<std::uint64_t>(DurationNs / kDetectionIntervalNs), "detection loop missed wakes");
+        Test.Expect(First.OffDeadlineWakes == 0 && Second.OffDeadlineWakes == 0, "a sleeper woke off its deadline");
+        Test.Expect(First.HapticsTicks == Second.HapticsTicks && First.DetectionTicks == Second.DetectionTicks && First.FinalNs == Second.FinalNs,
+                    "two runs of the same timeline diverged");
+        Test.Expect(First.FinalNs == DurationNs / kHapticsTickNs * kHapticsTickNs, "clock ran past the last deadline");
+        const std::uint64_t Posts = (First.DetectionTicks + kRumbleEveryWakes - 1) / kRumbleEveryWakes;
+        Test.Expect(First.RumblePickups == Posts && Second.RumblePickups == Posts, "rumble posts not picked up by the haptics loop");
+        Test.Expect(First.MaxRumbleLatencyUs <= kHapticsTickNs / 1000, "rumble waited more than one haptics tick");
+    }
+
+    // 2. Wake signal, single thread: a Notify() between reading the generation and sleeping is not lost
+    {
+        FSimulatedClock Clock;
+        IServiceClock::SetInstance(&Clock);
+        FServiceWakeSignal Signal;
+        const std::uint64_t Seen = Signal.GetGeneration();
+        Signal.Notify();
+        Test.Expect(Clock.SleepUntilNs(kDetectionIntervalNs, Signal, Seen) && Clock.NowNs() == 0, "notify before the sleep was lost or waited out");
+
+        // No participants: a plain sleep just moves the clock
+        const auto WallStart = std::chrono::steady_clock::now();
+        Clock.SleepFor(1h);
+        Test.Expect(Clock.NowNs() == std::chrono::nanoseconds(1h).count() && std::chrono::steady_clock::now() - WallStart < 1s, "lone sleep did not advance virtual time");
+        IServiceClock::SetInstance(nullptr);
+    }
+
+    // 3. Wake signal on the simulated clock: arrivals notified from a thread outside the timeline while
+    // the haptics loop keeps virtual time moving
+    {
+        FSimulatedClock Clock;
+        IServiceClock::SetInstance(&Clock);
+        FServiceWakeSignal Arrival;
+        std::atomic<std::uint64_t> Handled{0}, SignaledWakes{0}, DeadlineWakes{0}, LateWakes{0};
+        std::atomic<bool> bDone{false};
+        std::latch Entered(2);
+
+        std::thread Haptics([&] {
+            FServiceClockThreadScope ClockScope;
+            Entered.arrive_and_wait();
+            for (std::int64_t Deadline = kHapticsTickNs; !bDone.load(std::memory_order_acquire); Deadline += kHapticsTickNs)
+            {
+                Clock.SleepUntilNs(Deadline);
+            }
+        });
+        std::thread Detection([&] {
+            FServiceClockThreadScope ClockScope;
+            Entered.arrive_and_wait();
+            // The detection pattern: read the generation, handle what arrived, then sleep on it
+            while (Handled.load(std::memory_order_relaxed) < Arrivals)
+            {
+                const std::uint64_t Seen = Arrival.GetGeneration();
+                if (Seen != Handled.load(std::memory_order_relaxed))
+                {
+                    Handled.store(Seen, std::memory_order_release);
+                    continue;
+                }
+                const std::int64_t Deadline = Clock.NowNs() + kArrivalWaitNs;
+                if (Clock.SleepUntilNs(Deadline, Arrival, Seen))
+                {
+                    LateWakes.fetch_add(Clock.NowNs() > Deadline ? 1 : 0, std::memory_order_relaxed);
+                    SignaledWakes.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    DeadlineWakes.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            bDone.store(true, std::memory_order_release);
+        });
+        std::thread Callback([&] {
+            // OS device notification thread: never registers with the clock
+            for (std::uint64_t n = 0; n < Arrivals; ++n)
+            {
+                while (Handled.load(std::memory_order_acquire) < n)
+                {
+                    std::this_thread::yield();
+                }
+                Arrival.Notify();
+            }
+        });
+        Callback.join();
+        Detection.join();
+        Haptics.join();
+        IServiceClock::SetInstance(nullptr);
+
+        std::cout << "[Clock] " << Handled.load() << " arrivals handled over " << Clock.NowNs() / 1000000 << " virtual ms, " << SignaledWakes.load()
+                  << " of them woke the sleeping detection loop" << std::endl;
+        Test.Expect(Handled.load() == Arrivals && SignaledWakes.load() > 0, "arrivals not handled");
+        Test.Expect(DeadlineWakes.load() == 0, "arrival notification lost: the wait ran out");
+        Test.Expect(LateWakes.load() == 0, "virtual time moved past a woken sleeper's deadline");
+        Test.Expect(Arrival.GetGeneration() == Arrivals, "arrival generation miscounted");
+    }
+
+    // 4. The same wait on the steady clock: a notify ends the sleep early, the deadline ends it otherwise
+    {
+        IServiceClock& Clock = IServiceClock::Get();
+        FServiceWakeSignal Arrival;
+        const std::uint64_t Seen = Arrival.GetGeneration();
+        std::thread Callback([&] {
+            std::this_thread::sleep_for(10ms);
+            Arrival.Notify();
+        });
+        const auto WallStart = std::chrono::steady_clock::now();
+        const bool bSignaled = Clock.SleepUntilNs(Clock.NowNs() + std::chrono::nanoseconds(5s).count(), Arrival, Seen);
+        const auto Waited = std::chrono::steady_clock::now() - WallStart;
+        Callback.join();
+        Test.Expect(bSignaled && Waited < 2s, "steady clock slept through the notify");
+
+        const std::uint64_t After = Arrival.GetGeneration();
+        Test.Expect(!Clock.SleepUntilNs(Clock.NowNs() + std::chrono::nanoseconds(2ms).count(), Arrival, After), "steady clock reported a signal nobody sent");
+    }
+
+    return Test.Finish();
+}
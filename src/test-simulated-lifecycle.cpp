@@ -0,0 +1,187 @@
+// Device lifecycle test against simulated controllers: the same steps as test-device-initialization,
+// plus a disconnect and a reconnect over Bluetooth, with assertions on the output reports the
+// controller receives. The service's own input loop (FInputLoop) does the detection, settings and
+// reads one Tick() at a time under a virtual clock, so it needs no hardware and never sleeps.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "GCore/Interfaces/IPlatformHardwareInfo.h"
+#include "GCore/Templates/TGenericHardwareInfo.h"
+#include "GCore/Interfaces/ISonyGamepad.h"
+#include "Input/CalibrationCache.h"
+#include "Platform_Simulated/test_simulated_hardware_policy.h"
+#include "Service/GamepadService.h"
+#include "Simulation/ScenarioRunner.h"
+
+using namespace GamepadCore;
+using namespace std::chrono_literals;
+using TestHardwareInfo = Ftest_simulated_platform::Ftest_simulated_hardware;
+
+int main() {
+    std::cout << "--- Simulated DualSense Lifecycle Test ---" << std::endl;
+
+    FScenarioRunner Scenario;
+    FSimulatedBus& Bus = FSimulatedBus::Get();
+    Bus.Devices.emplace_back("sim://dualsense/0", ESimulatedTransport::Usb);
+    FSimulatedDualSense& Device = Bus.Devices.front();
+
+    IPlatformHardwareInfo::SetInstance(std::make_unique<TestHardwareInfo>());
+    auto Registry = std::make_unique<FServiceDeviceRegistry>();
+    Registry->Policy.deviceId = 0;
+
+    // No participants on the clock: every wait of the loop (1 ms USB poll, 4 ms Bluetooth report,
+    // 200 ms detection) advances virtual time by itself, and steps fire between ticks
+    FGamepadService Service;
+    Service.Start();
+    auto Loop = std::make_unique<FInputLoop>(Service, *Registry, FGamepadServiceSettings{});
+
+    constexpr std::int64_t kDetectionIntervalNs = 200 * 1000000LL;
+    constexpr std::int64_t kReportIntervalNs = 4 * 1000000LL;
+    std::int64_t AttachedAtNs = -1;
+    std::int64_t PluggedAtNs = 0;
+
+    auto Tick = [&](std::int64_t) {
+        Loop->Tick();
+        if (!Service.GetAttachedGamepad()) {
+            AttachedAtNs = -1;
+        } else if (AttachedAtNs < 0) {
+            AttachedAtNs = Scenario.NowNs();
+        }
+    };
+
+    auto LastOutput = [&]() -> const FRecordedOutput* {
+        return Device.GetOutputs().empty() ? nullptr : &Device.GetOutputs().back();
+    };
+
+    auto ExpectLightbar = [&](const DSCoreTypes::FDSColor& Color) {
+        const FRecordedOutput* Output = LastOutput();
+        if (!Scenario.Expect(Output != nullptr, "no output report written")) return;
+        Scenario.Expect(Output->bValidReportId, "output report has the wrong report ID");
+        Scenario.Expect(Output->bValidCrc, "Bluetooth output report CRC mismatch");
+        Scenario.Expect(Output->TimeNs == Scenario.NowNs(), "output report not written synchronously");
+        const std::array<std::uint8_t, 3> Lightbar = Output->GetLightbar();
+        Scenario.Expect(Lightbar[0] == Color.R && Lightbar[1] == Color.G && Lightbar[2] == Color.B, "lightbar bytes do not match the requested color");
+    };
+
+    const DSCoreTypes::FDSColor Config = {200, 160, 80}; // the service settings (Session: Skater)
+    std::uint64_t PublishedAtConnect = 0;
+    Scenario.At(0ms, "Search devices DualSense", [&] {
+        Registry->RequestImmediateDetection();
+    });
+
+    Scenario.At(300ms, "Connected via USB", [&] {
+        ISonyGamepad* Gamepad = Service.GetAttachedGamepad();
+        if (Scenario.Expect(Gamepad && Gamepad->IsConnected(), "controller not detected")) {
+            Scenario.Expect(Gamepad->GetConnectionType() == EDSDeviceConnection::Usb, "expected a USB connection");
+            Scenario.Expect(Service.InputState.GetPublishCount() > 0, "input loop published no input state");
+            const FRecordedOutput* Output = LastOutput();
+            Scenario.Expect(Output && Output->GetLightbar() == std::array<std::uint8_t, 3>{Config.R, Config.G, Config.B}, "service settings not written on connect");
+        }
+        PublishedAtConnect = Service.InputState.GetPublishCount();
+    });
+
+    const DSCoreTypes::FDSColor Colors[] = {
+        {255, 0, 0}, // Red
+        {0, 255, 0}, // Green
+        {0, 0, 255}, // Blue
+        Config
+    };
+    for (int i = 0; i < 4; ++i) {
+        Scenario.At(400ms + i * 2000ms, "Lightbar color " + std::to_string(i), [&, Color = Colors[i]] {
+            ISonyGamepad* Gamepad = Service.GetAttachedGamepad();
+            if (!Gamepad) return;
+            Gamepad->SetLightbar(Color);
+            Gamepad->UpdateOutput();
+            ExpectLightbar(Color);
+        });
+    }
+
+    Scenario.At(8500ms, "Player LED", [&] {
+        ISonyGamepad* Gamepad = Service.GetAttachedGamepad();
+        if (!Gamepad) return;
+        Scenario.Expect(Service.InputState.GetPublishCount() > PublishedAtConnect, "input loop stopped publishing");
+        Gamepad->SetPlayerLed(EDSPlayer::One, 255);
+        Gamepad->UpdateOutput();
+        const FRecordedOutput* Output = LastOutput();
+        Scenario.Expect(Output && Output->GetPlayerLeds() != 0, "player LED byte not set");
+    });
+
+    std::array<std::uint8_t, DualSenseOutputReport::TriggerEffectSize> Resistance{};
+    Scenario.At(9000ms, "Trigger resistance", [&] {
+        ISonyGamepad* Gamepad = Service.GetAttachedGamepad();
+        auto Trigger = Gamepad ? Gamepad->GetIGamepadTrigger() : nullptr;
+        if (!Scenario.Expect(Trigger != nullptr, "trigger interface not available")) return;
+        Trigger->SetResistance(0, 255, EDSGamepadHand::Left);
+        Trigger->SetResistance(0, 255, EDSGamepadHand::Right);
+        Gamepad->UpdateOutput();
+
+        const FRecordedOutput* Output = LastOutput();
+        if (!Scenario.Expect(Output != nullptr, "no output report written")) return;
+        const std::uint8_t* Left = Output->GetTriggerEffect(false);
+        const std::uint8_t* Right = Output->GetTriggerEffect(true);
+        if (!Scenario.Expect(Left && Right, "output report too short for trigger effects")) return;
+        Scenario.Expect(Left[0] != 0 && Right[0] != 0, "trigger effect mode not set");
+        std::copy(Right, Right + Resistance.size(), Resistance.begin());
+    });
+
+    Scenario.At(14000ms, "Clear trigger effects", [&] {
+        ISonyGamepad* Gamepad = Service.GetAttachedGamepad();
+        auto Trigger = Gamepad ? Gamepad->GetIGamepadTrigger() : nullptr;
+        if (!Trigger) return;
+        Trigger->StopTrigger(EDSGamepadHand::Left);
+        Trigger->StopTrigger(EDSGamepadHand::Right);
+        Gamepad->UpdateOutput();
+
+        const FRecordedOutput* Output = LastOutput();
+        const std::uint8_t* Right = Output ? Output->GetTriggerEffect(true) : nullptr;
+        if (!Scenario.Expect(Right != nullptr, "no output report with trigger effects written")) return;
+        Scenario.Expect(!std::equal(Resistance.begin(), Resistance.end(), Right), "trigger effect not cleared");
+    });
+
+    Scenario.At(14500ms, "Inject disconnect", [&] {
+        Device.Unplug();
+    });
+
+    // On USB nothing reads: the unplug shows up as a failed write at the next settings resend (400 ms)
+    std::size_t OutputsAtDisconnect = 0;
+    Scenario.At(15000ms, "Disconnected", [&] {
+        Scenario.Expect(Service.GetAttachedGamepad() == nullptr, "disconnect not noticed within 500 ms");
+        OutputsAtDisconnect = Device.GetOutputs().size();
+    });
+
+    Scenario.At(15500ms, "Reconnect over Bluetooth", [&] {
+        Scenario.Expect(Device.GetOutputs().size() == OutputsAtDisconnect, "output written to an unplugged controller");
+        Device.Plug(ESimulatedTransport::Bluetooth);
+        PluggedAtNs = Scenario.NowNs();
+    });
+
+    Scenario.At(16000ms, "Connected via Bluetooth", [&] {
+        ISonyGamepad* Gamepad = Service.GetAttachedGamepad();
+        if (!Scenario.Expect(Gamepad && Gamepad->IsConnected(), "controller not re-detected within 500 ms")) return;
+        Scenario.Expect(Gamepad->GetConnectionType() == EDSDeviceConnection::Bluetooth, "expected a Bluetooth connection");
+        Scenario.Expect(AttachedAtNs >= PluggedAtNs && AttachedAtNs - PluggedAtNs <= kDetectionIntervalNs + kReportIntervalNs, "re-detection slower than one detection interval");
+        Scenario.Expect(Device.IsSendingFullReports(), "Bluetooth connection left on basic input reports");
+
+        Gamepad->SetLightbar(Config);
+        Gamepad->UpdateOutput();
+        ExpectLightbar(Config);
+        Scenario.Expect(LastOutput() && LastOutput()->Bytes.size() == DualSenseOutputReport::BtReportSize, "Bluetooth output report has the wrong length");
+    });
+
+    Scenario.Run(16500ms, 0us, Tick);
+
+    Scenario.Expect(Bus.InvalidOutputs == 0, "invalid output report (report ID or BT CRC)");
+    Scenario.Expect(Bus.CalibrationFailures == 0, "a connect ended without valid calibration");
+
+    Service.Stop();
+    Loop.reset();
+    Registry.reset();
+    FCalibrationCache::Get().Shutdown();
+    const int Result = Scenario.Report();
+    std::cout << "--- Test " << (Result == 0 ? "Completed" : "Failed") << " ---" << std::endl;
+    return Result;
+}
@@ -0,0 +1,235 @@
+// Stick response curve test: built-in profiles ship the identity and user curve settings parse,
+// then the compiled radius table against the reference EvaluateRadius() for a user curve and for
+// deadzone/anti-deadzone/exponent extremes, direction preservation, the two-stick SSE path against
+// the scalar one, then a benchmark of the table against evaluating the curve per report.
+//
+//   test-stick-curves [million sticks per benchmark]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Config/GameProfile.h"
+#include "Input/StickResponseCurve.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr double kDefaultMillionSticks = 20.0;
+    constexpr std::size_t kRadiusSteps = 20000;
+    constexpr float kCell = FStickResponseCurve::MaxRadius / static_cast<float>(FStickResponseCurve::TableSize - 1);
+    constexpr double kDirectionTolerance = 1e-5; // sine of the angle between input and output
+
+    struct FCurveCase
+    {
+        const char* Name;
+        FStickCurveConfig Config;
+        double Tolerance; // max output radius error away from the deadzone edges, stick units
+    };
+
+    // Reference: the curve evaluated per stick, with the parameter clamping Compile() applies
+    float ReferenceRadius(const FStickCurveConfig& Config, float Radius)
+    {
+        const float Inner = std::clamp(Config.InnerDeadzone, 0.0f, 0.99f);
+        const float Outer = std::clamp(Config.OuterDeadzone, Inner + 0.01f, FStickResponseCurve::MaxRadius);
+        const float Anti = std::clamp(Config.AntiDeadzone, 0.0f, 1.0f);
+        return FStickResponseCurve::EvaluateRadius(Radius, Inner, Outer, Anti, Config.Exponent);
+    }
+
+    void ApplyReference(const FStickCurveConfig& Config, float& X, float& Y)
+    {
+        const float Radius = std::sqrt(X * X + Y * Y);
+        const float Scale = Radius > 0.0f ? ReferenceRadius(Config, Radius) / Radius : 0.0f;
+        X *= Scale;
+        Y *= Scale;
+    }
+
+    std::vector<float> MakeSticks(std::size_t Count)
+    {
+        std::mt19937 Random(34);
+        std::uniform_real_distribution<float> Axis(-1.0f, 1.0f);
+        std::vector<float> Sticks(Count * 4);
+        for (float& Value : Sticks)
+        {
+            Value = Axis(Random);
+        }
+        return Sticks;
+    }
+
+    template<typename TFunc>
+    double MeasureMillionSticksPerSecond(std::size_t Sticks, TFunc&& Func)
+    {
+        const auto Start = std::chrono::steady_clock::now();
+        Func();
+        const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        return static_cast<double>(Sticks) / Seconds / 1e6;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double MillionSticks = argc > 1 ? std::strtod(argv[1], nullptr) : kDefaultMillionSticks;
+    FTestReport Test("Stick Curves");
+
+    // A user setting as it would come from DUALSENSE_MOD_LEFT_STICK / DUALSENSE_MOD_RIGHT_STICK
+    FGameProfile Profile = kGameProfiles[0];
+    const bool bLeftParsed = ParseStickCurve("0.05,0.97,0,1.4", Profile.LeftStick);
+    const bool bRightParsed = ParseStickCurve(" 0.05 , 0.97", Profile.RightStick);
+    const FCurveCase Cases[] = {
+        {"user left", Profile.LeftStick, 1e-4},
+        {"user right", Profile.RightStick, 1e-4},
+        {"anti-deadzone", {0.1f, 0.9f, 0.25f, 1.0f}, 1e-4},
+        {"anti-deadzone at origin", {0.0f, 1.0f, 0.15f, 1.0f}, 1e-4},
+        {"steep", {0.08f, 1.0f, 0.1f, 3.0f}, 1e-4},
+        {"concave", {0.05f, 0.95f, 0.0f, 0.6f}, 5e-3}, // pow(T, 0.6) is vertical at the inner edge
+    };
+
+    // 1. Profiles ship the identity, user curves parse, and the identity leaves the sticks bit-exact
+    {
+        bool bShippedIdentity = kDefaultGameProfile.LeftStick.IsIdentity() && kDefaultGameProfile.RightStick.IsIdentity();
+        for (const FGameProfile& Shipped : kGameProfiles)
+        {
+            bShippedIdentity = bShippedIdentity && Shipped.LeftStick.IsIdentity() && Shipped.RightStick.IsIdentity();
+        }
+        Test.Expect(bShippedIdentity, "a built-in game profile reshapes the sticks without the user asking");
+
+        Test.Expect(bLeftParsed && Profile.LeftStick.InnerDeadzone == 0.05f && Profile.LeftStick.OuterDeadzone == 0.97f && Profile.LeftStick.Exponent == 1.4f,
+                    "full curve setting not parsed");
+        Test.Expect(bRightParsed && Profile.RightStick.InnerDeadzone == 0.05f && Profile.RightStick.AntiDeadzone == 0.0f && Profile.RightStick.Exponent == 1.0f,
+                    "partial curve setting not parsed, or the missing fields not left at the identity");
+
+        std::size_t Accepted = 0;
+        for (const char* Bad : {"", "0.1,", "0.1;0.9", "0.1,0.9,0,1,5", "0.1,0.9,0,0", "0.1,0.9,0,-1", "nan", "inf,1", "deadzone"})
+        {
+            FStickCurveConfig Untouched;
+            Accepted += ParseStickCurve(Bad, Untouched) || !Untouched.IsIdentity() ? 1 : 0;
+        }
+        Test.Expect(Accepted == 0, "malformed curve setting accepted or partially applied");
+
+        const FStickResponseCurve Identity;
+        float LX = 0.3f, LY = -0.7f, RX = -0.01f, RY = 0.02f;
+        ApplyStickCurves(Identity, Identity, LX, LY, RX, RY);
+        Test.Expect(LX == 0.3f && LY == -0.7f && RX == -0.01f && RY == 0.02f, "identity curve changed the sticks");
+    }
+
+    // 2. Table vs reference over the whole radius range, every case
+    for (const FCurveCase& Case : Cases)
+    {
+        const FStickResponseCurve Curve(Case.Config);
+        const float Inner = std::clamp(Case.Config.InnerDeadzone, 0.0f, 0.99f);
+        const float Outer = std::clamp(Case.Config.OuterDeadzone, Inner + 0.01f, FStickResponseCurve::MaxRadius);
+
+        // The cell holding the outer deadzone edge interpolates across a kink: there the error is
+        // bounded by the curve's slope over one cell instead
+        const double EdgeTolerance = (1.0 - Case.Config.AntiDeadzone) * std::max(1.0f, Case.Config.Exponent) / (Outer - Inner) * kCell;
+        double MaxError = 0.0, MaxEdgeError = 0.0, MaxDirection = 0.0;
+        bool bDeadzoneLeaked = false;
+        for (std::size_t i = 0; i <= kRadiusSteps; ++i)
+        {
+            const float Radius = FStickResponseCurve::MaxRadius * static_cast<float>(i) / static_cast<float>(kRadiusSteps);
+            const float Angle = 6.28318530718f * static_cast<float>(i % 97) / 97.0f;
+            float X = Radius * std::cos(Angle), Y = Radius * std::sin(Angle);
+            const float InX = X, InY = Y;
+            Curve.Apply(X, Y);
+            const float OutRadius = std::sqrt(X * X + Y * Y);
+
+            if (Radius <= Inner)
+            {
+                bDeadzoneLeaked |= OutRadius != 0.0f && Radius + kCell <= Inner;
+                continue;
+            }
+            if (Radius - Inner <= kCell)
+            {
+                continue; // the jump to the anti-deadzone is spread over this cell
+            }
+            const double Error = std::fabs(OutRadius - ReferenceRadius(Case.Config, std::sqrt(InX * InX + InY * InY)));
+            double& Bucket = std::fabs(Radius - Outer) <= kCell ? MaxEdgeError : MaxError;
+            Bucket = std::max(Bucket, Error);
+            if (OutRadius > 1e-3f)
+            {
+                MaxDirection = std::max(MaxDirection, std::fabs(static_cast<double>(InX) * Y - static_cast<double>(InY) * X) / (Radius * OutRadius));
+            }
+        }
+
+        std::cout << "[Curves] " << Case.Name << ": max radius error " << MaxError << " (" << MaxEdgeError << " at the outer edge), max direction error "
+                  << MaxDirection << std::endl;
+        Test.Expect(MaxError <= Case.Tolerance, (std::string("table diverges from the reference curve: ") + Case.Name).c_str());
+        Test.Expect(MaxEdgeError <= EdgeTolerance, (std::string("table diverges from the reference curve at the outer edge: ") + Case.Name).c_str());
+        Test.Expect(MaxDirection <= kDirectionTolerance, (std::string("curve changed the stick direction: ") + Case.Name).c_str());
+        Test.Expect(!bDeadzoneLeaked, (std::string("stick moved inside the inner deadzone: ") + Case.Name).c_str());
+
+        float X = 1.0f, Y = 1.0f;
+        Curve.Apply(X, Y);
+        Test.Expect(std::fabs(std::sqrt(X * X + Y * Y) - 1.0f) < 1e-4f, (std::string("square-gate corner not clamped to full scale: ") + Case.Name).c_str());
+    }
+
+    // 3. The two-stick SSE path matches the scalar path, with one or both sides shaped
+    {
+        const FStickResponseCurve Identity;
+        const FStickResponseCurve Shaped(Cases[2].Config);
+        const std::vector<float> Sticks = MakeSticks(10000);
+        double MaxDifference = 0.0;
+        for (std::size_t i = 0; i < Sticks.size(); i += 4)
+        {
+            for (const FStickResponseCurve* Right : {&Identity, &Shaped})
+            {
+                float LX = Sticks[i], LY = Sticks[i + 1], RX = Sticks[i + 2], RY = Sticks[i + 3];
+                ApplyStickCurves(Shaped, *Right, LX, LY, RX, RY);
+
+                float SLX = Sticks[i], SLY = Sticks[i + 1], SRX = Sticks[i + 2], SRY = Sticks[i + 3];
+                Shaped.Apply(SLX, SLY);
+                Right->Apply(SRX, SRY);
+                MaxDifference = std::max({MaxDifference, static_cast<double>(std::fabs(LX - SLX)), static_cast<double>(std::fabs(LY - SLY)),
+                                          static_cast<double>(std::fabs(RX - SRX)), static_cast<double>(std::fabs(RY - SRY))});
+            }
+        }
+        Test.Expect(MaxDifference <= 1e-6, "two-stick path diverges from the scalar curve");
+
+        float LX = 0.0f, LY = 0.0f, RX = 0.0f, RY = 0.0f;
+        ApplyStickCurves(Shaped, Shaped, LX, LY, RX, RY);
+        Test.Expect(LX == 0.0f && LY == 0.0f && RX == 0.0f && RY == 0.0f && !std::isnan(LX), "centered sticks not left at the origin");
+    }
+
+    // 4. Benchmark: compiled table (both sticks per call) vs evaluating the curve per stick
+    {
+        const std::size_t Reports = static_cast<std::size_t>(MillionSticks * 1e6 / 2.0);
+        const std::vector<float> Source = MakeSticks(std::min<std::size_t>(Reports, 1 << 16));
+        const std::size_t SourceReports = Source.size() / 4;
+        const FStickResponseCurve Left(Profile.LeftStick);
+        const FStickResponseCurve Right(Profile.RightStick);
+        double TableSum = 0.0, ReferenceSum = 0.0;
+
+        const double TableRate = MeasureMillionSticksPerSecond(Reports * 2, [&] {
+            for (std::size_t i = 0; i < Reports; ++i)
+            {
+                const float* In = &Source[(i % SourceReports) * 4];
+                float LX = In[0], LY = In[1], RX = In[2], RY = In[3];
+                ApplyStickCurves(Left, Right, LX, LY, RX, RY);
+                TableSum += LX + LY + RX + RY;
+            }
+        });
+        const double ReferenceRate = MeasureMillionSticksPerSecond(Reports * 2, [&] {
+            for (std::size_t i = 0; i < Reports; ++i)
+            {
+                const float* In = &Source[(i % SourceReports) * 4];
+                float LX = In[0], LY = In[1], RX = In[2], RY = In[3];
+                ApplyReference(Profile.LeftStick, LX, LY);
+                ApplyReference(Profile.RightStick, RX, RY);
+                ReferenceSum += LX + LY + RX + RY;
+            }
+        });
+
+        std::cout << "[Curves] " << Reports * 2 << " sticks: table " << TableRate << " M sticks/s, per-report pow() " << ReferenceRate
+                  << " M sticks/s (checksums " << TableSum << " / " << ReferenceSum << ")" << std::endl;
+        Test.Expect(std::fabs(TableSum - ReferenceSum) <= 1e-3 * static_cast<double>(Reports), "benchmark outputs diverge");
+    }
+
+    return Test.Finish();
+}
@@ -0,0 +1,225 @@
+// Telemetry channel test: the shared-memory SPSC ring between a game-side producer and the input
+// thread. The producer and the consumer map the channel separately, as two processes would. Checks
+// the layout round trip, full-ring behavior and header validation, then benchmarks raw throughput and
+// the push-to-drain latency of a 1 kHz producer against a 1 kHz polling consumer.
+//
+//   test-telemetry-channel [records]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Diagnostics/LatencyHistogram.h"
+#include "Telemetry/TelemetryChannel.h"
+#include "Testing/TestReport.h"
+#include "Timing/ServiceClock.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::size_t kDefaultRecords = 20000000;
+    constexpr auto kPacedPeriod = std::chrono::milliseconds(1);
+    constexpr int kPacedRecords = 2000;
+
+    // Unique per run, so parallel runs and stale objects from a crashed run do not collide
+    std::string MakeChannelName(const char* Suffix)
+    {
+#ifdef _WIN32
+        std::string Name = "Local\\DualSenseModTelemetryTest";
+#else
+        std::string Name = "/dualsense-mod-telemetry-test-";
+#endif
+        return Name + std::to_string(IServiceClock::Get().NowNs() % 1000000007) + Suffix;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t RecordCount = argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : kDefaultRecords;
+    FTestReport Test("Telemetry Channel");
+
+    // 1. Round trip between two mappings of the same channel, across the ring wrap
+    {
+        const std::string Name = MakeChannelName("-roundtrip");
+        FTelemetryChannel Service;
+        FTelemetryChannel Producer;
+        Test.Expect(!Producer.Open(Name), "opened a channel that does not exist yet");
+        Test.Expect(Service.Create(Name, 6), "channel creation failed");
+        Test.Expect(Service.GetCapacity() == 8, "capacity not rounded up to a power of two");
+        Test.Expect(Producer.Open(Name), "producer could not map the channel");
+
+        bool bIntact = true;
+        FTelemetryRecord Out[8];
+        for (int Round = 0; Round < 5; ++Round)
+        {
+            for (int i = 0; i < 5; ++i)
+            {
+                const float Values[4] = {static_cast<float>(Round), static_cast<float>(i), -1.5f, 0.25f};
+                Producer.Push(ETelemetryType::BoardState, Values, 4, Round * 10 + i);
+            }
+            const std::size_t Count = Service.Drain(Out, 8);
+            bIntact = bIntact && Count == 5;
+            for (std::size_t i = 0; i < Count; ++i)
+            {
+                bIntact = bIntact && Out[i].Type == static_cast<std::uint16_t>(ETelemetryType::BoardState) &&
+                          Out[i].Sequence == static_cast<std::uint32_t>(Round * 5 + i) && Out[i].TimestampNs == Round * 10 + static_cast<std::int64_t>(i) &&
+                          Out[i].Values[0] == static_cast<float>(Round) && Out[i].Values[1] == static_cast<float>(i) && Out[i].Values[3] == 0.25f;
+            }
+        }
+        Test.Expect(bIntact, "records corrupted or reordered between the two mappings");
+        Test.Expect(Service.Drain(Out, 8) == 0, "drained records from an empty ring");
+    }
+
+    // 2. A full ring refuses pushes, counts them, and keeps the oldest records
+    {
+        const std::string Name = MakeChannelName("-full");
+        FTelemetryChannel Service;
+        FTelemetryChannel Producer;
+        Service.Create(Name, 16);
+        Producer.Open(Name);
+        int Accepted = 0;
+        for (int i = 0; i < 26; ++i)
+        {
+            const float Strength = static_cast<float>(i);
+            Accepted += Producer.Push(ETelemetryType::Impact, &Strength, 1, i) ? 1 : 0;
+        }
+        FTelemetryRecord Out[32];
+        const std::size_t Count = Service.Drain(Out, 32);
+        Test.Expect(Accepted == 16 && Count == 16 && Service.GetDroppedCount() == 10, "full ring: expected 16 kept, 10 refused and counted");
+        Test.Expect(Count > 0 && Out[0].Values[0] == 0.0f && Out[Count - 1].Values[0] == 15.0f, "full ring: oldest records not kept");
+        const float Strength = 99.0f;
+        Test.Expect(Producer.Push(ETelemetryType::Impact, &Strength, 1, 0), "push refused after the consumer made room");
+    }
+
+    // 3. Header validation
+    {
+        alignas(64) static std::uint8_t Memory[FTelemetryChannel::HeaderSize + 64 * sizeof(FTelemetryRecord)];
+        FTelemetryChannel Channel;
+        Test.Expect(!Channel.Initialize(Memory, sizeof(Memory), 48), "accepted a capacity that is not a power of two");
+        Test.Expect(!Channel.Initialize(Memory, sizeof(Memory), 128), "accepted a capacity larger than the memory");
+        Test.Expect(Channel.Initialize(Memory, sizeof(Memory), 64), "in-memory channel initialization failed");
+
+        FTelemetryChannel Reader;
+        Test.Expect(Reader.Attach(Memory, sizeof(Memory)), "attach to a valid channel failed");
+        Test.Expect(!Reader.Attach(Memory, FTelemetryChannel::HeaderSize + 32 * sizeof(FTelemetryRecord)), "attached although the mapping is too small");
+        Memory[0] ^= 0xFF;
+        Test.Expect(!Reader.Attach(Memory, sizeof(Memory)), "attached to a channel with a bad magic");
+    }
+
+    // 4. Throughput: producer thread as fast as it can (retrying when full), consumer draining in batches
+    {
+        const std::string Name = MakeChannelName("-throughput");
+        FTelemetryChannel Service;
+        Service.Create(Name);
+        std::atomic<bool> bProducerReady{false};
+
+        std::thread ProducerThread([&] {
+            FTelemetryChannel Producer;
+            Producer.Open(Name);
+            bProducerReady.store(true, std::memory_order_release);
+            for (std::size_t i = 0; i < RecordCount; ++i)
+            {
+                const float Value = static_cast<float>(i & 0xFFFF);
+                FTelemetryRecord Record{};
+                Record.Type = static_cast<std::uint16_t>(ETelemetryType::Grind);
+                Record.Sequence = static_cast<std::uint32_t>(i);
+                Record.Values[0] = Value;
+                while (!Producer.Push(Record))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        while (!bProducerReady.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        const auto Start = std::chrono::steady_clock::now();
+        std::vector<FTelemetryRecord> Batch(256);
+        std::size_t Received = 0;
+        bool bInOrder = true;
+        while (Received < RecordCount)
+        {
+            const std::size_t Count = Service.Drain(Batch.data(), Batch.size());
+            for (std::size_t i = 0; i < Count; ++i)
+            {
+                bInOrder = bInOrder && Batch[i].Sequence == static_cast<std::uint32_t>(Received + i) &&
+                           Batch[i].Values[0] == static_cast<float>((Received + i) & 0xFFFF);
+            }
+            Received += Count;
+            if (Count == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        ProducerThread.join();
+
+        std::cout << "[Telemetry] Throughput: " << RecordCount << " records in " << Seconds * 1000.0 << " ms ("
+                  << static_cast<double>(RecordCount) / Seconds / 1e6 << " M records/s, " << Service.GetDroppedCount()
+                  << " refused pushes while full)" << std::endl;
+        Test.Expect(bInOrder, "records lost, duplicated or reordered under load");
+        Test.Expect(static_cast<double>(RecordCount) / Seconds > 1000.0 * 100.0, "ring cannot carry 100x the 1 kHz budget");
+    }
+
+    // 5. 1 kHz producer vs a consumer polling every 1 ms like the input thread, and vs a spinning one
+    for (const bool bSpin : {false, true})
+    {
+        const std::string Name = MakeChannelName(bSpin ? "-spin" : "-paced");
+        FTelemetryChannel Service;
+        Service.Create(Name);
+        std::atomic<bool> bDone{false};
+
+        std::thread ProducerThread([&] {
+            FTelemetryChannel Producer;
+            Producer.Open(Name);
+            auto Next = std::chrono::steady_clock::now();
+            for (int i = 0; i < kPacedRecords; ++i)
+            {
+                const float Values[4] = {0.1f, 0.2f, 5.0f, 0.5f};
+                Producer.Push(ETelemetryType::BoardState, Values, 4, IServiceClock::Get().NowNs());
+                Next += kPacedPeriod;
+                std::this_thread::sleep_until(Next);
+            }
+            bDone.store(true, std::memory_order_release);
+        });
+
+        FLatencyHistogram Latency;
+        FTelemetryRecord Batch[64];
+        int Received = 0;
+        for (;;)
+        {
+            const bool bFinished = bDone.load(std::memory_order_acquire);
+            const std::size_t Count = Service.Drain(Batch, 64);
+            const std::int64_t Now = IServiceClock::Get().NowNs();
+            for (std::size_t i = 0; i < Count; ++i)
+            {
+                Latency.Record((Now - Batch[i].TimestampNs) / 1000);
+            }
+            Received += static_cast<int>(Count);
+            if (bFinished && Count == 0)
+            {
+                break;
+            }
+            if (!bSpin)
+            {
+                std::this_thread::sleep_for(kPacedPeriod);
+            }
+        }
+        ProducerThread.join();
+
+        std::cout << "[Telemetry] 1 kHz producer, " << (bSpin ? "spinning" : "1 ms polling") << " consumer: " << Received << " records, p50 < "
+                  << Latency.GetPercentileUs(50.0) << " us, p99 < " << Latency.GetPercentileUs(99.0) << " us" << std::endl;
+        Test.Expect(Received == kPacedRecords && Service.GetDroppedCount() == 0, "paced records lost");
+    }
+
+    return Test.Finish();
+}
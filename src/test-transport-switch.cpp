@@ -0,0 +1,204 @@
+// Transport switch test: a fake loopback capture feeds the haptic ring in real time while a fake
+// transport flips the controller between USB and Bluetooth mid-stream, and a haptics thread encodes
+// for whichever transport is current, the way the audio loop does. Checks the capture is started once
+// and never stalls, that USB audio stays in order across switches, that every captured frame is
+// either sent or trimmed at a switch, and that a switch adds at most the bounded backlog of latency.
+//
+//   test-transport-switch [seconds] [flip-interval-ms]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Audio/HapticStream.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr double kDefaultSeconds = 3.0;
+    constexpr int kDefaultFlipMs = 150;
+    constexpr std::size_t kCaptureBlockFrames = 480; // 10 ms WASAPI period
+    constexpr auto kUsbTick = std::chrono::milliseconds(16);
+    constexpr auto kBtIdleWait = std::chrono::milliseconds(1);
+    constexpr std::uint32_t kLowBits = 14;
+
+    // Every frame carries its index: 14 bits per channel, exact through the USB int16 encoder
+    void EncodeFrameIndex(std::uint32_t Index, float* Frame)
+    {
+        Frame[0] = (static_cast<float>(Index & ((1u << kLowBits) - 1)) + 0.5f) / 32767.0f;
+        Frame[1] = (static_cast<float>((Index >> kLowBits) & ((1u << kLowBits) - 1)) + 0.5f) / 32767.0f;
+    }
+
+    std::uint32_t DecodeFrameIndex(const std::int16_t* Frame)
+    {
+        return static_cast<std::uint32_t>(Frame[0]) | static_cast<std::uint32_t>(Frame[1]) << kLowBits;
+    }
+
+    /**
+     * Loopback capture stand-in: one device started once, delivering 10 ms blocks at the real-time
+     * rate into the ring the way the WASAPI callback does.
+     */
+    class FFakeLoopbackCapture
+    {
+    public:
+        explicit FFakeLoopbackCapture(FHapticFrameRing& InRing)
+            : Ring(InRing)
+        {
+        }
+
+        void Start()
+        {
+            ++Starts;
+            Thread = std::thread([this] { Run(); });
+        }
+
+        void Stop()
+        {
+            bRunning.store(false, std::memory_order_release);
+            Thread.join();
+        }
+
+        std::uint32_t GetCaptured() const { return Captured.load(std::memory_order_acquire); }
+        std::uint64_t GetDropped() const { return Dropped; }
+        int GetStarts() const { return Starts; }
+
+    private:
+        void Run()
+        {
+            float Block[kCaptureBlockFrames * 2];
+            auto Next = std::chrono::steady_clock::now();
+            while (bRunning.load(std::memory_order_acquire))
+            {
+                const std::uint32_t First = Captured.load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < kCaptureBlockFrames; ++i)
+                {
+                    EncodeFrameIndex(First + static_cast<std::uint32_t>(i), Block + i * 2);
+                }
+                Dropped += kCaptureBlockFrames - Ring.Push(Block, kCaptureBlockFrames);
+                Captured.store(First + kCaptureBlockFrames, std::memory_order_release);
+
+                Next += std::chrono::microseconds(kCaptureBlockFrames * 1000000 / 48000);
+                std::this_thread::sleep_until(Next);
+            }
+        }
+
+        FHapticFrameRing& Ring;
+        std::thread Thread;
+        std::atomic<bool> bRunning{true};
+        std::atomic<std::uint32_t> Captured{0};
+        std::uint64_t Dropped = 0;
+        int Starts = 0;
+    };
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double Seconds = argc > 1 ? std::strtod(argv[1], nullptr) : kDefaultSeconds;
+    const int FlipMs = argc > 2 ? std::atoi(argv[2]) : kDefaultFlipMs;
+    FTestReport Test("Transport Switch", std::to_string(Seconds) + " s, flip every " + std::to_string(FlipMs) + " ms");
+
+    FHapticFrameRing Ring;
+    FHapticEncoder Encoder;
+    FFakeLoopbackCapture Capture(Ring);
+
+    // Fake transport: the connection type the controller reports, flipped by a "cable" thread
+    std::atomic<EHapticTransport> Connection{EHapticTransport::Usb};
+    std::atomic<bool> bRunning{true};
+
+    std::uint64_t UsbFrames = 0, BtPackets = 0, OrderViolations = 0, Switches = 0;
+    std::uint64_t MaxSwitchBacklogFrames = 0, BadBtPackets = 0, OversizedUsbBatches = 0;
+    std::uint32_t NextExpected = 0;
+    bool bMeasureBacklog = false;
+
+    Capture.Start();
+    std::thread Cable([&] {
+        const auto End = std::chrono::steady_clock::now() + std::chrono::duration<double>(Seconds);
+        while (std::chrono::steady_clock::now() < End)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(FlipMs));
+            const EHapticTransport Current = Connection.load(std::memory_order_relaxed);
+            Connection.store(Current == EHapticTransport::Usb ? EHapticTransport::Bluetooth : EHapticTransport::Usb, std::memory_order_release);
+        }
+        bRunning.store(false, std::memory_order_release);
+    });
+
+    while (bRunning.load(std::memory_order_acquire))
+    {
+        const EHapticTransport Transport = Connection.load(std::memory_order_acquire);
+        if (Encoder.SetTransport(Transport, Ring))
+        {
+            ++Switches;
+            bMeasureBacklog = true;
+        }
+
+        // Latency a switch adds: how far the oldest frame still buffered lags the capture right after it
+        Encoder.Pull(Ring);
+        if (bMeasureBacklog)
+        {
+            bMeasureBacklog = false;
+            const std::uint64_t Buffered = Encoder.GetPendingFrames() + Ring.Size();
+            MaxSwitchBacklogFrames = std::max(MaxSwitchBacklogFrames, Buffered);
+        }
+
+        const std::size_t Sent = Encoder.Flush(
+            [&](std::vector<std::int16_t>& Samples) {
+                const std::size_t Frames = Samples.size() / 2;
+                OversizedUsbBatches += Frames > FHapticEncoder::MaxUsbBatchFrames ? 1 : 0;
+                for (std::size_t i = 0; i < Frames; ++i)
+                {
+                    // Frames trimmed at a switch leave a gap, never a step back
+                    const std::uint32_t Index = DecodeFrameIndex(&Samples[i * 2]);
+                    OrderViolations += Index < NextExpected ? 1 : 0;
+                    NextExpected = Index + 1;
+                }
+                UsbFrames += Frames;
+            },
+            [&](std::vector<std::uint8_t>& Packet) {
+                BadBtPackets += Packet.size() != FHapticEncoder::BtPacketSize ? 1 : 0;
+                ++BtPackets;
+            });
+
+        if (Transport == EHapticTransport::Usb)
+        {
+            std::this_thread::sleep_for(kUsbTick);
+        }
+        else if (Sent == 0)
+        {
+            std::this_thread::sleep_for(kBtIdleWait);
+        }
+    }
+    Cable.join();
+    Capture.Stop();
+
+    // Frame accounting: each captured frame went out on USB, in a Bluetooth block, or was trimmed at a switch
+    const std::uint64_t Captured = Capture.GetCaptured();
+    const std::uint64_t BtFrames = BtPackets / 2 * FHapticEncoder::BtBlockFrames;
+    const std::uint64_t Remaining = Encoder.GetPendingFrames() + Ring.Size();
+    const std::uint64_t Accounted = UsbFrames + BtFrames + Remaining;
+    const std::uint64_t Trimmed = Captured >= Accounted ? Captured - Accounted : 0;
+    const double BacklogMs = static_cast<double>(MaxSwitchBacklogFrames) / 48.0;
+
+    std::cout << "[Switch] " << Switches << " switches, " << Captured << " frames captured: " << UsbFrames << " USB, " << BtFrames << " Bluetooth ("
+              << BtPackets << " packets), " << Trimmed << " trimmed at switches, " << Remaining << " still buffered" << std::endl;
+    std::cout << "[Switch] Max backlog right after a switch: " << MaxSwitchBacklogFrames << " frames (" << BacklogMs << " ms)" << std::endl;
+
+    Test.Expect(Capture.GetStarts() == 1, "capture restarted on a transport change");
+    Test.Expect(Capture.GetDropped() == 0, "capture stalled: the ring overflowed");
+    Test.Expect(Switches >= 4, "transport never switched mid-stream");
+    Test.Expect(UsbFrames > 0 && BtPackets > 0, "one of the encoders never sent");
+    Test.Expect(OrderViolations == 0, "USB audio went out of order across a switch");
+    Test.Expect(BadBtPackets == 0 && OversizedUsbBatches == 0, "payload sizes broken after a switch");
+    Test.Expect(Accounted <= Captured, "more frames sent than captured");
+    Test.Expect(Trimmed <= Switches * FHapticEncoder::MaxSwitchBacklogFrames, "frames lost outside transport switches");
+    // The backlog bound, plus what the capture delivered between the trim and the measurement
+    Test.Expect(MaxSwitchBacklogFrames <= FHapticEncoder::MaxSwitchBacklogFrames + 2 * kCaptureBlockFrames, "a switch added unbounded latency");
+
+    return Test.Finish();
+}
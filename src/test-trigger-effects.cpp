@@ -0,0 +1,245 @@
+// Trigger effect engine test: keyframe curves, bytecode programs and the write-on-change policy,
+// checked against a recording fake transport, plus a benchmark with hundreds of concurrent effects.
+// Portable and deterministic apart from the benchmark timings.
+//
+//   test-trigger-effects
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Output/TriggerEffects.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::int64_t kTickNs = 1000000; // 1 kHz input thread
+    constexpr std::size_t kBenchmarkEffects = 512;
+    constexpr std::size_t kBenchmarkTicks = 20000;
+
+    /**
+     * Fake transport: records every trigger write with the tick it happened on.
+     */
+    class FRecordingTriggerSink : public ITriggerEffectSink
+    {
+    public:
+        struct FWrite
+        {
+            std::int64_t TimeNs;
+            ETriggerSide Side;
+            FTriggerEffectBytes Bytes;
+        };
+
+        void WriteTrigger(ETriggerSide Side, const FTriggerEffectBytes& Bytes) override { Writes.push_back({NowNs, Side, Bytes}); }
+
+        std::size_t Count(ETriggerSide Side) const
+        {
+            return static_cast<std::size_t>(std::count_if(Writes.begin(), Writes.end(), [Side](const FWrite& W) { return W.Side == Side; }));
+        }
+
+        std::vector<FWrite> Writes;
+        std::int64_t NowNs = 0;
+    };
+
+    // Ticks the engine from FromNs up to (excluding) ToNs with fixed inputs
+    void Run(FTriggerEffectEngine& Engine, FRecordingTriggerSink& Sink, std::int64_t FromNs, std::int64_t ToNs, const FTriggerEffectInputs& Inputs = {})
+    {
+        for (std::int64_t Now = FromNs; Now < ToNs; Now += kTickNs)
+        {
+            Sink.NowNs = Now;
+            Engine.Tick(Now, Inputs, Sink);
+        }
+    }
+} // namespace
+
+int main()
+{
+    FTestReport Test("Trigger Effects");
+
+    // 1. A constant effect is written once, then only again after Invalidate()
+    {
+        FTriggerEffectEngine Engine;
+        FRecordingTriggerSink Sink;
+        Engine.Play(TriggerEffects::Constant(ETriggerSide::Right, 0.0f, 1.0f), 0);
+        Run(Engine, Sink, 0, 1000 * kTickNs);
+        Test.Expect(Sink.Writes.size() == 2, "constant effect: expected one write per trigger in 1000 ticks");
+        Test.Expect(Engine.GetLastBytes(ETriggerSide::Right).Level == FTriggerEffectBytes::MaxLevel, "constant effect: full strength not reached");
+        Test.Expect(Engine.GetLastBytes(ETriggerSide::Left).IsOff(), "constant effect: idle trigger not off");
+
+        Engine.Invalidate();
+        Run(Engine, Sink, 1000 * kTickNs, 1010 * kTickNs);
+        Test.Expect(Sink.Writes.size() == 4, "Invalidate() did not resend both triggers exactly once");
+    }
+
+    // 2. Ramp: one write per strength level, in order, near the level crossings
+    {
+        FTriggerEffectEngine Engine;
+        FRecordingTriggerSink Sink;
+        Engine.Play(TriggerEffects::Ramp(ETriggerSide::Right, 0.0f, 1.0f, 1.0f), 0);
+        Run(Engine, Sink, 0, 2000 * kTickNs);
+
+        std::vector<FRecordingTriggerSink::FWrite> Right;
+        for (const auto& W : Sink.Writes)
+        {
+            if (W.Side == ETriggerSide::Right)
+            {
+                Right.push_back(W);
+            }
+        }
+        Test.Expect(Right.size() == 1 + FTriggerEffectBytes::MaxLevel, "ramp: expected the off state plus one write per level");
+        bool bMonotonic = true;
+        double WorstTimingErrorMs = 0.0;
+        for (std::size_t i = 1; i < Right.size(); ++i)
+        {
+            bMonotonic = bMonotonic && Right[i].Bytes.Level == Right[i - 1].Bytes.Level + 1;
+            // Level L is taken once the ramp is Hysteresis past the midpoint between L - 1 and L
+            const double ExpectedMs = 1000.0 * (Right[i].Bytes.Level - 0.5 + FTriggerEffectEngine::Hysteresis) / FTriggerEffectBytes::MaxLevel;
+            WorstTimingErrorMs = std::max(WorstTimingErrorMs, std::fabs(static_cast<double>(Right[i].TimeNs) / 1e6 - ExpectedMs));
+        }
+        std::cout << "[Trigger] Ramp: " << Right.size() << " writes in 2000 ticks, worst level timing error " << WorstTimingErrorMs << " ms" << std::endl;
+        Test.Expect(bMonotonic, "ramp: levels not written in order");
+        Test.Expect(WorstTimingErrorMs <= 1.5, "ramp: level written more than a tick late");
+    }
+
+    // 3. Pulse: on/off writes only, stops after its duration
+    {
+        FTriggerEffectEngine Engine;
+        FRecordingTriggerSink Sink;
+        const FTriggerEffectHandle Handle = Engine.Play(TriggerEffects::Pulse(ETriggerSide::Left, 0.75f, 0.1f, 0.5f, 1.0f), 0);
+        Run(Engine, Sink, 0, 1500 * kTickNs);
+        const std::size_t LeftWrites = Sink.Count(ETriggerSide::Left);
+        std::cout << "[Trigger] Pulse: " << LeftWrites << " writes for 10 pulses" << std::endl;
+        Test.Expect(LeftWrites == 20, "pulse: expected one on and one off write per period");
+        Test.Expect(!Engine.IsPlaying(Handle) && Engine.GetActiveCount() == 0, "pulse: effect still playing after its duration");
+        Test.Expect(Engine.GetLastBytes(ETriggerSide::Left).IsOff(), "pulse: trigger left on");
+    }
+
+    // 4. Impact kick over a constant base: decays back onto the base, then expires
+    {
+        FTriggerEffectEngine Engine;
+        FRecordingTriggerSink Sink;
+        Engine.Play(TriggerEffects::Constant(ETriggerSide::Right, 0.3f, 0.25f), 0);
+        Run(Engine, Sink, 0, 100 * kTickNs);
+        const FTriggerEffectHandle Kick = Engine.Play(TriggerEffects::ImpactKick(ETriggerSide::Right, 1.0f, 0.05f), 100 * kTickNs);
+        Sink.NowNs = 100 * kTickNs;
+        Engine.Tick(Sink.NowNs, {}, Sink);
+        Test.Expect(Engine.GetLastBytes(ETriggerSide::Right).Level == FTriggerEffectBytes::MaxLevel, "kick: peak not written on the tick it started");
+        Test.Expect(Engine.GetLastBytes(ETriggerSide::Right).Zone == 0, "kick: start position of the strongest effect not used");
+        Run(Engine, Sink, 101 * kTickNs, 600 * kTickNs);
+        Test.Expect(!Engine.IsPlaying(Kick) && Engine.GetActiveCount() == 1, "kick: did not expire");
+        Test.Expect(Engine.GetLastBytes(ETriggerSide::Right).Level == 2 && Engine.GetLastBytes(ETriggerSide::Right).Zone == 3,
+               "kick: did not settle back onto the base effect");
+        Test.Expect(Sink.Count(ETriggerSide::Right) <= 2 + FTriggerEffectBytes::MaxLevel, "kick: more writes than levels crossed");
+    }
+
+    // 5. Inclination: follows the pitch, tilt noise on a level boundary does not toggle the trigger
+    {
+        FTriggerEffectEngine Engine;
+        FRecordingTriggerSink Sink;
+        Engine.Play(TriggerEffects::Inclination(ETriggerSide::Right, 0.0f, 1.0f), 0);
+
+        std::mt19937 Rng(7);
+        std::normal_distribution<float> Noise(0.0f, 0.005f);
+        const float Boundary = 3.5f / FTriggerEffectBytes::MaxLevel; // between levels 3 and 4
+        std::int64_t Now = 0;
+        for (int i = 0; i < 2000; ++i, Now += kTickNs)
+        {
+            Sink.NowNs = Now;
+            FTriggerEffectInputs Inputs;
+            Inputs.Pitch = Boundary + Noise(Rng);
+            Engine.Tick(Now, Inputs, Sink);
+        }
+        const std::size_t NoisyWrites = Sink.Count(ETriggerSide::Right);
+
+        FTriggerEffectInputs Tilted;
+        Tilted.Pitch = -0.9f; // either direction
+        Run(Engine, Sink, Now, Now + 10 * kTickNs, Tilted);
+        std::cout << "[Trigger] Inclination: " << NoisyWrites << " writes in 2000 noisy ticks on a level boundary" << std::endl;
+        Test.Expect(NoisyWrites <= 2, "inclination: boundary noise toggles the trigger");
+        Test.Expect(Engine.GetLastBytes(ETriggerSide::Right).Level == 7, "inclination: level does not follow the pitch");
+    }
+
+    // 6. Handles, capacity and malformed programs
+    {
+        FTriggerEffectEngine Engine(4);
+        FTriggerEffectHandle Handles[4];
+        for (FTriggerEffectHandle& Handle : Handles)
+        {
+            Handle = Engine.Play(TriggerEffects::Constant(ETriggerSide::Left, 0.0f, 0.5f), 0);
+        }
+        Test.Expect(!Engine.Play(TriggerEffects::Constant(ETriggerSide::Left, 0.0f, 0.5f), 0).IsValid(), "full engine accepted an effect");
+        Test.Expect(Engine.Stop(Handles[1]) && !Engine.Stop(Handles[1]), "stopping twice should fail the second time");
+        const FTriggerEffectHandle Reused = Engine.Play(TriggerEffects::Constant(ETriggerSide::Left, 0.0f, 0.5f), 0);
+        Test.Expect(Reused.IsValid() && Reused.Slot == Handles[1].Slot && !Engine.IsPlaying(Handles[1]), "stale handle controls a reused slot");
+        Engine.StopAll();
+        Test.Expect(Engine.GetActiveCount() == 0, "StopAll left effects playing");
+
+        FTriggerEffect Underflow;
+        Underflow.Program.Push(1.0f).Emit(ETriggerOp::Add);
+        FTriggerEffect Leftover;
+        Leftover.Program.Push(1.0f).Push(2.0f);
+        Test.Expect(!Engine.Play(Underflow, 0).IsValid() && !Engine.Play(Leftover, 0).IsValid(), "malformed programs accepted");
+    }
+
+    // 7. Curve cursor: incremental evaluation matches a fresh search, also across loop wraps
+    {
+        FTriggerCurve Curve;
+        Curve.Add(0.0f, 0.0f).Add(0.05f, 1.0f).Add(0.1f, 0.2f).Add(0.3f, 0.6f).Add(0.5f, 0.0f).Loop();
+        std::uint8_t Cursor = 0;
+        float WorstError = 0.0f;
+        for (int i = 0; i < 5000; ++i)
+        {
+            const float Time = static_cast<float>(i) * 0.00137f;
+            std::uint8_t Fresh = 0;
+            WorstError = std::max(WorstError, std::fabs(Curve.Evaluate(Time, Cursor) - Curve.Evaluate(Time, Fresh)));
+        }
+        Test.Expect(WorstError < 1e-6f, "curve cursor diverges from a fresh evaluation");
+    }
+
+    // 8. Benchmark: hundreds of concurrent effects of every kind on both triggers
+    {
+        FTriggerEffectEngine Engine(kBenchmarkEffects);
+        FRecordingTriggerSink Sink;
+        std::mt19937 Rng(11);
+        std::uniform_real_distribution<float> Uniform(0.0f, 1.0f);
+        for (std::size_t i = 0; i < kBenchmarkEffects; ++i)
+        {
+            const ETriggerSide Side = i % 2 ? ETriggerSide::Left : ETriggerSide::Right;
+            FTriggerEffect Effect;
+            switch (i % 5)
+            {
+                case 0: Effect = TriggerEffects::Ramp(Side, 0.0f, Uniform(Rng), 1.0f + 4.0f * Uniform(Rng)); break;
+                case 1: Effect = TriggerEffects::Pulse(Side, Uniform(Rng), 0.05f + 0.2f * Uniform(Rng), 0.5f); break;
+                case 2: Effect = TriggerEffects::ImpactKick(Side, Uniform(Rng), 10.0f); break;
+                case 3: Effect = TriggerEffects::Inclination(Side, 0.1f, Uniform(Rng)); break;
+                default: Effect.Side = Side; Effect.Envelope.Add(0.0f, 0.0f).Add(0.2f, Uniform(Rng)).Add(0.4f, 0.1f).Loop(); break;
+            }
+            Effect.StartPosition = Uniform(Rng);
+            Engine.Play(Effect, 0);
+        }
+
+        FTriggerEffectInputs Inputs;
+        const auto Start = std::chrono::steady_clock::now();
+        for (std::size_t Tick = 0; Tick < kBenchmarkTicks; ++Tick)
+        {
+            Inputs.Pitch = 0.5f * std::sin(static_cast<float>(Tick) * 0.001f);
+            Sink.NowNs = static_cast<std::int64_t>(Tick) * kTickNs;
+            Engine.Tick(Sink.NowNs, Inputs, Sink);
+        }
+        const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        const double TickUs = Seconds * 1e6 / static_cast<double>(kBenchmarkTicks);
+        std::cout << "[Trigger] Benchmark: " << Engine.GetActiveCount() << " effects, " << TickUs << " us/tick ("
+                  << TickUs * 1000.0 / static_cast<double>(kBenchmarkEffects) << " ns/effect), " << Engine.GetWriteCount()
+                  << " writes in " << kBenchmarkTicks << " ticks" << std::endl;
+        Test.Expect(Engine.GetActiveCount() == kBenchmarkEffects, "benchmark effects expired");
+        Test.Expect(TickUs < 250.0, "512 effects take more than a quarter of a 1 kHz tick");
+        Test.Expect(Engine.GetWriteCount() < kBenchmarkTicks / 4, "benchmark writes on most ticks");
+    }
+
+    return Test.Finish();
+}
@@ -0,0 +1,158 @@
+// uinput smoke test: creates the virtual gamepad through UInputAdapter, finds its evdev node by name,
+// sends one decoded state and reads the button and axes back, then checks that Shutdown stops the
+// rumble with the mailbox's stop flag instead of posting. Skips (and passes) when /dev/uinput is
+// missing or not writable, as in containers and on CI runners; the read-back is skipped when the
+// evdev node is not readable.
+//
+//   test-uinput-adapter
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <linux/input.h>
+#include <poll.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+
+#include "Audio/RumbleBridge.h"
+#include "Platform_Linux/UInputAdapter/UInputAdapter.h"
+#include "Testing/TestReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr const char* kDeviceName = "DualSense Mod Virtual Gamepad";
+    constexpr int kNodeWaitMs = 2000; // udev creates the node asynchronously
+    constexpr int kReadTimeoutMs = 1000;
+
+    int OpenEventNode(const char* Name)
+    {
+        DIR* Directory = opendir("/dev/input");
+        if (!Directory)
+        {
+            return -1;
+        }
+        int Found = -1;
+        while (dirent* Entry = readdir(Directory))
+        {
+            if (std::strncmp(Entry->d_name, "event", 5) != 0)
+            {
+                continue;
+            }
+            const int Fd = open((std::string("/dev/input/") + Entry->d_name).c_str(), O_RDONLY | O_NONBLOCK);
+            char DeviceName[256] = {};
+            if (Fd >= 0 && ioctl(Fd, EVIOCGNAME(sizeof(DeviceName) - 1), DeviceName) >= 0 && std::strcmp(DeviceName, Name) == 0)
+            {
+                Found = Fd;
+                break;
+            }
+            if (Fd >= 0)
+            {
+                close(Fd);
+            }
+        }
+        closedir(Directory);
+        return Found;
+    }
+
+    struct FReadBack
+    {
+        int Cross = -1;
+        int LeftX = 0;
+        int RightTrigger = 0;
+        bool bSynced = false;
+    };
+
+    FReadBack ReadReport(int Fd)
+    {
+        FReadBack Result;
+        pollfd Poll{Fd, POLLIN, 0};
+        while (!Result.bSynced && poll(&Poll, 1, kReadTimeoutMs) > 0)
+        {
+            input_event Event;
+            while (read(Fd, &Event, sizeof(Event)) == static_cast<ssize_t>(sizeof(Event)))
+            {
+                if (Event.type == EV_KEY && Event.code == BTN_SOUTH)
+                {
+                    Result.Cross = Event.value;
+                }
+                else if (Event.type == EV_ABS && Event.code == ABS_X)
+                {
+                    Result.LeftX = Event.value;
+                }
+                else if (Event.type == EV_ABS && Event.code == ABS_RZ)
+                {
+                    Result.RightTrigger = Event.value;
+                }
+                else if (Event.type == EV_SYN && Event.code == SYN_REPORT)
+                {
+                    Result.bSynced = true;
+                }
+            }
+        }
+        return Result;
+    }
+} // namespace
+
+int main()
+{
+    FTestReport Test("UInput Adapter");
+
+    if (access("/dev/uinput", R_OK | W_OK) != 0)
+    {
+        std::cout << "[UInput] /dev/uinput not available (" << std::strerror(errno) << "), skipped" << std::endl;
+        return Test.Finish();
+    }
+
+    FRumbleMailbox Mailbox;
+    UInputAdapter Adapter;
+    Adapter.SetRumbleMailbox(&Mailbox);
+    if (!Test.Expect(Adapter.Initialize(), "virtual gamepad not created although /dev/uinput is writable"))
+    {
+        return Test.Finish();
+    }
+
+    // 1. A decoded state reaches the evdev node
+    {
+        int EventFd = -1;
+        const auto Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kNodeWaitMs);
+        while ((EventFd = OpenEventNode(kDeviceName)) < 0 && std::chrono::steady_clock::now() < Deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (EventFd < 0)
+        {
+            std::cout << "[UInput] evdev node not found or not readable, read-back skipped" << std::endl;
+        }
+        else
+        {
+            FInputContext Context;
+            Context.bCross = true;
+            Context.LeftAnalog.X = 1.0f;
+            Context.RightTriggerAnalog = 1.0f;
+            Adapter.Update(Context);
+
+            const FReadBack Report = ReadReport(EventFd);
+            Test.Expect(Report.bSynced, "no SYN_REPORT read back from the evdev node");
+            Test.Expect(Report.Cross == 1, "cross not reported as BTN_SOUTH");
+            Test.Expect(Report.LeftX == 32767 && Report.RightTrigger == 255, "stick or trigger not scaled to the evdev ranges");
+            close(EventFd);
+        }
+    }
+
+    // 2. Shutdown stops a playing rumble through the stop flag and never posts itself
+    {
+        Mailbox.Post(200, 100);
+        Adapter.Shutdown();
+        Test.Expect(Mailbox.GetPostCount() == 1, "shutdown posted into the rumble mailbox");
+        Test.Expect(Mailbox.GetStoppedThrough() > Mailbox.GetPostCount(), "shutdown did not stop the rumble");
+    }
+
+    return Test.Finish();
+}
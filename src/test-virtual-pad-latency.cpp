@@ -0,0 +1,154 @@
+// Virtual pad latency test: HID read to virtual report, through the service's own input loop
+// (FInputLoop) reading a simulated Bluetooth DualSense and forwarding to FMemoryRecorderSink.
+// A button and stick change is injected every few reports; checks that each one reaches the
+// recorder within one report interval of virtual time and that every report read is forwarded
+// exactly once, then prints the CPU time from the start of the read to the recorder's timestamp.
+//
+//   test-virtual-pad-latency [reports] [change every n reports]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GCore/Interfaces/IPlatformHardwareInfo.h"
+#include "Input/CalibrationCache.h"
+#include "Platform_Simulated/test_simulated_hardware_policy.h"
+#include "Service/GamepadService.h"
+#include "Simulation/SimulatedClock.h"
+#include "Simulation/SimulatedDualSense.h"
+#include "Testing/TestReport.h"
+#include "VirtualPad/MemoryRecorderSink.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr std::uint64_t kDefaultReports = 20000;
+    constexpr std::uint64_t kDefaultChangeEvery = 25;
+    constexpr std::int64_t kReportIntervalNs = 4000000; // 250 Hz Bluetooth reports
+    constexpr std::int64_t kAttachTimeoutNs = 1000000000;
+    constexpr std::int64_t kWallP99BudgetNs = 2000000; // regression budget for read + decode + forward on one core
+    constexpr std::uint8_t kCrossBit = 0x20;           // Buttons0 high nibble: square, cross, circle, triangle
+
+    std::int64_t SteadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::int64_t Percentile(std::vector<std::int64_t> Values, double P)
+    {
+        if (Values.empty())
+        {
+            return 0;
+        }
+        std::sort(Values.begin(), Values.end());
+        return Values[std::min(Values.size() - 1, static_cast<std::size_t>(Values.size() * P / 100.0))];
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::uint64_t Reports = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultReports;
+    const std::uint64_t ChangeEvery = std::max<std::uint64_t>(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : kDefaultChangeEvery, 1);
+    FTestReport Test("Virtual Pad Latency", std::to_string(Reports) + " reports, a change every " + std::to_string(ChangeEvery));
+
+    // Single-threaded: with no clock participants, the loop's report waits advance virtual time themselves
+    FSimulatedClock Clock;
+    IServiceClock::SetInstance(&Clock);
+
+    FSimulatedBus& Bus = FSimulatedBus::Get();
+    Bus.bKeepOutputs = false;
+    Bus.Devices.emplace_back("sim://dualsense/latency", ESimulatedTransport::Bluetooth);
+    FSimulatedDualSense& Device = Bus.Devices.front();
+    Device.SetReportInterval(kReportIntervalNs);
+
+    IPlatformHardwareInfo::SetInstance(std::make_unique<Ftest_simulated_platform::Ftest_simulated_hardware>());
+    auto Registry = std::make_unique<FServiceDeviceRegistry>();
+    Registry->Policy.deviceId = 0;
+
+    FMemoryRecorderSink Recorder;
+    Recorder.Initialize();
+    FGamepadService Service;
+    Service.SetVirtualPad(&Recorder);
+    Service.Start();
+    auto Loop = std::make_unique<FInputLoop>(Service, *Registry, FGamepadServiceSettings{});
+
+    // Attach and settle on full reports before measuring
+    while ((!Service.GetAttachedGamepad() || Recorder.GetFrameCount() == 0) && Clock.NowNs() < kAttachTimeoutNs)
+    {
+        Loop->Tick();
+    }
+    Test.Expect(Service.GetAttachedGamepad() != nullptr, "controller not attached");
+
+    std::vector<std::int64_t> WallLatencyNs;
+    std::vector<std::int64_t> VirtualLatencyNs;
+    WallLatencyNs.reserve(Reports);
+    std::uint64_t Changes = 0;
+    std::uint64_t ChangesSeen = 0;
+    std::uint64_t ExtraFrames = 0;
+    bool bPending = false;
+    std::int64_t ChangedAtNs = 0;
+    FSimulatedPadState State;
+
+    const std::uint64_t ReadsBefore = Device.GetInputReportCount();
+    const std::uint64_t FramesBefore = Recorder.GetFrameCount();
+    while (Recorder.GetFrameCount() - FramesBefore < Reports && Service.GetAttachedGamepad())
+    {
+        const std::uint64_t Frame = Recorder.GetFrameCount() - FramesBefore;
+        if (!bPending && Frame % ChangeEvery == ChangeEvery - 1)
+        {
+            // Lands between two reads, like a real press
+            State.Buttons0 ^= kCrossBit;
+            State.LeftStickX = State.LeftStickX == 0x80 ? 0xFF : 0x80;
+            Device.SetState(State, Clock.NowNs());
+            ChangedAtNs = Clock.NowNs();
+            bPending = true;
+            ++Changes;
+        }
+
+        const std::uint64_t FramesBeforeTick = Recorder.GetFrameCount();
+        const std::int64_t TickStartNs = SteadyNowNs();
+        Loop->Tick();
+        const std::uint64_t Forwarded = Recorder.GetFrameCount() - FramesBeforeTick;
+        if (Forwarded == 0)
+        {
+            continue;
+        }
+        ExtraFrames += Forwarded - 1;
+
+        const FMemoryRecorderSink::FFrame* Last = Recorder.GetFrame(Recorder.GetFrameCount() - 1);
+        WallLatencyNs.push_back(Last->TimestampNs - TickStartNs);
+        if (bPending && Last->State.bCross == ((State.Buttons0 & kCrossBit) != 0))
+        {
+            VirtualLatencyNs.push_back(Clock.NowNs() - ChangedAtNs);
+            ++ChangesSeen;
+            bPending = false;
+        }
+    }
+    const std::uint64_t Reads = Device.GetInputReportCount() - ReadsBefore;
+    const std::uint64_t Frames = Recorder.GetFrameCount() - FramesBefore;
+
+    Service.Stop();
+    Loop.reset();
+    Registry.reset();
+    IPlatformHardwareInfo::SetInstance(nullptr);
+    FCalibrationCache::Get().Shutdown();
+    IServiceClock::SetInstance(nullptr);
+
+    std::cout << "[Latency] " << Frames << " virtual reports from " << Reads << " HID reads over " << Clock.NowMs() / 1000.0 << " virtual s; " << ChangesSeen << "/"
+              << Changes << " changes forwarded within " << Percentile(VirtualLatencyNs, 100.0) / 1e6 << " ms (virtual)" << std::endl;
+    std::cout << "[Latency] HID read to virtual report: p50 " << Percentile(WallLatencyNs, 50.0) << " ns, p99 " << Percentile(WallLatencyNs, 99.0) << " ns, max "
+              << Percentile(WallLatencyNs, 100.0) << " ns" << std::endl;
+
+    Test.Expect(Frames == Reports, "input loop stopped forwarding");
+    Test.Expect(Frames == Reads && ExtraFrames == 0, "a report was read without being forwarded, or forwarded twice");
+    Test.Expect(ChangesSeen == Changes, "a state change never reached the virtual pad");
+    Test.Expect(Percentile(VirtualLatencyNs, 100.0) <= kReportIntervalNs, "a change took more than one report interval to reach the virtual pad");
+    Test.Expect(Percentile(WallLatencyNs, 99.0) <= kWallP99BudgetNs, "read to virtual report p99 over budget");
+
+    return Test.Finish();
+}
@@ -0,0 +1,262 @@
+// X360 report test: the table-driven BuildXusbReport against the per-button branches it replaced, and
+// TReportChangeFilter in front of a stubbed vigem_target_x360_update that counts round trips and
+// spins for roughly the cost of one. Checks the mapping on random states, that every changed report is
+// submitted, that idle stretches only send keep-alives, then benchmarks the report build and the
+// per-tick cost with and without the filter.
+//
+//   test-xusb-report [seconds of input] [round-trip-ns]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Testing/TestReport.h"
+#include "VirtualPad/ReportChangeFilter.h"
+#include "VirtualPad/XusbReport.h"
+
+using namespace GamepadCore;
+
+namespace
+{
+    constexpr double kDefaultSeconds = 60.0;
+    constexpr std::int64_t kDefaultRoundTripNs = 20000;
+    constexpr std::int64_t kReportIntervalMs = 4; // 250 Hz Bluetooth input
+    constexpr int kSegmentReports = 500;          // alternating 2 s idle / 2 s moving stretches
+    constexpr std::size_t kRandomStates = 100000;
+    constexpr auto kKeepAlive = std::chrono::milliseconds(100);
+
+    using FFilterClock = TReportChangeFilter<FXusbReport>::Clock;
+
+    // The pre-table ViGEmAdapter::Update mapping, one branch per button
+    FXusbReport BuildXusbReportBranches(const FInputContext& Context)
+    {
+        FXusbReport Report;
+        if (Context.bCross) Report.Buttons |= 0x1000;
+        if (Context.bCircle) Report.Buttons |= 0x2000;
+        if (Context.bSquare) Report.Buttons |= 0x4000;
+        if (Context.bTriangle) Report.Buttons |= 0x8000;
+        if (Context.bDpadUp) Report.Buttons |= 0x0001;
+        if (Context.bDpadDown) Report.Buttons |= 0x0002;
+        if (Context.bDpadLeft) Report.Buttons |= 0x0004;
+        if (Context.bDpadRight) Report.Buttons |= 0x0008;
+        if (Context.bStart) Report.Buttons |= 0x0010;
+        if (Context.bShare) Report.Buttons |= 0x0020;
+        if (Context.bLeftShoulder) Report.Buttons |= 0x0100;
+        if (Context.bRightShoulder) Report.Buttons |= 0x0200;
+        if (Context.bLeftStick) Report.Buttons |= 0x0040;
+        if (Context.bRightStick) Report.Buttons |= 0x0080;
+        if (Context.bPSButton) Report.Buttons |= 0x0400;
+        Report.LeftTrigger = static_cast<std::uint8_t>(Context.LeftTriggerAnalog * 255.0f);
+        Report.RightTrigger = static_cast<std::uint8_t>(Context.RightTriggerAnalog * 255.0f);
+        Report.ThumbLX = static_cast<std::int16_t>(std::clamp(Context.LeftAnalog.X * 32767.0f, -32768.0f, 32767.0f));
+        Report.ThumbLY = static_cast<std::int16_t>(std::clamp(Context.LeftAnalog.Y * 32767.0f, -32768.0f, 32767.0f));
+        Report.ThumbRX = static_cast<std::int16_t>(std::clamp(Context.RightAnalog.X * 32767.0f, -32768.0f, 32767.0f));
+        Report.ThumbRY = static_cast<std::int16_t>(std::clamp(Context.RightAnalog.Y * 32767.0f, -32768.0f, 32767.0f));
+        return Report;
+    }
+
+    FInputContext RandomState(std::mt19937& Random)
+    {
+        std::uniform_real_distribution<float> Axis(-1.2f, 1.2f);
+        std::uniform_real_distribution<float> Trigger(0.0f, 1.0f);
+        FInputContext Context;
+        for (const FXusbButtonMapping& Mapping : kXusbButtonMap)
+        {
+            Context.*Mapping.Field = Random() % 3 == 0;
+        }
+        Context.LeftAnalog.X = Axis(Random);
+        Context.LeftAnalog.Y = Axis(Random);
+        Context.RightAnalog.X = Axis(Random);
+        Context.RightAnalog.Y = Axis(Random);
+        Context.LeftTriggerAnalog = Trigger(Random);
+        Context.RightTriggerAnalog = Trigger(Random);
+        return Context;
+    }
+
+    // Play session: still stretches (menus, cutscenes) between stretches of stick movement and presses
+    std::vector<FInputContext> MakeSession(std::size_t Reports)
+    {
+        std::vector<FInputContext> Session(Reports);
+        FInputContext State;
+        for (std::size_t i = 0; i < Reports; ++i)
+        {
+            if ((i / kSegmentReports) % 2 == 1)
+            {
+                const float Phase = static_cast<float>(i) * 0.05f;
+                State.LeftAnalog.X = 0.8f * std::sin(Phase);
+                State.LeftAnalog.Y = 0.8f * std::cos(Phase);
+                State.bCross = (i / 50) % 2 == 1;
+            }
+            Session[i] = State;
+        }
+        return Session;
+    }
+
+    struct FStubClient
+    {
+        std::int64_t RoundTripNs = 0;
+        std::uint64_t RoundTrips = 0;
+        std::uint64_t Checksum = 0;
+
+        // vigem_target_x360_update: the report goes to the bus driver and back
+        void Update(const FXusbReport& Report)
+        {
+            ++RoundTrips;
+            Checksum += Report.Buttons + static_cast<std::uint16_t>(Report.ThumbLX);
+            const auto Deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(RoundTripNs);
+            while (std::chrono::steady_clock::now() < Deadline)
+            {
+            }
+        }
+    };
+
+    FFilterClock::time_point ReportTime(std::size_t Index)
+    {
+        return FFilterClock::time_point{} + std::chrono::milliseconds(static_cast<std::int64_t>(Index) * kReportIntervalMs);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const double Seconds = argc > 1 ? std::strtod(argv[1], nullptr) : kDefaultSeconds;
+    const std::int64_t RoundTripNs = argc > 2 ? std::strtoll(argv[2], nullptr, 10) : kDefaultRoundTripNs;
+    FTestReport Test("XUSB Report", std::to_string(Seconds) + " s of input, " + std::to_string(RoundTripNs) + " ns per round trip");
+    const std::size_t Reports = static_cast<std::size_t>(Seconds * 1000.0 / kReportIntervalMs);
+
+    // 1. Mapping: one bit per button, the same reports as the branches it replaced
+    {
+        std::uint16_t AllMasks = 0;
+        bool bOneBitEach = true;
+        for (const FXusbButtonMapping& Mapping : kXusbButtonMap)
+        {
+            FInputContext Context;
+            Context.*Mapping.Field = true;
+            bOneBitEach = bOneBitEach && BuildXusbReport(Context).Buttons == Mapping.Mask && (AllMasks & Mapping.Mask) == 0;
+            AllMasks |= Mapping.Mask;
+        }
+        Test.Expect(bOneBitEach, "a button maps to the wrong XUSB bit, or two buttons share one");
+        Test.Expect(AllMasks == 0xF7FF, "XUSB button table incomplete");
+
+        std::mt19937 Random(32);
+        std::size_t Mismatches = 0;
+        for (std::size_t i = 0; i < kRandomStates; ++i)
+        {
+            const FInputContext Context = RandomState(Random);
+            Mismatches += BuildXusbReport(Context) == BuildXusbReportBranches(Context) ? 0 : 1;
+        }
+        Test.Expect(Mismatches == 0, "table-driven report differs from the per-button mapping");
+
+        FInputContext Extreme;
+        Extreme.LeftAnalog.X = 1.5f;
+        Extreme.LeftAnalog.Y = -1.5f;
+        Extreme.RightAnalog.X = -1.0f;
+        Extreme.RightAnalog.Y = 1.0f;
+        Extreme.RightTriggerAnalog = 1.0f;
+        const FXusbReport Report = BuildXusbReport(Extreme);
+        Test.Expect(Report.ThumbLX == 32767 && Report.ThumbLY == -32768, "stick axes not clamped to the XInput range");
+        Test.Expect(Report.ThumbRX == -32767 && Report.ThumbRY == 32767, "stick Y inverted or scaled wrongly");
+        Test.Expect(Report.RightTrigger == 255 && Report.LeftTrigger == 0, "triggers not scaled to 0..255");
+    }
+
+    const std::vector<FInputContext> Session = MakeSession(Reports);
+
+    // 2. Filter: changed reports always go out, idle stretches only send keep-alives
+    {
+        FStubClient Client;
+        TReportChangeFilter<FXusbReport> Filter(kKeepAlive);
+        std::uint64_t Changes = 0, ChangesSubmitted = 0, IdleSubmits = 0;
+        FXusbReport Previous;
+        for (std::size_t i = 0; i < Session.size(); ++i)
+        {
+            const FXusbReport Report = BuildXusbReport(Session[i]);
+            const bool bChanged = i == 0 || !(Report == Previous);
+            Previous = Report;
+            const bool bSubmit = Filter.ShouldSubmit(Report, ReportTime(i));
+            if (bSubmit)
+            {
+                Client.Update(Report);
+            }
+            Changes += bChanged ? 1 : 0;
+            ChangesSubmitted += bChanged && bSubmit ? 1 : 0;
+            IdleSubmits += !bChanged && bSubmit ? 1 : 0;
+        }
+
+        const std::uint64_t KeepAlivesPerIdle = kSegmentReports * kReportIntervalMs / kKeepAlive.count();
+        const std::uint64_t IdleStretches = (Session.size() + 2 * kSegmentReports - 1) / (2 * kSegmentReports);
+        std::cout << "[Xusb] " << Session.size() << " reports, " << Changes << " changed: " << Filter.GetSubmittedCount() << " round trips, "
+                  << Filter.GetSkippedCount() << " skipped, " << IdleSubmits << " keep-alives" << std::endl;
+        Test.Expect(Filter.GetSubmittedCount() + Filter.GetSkippedCount() == Session.size(), "filter lost count of reports");
+        Test.Expect(Client.RoundTrips == Filter.GetSubmittedCount(), "submitted count differs from the client's round trips");
+        Test.Expect(ChangesSubmitted == Changes, "a changed report was skipped");
+        Test.Expect(IdleSubmits <= IdleStretches * KeepAlivesPerIdle, "unchanged reports sent more often than the keep-alive");
+        Test.Expect(Session.size() < 2 * kSegmentReports || IdleSubmits >= KeepAlivesPerIdle - 1, "no keep-alive during an idle stretch");
+
+        TReportChangeFilter<FXusbReport> NoKeepAlive(std::chrono::milliseconds(0));
+        const FXusbReport Idle = BuildXusbReport(FInputContext{});
+        std::uint64_t Sent = 0;
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            Sent += NoKeepAlive.ShouldSubmit(Idle, ReportTime(i)) ? 1 : 0;
+        }
+        Test.Expect(Sent == 1, "zero keep-alive still resent an unchanged report");
+        NoKeepAlive.Invalidate();
+        Test.Expect(NoKeepAlive.ShouldSubmit(Idle, ReportTime(1000)), "invalidated filter skipped the next report");
+    }
+
+    // 3. Benchmark: report build (table vs branches) and per-tick cost with and without the filter
+    {
+        std::mt19937 Random(320);
+        std::vector<FInputContext> States(4096);
+        for (FInputContext& State : States)
+        {
+            State = RandomState(Random);
+        }
+        const std::size_t Builds = States.size() * 200;
+        std::uint64_t Checksum = 0;
+        auto Start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < Builds; ++i)
+        {
+            Checksum += BuildXusbReport(States[i % States.size()]).Buttons;
+        }
+        const double TableNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Builds);
+        Start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < Builds; ++i)
+        {
+            Checksum += BuildXusbReportBranches(States[i % States.size()]).Buttons;
+        }
+        const double BranchesNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Builds);
+
+        FStubClient Unfiltered{RoundTripNs};
+        Start = std::chrono::steady_clock::now();
+        for (const FInputContext& State : Session)
+        {
+            Unfiltered.Update(BuildXusbReport(State));
+        }
+        const double UnfilteredUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Session.size());
+
+        FStubClient Filtered{RoundTripNs};
+        TReportChangeFilter<FXusbReport> Filter(kKeepAlive);
+        Start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < Session.size(); ++i)
+        {
+            const FXusbReport Report = BuildXusbReport(Session[i]);
+            if (Filter.ShouldSubmit(Report, ReportTime(i)))
+            {
+                Filtered.Update(Report);
+            }
+        }
+        const double FilteredUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Session.size());
+
+        std::cout << "[Xusb] build: table " << TableNs << " ns, branches " << BranchesNs << " ns per report (checksum " << Checksum + Unfiltered.Checksum + Filtered.Checksum
+                  << "); per tick: every report " << UnfilteredUs << " us (" << Unfiltered.RoundTrips << " round trips), filtered " << FilteredUs << " us ("
+                  << Filtered.RoundTrips << " round trips)" << std::endl;
+        Test.Expect(Filtered.RoundTrips < Unfiltered.RoundTrips, "filter saved no round trips on a session with idle stretches");
+    }
+
+    return Test.Finish();
+}
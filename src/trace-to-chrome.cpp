@@ -0,0 +1,108 @@
+// Converts a GamepadService.trace ring file into Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+//
+//   trace-to-chrome GamepadService.trace [out.json]
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "Diagnostics/FrameTrace.h"
+
+using namespace GamepadCore;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: trace-to-chrome <trace file> [output.json]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    FTraceFileHeader header{};
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.Magic, FTraceFileHeader::ExpectedMagic, sizeof(header.Magic)) != 0 ||
+        header.Version != FTraceFileHeader::CurrentVersion || header.RecordSize != sizeof(FTraceRecord) ||
+        header.Capacity == 0 || (header.Capacity & (header.Capacity - 1)) != 0 ||
+        header.ThreadNameCapacity > FFrameTrace::ThreadNameCapacity) {
+        std::cerr << "[Trace] " << argv[1] << " is not a trace file of this version." << std::endl;
+        return 1;
+    }
+
+    // Thread names sit outside the ring, so even the tracks of threads named long before the wrap keep their labels
+    std::vector<FTraceThreadName> threadNames(header.ThreadNameCapacity);
+    input.read(reinterpret_cast<char*>(threadNames.data()), static_cast<std::streamsize>(threadNames.size() * sizeof(FTraceThreadName)));
+    threadNames.resize(std::min<std::size_t>(header.ThreadNameCount, threadNames.size()));
+
+    std::vector<FTraceRecord> ring(header.Capacity);
+    input.read(reinterpret_cast<char*>(ring.data()), static_cast<std::streamsize>(ring.size() * sizeof(FTraceRecord)));
+
+    // Oldest surviving record first, then sort by time: threads claim slots and stamp them in slightly different orders
+    const std::uint64_t count = std::min<std::uint64_t>(header.WriteIndex, header.Capacity);
+    std::vector<FTraceRecord> records;
+    records.reserve(count);
+    for (std::uint64_t i = header.WriteIndex - count; i < header.WriteIndex; ++i) {
+        const FTraceRecord& record = ring[i & (header.Capacity - 1)];
+        if (record.TimestampNs != 0 && record.Event < ETraceEvent::Count) {
+            records.push_back(record);
+        }
+    }
+    std::stable_sort(records.begin(), records.end(), [](const FTraceRecord& a, const FTraceRecord& b) { return a.TimestampNs < b.TimestampNs; });
+
+    std::FILE* output = argc > 2 ? std::fopen(argv[2], "w") : stdout;
+    if (!output) {
+        std::cerr << "[Trace] Cannot write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    const std::uint64_t origin = records.empty() ? 0 : records.front().TimestampNs;
+    std::unordered_map<std::uint16_t, int> openScopes;
+    size_t written = 0;
+
+    std::fprintf(output, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    auto separator = [&]() { return written++ == 0 ? "" : ",\n"; };
+    auto nameThread = [&](std::uint16_t threadId, std::uint32_t thread) {
+        std::fprintf(output, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                     separator(), threadId, GetTraceThreadName(thread));
+    };
+
+    for (const FTraceThreadName& name : threadNames) {
+        if (name.ThreadId != 0) {
+            nameThread(name.ThreadId, name.Thread);
+        }
+    }
+
+    for (const FTraceRecord& record : records) {
+        const double ts = static_cast<double>(record.TimestampNs - origin) / 1000.0;
+
+        // Only threads named after the side table filled up
+        if (record.Event == ETraceEvent::ThreadName) {
+            nameThread(record.ThreadId, record.Arg);
+            continue;
+        }
+
+        // The ring may have overwritten the Begin of the oldest scopes: drop their orphaned Ends
+        const char* phase = "i";
+        if (record.Phase == ETracePhase::Begin) {
+            ++openScopes[record.ThreadId];
+            phase = "B";
+        } else if (record.Phase == ETracePhase::End) {
+            int& open = openScopes[record.ThreadId];
+            if (open == 0) continue;
+            --open;
+            phase = "E";
+        }
+
+        std::fprintf(output, "%s{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u%s,\"args\":{\"arg\":%u}}",
+                     separator(), GetTraceEventName(record.Event), phase, ts, record.ThreadId,
+                     record.Phase == ETracePhase::Instant ? ",\"s\":\"t\"" : "", record.Arg);
+    }
+
+    std::fprintf(output, "\n]}\n");
+    if (output != stdout) std::fclose(output);
+
+    std::cerr << "[Trace] " << records.size() << " events (" << header.WriteIndex << " recorded, ring of " << header.Capacity << "), "
+              << header.ThreadNameCount << " named threads." << std::endl;
+    return 0;
+}